@@ -26,11 +26,14 @@ import dreamplace.ops.rmst_wl.rmst_wl as rmst_wl
 import dreamplace.ops.macro_legalize.macro_legalize as macro_legalize 
 import dreamplace.ops.greedy_legalize.greedy_legalize as greedy_legalize 
 import dreamplace.ops.abacus_legalize.abacus_legalize as abacus_legalize 
+import dreamplace.ops.flow_legalize.flow_legalize as flow_legalize 
 import dreamplace.ops.legality_check.legality_check as legality_check 
 import dreamplace.ops.draw_place.draw_place as draw_place 
 import dreamplace.ops.pin_pos.pin_pos as pin_pos
+import dreamplace.ops.detailed_place.detailed_place as detailed_place
 import dreamplace.ops.global_swap.global_swap as global_swap 
 import dreamplace.ops.k_reorder.k_reorder as k_reorder
+import dreamplace.ops.k_reorder_flip.k_reorder_flip as k_reorder_flip
 import dreamplace.ops.independent_set_matching.independent_set_matching as independent_set_matching
 import pdb 
 
@@ -56,6 +59,8 @@ class PlaceDataCollection (object):
 
         self.pin_offset_x = torch.tensor(placedb.pin_offset_x, dtype=self.pos[0].dtype, device=device)
         self.pin_offset_y = torch.tensor(placedb.pin_offset_y, dtype=self.pos[0].dtype, device=device)
+        # movable cells flipped horizontally in detailed placement, with pin_offset_x updated accordingly 
+        self.node_flip_x = torch.zeros(placedb.num_movable_nodes, dtype=torch.uint8, device=device)
 
         self.pin2node_map = torch.from_numpy(placedb.pin2node_map).to(device)
         self.flat_node2pin_map = torch.from_numpy(placedb.flat_node2pin_map).to(device)
@@ -397,7 +402,8 @@ class BasicPlace (nn.Module):
                 xl=placedb.xl, yl=placedb.yl, xh=placedb.xh, yh=placedb.yh, 
                 site_width=placedb.site_width, row_height=placedb.row_height, 
                 num_terminals=placedb.num_terminals, 
-                num_movable_nodes=placedb.num_movable_nodes
+                num_movable_nodes=placedb.num_movable_nodes, 
+                num_threads=params.num_threads
                 )
 
     def build_legalization(self, params, placedb, data_collections, device):
@@ -418,7 +424,8 @@ class BasicPlace (nn.Module):
                 num_bins_x=params.num_bins_x, num_bins_y=params.num_bins_y, 
                 num_movable_nodes=placedb.num_movable_nodes, 
                 num_terminal_NIs=placedb.num_terminal_NIs, 
-                num_filler_nodes=placedb.num_filler_nodes
+                num_filler_nodes=placedb.num_filler_nodes, 
+                num_threads=params.num_threads
                 )
         # for standard cell legalization
         gl = greedy_legalize.GreedyLegalize(
@@ -426,11 +433,11 @@ class BasicPlace (nn.Module):
                 flat_region_boxes=data_collections.flat_region_boxes, flat_region_boxes_start=data_collections.flat_region_boxes_start, node2fence_region_map=data_collections.node2fence_region_map, 
                 xl=placedb.xl, yl=placedb.yl, xh=placedb.xh, yh=placedb.yh, 
                 site_width=placedb.site_width, row_height=placedb.row_height, 
-                num_bins_x=1, num_bins_y=64, 
-                #num_bins_x=64, num_bins_y=64, 
+                num_bins_x=params.greedy_legalize_num_bins_x, num_bins_y=params.greedy_legalize_num_bins_y, 
                 num_movable_nodes=placedb.num_movable_nodes, 
                 num_terminal_NIs=placedb.num_terminal_NIs, 
-                num_filler_nodes=placedb.num_filler_nodes
+                num_filler_nodes=placedb.num_filler_nodes, 
+                num_threads=params.num_threads
                 )
         # for standard cell legalization
         al = abacus_legalize.AbacusLegalize(
@@ -442,11 +449,33 @@ class BasicPlace (nn.Module):
                 #num_bins_x=64, num_bins_y=64, 
                 num_movable_nodes=placedb.num_movable_nodes, 
                 num_terminal_NIs=placedb.num_terminal_NIs, 
-                num_filler_nodes=placedb.num_filler_nodes
+                num_filler_nodes=placedb.num_filler_nodes, 
+                num_threads=params.num_threads
                 )
+        # for standard cell legalization with min-cost flow 
+        fl = None 
+        if params.legalize_engine == "flow": 
+            fl = flow_legalize.FlowLegalize(
+                    node_size_x=data_collections.node_size_x, node_size_y=data_collections.node_size_y, 
+                    flat_region_boxes=data_collections.flat_region_boxes, flat_region_boxes_start=data_collections.flat_region_boxes_start, node2fence_region_map=data_collections.node2fence_region_map, 
+                    xl=placedb.xl, yl=placedb.yl, xh=placedb.xh, yh=placedb.yh, 
+                    site_width=placedb.site_width, row_height=placedb.row_height, 
+                    num_movable_nodes=placedb.num_movable_nodes, 
+                    num_terminal_NIs=placedb.num_terminal_NIs, 
+                    num_filler_nodes=placedb.num_filler_nodes, 
+                    max_displacement=params.legalize_max_displacement*placedb.row_height, 
+                    num_threads=params.num_threads
+                    )
         def build_legalization_op(pos): 
             logging.info("Start legalization")
             pos1 = ml(pos, pos)
+            if fl is not None: 
+                # multi-row cells are regarded as obstacles at their current locations in flow legalization 
+                pos2 = fl(pos1, pos1)
+                legal = self.op_collections.legality_check_op(pos2)
+                if legal: 
+                    return pos2 
+                logging.warning("legality check failed in flow legalization, fall back to greedy legalization")
             pos2 = gl(pos1, pos1)
             legal = self.op_collections.legality_check_op(pos2)
             if not legal:
@@ -457,49 +486,70 @@ class BasicPlace (nn.Module):
 
     def build_detailed_placement(self, params, placedb, data_collections, device):
         """
-        @brief detailed placement consisting of global swap and independent set matching 
+        @brief detailed placement consisting of k-reorder, global swap and independent set matching 
         @param params parameters 
         @param placedb placement database 
         @param data_collections a collection of all data and variables required for constructing the ops 
         @param device cpu or cuda 
         """
-        gs = global_swap.GlobalSwap(
-                node_size_x=data_collections.node_size_x, node_size_y=data_collections.node_size_y, 
-                flat_region_boxes=data_collections.flat_region_boxes, flat_region_boxes_start=data_collections.flat_region_boxes_start, node2fence_region_map=data_collections.node2fence_region_map, 
-                flat_net2pin_map=data_collections.flat_net2pin_map, flat_net2pin_start_map=data_collections.flat_net2pin_start_map, pin2net_map=data_collections.pin2net_map, 
-                flat_node2pin_map=data_collections.flat_node2pin_map, flat_node2pin_start_map=data_collections.flat_node2pin_start_map, pin2node_map=data_collections.pin2node_map, 
-                pin_offset_x=data_collections.pin_offset_x, pin_offset_y=data_collections.pin_offset_y, 
-                net_mask=data_collections.net_mask_ignore_large_degrees, 
-                xl=placedb.xl, yl=placedb.yl, xh=placedb.xh, yh=placedb.yh, 
-                site_width=placedb.site_width, row_height=placedb.row_height, 
-                #num_bins_x=placedb.num_bins_x//16, num_bins_y=placedb.num_bins_y//16, 
-                num_bins_x=placedb.num_bins_x//2, num_bins_y=placedb.num_bins_y//2, 
-                num_movable_nodes=placedb.num_movable_nodes, 
-                num_terminal_NIs=placedb.num_terminal_NIs, 
-                num_filler_nodes=placedb.num_filler_nodes, 
-                batch_size=256, 
-                max_iters=2, 
-                algorithm='concurrent', 
-                num_threads=params.num_threads
-                )
-        kr = k_reorder.KReorder(
+        passes = [name.strip() for name in params.detailed_place_schedule.split(',') if name.strip()]
+        if params.detailed_place_flip_flag: 
+            # jointly optimize order and horizontal flipping of cells, which updates pin offsets in place 
+            passes = ["k_reorder_flip" if name == "k_reorder" else name for name in passes]
+        if params.gpu: 
+            return self.build_detailed_placement_cuda(params, placedb, data_collections, passes)
+        # all passes share one database with its row occupancy and net boxes 
+        dp = detailed_place.DetailedPlace(
                 node_size_x=data_collections.node_size_x, node_size_y=data_collections.node_size_y, 
                 flat_region_boxes=data_collections.flat_region_boxes, flat_region_boxes_start=data_collections.flat_region_boxes_start, node2fence_region_map=data_collections.node2fence_region_map, 
                 flat_net2pin_map=data_collections.flat_net2pin_map, flat_net2pin_start_map=data_collections.flat_net2pin_start_map, pin2net_map=data_collections.pin2net_map, 
                 flat_node2pin_map=data_collections.flat_node2pin_map, flat_node2pin_start_map=data_collections.flat_node2pin_start_map, pin2node_map=data_collections.pin2node_map, 
                 pin_offset_x=data_collections.pin_offset_x, pin_offset_y=data_collections.pin_offset_y, 
                 net_mask=data_collections.net_mask_ignore_large_degrees, 
+                node_flip_x=data_collections.node_flip_x, 
                 xl=placedb.xl, yl=placedb.yl, xh=placedb.xh, yh=placedb.yh, 
                 site_width=placedb.site_width, row_height=placedb.row_height, 
                 num_bins_x=placedb.num_bins_x, num_bins_y=placedb.num_bins_y, 
                 num_movable_nodes=placedb.num_movable_nodes, 
                 num_terminal_NIs=placedb.num_terminal_NIs, 
                 num_filler_nodes=placedb.num_filler_nodes, 
+                passes=passes, 
+                max_rounds=params.detailed_place_max_rounds, 
+                stop_threshold=0.1/100, 
                 K=4, 
-                max_iters=2, 
+                k_reorder_max_iters=2, 
+                ism_batch_size=2048, 
+                ism_set_size=128, 
+                ism_max_iters=50, 
+                gs_batch_size=256, 
+                gs_max_iters=2, 
+                # global swap searches in bins twice as large 
+                gs_bin_ratio=2, 
+                gs_deterministic=bool(params.detailed_place_deterministic_flag), 
+                num_shards=params.detailed_place_num_shards, 
                 num_threads=params.num_threads
                 )
-        ism = independent_set_matching.IndependentSetMatching(
+
+        # wirelength for position 
+        def build_detailed_placement_op(pos): 
+            logging.info("Start ABCDPlace for refinement")
+            # legality is checked after each pass, and the passes stop at the first illegal result 
+            pos1 = dp(pos)
+            logging.info("Detailed placement legal flag = %d" % (dp.legal))
+            return pos1 
+        return build_detailed_placement_op
+
+    def build_detailed_placement_cuda(self, params, placedb, data_collections, passes): 
+        """
+        @brief detailed placement with the separate ops, which run CUDA kernels except for k_reorder_flip; 
+        the engine sharing indices across passes only runs on CPU 
+        @param params parameters 
+        @param placedb placement database 
+        @param data_collections a collection of all data and variables required for constructing the ops 
+        @param passes names of passes in a round 
+        """
+        def common_args(num_bins_x, num_bins_y): 
+            return dict(
                 node_size_x=data_collections.node_size_x, node_size_y=data_collections.node_size_y, 
                 flat_region_boxes=data_collections.flat_region_boxes, flat_region_boxes_start=data_collections.flat_region_boxes_start, node2fence_region_map=data_collections.node2fence_region_map, 
                 flat_net2pin_map=data_collections.flat_net2pin_map, flat_net2pin_start_map=data_collections.flat_net2pin_start_map, pin2net_map=data_collections.pin2net_map, 
@@ -508,42 +558,44 @@ class BasicPlace (nn.Module):
                 net_mask=data_collections.net_mask_ignore_large_degrees, 
                 xl=placedb.xl, yl=placedb.yl, xh=placedb.xh, yh=placedb.yh, 
                 site_width=placedb.site_width, row_height=placedb.row_height, 
-                num_bins_x=placedb.num_bins_x, num_bins_y=placedb.num_bins_y, 
+                num_bins_x=num_bins_x, num_bins_y=num_bins_y, 
                 num_movable_nodes=placedb.num_movable_nodes, 
                 num_terminal_NIs=placedb.num_terminal_NIs, 
                 num_filler_nodes=placedb.num_filler_nodes, 
-                batch_size=2048, 
-                set_size=128, 
-                max_iters=50, 
-                algorithm='concurrent', 
                 num_threads=params.num_threads
                 )
+        # the same parameters as the engine on CPU 
+        ops = {}
+        for name in passes: 
+            if name in ops: 
+                continue 
+            if name == "k_reorder": 
+                ops[name] = k_reorder.KReorder(K=4, max_iters=2, **common_args(placedb.num_bins_x, placedb.num_bins_y))
+            elif name == "k_reorder_flip": 
+                ops[name] = k_reorder_flip.KReorderFlip(node_flip_x=data_collections.node_flip_x, K=4, max_iters=2, **common_args(placedb.num_bins_x, placedb.num_bins_y))
+            elif name == "independent_set_matching": 
+                ops[name] = independent_set_matching.IndependentSetMatching(batch_size=2048, set_size=128, max_iters=50, algorithm='concurrent', **common_args(placedb.num_bins_x, placedb.num_bins_y))
+            elif name == "global_swap": 
+                # global swap searches in bins twice as large 
+                ops[name] = global_swap.GlobalSwap(batch_size=256, max_iters=2, algorithm='concurrent', **common_args(max(placedb.num_bins_x//2, 1), max(placedb.num_bins_y//2, 1)))
+            else: 
+                raise ValueError("unknown detailed placement pass %s" % (name))
 
-        # wirelength for position 
         def build_detailed_placement_op(pos): 
             logging.info("Start ABCDPlace for refinement")
             pos1 = pos 
-            for i in range(1): 
-                pos1 = kr(pos1)
-                legal = self.op_collections.legality_check_op(pos1)
-                logging.info("K-Reorder legal flag = %d" % (legal))
-                if not legal:
-                    return pos1 
-                pos1 = ism(pos1)
-                legal = self.op_collections.legality_check_op(pos1)
-                logging.info("Independent set matching legal flag = %d" % (legal))
-                if not legal:
-                    return pos1 
-                pos1 = gs(pos1)
-                legal = self.op_collections.legality_check_op(pos1)
-                logging.info("Global swap legal flag = %d" % (legal))
-                if not legal:
-                    return pos1 
-                pos1 = kr(pos1)
-                legal = self.op_collections.legality_check_op(pos1)
-                logging.info("K-Reorder legal flag = %d" % (legal))
-                if not legal:
-                    return pos1 
+            initial_hpwl = float(self.op_collections.hpwl_op(pos1))
+            for i in range(params.detailed_place_max_rounds): 
+                round_hpwl = float(self.op_collections.hpwl_op(pos1))
+                for name in passes: 
+                    pos1 = ops[name](pos1)
+                    legal = self.op_collections.legality_check_op.incremental(pos1)
+                    logging.info("round %d %s legal flag = %d" % (i, name, legal))
+                    if not legal: 
+                        return pos1 
+                # stop if a round improves HPWL by less than 0.1% of the initial HPWL 
+                if round_hpwl-float(self.op_collections.hpwl_op(pos1)) < 0.1/100*initial_hpwl: 
+                    break 
             return pos1 
         return build_detailed_placement_op
 
@@ -213,7 +213,10 @@ class NonLinearPlace (BasicPlace.BasicPlace):
         # save results 
         cur_pos = self.pos[0].data.clone().cpu().numpy()
         # apply solution 
-        placedb.apply(params, cur_pos[0:placedb.num_movable_nodes], cur_pos[placedb.num_nodes:placedb.num_nodes+placedb.num_movable_nodes])
+        placedb.apply(params, cur_pos[0:placedb.num_movable_nodes], cur_pos[placedb.num_nodes:placedb.num_nodes+placedb.num_movable_nodes], 
+                self.data_collections.node_flip_x.cpu().numpy())
+        # flips are applied to the database 
+        self.data_collections.node_flip_x.zero_()
         # plot placement 
         if params.plot_flag: 
             self.plot(params, placedb, iteration, cur_pos)
@@ -583,13 +583,16 @@ row height = %g, site width = %g
         """
         @brief write placement solution
         @param filename output file name 
-        @param sol_file_format solution file format, DEF|DEFSIMPLE|BOOKSHELF|BOOKSHELFALL
+        @param sol_file_format solution file format, DEF|DEFSIMPLE|DEFDELTA|BOOKSHELF|BOOKSHELFALL
         """
         tt = time.time()
         logging.info("writing to %s" % (filename))
         if sol_file_format is None: 
             if filename.endswith(".def"): 
-                sol_file_format = place_io.SolutionFileFormat.DEF 
+                if params.def_delta_flag: 
+                    sol_file_format = place_io.SolutionFileFormat.DEFDELTA 
+                else:
+                    sol_file_format = place_io.SolutionFileFormat.DEF 
             else:
                 sol_file_format = place_io.SolutionFileFormat.BOOKSHELF
 
@@ -684,9 +687,10 @@ row height = %g, site width = %g
             f.write(content)
         logging.info("write_nets takes %.3f seconds" % (time.time()-tt))
 
-    def apply(self, params, node_x, node_y):
+    def apply(self, params, node_x, node_y, node_flip_x=None):
         """
         @brief apply placement solution and update database 
+        @param node_flip_x flags of movable cells flipped horizontally in detailed placement, None if no cell is flipped 
         """
         # assign solution 
         self.node_x[:self.num_movable_nodes] = node_x[:self.num_movable_nodes]
@@ -704,6 +708,29 @@ row height = %g, site width = %g
         # update raw database 
         place_io.PlaceIOFunction.apply(self.rawdb, node_x, node_y)
 
+        if node_flip_x is not None: 
+            self.flip_x(node_flip_x)
+
+    def flip_x(self, node_flip_x):
+        """
+        @brief flip movable cells horizontally, e.g., N <=> FN, and mirror the offsets of their pins 
+        @param node_flip_x flags of cells to flip 
+        """
+        flip_mask = np.zeros(self.num_physical_nodes, dtype=np.uint8)
+        flip_mask[:self.num_movable_nodes] = (node_flip_x[:self.num_movable_nodes] != 0)
+        if not flip_mask.any(): 
+            return 
+        pin_mask = flip_mask[self.pin2node_map].astype(bool)
+        self.pin_offset_x[pin_mask] = self.node_size_x[self.pin2node_map[pin_mask]] - self.pin_offset_x[pin_mask]
+        hflip_map = {b"N" : b"FN", b"S" : b"FS", b"W" : b"FW", b"E" : b"FE"}
+        hflip_map.update({v : k for k, v in hflip_map.items()})
+        # strings may be of length 1 if all cells are not flipped initially
+        self.node_orient = self.node_orient.astype(np.dtype("S%d" % (max(self.node_orient.dtype.itemsize, 2))))
+        for node_id in np.nonzero(flip_mask)[0]: 
+            self.node_orient[node_id] = hflip_map.get(self.node_orient[node_id], self.node_orient[node_id])
+        place_io.PlaceIOFunction.apply_flip(self.rawdb, flip_mask)
+        logging.info("flip %d cells horizontally" % (np.count_nonzero(flip_mask)))
+
 if __name__ == "__main__":
     if len(sys.argv) != 2:
         logging.error("One input parameters in json format in required")
@@ -6,12 +6,14 @@
 #include "utility/src/torch.h"
 #include "utility/src/LegalizationDB.h"
 #include "utility/src/LegalizationDBUtils.h"
+#include "utility/src/LegalizationRegions.h"
 #include "abacus_legalize/src/abacus_legalize_cpu.h"
 
 DREAMPLACE_BEGIN_NAMESPACE
 
 /// @brief legalize layout with abacus legalization. 
 /// Only movable nodes will be moved. Fixed nodes and filler nodes are fixed. 
+/// Nodes stay in their rows, and multi-row nodes move together with the rows they span. 
 /// 
 /// @param init_x initial x location of nodes, including movable nodes, fixed nodes, and filler nodes, [0, num_movable_nodes) are movable nodes, [num_movable_nodes, num_nodes-num_filler_nodes) are fixed nodes, [num_nodes-num_filler_nodes, num_nodes) are filler nodes
 /// @param init_y initial y location of nodes, including movable nodes, fixed nodes, and filler nodes, same as init_x
@@ -28,8 +30,9 @@ DREAMPLACE_BEGIN_NAMESPACE
 /// @param num_nodes total number of nodes, including movable nodes, fixed nodes, and filler nodes; fixed nodes are in the range of [num_movable_nodes, num_nodes-num_filler_nodes)
 /// @param num_movable_nodes number of movable nodes, movable nodes are in the range of [0, num_movable_nodes)
 /// @param number of filler nodes, filler nodes are in the range of [num_nodes-num_filler_nodes, num_nodes)
+/// @param num_threads number of threads, fence regions and rows are legalized in parallel 
 template <typename T>
-int abacusLegalizationLauncher(LegalizationDB<T> db);
+int abacusLegalizationLauncher(LegalizationDB<T> db, int num_threads);
 
 #define CHECK_FLAT(x) AT_ASSERTM(!x.is_cuda() && x.ndimension() == 1, #x "must be a flat tensor on CPU")
 #define CHECK_EVEN(x) AT_ASSERTM((x.numel()&1) == 0, #x "must have even number of elements")
@@ -37,6 +40,7 @@ int abacusLegalizationLauncher(LegalizationDB<T> db);
 
 /// @brief legalize layout with abacus legalization. 
 /// Only movable nodes will be moved. Fixed nodes and filler nodes are fixed. 
+/// Nodes stay in their rows, and multi-row nodes move together with the rows they span. 
 /// 
 /// @param init_pos initial locations of nodes, including movable nodes, fixed nodes, and filler nodes, [0, num_movable_nodes) are movable nodes, [num_movable_nodes, num_nodes-num_filler_nodes) are fixed nodes, [num_nodes-num_filler_nodes, num_nodes) are filler nodes
 /// @param node_size_x width of nodes, including movable nodes, fixed nodes, and filler nodes, [0, num_movable_nodes) are movable nodes, [num_movable_nodes, num_nodes-num_filler_nodes) are fixed nodes, [num_nodes-num_filler_nodes, num_nodes) are filler nodes
@@ -52,6 +56,7 @@ int abacusLegalizationLauncher(LegalizationDB<T> db);
 /// @param num_nodes total number of nodes, including movable nodes, fixed nodes, and filler nodes; fixed nodes are in the range of [num_movable_nodes, num_nodes-num_filler_nodes)
 /// @param num_movable_nodes number of movable nodes, movable nodes are in the range of [0, num_movable_nodes)
 /// @param number of filler nodes, filler nodes are in the range of [num_nodes-num_filler_nodes, num_nodes)
+/// @param num_threads number of threads, rows are legalized in parallel 
 at::Tensor abacus_legalization_forward(
         at::Tensor init_pos,
         at::Tensor pos, 
@@ -69,7 +74,8 @@ at::Tensor abacus_legalization_forward(
         int num_bins_y,
         int num_movable_nodes, 
         int num_terminal_NIs, 
-        int num_filler_nodes
+        int num_filler_nodes, 
+        int num_threads
         )
 {
     CHECK_FLAT(init_pos); 
@@ -96,7 +102,7 @@ at::Tensor abacus_legalization_forward(
                     num_terminal_NIs, 
                     num_filler_nodes
                     );
-            abacusLegalizationLauncher<scalar_t>(db);
+            abacusLegalizationLauncher<scalar_t>(db, num_threads);
             });
     timer_stop = get_globaltime(); 
     dreamplacePrint(kINFO, "Abacus legalization takes %g ms\n", (timer_stop-timer_start)*get_timer_period());
@@ -105,18 +111,21 @@ at::Tensor abacus_legalization_forward(
 }
 
 template <typename T>
-int abacusLegalizationLauncher(LegalizationDB<T> db)
+int abacusLegalizationLauncher(LegalizationDB<T> db, int num_threads)
 {
-    abacusLegalizationCPU(
-            db.init_x, db.init_y, 
-            db.node_size_x, db.node_size_y, 
-            db.x, db.y, 
-            db.xl, db.yl, db.xh, db.yh, 
-            db.site_width, db.row_height, 
-            1, db.num_bins_y, 
-            db.num_nodes, 
-            db.num_movable_nodes 
-            );
+    legalizeFenceRegions(db, std::max(num_threads, 1), [](const LegalizationDB<T>& rdb, int rnum_threads){
+            abacusLegalizationCPU(
+                rdb.init_x, rdb.init_y, 
+                rdb.node_size_x, rdb.node_size_y, 
+                rdb.x, rdb.y, 
+                rdb.xl, rdb.yl, rdb.xh, rdb.yh, 
+                rdb.site_width, rdb.row_height, 
+                1, rdb.num_bins_y, 
+                rdb.num_nodes, 
+                rdb.num_movable_nodes, 
+                rnum_threads
+                );
+            });
 
     return 0; 
 }
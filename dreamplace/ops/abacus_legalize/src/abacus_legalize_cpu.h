@@ -15,7 +15,10 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <limits>
+#include <omp.h>
 #include "utility/src/Msg.h"
+#include "utility/src/RowOccupancy.h"
 
 DREAMPLACE_BEGIN_NAMESPACE
 
@@ -262,101 +265,696 @@ bool abacusPlaceRowCPU(
     return ret_flag; 
 }
 
+/// @brief Abacus on a group of consecutive rows linked by multi-row cells. 
+/// Cells are inserted from left to right in the order shared by all rows. 
+/// A new cell forms a cluster, which is merged with the overlapping cluster ahead of it or behind it 
+/// in any row it spans, so a cluster may span multiple rows with fixed offsets of its cells. 
+/// Offsets of cells to their clusters are kept in a union-find tree with offsets to parents. 
 template <typename T>
-void abacusLegalizeRowCPU(
+class AbacusRowGroupCPU
+{
+    public:
+        /// @param row_cells sorted cells of the rows in the group, including obstacles 
+        /// @param num_rows number of rows in the group 
+        /// @param is_joint whether a multi-row movable cell moves with the group; other multi-row cells are obstacles. 
+        /// Multi-row cells in overflowed clusters are released to obstacles. 
+        /// @param node2local scratch array of length num_movable_nodes initialized to -1, restored on return 
+        /// @return false if the rows disagree on the order of clusters, in which case nothing is changed 
+        bool run(
+                const T* init_x, 
+                const T* node_size_x, const T* node_size_y, 
+                T* x, 
+                const T site_xl, const T site_width, const T row_height, 
+                const T xl, const T xh, 
+                const int num_movable_nodes, 
+                char* is_joint, 
+                std::vector<int>* row_cells, const int num_rows, 
+                int* node2local
+                )
+        {
+            m_node_size_x = node_size_x; 
+            while (true)
+            {
+                collect(node_size_x, node_size_y, x, site_xl, site_width, row_height, xl, xh, num_movable_nodes, is_joint, row_cells, num_rows, node2local); 
+                for (auto node_id : m_nodes)
+                {
+                    node2local[node_id] = -1; 
+                }
+                if (!insertCells(init_x, x))
+                {
+                    return false; 
+                }
+                // clusters are rigid, so the space between cells of a cluster is wasted. 
+                // If a cluster overflows its bounds, keep its multi-row cells fixed and try again. 
+                bool retry_flag = false; 
+                for (unsigned int c = 0; c < m_nodes.size(); ++c)
+                {
+                    const Cluster& cluster = m_clusters[find(c)]; 
+                    int node_id = m_nodes[c]; 
+                    if (cluster.lo > cluster.hi && node_size_y[node_id] > row_height)
+                    {
+                        is_joint[node_id] = 0; 
+                        retry_flag = true; 
+                    }
+                }
+                if (!retry_flag)
+                {
+                    break; 
+                }
+            }
+
+            // align clusters to sites, so that cells inside are aligned as well 
+            for (unsigned int c = 0; c < m_nodes.size(); ++c)
+            {
+                if (m_parent[c] == (int)c)
+                {
+                    Cluster& cluster = m_clusters[c]; 
+                    cluster.x = floor((cluster.x-site_xl)/site_width)*site_width+site_xl; 
+                }
+            }
+            for (unsigned int c = 0; c < m_nodes.size(); ++c)
+            {
+                x[m_nodes[c]] = position(c); 
+            }
+            return true; 
+        }
+
+    protected:
+        struct Cluster
+        {
+            T e; ///< weight of displacement in the objective
+            T q; ///< x = q/e 
+            T lo; ///< lower bound of x from obstacles 
+            T hi; ///< upper bound of x from obstacles 
+            T x; ///< optimal location of the cluster origin 
+            int row_bgn; ///< first row spanned by the cluster 
+            std::vector<int> first; ///< first cell of the cluster in each row 
+            std::vector<int> last; ///< last cell of the cluster in each row 
+
+            int row_end() const {return row_bgn+first.size();}
+        };
+
+        /// @brief insert cells from left to right and collapse clusters 
+        /// @return false if the rows disagree on the order of cells 
+        bool insertCells(const T* init_x, const T* x)
+        {
+            int num_cells = m_nodes.size(); 
+            std::vector<int> order (num_cells); 
+            for (int c = 0; c < num_cells; ++c)
+            {
+                order[c] = c; 
+            }
+            std::sort(order.begin(), order.end(), 
+                    [&] (int c1, int c2) {
+                    T x1 = x[m_nodes[c1]] + m_node_size_x[m_nodes[c1]]/2;
+                    T x2 = x[m_nodes[c2]] + m_node_size_x[m_nodes[c2]]/2;
+                    return x1 < x2 || (x1 == x2 && m_nodes[c1] < m_nodes[c2]);
+                    });
+            m_rank.resize(num_cells); 
+            for (int k = 0; k < num_cells; ++k)
+            {
+                m_rank[order[k]] = k; 
+            }
+            for (auto const& cells : m_row_cells)
+            {
+                for (unsigned int j = 1; j < cells.size(); ++j)
+                {
+                    if (m_rank[cells[j-1]] > m_rank[cells[j]])
+                    {
+                        return false; 
+                    }
+                }
+            }
+
+            m_parent.resize(num_cells); 
+            m_offset.assign(num_cells, 0); 
+            m_clusters.assign(num_cells, Cluster()); 
+            for (int c = 0; c < num_cells; ++c)
+            {
+                Cluster& cluster = m_clusters[c]; 
+                m_parent[c] = c; 
+                cluster.e = 1.0; 
+                cluster.q = init_x[m_nodes[c]]; 
+                cluster.lo = m_lo[c]; 
+                cluster.hi = m_hi[c]; 
+                cluster.x = m_lo[c]; 
+                cluster.row_bgn = m_cell_row_bgn[c]; 
+                cluster.first.assign(m_cell_num_rows[c], c); 
+                cluster.last.assign(m_cell_num_rows[c], c); 
+            }
+            for (m_cur_rank = 0; m_cur_rank < num_cells; ++m_cur_rank)
+            {
+                if (!collapse(order[m_cur_rank]))
+                {
+                    return false; 
+                }
+            }
+            return true; 
+        }
+        /// @brief collect movable cells with their bounds from obstacles and their orders in rows 
+        void collect(
+                const T* node_size_x, const T* node_size_y, 
+                const T* x, 
+                const T site_xl, const T site_width, const T row_height, 
+                const T xl, const T xh, 
+                const int num_movable_nodes, 
+                const char* is_joint, 
+                std::vector<int>* row_cells, const int num_rows, 
+                int* node2local
+                )
+        {
+            auto is_movable = [&](int node_id){
+                return node_id < num_movable_nodes && (node_size_y[node_id] <= row_height || is_joint[node_id]); 
+            };
+            m_nodes.clear(); 
+            m_lo.clear(); 
+            m_hi.clear(); 
+            m_cell_row_bgn.clear(); 
+            m_cell_num_rows.clear(); 
+            m_row_cells.assign(num_rows, std::vector<int>()); 
+            for (int r = 0; r < num_rows; ++r)
+            {
+                auto const& cells = row_cells[r]; 
+                T range_xl = xl; 
+                T range_xh = xh; 
+                unsigned int next_obstacle = 0; 
+                for (unsigned int j = 0; j < cells.size(); ++j)
+                {
+                    int node_id = cells[j]; 
+                    if (is_movable(node_id))
+                    {
+                        if (next_obstacle <= j)
+                        {
+                            for (next_obstacle = j+1; next_obstacle < cells.size() && is_movable(cells[next_obstacle]); ++next_obstacle);
+                            range_xh = (next_obstacle < cells.size())? std::min(x[cells[next_obstacle]], xh) : xh; 
+                            range_xh = floor((range_xh-site_xl)/site_width)*site_width+site_xl; 
+                        }
+                        int& c = node2local[node_id]; 
+                        if (c < 0)
+                        {
+                            c = m_nodes.size(); 
+                            m_nodes.push_back(node_id); 
+                            m_lo.push_back(range_xl); 
+                            m_hi.push_back(range_xh-node_size_x[node_id]); 
+                            m_cell_row_bgn.push_back(r); 
+                            m_cell_num_rows.push_back(0); 
+                        }
+                        else 
+                        {
+                            m_lo[c] = std::max(m_lo[c], range_xl); 
+                            m_hi[c] = std::min(m_hi[c], range_xh-node_size_x[node_id]); 
+                        }
+                        m_cell_num_rows[c] += 1; 
+                        m_row_cells[r].push_back(c); 
+                    }
+                    else // set range xl/xh according to obstacles, aligned to sites 
+                    {
+                        range_xl = ceil((x[node_id]+node_size_x[node_id]-site_xl)/site_width)*site_width+site_xl; 
+                        next_obstacle = j; 
+                    }
+                }
+            }
+            // index of each cell in the rows it spans 
+            int num_cells = m_nodes.size(); 
+            m_cell_row_pos_start.assign(num_cells+1, 0); 
+            for (int c = 0; c < num_cells; ++c)
+            {
+                m_cell_row_pos_start[c+1] = m_cell_row_pos_start[c]+m_cell_num_rows[c]; 
+            }
+            m_cell_row_pos.resize(m_cell_row_pos_start[num_cells]); 
+            for (int r = 0; r < num_rows; ++r)
+            {
+                for (unsigned int j = 0; j < m_row_cells[r].size(); ++j)
+                {
+                    int c = m_row_cells[r][j]; 
+                    m_cell_row_pos[m_cell_row_pos_start[c]+r-m_cell_row_bgn[c]] = j; 
+                }
+            }
+        }
+        /// @return root of the cluster of cell c, with path compression 
+        int find(int c)
+        {
+            int root = c; 
+            T offset = 0; 
+            while (m_parent[root] != root)
+            {
+                offset += m_offset[root]; 
+                root = m_parent[root]; 
+            }
+            while (m_parent[c] != root && c != root)
+            {
+                int parent = m_parent[c]; 
+                T parent_offset = offset-m_offset[c]; 
+                m_parent[c] = root; 
+                m_offset[c] = offset; 
+                offset = parent_offset; 
+                c = parent; 
+            }
+            return root; 
+        }
+        /// @return offset of cell c to its cluster 
+        T offset(int c)
+        {
+            return (find(c) == c)? 0 : m_offset[c]; 
+        }
+        /// @return location of cell c 
+        T position(int c)
+        {
+            return m_clusters[find(c)].x+offset(c); 
+        }
+        /// @return the neighboring cell of cell c in row r, -1 if not exist 
+        int neighbor(int c, int r, int direction) const
+        {
+            int j = m_cell_row_pos[m_cell_row_pos_start[c]+r-m_cell_row_bgn[c]]+direction; 
+            return (j >= 0 && j < (int)m_row_cells[r].size())? m_row_cells[r][j] : -1; 
+        }
+        /// @brief merge cluster src to cluster dst on its left. 
+        /// Clusters between them in any shared row are merged as well. 
+        /// @return root of the merged cluster, -1 if the clusters interleave in some row 
+        int merge(int dst, int src)
+        {
+            while (true)
+            {
+                dst = find(dst); 
+                src = find(src); 
+                if (dst == src)
+                {
+                    return dst; 
+                }
+                Cluster& a = m_clusters[dst]; 
+                Cluster& b = m_clusters[src]; 
+                int row_bgn = std::max(a.row_bgn, b.row_bgn); 
+                int row_end = std::min(a.row_end(), b.row_end()); 
+                if (row_bgn >= row_end)
+                {
+                    return -1; 
+                }
+                int between = -1; 
+                for (int r = row_bgn; r < row_end; ++r)
+                {
+                    int l = a.last[r-a.row_bgn]; 
+                    int f = b.first[r-b.row_bgn]; 
+                    if (m_rank[f] < m_rank[l])
+                    {
+                        return -1; 
+                    }
+                    int next = neighbor(l, r, 1); 
+                    if (next != f)
+                    {
+                        between = next; 
+                        break; 
+                    }
+                }
+                if (between >= 0)
+                {
+                    if (merge(dst, between) < 0)
+                    {
+                        return -1; 
+                    }
+                    continue; 
+                }
+
+                // src abuts dst in the tightest shared row, 
+                // or leaves enough space for the obstacles between them 
+                T delta = b.lo-a.hi; 
+                for (int r = row_bgn; r < row_end; ++r)
+                {
+                    int l = a.last[r-a.row_bgn]; 
+                    int f = b.first[r-b.row_bgn]; 
+                    delta = std::max(delta, offset(l)+m_node_size_x[m_nodes[l]]-offset(f)); 
+                }
+                a.e += b.e; 
+                a.q += b.q-b.e*delta; 
+                a.lo = std::max(a.lo, b.lo-delta); 
+                a.hi = std::min(a.hi, b.hi-delta); 
+                int merged_row_bgn = std::min(a.row_bgn, b.row_bgn); 
+                int merged_row_end = std::max(a.row_end(), b.row_end()); 
+                std::vector<int> first (merged_row_end-merged_row_bgn); 
+                std::vector<int> last (merged_row_end-merged_row_bgn); 
+                for (int r = merged_row_bgn; r < merged_row_end; ++r)
+                {
+                    bool in_a = (r >= a.row_bgn && r < a.row_end()); 
+                    bool in_b = (r >= b.row_bgn && r < b.row_end()); 
+                    first[r-merged_row_bgn] = (in_a)? a.first[r-a.row_bgn] : b.first[r-b.row_bgn]; 
+                    last[r-merged_row_bgn] = (in_b)? b.last[r-b.row_bgn] : a.last[r-a.row_bgn]; 
+                }
+                a.row_bgn = merged_row_bgn; 
+                a.first.swap(first); 
+                a.last.swap(last); 
+                std::vector<int>().swap(b.first); 
+                std::vector<int>().swap(b.last); 
+                m_parent[src] = dst; 
+                m_offset[src] = delta; 
+                return dst; 
+            }
+        }
+        /// @brief place a cluster and merge it with overlapping clusters until no overlap 
+        /// @return false if clusters interleave 
+        bool collapse(int root)
+        {
+            while (true)
+            {
+                Cluster& cluster = m_clusters[root]; 
+                // in illegal case, the cluster may exceed hi, like in abacusPlaceRowCPU 
+                cluster.x = std::max(std::min(cluster.q/cluster.e, cluster.hi), cluster.lo); 
+                int dst = -1; 
+                int src = -1; 
+                for (int r = cluster.row_bgn; dst < 0 && r < cluster.row_end(); ++r)
+                {
+                    int f = cluster.first[r-cluster.row_bgn]; 
+                    int prev = neighbor(f, r, -1); 
+                    if (prev >= 0 && position(prev)+m_node_size_x[m_nodes[prev]] > cluster.x+offset(f))
+                    {
+                        dst = prev; 
+                        src = root; 
+                        break; 
+                    }
+                    int l = cluster.last[r-cluster.row_bgn]; 
+                    int next = neighbor(l, r, 1); 
+                    // cells to the right not inserted yet are ignored 
+                    if (next >= 0 && m_rank[next] <= m_cur_rank && cluster.x+offset(l)+m_node_size_x[m_nodes[l]] > position(next))
+                    {
+                        dst = root; 
+                        src = next; 
+                    }
+                }
+                if (dst < 0)
+                {
+                    return true; 
+                }
+                root = merge(dst, src); 
+                if (root < 0)
+                {
+                    return false; 
+                }
+            }
+        }
+
+        const T* m_node_size_x; 
+        std::vector<int> m_nodes; ///< movable cells 
+        std::vector<T> m_lo; ///< lower bound of each cell from obstacles 
+        std::vector<T> m_hi; ///< upper bound of each cell from obstacles 
+        std::vector<int> m_cell_row_bgn; ///< first row of each cell 
+        std::vector<int> m_cell_num_rows; ///< number of rows of each cell 
+        std::vector<int> m_cell_row_pos_start; ///< start of each cell in m_cell_row_pos 
+        std::vector<int> m_cell_row_pos; ///< index of each cell in the rows it spans 
+        std::vector<std::vector<int> > m_row_cells; ///< movable cells in each row from left to right 
+        std::vector<int> m_rank; ///< order of cells shared by all rows 
+        std::vector<int> m_parent; ///< union-find tree of clusters 
+        std::vector<T> m_offset; ///< offset to the parent in the union-find tree 
+        std::vector<Cluster> m_clusters; ///< clusters at roots of union-find trees 
+        int m_cur_rank; ///< rank of the cell being inserted 
+};
+
+/// @brief move multi-row cells in a group of rows towards their initial locations, 
+/// within the free space left by other cells in all the rows they span. 
+/// Multi-row cells are moved one at a time, so neighboring multi-row cells see the updated locations. 
+/// @param row_cells sorted cells of the rows in the group, including obstacles 
+/// @param is_joint whether a multi-row movable cell moves with the group 
+/// @param node2local scratch array of length num_movable_nodes initialized to -1, restored on return 
+template <typename T>
+void abacusSlideMultiRowCellsCPU(
         const T* init_x, 
         const T* node_size_x, const T* node_size_y, 
         T* x, 
+        const T site_xl, const T site_width, const T row_height, 
         const T xl, const T xh, 
-        const T bin_size_x, const T bin_size_y, 
-        const int num_bins_x, const int num_bins_y, 
-        const int num_nodes, 
         const int num_movable_nodes, 
-        std::vector<std::vector<int> >& bin_cells, 
-        std::vector<std::vector<AbacusCluster<T> > >& bin_clusters
+        const char* is_joint, 
+        const std::vector<int>* row_cells, const int num_rows, 
+        int* node2local
         )
 {
-    for (unsigned int i = 0; i < bin_cells.size(); i += 1)
+    // free space of a multi-row cell in a row, bounded by other cells and the neighboring multi-row cells 
+    struct Window 
     {
-        auto& row2nodes = bin_cells.at(i);
-
-        // sort bin cells from left to right 
-        // we need to remove fixed cells if it is inside another fixed cell 
-        // first sort by left edge 
-        std::sort(row2nodes.begin(), row2nodes.end(), 
-                    [&] (int node_id1, int node_id2) {
-                    T x1 = x[node_id1];
-                    T x2 = x[node_id2];
-                    return x1 < x2 || (x1 == x2 && node_id1 < node_id2);
-                    });
-        // After sorting by left edge, 
-        // there is a special case for fixed cells where 
-        // one fixed cell is completely within another in a row. 
-        // This will cause failure to detect some overlaps. 
-        // We need to remove the "small" fixed cell that is inside another. 
-        if (!row2nodes.empty())
+        T xl; 
+        T xh; 
+        int prev_node_id; 
+        int next_node_id; 
+    };
+    auto is_sliding = [&](int node_id){
+        return node_id < num_movable_nodes && node_size_y[node_id] > row_height && is_joint[node_id]; 
+    };
+
+    std::vector<int> nodes; 
+    std::vector<std::vector<Window> > windows; 
+    std::vector<T> suffix_xl; 
+    for (int r = 0; r < num_rows; ++r)
+    {
+        auto const& cells = row_cells[r]; 
+        int num_row_cells = cells.size(); 
+        // minimum left edge of the other cells behind each position 
+        suffix_xl.assign(num_row_cells+1, xh); 
+        for (int j = num_row_cells-1; j >= 0; --j)
+        {
+            suffix_xl[j] = (is_sliding(cells[j]))? suffix_xl[j+1] : std::min(suffix_xl[j+1], x[cells[j]]); 
+        }
+        T prefix_xh = xl; 
+        int prev_node_id = -1; 
+        for (int j = 0; j < num_row_cells; ++j)
         {
-            std::vector<int> tmp_nodes; 
-            tmp_nodes.reserve(row2nodes.size());
-            tmp_nodes.push_back(row2nodes.front()); 
-            for (int j = 1, je = row2nodes.size(); j < je; ++j)
+            int node_id = cells[j]; 
+            if (is_sliding(node_id))
             {
-                int node_id1 = row2nodes.at(j-1);
-                int node_id2 = row2nodes.at(j);
-                // two fixed cells 
-                if (node_id1 >= num_movable_nodes && node_id2 >= num_movable_nodes)
+                int& c = node2local[node_id]; 
+                if (c < 0)
                 {
-                    T xl1 = x[node_id1]; 
-                    T xl2 = x[node_id2];
-                    T width1 = node_size_x[node_id1]; 
-                    T width2 = node_size_x[node_id2]; 
-                    T xh1 = xl1 + width1; 
-                    T xh2 = xl2 + width2; 
-                    // only collect node_id2 if its right edge is righter than node_id1 
-                    if (xh1 < xh2)
-                    {
-                        tmp_nodes.push_back(node_id2);
-                    }
+                    c = nodes.size(); 
+                    nodes.push_back(node_id); 
+                    windows.push_back(std::vector<Window>()); 
                 }
-                else 
+                Window window; 
+                window.xl = prefix_xh; 
+                window.xh = suffix_xl[j+1]; 
+                window.prev_node_id = prev_node_id; 
+                window.next_node_id = -1; 
+                if (prev_node_id >= 0)
                 {
-                    tmp_nodes.push_back(node_id2);
+                    windows[node2local[prev_node_id]].back().next_node_id = node_id; 
                 }
+                windows[c].push_back(window); 
+                prev_node_id = node_id; 
+            }
+            else 
+            {
+                prefix_xh = std::max(prefix_xh, x[node_id]+node_size_x[node_id]); 
             }
-            row2nodes.swap(tmp_nodes);
-
-            // sort according to center 
-            std::sort(row2nodes.begin(), row2nodes.end(), 
-                    [&] (int node_id1, int node_id2) {
-                    T x1 = x[node_id1] + node_size_x[node_id1]/2;
-                    T x2 = x[node_id2] + node_size_x[node_id2]/2;
-                    return x1 < x2 || (x1 == x2 && node_id1 < node_id2);
-                    });
         }
+    }
 
-        auto& clusters = bin_clusters.at(i);
-        int num_row_nodes = row2nodes.size();
+    for (unsigned int c = 0; c < nodes.size(); ++c)
+    {
+        int node_id = nodes[c]; 
+        node2local[node_id] = -1; 
+        T lo = xl; 
+        T hi = xh; 
+        for (auto const& window : windows[c])
+        {
+            lo = std::max(lo, window.xl); 
+            hi = std::min(hi, window.xh); 
+            if (window.prev_node_id >= 0)
+            {
+                lo = std::max(lo, x[window.prev_node_id]+node_size_x[window.prev_node_id]); 
+            }
+            if (window.next_node_id >= 0)
+            {
+                hi = std::min(hi, x[window.next_node_id]); 
+            }
+        }
+        lo = ceil((lo-site_xl)/site_width)*site_width+site_xl; 
+        hi = floor((hi-node_size_x[node_id]-site_xl)/site_width)*site_width+site_xl; 
+        if (lo <= hi)
+        {
+            T target_x = floor((init_x[node_id]-site_xl)/site_width+0.5)*site_width+site_xl; 
+            x[node_id] = std::max(std::min(target_x, hi), lo); 
+        }
+    }
+}
 
-        int bin_id_x = i/num_bins_y; 
-        //int bin_id_y = i-bin_id_x*num_bins_y; 
+/// @brief order groups of bins by decreasing population, 
+/// so that dynamic scheduling starts the longest rows first and balances the tail 
+inline std::vector<int> orderBinsByPopulation(const std::vector<int>& populations)
+{
+    std::vector<int> order (populations.size()); 
+    for (unsigned int i = 0; i < populations.size(); ++i)
+    {
+        order[i] = i; 
+    }
+    std::sort(order.begin(), order.end(), 
+            [&] (int id1, int id2) {
+            return populations[id1] > populations[id2] 
+                || (populations[id1] == populations[id2] && id1 < id2);
+            });
+    return order; 
+}
 
+/// @brief mark multi-row movable cells within one column of bins, which move jointly with their rows, 
+/// and link the rows they span. 
+/// Other multi-row movable cells stay as obstacles. 
+/// @param is_joint length of num_movable_nodes 
+/// @param bin_linked whether a bin is linked with the bin above it, length of number of bins 
+template <typename T>
+void markJointMultiRowCellsCPU(
+        const T* x, const T* y, 
+        const T* node_size_x, const T* node_size_y, 
+        const T bin_size_x, const T bin_size_y, 
+        const T xl, const T yl, 
+        const int num_bins_x, const int num_bins_y, 
+        const int num_movable_nodes, 
+        std::vector<char>& is_joint, 
+        std::vector<char>& bin_linked
+        )
+{
+    is_joint.assign(num_movable_nodes, 0); 
+    bin_linked.assign(num_bins_x*num_bins_y, 0); 
+    for (int i = 0; i < num_movable_nodes; ++i)
+    {
+        if (node_size_y[i] > bin_size_y)
+        {
+            int bin_id_xl = std::max((x[i]-xl)/bin_size_x, (T)0);
+            int bin_id_xh = std::min((int)ceil((x[i]+node_size_x[i]-xl)/bin_size_x), num_bins_x);
+            int bin_id_yl = std::max((y[i]-yl)/bin_size_y, (T)0);
+            int bin_id_yh = std::min((int)ceil((y[i]+node_size_y[i]-yl)/bin_size_y), num_bins_y);
+            if (bin_id_xl+1 == bin_id_xh)
+            {
+                is_joint[i] = 1; 
+                for (int bin_id_y = bin_id_yl; bin_id_y+1 < bin_id_yh; ++bin_id_y)
+                {
+                    bin_linked[bin_id_xl*num_bins_y+bin_id_y] = 1; 
+                }
+            }
+        }
+    }
+}
+
+/// @brief legalize rows independently, except that rows linked by multi-row cells are legalized together. 
+/// Movable cells belong to exactly one group of rows, and cells shared by groups (fixed or multi-row obstacles) are read-only, 
+/// so groups are processed in parallel. 
+/// Each thread reuses one cluster arena sized to the largest bin it has processed. 
+template <typename T>
+void abacusLegalizeRowCPU(
+        const T* init_x, 
+        const T* node_size_x, const T* node_size_y, 
+        T* x, 
+        const T xl, const T xh, 
+        const T site_width, 
+        const T bin_size_x, const T bin_size_y, 
+        const int num_bins_x, const int num_bins_y, 
+        const int num_nodes, 
+        const int num_movable_nodes, 
+        std::vector<char>& is_joint, 
+        const std::vector<char>& bin_linked, 
+        std::vector<std::vector<int> >& bin_cells, 
+        const int num_threads, 
+        const int num_refine_rounds = 3
+        )
+{
+    // groups of consecutive bins in a column linked by multi-row cells 
+    std::vector<int> group_bin_bgn; 
+    std::vector<int> group_num_bins; 
+    std::vector<int> group_populations; 
+    for (int i = 0; i < num_bins_x*num_bins_y; ++i)
+    {
+        int bin_id_y = i%num_bins_y; 
+        if (bin_id_y == 0 || !bin_linked[i-1])
+        {
+            group_bin_bgn.push_back(i); 
+            group_num_bins.push_back(0); 
+            group_populations.push_back(0); 
+        }
+        group_num_bins.back() += 1; 
+        group_populations.back() += bin_cells[i].size(); 
+    }
+    std::vector<int> group_order = orderBinsByPopulation(group_populations); 
+    std::vector<std::vector<AbacusCluster<T> > > thread_clusters (num_threads); 
+    std::vector<AbacusRowGroupCPU<T> > thread_groups (num_threads); 
+    // scratch for row groups, each group only touches its own movable cells 
+    std::vector<int> node2local (num_movable_nodes, -1); 
+
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 1)
+    for (unsigned int k = 0; k < group_order.size(); ++k)
+    {
+        int group_id = group_order[k]; 
+        int bin_bgn = group_bin_bgn[group_id]; 
+        int num_group_bins = group_num_bins[group_id]; 
+
+        int bin_id_x = bin_bgn/num_bins_y; 
         T bin_xl = xl+bin_size_x*bin_id_x;
         T bin_xh = std::min(bin_xl+bin_size_x, xh);
 
-        abacusPlaceRowCPU(
-                init_x, 
-                node_size_x, node_size_y, 
-                x, 
-                bin_size_y, // must be equal to row_height
-                bin_xl, bin_xh, 
-                num_nodes, 
-                num_movable_nodes, 
-                row2nodes.data(), 
-                clusters.data(), 
-                num_row_nodes
-                );
+        // legalize rows one by one with multi-row cells as obstacles 
+        auto place_rows = [&](){
+            auto& clusters = thread_clusters[omp_get_thread_num()];
+            for (int i = bin_bgn; i < bin_bgn+num_group_bins; ++i)
+            {
+                auto& row2nodes = bin_cells[i];
+                sortRowNodes(x, node_size_x, num_movable_nodes, row2nodes); 
+                int num_row_nodes = row2nodes.size();
+                if ((int)clusters.size() < num_row_nodes)
+                {
+                    clusters.resize(num_row_nodes); 
+                }
+
+                abacusPlaceRowCPU(
+                        init_x, 
+                        node_size_x, node_size_y, 
+                        x, 
+                        bin_size_y, // must be equal to row_height
+                        bin_xl, bin_xh, 
+                        num_nodes, 
+                        num_movable_nodes, 
+                        row2nodes.data(), 
+                        clusters.data(), 
+                        num_row_nodes
+                        );
+            }
+        };
+
+        if (num_group_bins > 1)
+        {
+            for (int i = bin_bgn; i < bin_bgn+num_group_bins; ++i)
+            {
+                sortRowNodes(x, node_size_x, num_movable_nodes, bin_cells[i]); 
+            }
+            if (thread_groups[omp_get_thread_num()].run(
+                        init_x, 
+                        node_size_x, node_size_y, 
+                        x, 
+                        xl, site_width, bin_size_y, 
+                        bin_xl, bin_xh, 
+                        num_movable_nodes, 
+                        is_joint.data(), 
+                        bin_cells.data()+bin_bgn, num_group_bins, 
+                        node2local.data()
+                        ))
+            {
+                // joint clusters are rigid, 
+                // so single-row cells and multi-row cells are refined in turn 
+                for (int round = 0; round < num_refine_rounds; ++round)
+                {
+                    abacusSlideMultiRowCellsCPU(
+                            init_x, 
+                            node_size_x, node_size_y, 
+                            x, 
+                            xl, site_width, bin_size_y, 
+                            bin_xl, bin_xh, 
+                            num_movable_nodes, 
+                            is_joint.data(), 
+                            bin_cells.data()+bin_bgn, num_group_bins, 
+                            node2local.data()
+                            );
+                    place_rows(); 
+                }
+                continue; 
+            }
+            dreamplacePrint(kWARN, "rows %d-%d disagree on the order of multi-row cells, keep multi-row cells fixed\n", 
+                    bin_bgn%num_bins_y, bin_bgn%num_bins_y+num_group_bins-1);
+        }
+        place_rows(); 
     }
     T displace = 0; 
+#pragma omp parallel for num_threads (num_threads) reduction(+:displace)
     for (int i = 0; i < num_movable_nodes; ++i)
     {
         displace += fabs(x[i]-init_x[i]); 
@@ -373,7 +971,8 @@ void abacusLegalizationCPU(
         const T site_width, const T row_height, 
         int num_bins_x, int num_bins_y, 
         const int num_nodes, 
-        const int num_movable_nodes
+        const int num_movable_nodes, 
+        const int num_threads
         )
 {
     // adjust bin sizes 
@@ -395,32 +994,47 @@ void abacusLegalizationCPU(
             bin_cells
             );
 
-    std::vector<std::vector<AbacusCluster<T> > > bin_clusters (num_bins_x*num_bins_y);
-    for (unsigned int i = 0; i < bin_cells.size(); ++i)
-    {
-        bin_clusters[i].resize(bin_cells[i].size()); 
-    }
+    // multi-row cells move together with the rows they span 
+    std::vector<char> is_joint; 
+    std::vector<char> bin_linked; 
+    markJointMultiRowCellsCPU(
+            x, y, 
+            node_size_x, node_size_y, 
+            bin_size_x, bin_size_y, 
+            xl, yl, 
+            num_bins_x, num_bins_y, 
+            num_movable_nodes, 
+            is_joint, 
+            bin_linked
+            );
 
     abacusLegalizeRowCPU(
             init_x, 
             node_size_x, node_size_y, 
             x, 
             xl, xh, 
+            site_width, 
             bin_size_x, bin_size_y, 
             num_bins_x, num_bins_y,
             num_nodes, 
             num_movable_nodes,
+            is_joint, 
+            bin_linked, 
             bin_cells, 
-            bin_clusters
+            num_threads
             );
     // need to align nodes to sites 
     // this also considers cell width which is not integral times of site_width 
-    for (auto const& cells : bin_cells)
+    // multi-row cells appear in multiple bins, so they are aligned with their row groups and kept as obstacles here, 
+    // and each movable cell is written by only one thread 
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 16)
+    for (unsigned int i = 0; i < bin_cells.size(); ++i)
     {
+        auto const& cells = bin_cells[i]; 
         T xxl = xl; 
         for (auto node_id : cells)
         {
-            if (node_id < num_movable_nodes)
+            if (node_id < num_movable_nodes && node_size_y[node_id] <= bin_size_y)
             {
                 x[node_id] = std::max(std::min(x[node_id], xh-node_size_x[node_id]), xxl);
                 x[node_id] = floor((x[node_id]-xxl)/site_width)*site_width+xxl; 
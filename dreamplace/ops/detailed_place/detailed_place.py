@@ -0,0 +1,297 @@
+##
+# @file   detailed_place.py
+# @author agent
+# @date   Oct 2026
+# @brief  detailed placement engine running a schedule of passes with shared state
+#
+
+import math
+import torch
+from torch import nn
+from torch.autograd import Function
+
+import dreamplace.ops.detailed_place.detailed_place_cpp as detailed_place_cpp
+
+class DetailedPlaceFunction(Function):
+    """ Detailed placement with a schedule of passes in one call.
+    Row occupancy, net boxes and HPWL are built once and kept up to date across the passes.
+    Pin offsets of flipped cells are updated in place, and node_flip_x is toggled for them.
+    Legality is checked before the first pass and on the cells moved by each pass,
+    and the schedule stops at the first pass breaking legality.
+    The output is the position and whether it is legal.
+    """
+    @staticmethod
+    def forward(
+          pos,
+          node_size_x,
+          node_size_y,
+          flat_region_boxes,
+          flat_region_boxes_start,
+          node2fence_region_map,
+          flat_net2pin_map,
+          flat_net2pin_start_map,
+          pin2net_map,
+          flat_node2pin_map,
+          flat_node2pin_start_map,
+          pin2node_map,
+          pin_offset_x,
+          pin_offset_y,
+          net_mask,
+          node_flip_x,
+          xl,
+          yl,
+          xh,
+          yh,
+          site_width,
+          row_height,
+          num_bins_x,
+          num_bins_y,
+          num_movable_nodes,
+          num_terminal_NIs,
+          num_filler_nodes,
+          passes,
+          max_rounds,
+          stop_threshold,
+          K,
+          k_reorder_max_iters,
+          ism_batch_size,
+          ism_set_size,
+          ism_max_iters,
+          lap_solver,
+          gs_batch_size,
+          gs_max_iters,
+          gs_bin_ratio,
+          gs_deterministic,
+          num_shards,
+          num_threads
+          ):
+        if pos.is_cuda:
+            pin_offset_x_cpu = pin_offset_x.cpu()
+            node_flip_x_cpu = node_flip_x.cpu()
+            output, legal = detailed_place_cpp.detailed_place(
+                    pos.view(pos.numel()).cpu(),
+                    node_size_x.cpu(),
+                    node_size_y.cpu(),
+                    flat_region_boxes.cpu(),
+                    flat_region_boxes_start.cpu(),
+                    node2fence_region_map.cpu(),
+                    flat_net2pin_map.cpu(),
+                    flat_net2pin_start_map.cpu(),
+                    pin2net_map.cpu(),
+                    flat_node2pin_map.cpu(),
+                    flat_node2pin_start_map.cpu(),
+                    pin2node_map.cpu(),
+                    pin_offset_x_cpu,
+                    pin_offset_y.cpu(),
+                    net_mask.cpu(),
+                    node_flip_x_cpu,
+                    xl,
+                    yl,
+                    xh,
+                    yh,
+                    site_width,
+                    row_height,
+                    num_bins_x,
+                    num_bins_y,
+                    num_movable_nodes,
+                    num_terminal_NIs,
+                    num_filler_nodes,
+                    ",".join(passes),
+                    max_rounds,
+                    stop_threshold,
+                    K,
+                    k_reorder_max_iters,
+                    ism_batch_size,
+                    ism_set_size,
+                    ism_max_iters,
+                    lap_solver,
+                    gs_batch_size,
+                    gs_max_iters,
+                    gs_bin_ratio,
+                    gs_deterministic,
+                    num_shards,
+                    num_threads
+                    )
+            output = output.cuda()
+            pin_offset_x.copy_(pin_offset_x_cpu)
+            node_flip_x.copy_(node_flip_x_cpu)
+        else:
+            output, legal = detailed_place_cpp.detailed_place(
+                    pos.view(pos.numel()),
+                    node_size_x,
+                    node_size_y,
+                    flat_region_boxes,
+                    flat_region_boxes_start,
+                    node2fence_region_map,
+                    flat_net2pin_map,
+                    flat_net2pin_start_map,
+                    pin2net_map,
+                    flat_node2pin_map,
+                    flat_node2pin_start_map,
+                    pin2node_map,
+                    pin_offset_x,
+                    pin_offset_y,
+                    net_mask,
+                    node_flip_x,
+                    xl,
+                    yl,
+                    xh,
+                    yh,
+                    site_width,
+                    row_height,
+                    num_bins_x,
+                    num_bins_y,
+                    num_movable_nodes,
+                    num_terminal_NIs,
+                    num_filler_nodes,
+                    ",".join(passes),
+                    max_rounds,
+                    stop_threshold,
+                    K,
+                    k_reorder_max_iters,
+                    ism_batch_size,
+                    ism_set_size,
+                    ism_max_iters,
+                    lap_solver,
+                    gs_batch_size,
+                    gs_max_iters,
+                    gs_bin_ratio,
+                    gs_deterministic,
+                    num_shards,
+                    num_threads
+                    )
+        return output, legal
+
+class DetailedPlace(object):
+    """ Detailed placement engine running a schedule of passes on CPU,
+    with the same defaults as the separate ops in the default flow.
+    Positions on GPU are copied to the host and back,
+    so GPU flows run the separate ops with their CUDA kernels instead.
+    """
+    def __init__(self,
+            node_size_x, node_size_y,
+            flat_region_boxes, flat_region_boxes_start, node2fence_region_map,
+            flat_net2pin_map, flat_net2pin_start_map, pin2net_map,
+            flat_node2pin_map, flat_node2pin_start_map, pin2node_map,
+            pin_offset_x, pin_offset_y,
+            net_mask,
+            node_flip_x,
+            xl, yl, xh, yh,
+            site_width, row_height,
+            num_bins_x, num_bins_y,
+            num_movable_nodes, num_terminal_NIs, num_filler_nodes,
+            passes=("k_reorder", "independent_set_matching", "global_swap", "k_reorder"),
+            max_rounds=1,
+            stop_threshold=0.1/100,
+            K=4,
+            k_reorder_max_iters=2,
+            ism_batch_size=2048,
+            ism_set_size=128,
+            ism_max_iters=50,
+            lap_solver="auto",
+            gs_batch_size=256,
+            gs_max_iters=2,
+            gs_bin_ratio=2,
+            gs_deterministic=False,
+            num_shards=1,
+            num_threads=8):
+        """
+        @param node_flip_x uint8 flags of cells, toggled in place for flipped cells; only changed by k_reorder_flip
+        @param passes names of passes in a round, among k_reorder, k_reorder_flip, independent_set_matching and global_swap
+        @param max_rounds maximum number of rounds of the passes
+        @param stop_threshold stop if a round improves HPWL by less than this ratio of the initial HPWL
+        @param gs_bin_ratio global swap searches in bins this times larger than num_bins_x and num_bins_y in each direction
+        @param gs_deterministic whether global swap applies swaps in a fixed order;
+        otherwise threads apply them in the order they win, and results with multiple threads may differ between runs
+        @param num_shards number of shards placed concurrently, only 1 with k_reorder_flip
+        """
+        super(DetailedPlace, self).__init__()
+        self.node_size_x = node_size_x
+        self.node_size_y = node_size_y
+        self.flat_region_boxes = flat_region_boxes
+        self.flat_region_boxes_start = flat_region_boxes_start
+        self.node2fence_region_map = node2fence_region_map
+        self.flat_net2pin_map = flat_net2pin_map
+        self.flat_net2pin_start_map = flat_net2pin_start_map
+        self.pin2net_map = pin2net_map
+        self.flat_node2pin_map = flat_node2pin_map
+        self.flat_node2pin_start_map = flat_node2pin_start_map
+        self.pin2node_map = pin2node_map
+        self.pin_offset_x = pin_offset_x
+        self.pin_offset_y = pin_offset_y
+        self.net_mask = net_mask
+        self.node_flip_x = node_flip_x
+        self.xl = xl
+        self.yl = yl
+        self.xh = xh
+        self.yh = yh
+        self.site_width = site_width
+        self.row_height = row_height
+        self.num_bins_x = num_bins_x
+        self.num_bins_y = num_bins_y
+        self.num_movable_nodes = num_movable_nodes
+        self.num_terminal_NIs = num_terminal_NIs
+        self.num_filler_nodes = num_filler_nodes
+        self.passes = passes
+        self.max_rounds = max_rounds
+        self.stop_threshold = stop_threshold
+        self.K = K
+        self.k_reorder_max_iters = k_reorder_max_iters
+        self.ism_batch_size = ism_batch_size
+        self.ism_set_size = ism_set_size
+        self.ism_max_iters = ism_max_iters
+        self.lap_solver = lap_solver
+        self.gs_batch_size = gs_batch_size
+        self.gs_max_iters = gs_max_iters
+        self.gs_bin_ratio = gs_bin_ratio
+        self.gs_deterministic = gs_deterministic
+        self.num_shards = num_shards
+        self.num_threads = num_threads
+        # whether the result of the last call is legal
+        self.legal = None
+    def __call__(self, pos):
+        output, self.legal = DetailedPlaceFunction.forward(
+                pos,
+                node_size_x=self.node_size_x,
+                node_size_y=self.node_size_y,
+                flat_region_boxes=self.flat_region_boxes,
+                flat_region_boxes_start=self.flat_region_boxes_start,
+                node2fence_region_map=self.node2fence_region_map,
+                flat_net2pin_map=self.flat_net2pin_map,
+                flat_net2pin_start_map=self.flat_net2pin_start_map,
+                pin2net_map=self.pin2net_map,
+                flat_node2pin_map=self.flat_node2pin_map,
+                flat_node2pin_start_map=self.flat_node2pin_start_map,
+                pin2node_map=self.pin2node_map,
+                pin_offset_x=self.pin_offset_x,
+                pin_offset_y=self.pin_offset_y,
+                net_mask=self.net_mask,
+                node_flip_x=self.node_flip_x,
+                xl=self.xl,
+                yl=self.yl,
+                xh=self.xh,
+                yh=self.yh,
+                site_width=self.site_width,
+                row_height=self.row_height,
+                num_bins_x=self.num_bins_x,
+                num_bins_y=self.num_bins_y,
+                num_movable_nodes=self.num_movable_nodes,
+                num_terminal_NIs=self.num_terminal_NIs,
+                num_filler_nodes=self.num_filler_nodes,
+                passes=self.passes,
+                max_rounds=self.max_rounds,
+                stop_threshold=self.stop_threshold,
+                K=self.K,
+                k_reorder_max_iters=self.k_reorder_max_iters,
+                ism_batch_size=self.ism_batch_size,
+                ism_set_size=self.ism_set_size,
+                ism_max_iters=self.ism_max_iters,
+                lap_solver=self.lap_solver,
+                gs_batch_size=self.gs_batch_size,
+                gs_max_iters=self.gs_max_iters,
+                gs_bin_ratio=self.gs_bin_ratio,
+                gs_deterministic=self.gs_deterministic,
+                num_shards=self.num_shards,
+                num_threads=self.num_threads
+                )
+        return output
@@ -0,0 +1,304 @@
+/**
+ * @file   detailed_place.cpp
+ * @author agent
+ * @date   Oct 2026
+ * @brief  Detailed placement engine running a schedule of passes on one database,
+ * where row occupancy, net boxes and HPWL are shared across passes instead of rebuilt by each of them
+ */
+#include <sstream>
+#include <atomic>
+#include "utility/src/torch.h"
+#include "utility/src/Msg.h"
+#include "utility/src/DetailedPlaceShards.h"
+#include "utility/src/DetailedPlaceDB.h"
+#include "utility/src/DetailedPlaceDBUtils.h"
+#include "utility/src/DetailedPlaceContext.h"
+#include "k_reorder/src/k_reorder_cpu.h"
+#include "k_reorder_flip/src/k_reorder_flip_cpu.h"
+#include "independent_set_matching/src/independent_set_matching_cpu.h"
+#include "global_swap/src/global_swap_concurrent_cpu.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// @brief passes of detailed placement
+enum DetailedPlacePassType
+{
+    kKReorder = 0,
+    kKReorderFlip,
+    kIndependentSetMatching,
+    kGlobalSwap
+};
+
+/// @brief convert a pass name, the same as the name of its op, to the type
+inline DetailedPlacePassType detailedPlacePassType(const std::string& name)
+{
+    if (name == "k_reorder")
+    {
+        return kKReorder;
+    }
+    else if (name == "k_reorder_flip")
+    {
+        return kKReorderFlip;
+    }
+    else if (name == "independent_set_matching")
+    {
+        return kIndependentSetMatching;
+    }
+    else if (name == "global_swap")
+    {
+        return kGlobalSwap;
+    }
+    dreamplaceAssertMsg(0, "unknown detailed placement pass %s", name.c_str());
+    return kKReorder;
+}
+
+/// @brief schedule of passes and their parameters
+struct DetailedPlaceSchedule
+{
+    std::vector<std::string> passes; ///< names of passes in a round
+    int max_rounds; ///< maximum number of rounds of the passes
+    double stop_threshold; ///< stop if a round improves HPWL by less than this ratio of the initial HPWL
+    int K; ///< window size of k-reorder with or without flipping
+    int k_reorder_max_iters;
+    int ism_batch_size;
+    int ism_set_size;
+    int ism_max_iters;
+    LapSolverType lap_solver;
+    int gs_batch_size;
+    int gs_max_iters;
+    int gs_bin_ratio; ///< global swap searches in bins this times larger in each direction
+    bool gs_deterministic; ///< global swap applies swaps in a fixed order for reproducible results
+};
+
+/// @brief run the schedule on a database.
+/// The indices are built once and handed from one pass to the next,
+/// so each pass only builds its own search structures.
+/// The input is checked for legality, and so are the cells moved by each pass,
+/// in the rows they touch; the schedule stops at the first pass breaking legality.
+/// @param pin_offset_x mutable view of db.pin_offset_x, for flipping
+/// @param node_flip_x toggled for flipped cells
+/// @return true if the placement is legal
+template <typename T>
+bool detailedPlaceCPULauncher(DetailedPlaceDB<T> db, T* pin_offset_x, unsigned char* node_flip_x,
+        const DetailedPlaceSchedule& schedule, int num_threads)
+{
+    hr_clock_rep timer_start, timer_stop;
+
+    // the first check builds the row index and covers all cells
+    LegalityCheckRowIndex legality_index;
+    auto checkLegality = [&](const std::vector<int>& moved_nodes){
+        LegalityViolationList violations;
+        bool legal = legalityCheckIncrementalKernelCPU(
+                db.x, db.y,
+                db.node_size_x, db.node_size_y,
+                db.flat_region_boxes, db.flat_region_boxes_start, db.node2fence_region_map,
+                db.xl, db.yl, db.xh, db.yh,
+                db.site_width, db.row_height,
+                db.num_nodes, db.num_movable_nodes, db.num_regions,
+                moved_nodes.data(), moved_nodes.size(),
+                num_threads, legality_index, violations);
+        printLegalityViolations(db.x, db.y, db.node_size_x, db.node_size_y, db.yl, db.row_height, violations);
+        return legal;
+    };
+    if (!checkLegality(std::vector<int>()))
+    {
+        dreamplacePrint(kERROR, "detailed placement requires a legal placement\n");
+        return false;
+    }
+
+    timer_start = get_globaltime();
+    DetailedPlaceContext<T> context;
+    context.build(db, num_threads);
+    timer_stop = get_globaltime();
+    dreamplacePrint(kDEBUG, "build detailed placement context takes %g ms\n", get_timer_period()*(timer_stop-timer_start));
+
+    // global swap uses coarser bins, and the other passes use the bins of the database
+    DetailedPlaceDB<T> gs_db = db;
+    gs_db.num_bins_x = std::max(db.num_bins_x/schedule.gs_bin_ratio, 1);
+    gs_db.num_bins_y = std::max(db.num_bins_y/schedule.gs_bin_ratio, 1);
+    gs_db.bin_size_x = (db.xh-db.xl)/gs_db.num_bins_x;
+    gs_db.bin_size_y = (db.yh-db.yl)/gs_db.num_bins_y;
+
+    T initial_hpwl = context.hpwl;
+    for (int round = 0; round < schedule.max_rounds; ++round)
+    {
+        T round_hpwl = context.hpwl;
+        for (auto const& name : schedule.passes)
+        {
+            T pass_hpwl = context.hpwl;
+            timer_start = get_globaltime();
+            switch (detailedPlacePassType(name))
+            {
+                case kKReorder:
+                    kreorderCPULauncher(db, schedule.K, schedule.k_reorder_max_iters, num_threads, &context);
+                    break;
+                case kKReorderFlip:
+                    kreorderFlipCPULauncher(db, pin_offset_x, node_flip_x, schedule.K, schedule.k_reorder_max_iters, num_threads, &context);
+                    break;
+                case kIndependentSetMatching:
+                    independentSetMatchingCPULauncher(db, schedule.ism_batch_size, schedule.ism_set_size, schedule.ism_max_iters,
+                            schedule.lap_solver, num_threads, &context);
+                    break;
+                case kGlobalSwap:
+                    globalSwapCPULauncher(gs_db, schedule.gs_batch_size, schedule.gs_max_iters, schedule.gs_deterministic, num_threads, &context);
+                    break;
+            }
+            timer_stop = get_globaltime();
+            dreamplacePrint(kINFO, "round %d %s: hpwl %.3f => %.3f (imp. %g%%), %g ms\n",
+                    round, name.c_str(), pass_hpwl, context.hpwl, (1.0-context.hpwl/(double)pass_hpwl)*100,
+                    get_timer_period()*(timer_stop-timer_start));
+            // an illegal result would mislead later passes, so it is reported with the pass causing it
+            if (!checkLegality(context.moved_nodes))
+            {
+                dreamplacePrint(kERROR, "round %d %s breaks legality, stop detailed placement\n", round, name.c_str());
+                return false;
+            }
+        }
+        dreamplacePrint(kINFO, "round %d: hpwl %.3f => %.3f (imp. %g%%)\n",
+                round, initial_hpwl, context.hpwl, (1.0-context.hpwl/(double)initial_hpwl)*100);
+        if (round_hpwl-context.hpwl < schedule.stop_threshold*initial_hpwl)
+        {
+            break;
+        }
+    }
+    return true;
+}
+
+#define CHECK_FLAT(x) AT_ASSERTM(!x.is_cuda() && x.ndimension() == 1, #x "must be a flat tensor on CPU")
+#define CHECK_EVEN(x) AT_ASSERTM((x.numel()&1) == 0, #x "must have even number of elements")
+#define CHECK_CONTIGUOUS(x) AT_ASSERTM(x.is_contiguous(), #x "must be contiguous")
+
+/// @return locations after detailed placement and whether they are legal
+std::tuple<at::Tensor, bool> detailed_place_forward(
+        at::Tensor init_pos,
+        at::Tensor node_size_x,
+        at::Tensor node_size_y,
+        at::Tensor flat_region_boxes,
+        at::Tensor flat_region_boxes_start,
+        at::Tensor node2fence_region_map,
+        at::Tensor flat_net2pin_map,
+        at::Tensor flat_net2pin_start_map,
+        at::Tensor pin2net_map,
+        at::Tensor flat_node2pin_map,
+        at::Tensor flat_node2pin_start_map,
+        at::Tensor pin2node_map,
+        at::Tensor pin_offset_x,
+        at::Tensor pin_offset_y,
+        at::Tensor net_mask,
+        at::Tensor node_flip_x,
+        double xl,
+        double yl,
+        double xh,
+        double yh,
+        double site_width, double row_height,
+        int num_bins_x,
+        int num_bins_y,
+        int num_movable_nodes,
+        int num_terminal_NIs,
+        int num_filler_nodes,
+        std::string passes,
+        int max_rounds,
+        double stop_threshold,
+        int K,
+        int k_reorder_max_iters,
+        int ism_batch_size,
+        int ism_set_size,
+        int ism_max_iters,
+        std::string lap_solver,
+        int gs_batch_size,
+        int gs_max_iters,
+        int gs_bin_ratio,
+        bool gs_deterministic,
+        int num_shards,
+        int num_threads
+        )
+{
+    CHECK_FLAT(init_pos);
+    CHECK_EVEN(init_pos);
+    CHECK_CONTIGUOUS(init_pos);
+    CHECK_FLAT(pin_offset_x);
+    CHECK_CONTIGUOUS(pin_offset_x);
+    CHECK_FLAT(node_flip_x);
+    CHECK_CONTIGUOUS(node_flip_x);
+    AT_ASSERTM(node_flip_x.numel() >= num_movable_nodes, "node_flip_x must cover movable cells");
+    AT_ASSERTM(gs_bin_ratio > 0, "gs_bin_ratio must be positive");
+
+    DetailedPlaceSchedule schedule;
+    // names of passes are separated by commas
+    std::istringstream passes_stream (passes);
+    std::string name;
+    while (std::getline(passes_stream, name, ','))
+    {
+        if (!name.empty())
+        {
+            schedule.passes.push_back(name);
+        }
+    }
+    schedule.max_rounds = max_rounds;
+    schedule.stop_threshold = stop_threshold;
+    schedule.K = K;
+    schedule.k_reorder_max_iters = k_reorder_max_iters;
+    schedule.ism_batch_size = ism_batch_size;
+    schedule.ism_set_size = ism_set_size;
+    schedule.ism_max_iters = ism_max_iters;
+    schedule.lap_solver = lapSolverType(lap_solver);
+    schedule.gs_batch_size = gs_batch_size;
+    schedule.gs_max_iters = gs_max_iters;
+    schedule.gs_bin_ratio = gs_bin_ratio;
+    schedule.gs_deterministic = gs_deterministic;
+
+    bool flip = false;
+    for (auto const& name : schedule.passes)
+    {
+        // check names before running anything
+        flip |= (detailedPlacePassType(name) == kKReorderFlip);
+    }
+    // shards work on copies of pin offsets, so flipped pins would not be written back
+    if (flip && num_shards > 1)
+    {
+        dreamplacePrint(kWARN, "flipping is not supported with %d shards, place the whole layout instead\n", num_shards);
+        num_shards = 1;
+    }
+
+    auto pos = init_pos.clone();
+    // shards are checked separately
+    std::atomic<int> legal (1);
+
+    hr_clock_rep total_time_start, total_time_stop;
+    total_time_start = get_globaltime();
+
+    DREAMPLACE_DISPATCH_FLOATING_TYPES(pos.type(), "detailedPlaceCPULauncher", [&] {
+            auto db = make_placedb<scalar_t>(
+                    init_pos,
+                    pos,
+                    node_size_x, node_size_y,
+                    flat_region_boxes, flat_region_boxes_start, node2fence_region_map,
+                    flat_net2pin_map, flat_net2pin_start_map, pin2net_map,
+                    flat_node2pin_map, flat_node2pin_start_map, pin2node_map,
+                    pin_offset_x, pin_offset_y,
+                    net_mask,
+                    xl, yl, xh, yh,
+                    site_width, row_height,
+                    num_bins_x, num_bins_y,
+                    num_movable_nodes, num_terminal_NIs, num_filler_nodes
+                    );
+            detailedPlaceShards(db, num_shards, num_threads,
+                    [&](const DetailedPlaceDB<scalar_t>& shard_db, int shard_num_threads) {
+                    if (legal && !detailedPlaceCPULauncher(shard_db, pin_offset_x.data<scalar_t>(), node_flip_x.data<unsigned char>(),
+                            schedule, shard_num_threads))
+                    {
+                        legal = 0;
+                    }
+                    });
+            });
+    total_time_stop = get_globaltime();
+    dreamplacePrint(kINFO, "Detailed placement time: %g ms\n", get_timer_period()*(total_time_stop-total_time_start));
+
+    return std::make_tuple(pos, (bool)legal);
+}
+
+DREAMPLACE_END_NAMESPACE
+
+PYBIND11_MODULE(TORCH_EXTENSION_NAME, m) {
+  m.def("detailed_place", &DREAMPLACE_NAMESPACE::detailed_place_forward, "Detailed placement with a schedule of passes");
+}
@@ -0,0 +1,153 @@
+##
+# @file   flow_legalize.py
+# @author agent
+# @date   Oct 2026
+#
+
+import math
+import logging
+import torch
+from torch import nn
+from torch.autograd import Function
+
+import dreamplace.ops.flow_legalize.flow_legalize_cpp as flow_legalize_cpp
+
+class FlowLegalizeFunction(Function):
+    """ Legalize cells with min-cost flow among bins followed by abacus within rows
+    """
+    @staticmethod
+    def forward(
+          init_pos,
+          pos,
+          node_size_x,
+          node_size_y,
+          flat_region_boxes,
+          flat_region_boxes_start,
+          node2fence_region_map,
+          xl,
+          yl,
+          xh,
+          yh,
+          site_width,
+          row_height,
+          num_movable_nodes,
+          num_terminal_NIs,
+          num_filler_nodes,
+          max_displacement,
+          bin_width,
+          num_threads
+          ):
+        if pos.is_cuda:
+            output = flow_legalize_cpp.forward(
+                    init_pos.view(init_pos.numel()).cpu(),
+                    pos.view(pos.numel()).cpu(),
+                    node_size_x.cpu(),
+                    node_size_y.cpu(),
+                    flat_region_boxes.cpu(),
+                    flat_region_boxes_start.cpu(),
+                    node2fence_region_map.cpu(),
+                    xl,
+                    yl,
+                    xh,
+                    yh,
+                    site_width,
+                    row_height,
+                    num_movable_nodes,
+                    num_terminal_NIs,
+                    num_filler_nodes,
+                    max_displacement,
+                    bin_width,
+                    num_threads
+                    )
+            output = [x.cuda() for x in output]
+        else:
+            output = flow_legalize_cpp.forward(
+                    init_pos.view(init_pos.numel()),
+                    pos.view(pos.numel()),
+                    node_size_x,
+                    node_size_y,
+                    flat_region_boxes,
+                    flat_region_boxes_start,
+                    node2fence_region_map,
+                    xl,
+                    yl,
+                    xh,
+                    yh,
+                    site_width,
+                    row_height,
+                    num_movable_nodes,
+                    num_terminal_NIs,
+                    num_filler_nodes,
+                    max_displacement,
+                    bin_width,
+                    num_threads
+                    )
+        return output
+
+class FlowLegalize(object):
+    """ Legalize cells with min-cost flow among bins followed by abacus within rows.
+    Cell widths are transported among bins of row segments within the displacement bound.
+    Only single-row movable cells are transported among bins.
+    """
+    def __init__(self, node_size_x, node_size_y,
+            flat_region_boxes, flat_region_boxes_start, node2fence_region_map,
+            xl, yl, xh, yh, site_width, row_height, num_movable_nodes, num_terminal_NIs, num_filler_nodes,
+            max_displacement=None, bin_width=None, num_threads=8):
+        """
+        @param max_displacement bound of displacement in transporting cells among bins, 10 rows by default
+        @param bin_width target width of bins, 4 rows by default
+        """
+        super(FlowLegalize, self).__init__()
+        self.node_size_x = node_size_x
+        self.node_size_y = node_size_y
+        self.flat_region_boxes = flat_region_boxes
+        self.flat_region_boxes_start = flat_region_boxes_start
+        self.node2fence_region_map = node2fence_region_map
+        self.xl = xl
+        self.yl = yl
+        self.xh = xh
+        self.yh = yh
+        self.site_width = site_width
+        self.row_height = row_height
+        self.num_movable_nodes = num_movable_nodes
+        self.num_terminal_NIs = num_terminal_NIs
+        self.num_filler_nodes = num_filler_nodes
+        self.max_displacement = max_displacement if max_displacement is not None else 10*row_height
+        self.bin_width = bin_width if bin_width is not None else 4*row_height
+        self.num_threads = num_threads
+        # displacement of movable cells in the last call
+        self.displacement = None
+    def __call__(self, init_pos, pos):
+        """
+        @param init_pos the reference position for displacement minization
+        @param pos current roughly legal position
+        """
+        output, self.displacement = FlowLegalizeFunction.forward(
+                init_pos,
+                pos,
+                node_size_x=self.node_size_x,
+                node_size_y=self.node_size_y,
+                flat_region_boxes=self.flat_region_boxes,
+                flat_region_boxes_start=self.flat_region_boxes_start,
+                node2fence_region_map=self.node2fence_region_map,
+                xl=self.xl,
+                yl=self.yl,
+                xh=self.xh,
+                yh=self.yh,
+                site_width=self.site_width,
+                row_height=self.row_height,
+                num_movable_nodes=self.num_movable_nodes,
+                num_terminal_NIs=self.num_terminal_NIs,
+                num_filler_nodes=self.num_filler_nodes,
+                max_displacement=self.max_displacement,
+                bin_width=self.bin_width,
+                num_threads=self.num_threads
+                )
+        return output
+    def displacement_statistics(self):
+        """
+        @return average, maximum displacement, and number of cells exceeding the bound in the last call
+        """
+        if self.displacement is None or self.displacement.numel() == 0:
+            return 0, 0, 0
+        return self.displacement.mean().item(), self.displacement.max().item(), (self.displacement > self.max_displacement).sum().item()
@@ -0,0 +1,130 @@
+/**
+ * @file   flow_legalize.cpp
+ * @author agent
+ * @date   Oct 2026
+ */
+#include "utility/src/torch.h"
+#include "utility/src/LegalizationDB.h"
+#include "utility/src/LegalizationDBUtils.h"
+#include "utility/src/LegalizationRegions.h"
+#include "flow_legalize/src/flow_legalize_cpu.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// @brief legalize standard cells with min-cost flow among bins followed by Abacus within rows.
+/// Fence regions are legalized separately.
+/// @param max_displacement bound of displacement in transporting cells among bins
+/// @param bin_width target width of bins
+/// @param num_threads number of threads
+/// @param displacement output displacement of each movable node
+template <typename T>
+int flowLegalizationLauncher(LegalizationDB<T> db, T max_displacement, T bin_width, int num_threads, T* displacement)
+{
+    int num_fallback_cells = 0;
+    legalizeFenceRegions(db, std::max(num_threads, 1), [&](const LegalizationDB<T>& rdb, int rnum_threads){
+            int n = flowLegalizationCPU(rdb, max_displacement, bin_width, rnum_threads);
+#pragma omp atomic
+            num_fallback_cells += n;
+            });
+
+    T total_displacement = 0;
+    T max_cell_displacement = 0;
+    int num_exceeded_cells = 0;
+#pragma omp parallel for num_threads (num_threads) reduction(+:total_displacement, num_exceeded_cells) reduction(max:max_cell_displacement)
+    for (int i = 0; i < db.num_movable_nodes; ++i)
+    {
+        T d = std::abs(db.x[i]-db.init_x[i])+std::abs(db.y[i]-db.init_y[i]);
+        displacement[i] = d;
+        total_displacement += d;
+        max_cell_displacement = std::max(max_cell_displacement, d);
+        num_exceeded_cells += (d > max_displacement);
+    }
+    dreamplacePrint(kINFO, "flow legalization displacement average %g, max %g, %d cells exceed bound %g, %d cells out of flows\n",
+            (double)total_displacement/std::max(db.num_movable_nodes, 1), (double)max_cell_displacement,
+            num_exceeded_cells, (double)max_displacement, num_fallback_cells);
+
+    return num_exceeded_cells;
+}
+
+#define CHECK_FLAT(x) AT_ASSERTM(!x.is_cuda() && x.ndimension() == 1, #x "must be a flat tensor on CPU")
+#define CHECK_EVEN(x) AT_ASSERTM((x.numel()&1) == 0, #x "must have even number of elements")
+#define CHECK_CONTIGUOUS(x) AT_ASSERTM(x.is_contiguous(), #x "must be contiguous")
+
+/// @brief legalize standard cells with min-cost flow among bins followed by Abacus within rows.
+/// Only single-row movable nodes are transported among bins, and multi-row nodes are only moved within their rows by Abacus. 
+/// Fixed nodes and filler nodes are fixed.
+///
+/// @param init_pos initial locations of nodes, including movable nodes, fixed nodes, and filler nodes, [0, num_movable_nodes) are movable nodes, [num_movable_nodes, num_nodes-num_filler_nodes) are fixed nodes, [num_nodes-num_filler_nodes, num_nodes) are filler nodes
+/// @param pos current locations of nodes
+/// @param node_size_x width of nodes, including movable nodes, fixed nodes, and filler nodes, [0, num_movable_nodes) are movable nodes, [num_movable_nodes, num_nodes-num_filler_nodes) are fixed nodes, [num_nodes-num_filler_nodes, num_nodes) are filler nodes
+/// @param node_size_y height of nodes, including movable nodes, fixed nodes, and filler nodes, same as node_size_x
+/// @param xl left edge of bounding box of layout area
+/// @param yl bottom edge of bounding box of layout area
+/// @param xh right edge of bounding box of layout area
+/// @param yh top edge of bounding box of layout area
+/// @param site_width width of a placement site
+/// @param row_height height of a placement row
+/// @param num_movable_nodes number of movable nodes, movable nodes are in the range of [0, num_movable_nodes)
+/// @param number of filler nodes, filler nodes are in the range of [num_nodes-num_filler_nodes, num_nodes)
+/// @param max_displacement bound of displacement in transporting cells among bins
+/// @param bin_width target width of bins, at least the width of the widest cell
+/// @param num_threads number of threads
+/// @return legalized locations and displacement of movable nodes
+std::vector<at::Tensor> flow_legalization_forward(
+        at::Tensor init_pos,
+        at::Tensor pos,
+        at::Tensor node_size_x,
+        at::Tensor node_size_y,
+        at::Tensor flat_region_boxes,
+        at::Tensor flat_region_boxes_start,
+        at::Tensor node2fence_region_map,
+        double xl,
+        double yl,
+        double xh,
+        double yh,
+        double site_width, double row_height,
+        int num_movable_nodes,
+        int num_terminal_NIs,
+        int num_filler_nodes,
+        double max_displacement,
+        double bin_width,
+        int num_threads
+        )
+{
+    CHECK_FLAT(init_pos);
+    CHECK_EVEN(init_pos);
+    CHECK_CONTIGUOUS(init_pos);
+
+    auto pos_copy = pos.clone();
+    auto displacement = at::zeros(num_movable_nodes, pos.options());
+
+    hr_clock_rep timer_start, timer_stop;
+    timer_start = get_globaltime();
+    DREAMPLACE_DISPATCH_FLOATING_TYPES(pos.type(), "flowLegalizationLauncher", [&] {
+            auto db = make_placedb<scalar_t>(
+                    init_pos,
+                    pos_copy,
+                    node_size_x,
+                    node_size_y,
+                    flat_region_boxes, flat_region_boxes_start, node2fence_region_map,
+                    xl, yl, xh, yh,
+                    site_width, row_height,
+                    1,
+                    1,
+                    num_movable_nodes,
+                    num_terminal_NIs,
+                    num_filler_nodes
+                    );
+            flowLegalizationLauncher<scalar_t>(db, max_displacement, bin_width, num_threads, displacement.data<scalar_t>());
+            });
+    timer_stop = get_globaltime();
+    dreamplacePrint(kINFO, "Flow legalization takes %g ms\n", (timer_stop-timer_start)*get_timer_period());
+
+    return {pos_copy, displacement};
+}
+
+DREAMPLACE_END_NAMESPACE
+
+PYBIND11_MODULE(TORCH_EXTENSION_NAME, m) {
+  m.def("forward", &DREAMPLACE_NAMESPACE::flow_legalization_forward, "Flow legalization forward");
+}
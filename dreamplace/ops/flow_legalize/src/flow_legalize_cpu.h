@@ -0,0 +1,447 @@
+/**
+ * @file   flow_legalize_cpu.h
+ * @author agent
+ * @date   Oct 2026
+ * @brief  Legalization by min-cost flow of cell widths among bins of row segments,
+ * followed by Abacus within rows.
+ */
+
+#ifndef DREAMPLACE_FLOW_LEGALIZE_CPU_H
+#define DREAMPLACE_FLOW_LEGALIZE_CPU_H
+
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "utility/src/Msg.h"
+#include "utility/src/LegalizationDB.h"
+#include "independent_set_matching/src/min_cost_flow_cpu.h"
+#include "abacus_legalize/src/abacus_legalize_cpu.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// @brief a bin in a free segment of a row
+template <typename T>
+struct FlowLegalizeBin
+{
+    T xl; ///< left boundary aligned to sites
+    T xh; ///< right boundary aligned to sites
+    int row_id;
+    int capacity; ///< number of free sites
+};
+
+/// @brief bins of free row segments, stored row by row from left to right
+template <typename T>
+struct FlowLegalizeBinMap
+{
+    std::vector<FlowLegalizeBin<T> > bins;
+    std::vector<int> row_bin_start; ///< length of number of rows + 1
+    T yl;
+    T row_height;
+    int num_rows;
+
+    /// @brief displacement to move a cell of width w at (x, y) into a bin
+    T cost(const FlowLegalizeBin<T>& bin, T x, T y, T w) const
+    {
+        T dx = std::max(std::max(bin.xl-x, x+w-bin.xh), (T)0);
+        return dx+std::abs(yl+bin.row_id*row_height-y);
+    }
+    /// @brief find the nearest bin that can hold a cell
+    /// @param accept functor with accept(bin_id) to filter bins
+    /// @return bin index, or -1 if not found
+    template <typename AcceptType>
+    int nearestBin(T x, T y, T w, AcceptType const& accept) const
+    {
+        int best_bin_id = -1;
+        T best_cost = std::numeric_limits<T>::max();
+        int row_id0 = std::min(std::max((int)round((y-yl)/row_height), 0), num_rows-1);
+        T offset_y = std::abs(y-(yl+row_id0*row_height));
+        // rows row_id0-d and row_id0+d are at least d*row_height-offset_y away
+        for (int d = 0; row_id0-d >= 0 || row_id0+d < num_rows; ++d)
+        {
+            if (d*row_height-offset_y >= best_cost)
+            {
+                break;
+            }
+            for (int k = 0; k < 2; ++k)
+            {
+                int row_id = (k)? row_id0+d : row_id0-d;
+                if (row_id < 0 || row_id >= num_rows || (k && d == 0))
+                {
+                    continue;
+                }
+                T dy = std::abs(yl+row_id*row_height-y);
+                auto row_bgn = bins.begin()+row_bin_start[row_id];
+                auto row_end = bins.begin()+row_bin_start[row_id+1];
+                int idx = std::upper_bound(row_bgn, row_end, x,
+                        [](T xx, const FlowLegalizeBin<T>& bin) {return xx < bin.xh;})-bins.begin();
+                // costs increase monotonically away from x in both directions
+                for (int bin_id = idx-1; bin_id >= row_bin_start[row_id] && dy+x-bins[bin_id].xh < best_cost; --bin_id)
+                {
+                    update(bin_id, x, y, w, accept, best_bin_id, best_cost);
+                }
+                for (int bin_id = idx; bin_id < row_bin_start[row_id+1] && dy+bins[bin_id].xl-x < best_cost; ++bin_id)
+                {
+                    update(bin_id, x, y, w, accept, best_bin_id, best_cost);
+                }
+            }
+        }
+        return best_bin_id;
+    }
+    /// @brief collect bins within a displacement bound to a bin, including itself
+    void neighborBins(int bin_id, T max_displacement, std::vector<int>& neighbors) const
+    {
+        const FlowLegalizeBin<T>& bin = bins[bin_id];
+        int num_rows_bound = floor(max_displacement/row_height);
+        int row_bgn = std::max(bin.row_id-num_rows_bound, 0);
+        int row_end = std::min(bin.row_id+num_rows_bound+1, num_rows);
+        for (int row_id = row_bgn; row_id < row_end; ++row_id)
+        {
+            T remain = max_displacement-std::abs(row_id-bin.row_id)*row_height;
+            auto first = bins.begin()+row_bin_start[row_id];
+            auto last = bins.begin()+row_bin_start[row_id+1];
+            int idx = std::upper_bound(first, last, bin.xl-remain,
+                    [](T xx, const FlowLegalizeBin<T>& b) {return xx < b.xh;})-bins.begin();
+            for (; idx < row_bin_start[row_id+1] && bins[idx].xl < bin.xh+remain; ++idx)
+            {
+                neighbors.push_back(idx);
+            }
+        }
+    }
+
+    protected:
+        template <typename AcceptType>
+        void update(int bin_id, T x, T y, T w, AcceptType const& accept, int& best_bin_id, T& best_cost) const
+        {
+            const FlowLegalizeBin<T>& bin = bins[bin_id];
+            if (bin.xh-bin.xl >= w && accept(bin_id))
+            {
+                T c = cost(bin, x, y, w);
+                if (c < best_cost)
+                {
+                    best_cost = c;
+                    best_bin_id = bin_id;
+                }
+            }
+        }
+};
+
+/// @brief split free segments of rows into bins.
+/// Fixed cells and multi-row movable cells are obstacles at their current locations.
+template <typename T>
+void flowLegalizeBuildBins(const LegalizationDB<T>& db, T bin_width, int num_threads, FlowLegalizeBinMap<T>& bin_map)
+{
+    int num_rows = (db.yh-db.yl)/db.row_height;
+    int num_sites = (db.xh-db.xl)/db.site_width;
+    int bin_sites = std::max((int)round(bin_width/db.site_width), 1);
+    std::vector<std::vector<std::pair<T, T> > > row_blocks (num_rows);
+    for (int i = 0; i < db.num_nodes; ++i)
+    {
+        if (i < db.num_movable_nodes && db.node_size_y[i] <= db.row_height)
+        {
+            continue;
+        }
+        int row_bgn = std::max((int)floor((db.y[i]-db.yl)/db.row_height), 0);
+        int row_end = std::min((int)ceil((db.y[i]+db.node_size_y[i]-db.yl)/db.row_height), num_rows);
+        for (int row_id = row_bgn; row_id < row_end; ++row_id)
+        {
+            row_blocks[row_id].push_back(std::make_pair(db.x[i], db.x[i]+db.node_size_x[i]));
+        }
+    }
+
+    std::vector<std::vector<FlowLegalizeBin<T> > > row_bins (num_rows);
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 16)
+    for (int row_id = 0; row_id < num_rows; ++row_id)
+    {
+        auto& blocks = row_blocks[row_id];
+        auto& bins = row_bins[row_id];
+        // split sites [site_bgn, site_end) into bins no narrower than bin_sites unless the segment is
+        auto add_segment = [&](int site_bgn, int site_end) {
+            int n = site_end-site_bgn;
+            int nb = std::max(n/bin_sites, 1);
+            for (int k = 0; k < nb; ++k)
+            {
+                FlowLegalizeBin<T> bin;
+                int s0 = site_bgn+(long)n*k/nb;
+                int s1 = site_bgn+(long)n*(k+1)/nb;
+                bin.xl = db.xl+s0*db.site_width;
+                bin.xh = db.xl+s1*db.site_width;
+                bin.row_id = row_id;
+                bin.capacity = s1-s0;
+                bins.push_back(bin);
+            }
+        };
+        std::sort(blocks.begin(), blocks.end());
+        int cur_site = 0;
+        for (auto const& block : blocks)
+        {
+            int block_site_bgn = std::min((int)floor((block.first-db.xl)/db.site_width), num_sites);
+            int block_site_end = ceil((block.second-db.xl)/db.site_width);
+            if (block_site_bgn > cur_site)
+            {
+                add_segment(cur_site, block_site_bgn);
+            }
+            cur_site = std::max(cur_site, block_site_end);
+        }
+        if (cur_site < num_sites)
+        {
+            add_segment(cur_site, num_sites);
+        }
+    }
+
+    bin_map.yl = db.yl;
+    bin_map.row_height = db.row_height;
+    bin_map.num_rows = num_rows;
+    bin_map.row_bin_start.assign(num_rows+1, 0);
+    for (int row_id = 0; row_id < num_rows; ++row_id)
+    {
+        bin_map.row_bin_start[row_id+1] = bin_map.row_bin_start[row_id]+row_bins[row_id].size();
+    }
+    bin_map.bins.resize(bin_map.row_bin_start[num_rows]);
+#pragma omp parallel for num_threads (num_threads) schedule(static)
+    for (int row_id = 0; row_id < num_rows; ++row_id)
+    {
+        std::copy(row_bins[row_id].begin(), row_bins[row_id].end(), bin_map.bins.begin()+bin_map.row_bin_start[row_id]);
+    }
+}
+
+/// @brief legalize single-row cells.
+/// Cells are first assigned to their nearest bins, and then the overflowed widths are
+/// transported among bins within a displacement bound by min-cost flow.
+/// Cells that cannot be accommodated within the bound are put to the nearest bins with enough space.
+/// Finally, Abacus places cells within rows.
+/// Fixed cells and multi-row movable cells are regarded as obstacles.
+/// @param max_displacement bound of displacement in transporting cells among bins
+/// @param bin_width target width of bins, at least the width of the widest cell
+/// @return number of cells not accommodated by the flows
+template <typename T>
+int flowLegalizationCPU(const LegalizationDB<T>& db, T max_displacement, T bin_width, int num_threads)
+{
+    hr_clock_rep timer_start = get_globaltime();
+
+    std::vector<int> cells;
+    for (int i = 0; i < db.num_movable_nodes; ++i)
+    {
+        if (db.node_size_y[i] <= db.row_height)
+        {
+            cells.push_back(i);
+            bin_width = std::max(bin_width, db.node_size_x[i]);
+        }
+    }
+    if (cells.empty())
+    {
+        return 0;
+    }
+    int num_cells = cells.size();
+
+    FlowLegalizeBinMap<T> bin_map;
+    flowLegalizeBuildBins(db, bin_width, num_threads, bin_map);
+    int num_bins = bin_map.bins.size();
+    if (num_bins == 0)
+    {
+        dreamplacePrint(kWARN, "no free space for %d cells in flow legalization\n", num_cells);
+        return num_cells;
+    }
+
+    // assign cells to nearest bins
+    std::vector<int> cell_bins (num_cells);
+    std::vector<int> cell_sites (num_cells);
+#pragma omp parallel for num_threads (num_threads) schedule(static)
+    for (int k = 0; k < num_cells; ++k)
+    {
+        int node_id = cells[k];
+        cell_bins[k] = bin_map.nearestBin(db.x[node_id], db.y[node_id], db.node_size_x[node_id], [](int) {return true;});
+        cell_sites[k] = ceil(db.node_size_x[node_id]/db.site_width);
+    }
+    std::vector<int> demands (num_bins, 0);
+    std::vector<std::vector<int> > bin_cells (num_bins);
+    for (int k = 0; k < num_cells; ++k)
+    {
+        if (cell_bins[k] >= 0)
+        {
+            demands[cell_bins[k]] += cell_sites[k];
+            bin_cells[cell_bins[k]].push_back(k);
+        }
+    }
+
+    // nodes are sources (bins with demands), bins, and the sink
+    std::vector<int> sources;
+    for (int i = 0; i < num_bins; ++i)
+    {
+        if (demands[i] > 0)
+        {
+            sources.push_back(i);
+        }
+    }
+    int num_sources = sources.size();
+    int sink = num_sources+num_bins;
+    std::vector<std::vector<int> > source_targets (num_sources);
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 64)
+    for (int s = 0; s < num_sources; ++s)
+    {
+        bin_map.neighborBins(sources[s], max_displacement, source_targets[s]);
+    }
+    std::vector<int> source_arc_start (num_sources+1, 0);
+    for (int s = 0; s < num_sources; ++s)
+    {
+        // one more arc to the sink for widths out of the bound
+        source_arc_start[s+1] = source_arc_start[s]+source_targets[s].size()+1;
+    }
+    int num_arcs = source_arc_start[num_sources]+num_bins;
+    std::vector<int> arc_sources (num_arcs);
+    std::vector<int> arc_targets (num_arcs);
+    std::vector<int> arc_capacities (num_arcs);
+    // network simplex needs integral costs, so displacements are measured in half sites,
+    // the unit of distances between centers of site-aligned bins
+    T cost_unit = db.site_width/2;
+    std::vector<long> arc_costs (num_arcs);
+    long penalty = std::lround(((db.xh-db.xl)+(db.yh-db.yl))/cost_unit);
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 64)
+    for (int s = 0; s < num_sources; ++s)
+    {
+        const FlowLegalizeBin<T>& bin = bin_map.bins[sources[s]];
+        int arc_id = source_arc_start[s];
+        for (auto target : source_targets[s])
+        {
+            const FlowLegalizeBin<T>& target_bin = bin_map.bins[target];
+            arc_sources[arc_id] = s;
+            arc_targets[arc_id] = num_sources+target;
+            arc_capacities[arc_id] = demands[sources[s]];
+            arc_costs[arc_id] = std::lround((std::abs((target_bin.xl+target_bin.xh)-(bin.xl+bin.xh))/2
+                + std::abs(target_bin.row_id-bin.row_id)*db.row_height)/cost_unit);
+            ++arc_id;
+        }
+        arc_sources[arc_id] = s;
+        arc_targets[arc_id] = sink;
+        arc_capacities[arc_id] = demands[sources[s]];
+        arc_costs[arc_id] = penalty;
+    }
+    for (int i = 0; i < num_bins; ++i)
+    {
+        int arc_id = source_arc_start[num_sources]+i;
+        arc_sources[arc_id] = num_sources+i;
+        arc_targets[arc_id] = sink;
+        arc_capacities[arc_id] = bin_map.bins[i].capacity;
+        arc_costs[arc_id] = 0;
+    }
+    std::vector<int> supplies (sink+1, 0);
+    for (int s = 0; s < num_sources; ++s)
+    {
+        supplies[s] = demands[sources[s]];
+        supplies[sink] -= supplies[s];
+    }
+
+    std::vector<int> flows (num_arcs, 0);
+    MinCostFlowNetworkCPULauncher<long> solver;
+    long total_cost = solver.run(sink+1, supplies.data(), num_arcs, arc_sources.data(), arc_targets.data(), arc_capacities.data(), arc_costs.data(), flows.data());
+    dreamplacePrint(kDEBUG, "flow legalization: %d cells, %d bins, %d arcs, cost %g\n", num_cells, num_bins, num_arcs, total_cost*(double)cost_unit);
+
+    // realize flows with cells of each source,
+    // cheaper moves are taken first as long as the flow to the target has enough sites
+    std::vector<int> cell_targets (num_cells, -1);
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 16)
+    for (int s = 0; s < num_sources; ++s)
+    {
+        auto const& targets = source_targets[s];
+        std::vector<int> quotas (targets.size());
+        std::vector<std::pair<T, std::pair<int, int> > > moves;
+        for (unsigned int t = 0; t < targets.size(); ++t)
+        {
+            quotas[t] = flows[source_arc_start[s]+t];
+            if (quotas[t] > 0)
+            {
+                for (auto k : bin_cells[sources[s]])
+                {
+                    int node_id = cells[k];
+                    T c = bin_map.cost(bin_map.bins[targets[t]], db.x[node_id], db.y[node_id], db.node_size_x[node_id]);
+                    moves.push_back(std::make_pair(c, std::make_pair(k, t)));
+                }
+            }
+        }
+        std::sort(moves.begin(), moves.end());
+        for (auto const& move : moves)
+        {
+            int k = move.second.first;
+            int t = move.second.second;
+            const FlowLegalizeBin<T>& target_bin = bin_map.bins[targets[t]];
+            if (cell_targets[k] < 0 && quotas[t] >= cell_sites[k] && target_bin.xh-target_bin.xl >= db.node_size_x[cells[k]])
+            {
+                cell_targets[k] = targets[t];
+                quotas[t] -= cell_sites[k];
+            }
+        }
+    }
+
+    // put the remaining cells to the nearest bins with enough space, wider cells first
+    std::vector<int> remains (num_bins);
+    for (int i = 0; i < num_bins; ++i)
+    {
+        remains[i] = bin_map.bins[i].capacity;
+    }
+    std::vector<int> unplaced_cells;
+    for (int k = 0; k < num_cells; ++k)
+    {
+        if (cell_targets[k] >= 0)
+        {
+            remains[cell_targets[k]] -= cell_sites[k];
+        }
+        else
+        {
+            unplaced_cells.push_back(k);
+        }
+    }
+    std::sort(unplaced_cells.begin(), unplaced_cells.end(),
+            [&](int k1, int k2) {return cell_sites[k1] > cell_sites[k2] || (cell_sites[k1] == cell_sites[k2] && k1 < k2);});
+    int num_failed_cells = 0;
+    for (auto k : unplaced_cells)
+    {
+        int node_id = cells[k];
+        int bin_id = bin_map.nearestBin(db.x[node_id], db.y[node_id], db.node_size_x[node_id],
+                [&](int b) {return remains[b] >= cell_sites[k];});
+        if (bin_id >= 0)
+        {
+            cell_targets[k] = bin_id;
+            remains[bin_id] -= cell_sites[k];
+        }
+        else
+        {
+            ++num_failed_cells;
+        }
+    }
+    if (num_failed_cells)
+    {
+        dreamplacePrint(kWARN, "flow legalization fails to find space for %d cells\n", num_failed_cells);
+    }
+
+    // move cells into the target bins, and Abacus resolves overlaps within rows
+#pragma omp parallel for num_threads (num_threads)
+    for (int k = 0; k < num_cells; ++k)
+    {
+        int node_id = cells[k];
+        if (cell_targets[k] >= 0)
+        {
+            const FlowLegalizeBin<T>& bin = bin_map.bins[cell_targets[k]];
+            db.x[node_id] = std::max(std::min(db.x[node_id], bin.xh-db.node_size_x[node_id]), bin.xl);
+            db.y[node_id] = db.yl+bin.row_id*db.row_height;
+        }
+    }
+    abacusLegalizationCPU(
+            db.init_x, db.init_y,
+            db.node_size_x, db.node_size_y,
+            db.x, db.y,
+            db.xl, db.yl, db.xh, db.yh,
+            db.site_width, db.row_height,
+            1, bin_map.num_rows,
+            db.num_nodes,
+            db.num_movable_nodes,
+            num_threads
+            );
+    dreamplacePrint(kDEBUG, "flow legalization of %d cells takes %g ms, %d cells out of flows\n", 
+            num_cells, (get_globaltime()-timer_start)*get_timer_period(), (int)unplaced_cells.size());
+
+    return unplaced_cells.size();
+}
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
@@ -53,6 +53,8 @@ class GlobalSwapFunction(Function):
           batch_size, 
           max_iters, 
           algorithm, 
+          deterministic, 
+          num_shards, 
           num_threads
           ):
         if pos.is_cuda:
@@ -118,6 +120,8 @@ class GlobalSwapFunction(Function):
                         num_filler_nodes, 
                         batch_size, 
                         max_iters, 
+                        deterministic, 
+                        num_shards, 
                         num_threads
                         )
             else:
@@ -169,7 +173,14 @@ class GlobalSwap(object):
             batch_size=32, 
             max_iters=10, 
             algorithm='concurrent', 
+            deterministic=False, 
+            num_shards=1, 
             num_threads=8):
+        """
+        @param deterministic whether the concurrent CPU algorithm applies swaps in a fixed order; 
+        otherwise threads apply them in the order they win, and results with multiple threads may differ between runs 
+        @param num_shards number of rectangular shards placed concurrently by the concurrent CPU algorithm, 1 for the whole layout 
+        """
         super(GlobalSwap, self).__init__()
         self.node_size_x = node_size_x
         self.node_size_y = node_size_y
@@ -199,6 +210,8 @@ class GlobalSwap(object):
         self.batch_size = batch_size
         self.max_iters = max_iters
         self.algorithm = algorithm 
+        self.deterministic = deterministic 
+        self.num_shards = num_shards 
         self.num_threads = num_threads 
     def __call__(self, pos): 
         return GlobalSwapFunction.forward(
@@ -231,5 +244,7 @@ class GlobalSwap(object):
                 batch_size=self.batch_size, 
                 max_iters=self.max_iters, 
                 algorithm=self.algorithm, 
+                deterministic=self.deterministic, 
+                num_shards=self.num_shards, 
                 num_threads=self.num_threads
                 )
@@ -25,6 +25,10 @@ int globalSwapCPULauncher(DetailedPlaceDB<T> db, int max_iters)
 {
     dreamplacePrint(kDEBUG, "%dx%d bins, bin size %g x %g\n", db.num_bins_x, db.num_bins_y, db.bin_size_x, db.bin_size_y);
 
+    // extreme pins of nets, so that each net costs O(1) instead of a scan of its pins 
+    NetBoxCache<T> net_boxes; 
+    db.make_net_box_cache(net_boxes, 1); 
+
     auto compute_pair_hpwl = [&] (int node_id, T node_xl, T node_yl, int target_node_id, T target_node_xl, T target_node_yl) {
         T cost = 0; 
         for (int node2pin_id = db.flat_node2pin_start_map[node_id]; node2pin_id < db.flat_node2pin_start_map[node_id+1]; ++node2pin_id)
@@ -33,38 +37,13 @@ int globalSwapCPULauncher(DetailedPlaceDB<T> db, int max_iters)
             int net_id = db.pin2net_map[node_pin_id];
             if (db.net_mask[net_id])
             {
-                Box<T> box (
-                        db.xh, 
-                        db.yh, 
-                        db.xl, 
-                        db.yl
-                        ); 
-                for (int net2pin_id = db.flat_net2pin_start_map[net_id]; net2pin_id < db.flat_net2pin_start_map[net_id+1]; ++net2pin_id)
-                {
-                    int net_pin_id = db.flat_net2pin_map[net2pin_id];
-                    int other_node_id = db.pin2node_map[net_pin_id];
-                    if (other_node_id == node_id)
-                    {
-                        box.xl = std::min(box.xl, node_xl+db.pin_offset_x[net_pin_id]);
-                        box.xh = std::max(box.xh, node_xl+db.pin_offset_x[net_pin_id]);
-                        box.yl = std::min(box.yl, node_yl+db.pin_offset_y[net_pin_id]);
-                        box.yh = std::max(box.yh, node_yl+db.pin_offset_y[net_pin_id]);
-                    }
-                    else if (other_node_id == target_node_id)
-                    {
-                        box.xl = std::min(box.xl, target_node_xl+db.pin_offset_x[net_pin_id]);
-                        box.xh = std::max(box.xh, target_node_xl+db.pin_offset_x[net_pin_id]);
-                        box.yl = std::min(box.yl, target_node_yl+db.pin_offset_y[net_pin_id]);
-                        box.yh = std::max(box.yh, target_node_yl+db.pin_offset_y[net_pin_id]);
-                    }
-                    else
-                    {
-                        box.xl = std::min(box.xl, db.x[other_node_id]+db.pin_offset_x[net_pin_id]);
-                        box.xh = std::max(box.xh, db.x[other_node_id]+db.pin_offset_x[net_pin_id]);
-                        box.yl = std::min(box.yl, db.y[other_node_id]+db.pin_offset_y[net_pin_id]);
-                        box.yh = std::max(box.yh, db.y[other_node_id]+db.pin_offset_y[net_pin_id]);
-                    }
-                }
+                Box<T> box = net_boxes.boxWithout(net_id, node_id, target_node_id); 
+                box.xl = std::min(box.xl, db.xh);
+                box.yl = std::min(box.yl, db.yh);
+                box.xh = std::max(box.xh, db.xl);
+                box.yh = std::max(box.yh, db.yl);
+                db.encompass_node_pins(box, node_id, node_xl, node_yl, net_id); 
+                db.encompass_node_pins(box, target_node_id, target_node_xl, target_node_yl, net_id); 
                 T hpwl = box.xh-box.xl + box.yh-box.yl; 
                 cost += hpwl; 
             }
@@ -75,48 +54,27 @@ int globalSwapCPULauncher(DetailedPlaceDB<T> db, int max_iters)
             int net_id = db.pin2net_map[node_pin_id];
             if (db.net_mask[net_id])
             {
-                Box<T> box (
-                        db.xh, 
-                        db.yh, 
-                        db.xl, 
-                        db.yl
-                        ); 
                 // when encounter nets that have both node_id and target_node_id 
                 // skip them 
                 bool duplicate_net_flag = false; 
-                for (int net2pin_id = db.flat_net2pin_start_map[net_id]; net2pin_id < db.flat_net2pin_start_map[net_id+1]; ++net2pin_id)
+                for (int other_node2pin_id = db.flat_node2pin_start_map[node_id]; other_node2pin_id < db.flat_node2pin_start_map[node_id+1]; ++other_node2pin_id)
                 {
-                    int net_pin_id = db.flat_net2pin_map[net2pin_id];
-                    int other_node_id = db.pin2node_map[net_pin_id];
-                    if (other_node_id == node_id)
+                    if (db.pin2net_map[db.flat_node2pin_map[other_node2pin_id]] == net_id)
                     {
-                        // skip them 
                         duplicate_net_flag = true; 
                         break; 
-                        //box.xl = std::min(box.xl, node_xl+db.pin_offset_x[net_pin_id]);
-                        //box.xh = std::max(box.xh, node_xl+db.pin_offset_x[net_pin_id]);
-                        //box.yl = std::min(box.yl, node_yl+db.pin_offset_y[net_pin_id]);
-                        //box.yh = std::max(box.yh, node_yl+db.pin_offset_y[net_pin_id]);
-                    }
-                    else if (other_node_id == target_node_id)
-                    {
-                        box.xl = std::min(box.xl, target_node_xl+db.pin_offset_x[net_pin_id]);
-                        box.xh = std::max(box.xh, target_node_xl+db.pin_offset_x[net_pin_id]);
-                        box.yl = std::min(box.yl, target_node_yl+db.pin_offset_y[net_pin_id]);
-                        box.yh = std::max(box.yh, target_node_yl+db.pin_offset_y[net_pin_id]);
-                    }
-                    else
-                    {
-                        box.xl = std::min(box.xl, db.x[other_node_id]+db.pin_offset_x[net_pin_id]);
-                        box.xh = std::max(box.xh, db.x[other_node_id]+db.pin_offset_x[net_pin_id]);
-                        box.yl = std::min(box.yl, db.y[other_node_id]+db.pin_offset_y[net_pin_id]);
-                        box.yh = std::max(box.yh, db.y[other_node_id]+db.pin_offset_y[net_pin_id]);
                     }
                 }
                 if (duplicate_net_flag)
                 {
                     continue; 
                 }
+                Box<T> box = net_boxes.boxWithout(net_id, target_node_id); 
+                box.xl = std::min(box.xl, db.xh);
+                box.yl = std::min(box.yl, db.yh);
+                box.xh = std::max(box.xh, db.xl);
+                box.yh = std::max(box.yh, db.yl);
+                db.encompass_node_pins(box, target_node_id, target_node_xl, target_node_yl, net_id); 
                 T hpwl = box.xh-box.xl + box.yh-box.yl; 
                 cost += hpwl; 
             }
@@ -126,35 +84,13 @@ int globalSwapCPULauncher(DetailedPlaceDB<T> db, int max_iters)
 
     // divide layout into rows
     // distribute cells into them 
-    std::vector<std::vector<int> > row2node_map (db.num_sites_y);
-    // map node index to its location in row2node_map 
-    // we can compute the rows, so only the index within a row of row2node_map is stored 
-    std::vector<int> node2row2node_index_map (db.num_nodes);
-
-    // distribute cells to rows 
-    db.make_row2node_map(db.x, db.y, row2node_map, 1); 
-
-    // set node2row2node_index_map 
-    for (int i = 0; i < db.num_sites_y; ++i)
-    {
-        for (unsigned int j = 0; j < row2node_map[i].size(); ++j)
-        {
-            node2row2node_index_map[row2node_map[i][j]] = j; 
-        }
-    }
+    // the index also maps each node to its location in the row 
+    RowOccupancy<T> row_occupancy; 
+    db.make_row_occupancy(db.x, db.y, row_occupancy, 1); 
 
 #ifdef DEBUG 
-    // debug 
-    // check row2node_map 
-    for (unsigned int i = 0; i < row2node_map.size(); ++i)
-    {
-        for (unsigned int j = 1; j < row2node_map[i].size(); ++j)
-        {
-            assert(y[row2node_map.at(i).at(j-1)] == y[row2node_map.at(i).at(j)] && x[row2node_map.at(i).at(j-1)]+node_size_x[row2node_map.at(i).at(j-1)] <= x[row2node_map.at(i).at(j)]);
-            assert(node2row2node_index_map.at(row2node_map.at(i).at(j)) == j);
-        }
-    }
-    dreamplacePrint(kDEBUG, "passed row2node_map check\n");
+    dreamplaceAssert(row_occupancy.check()); 
+    dreamplacePrint(kDEBUG, "passed row occupancy check\n");
 #endif
 
     auto compute_cost = [&] (int node_id, T& node_xl, T& node_yl, int target_node_id, T& target_node_xl, T& target_node_yl) {
@@ -180,16 +116,14 @@ int globalSwapCPULauncher(DetailedPlaceDB<T> db, int max_iters)
             target_node_xl = db.x[node_id]+db.node_size_x[node_id]/2-db.node_size_x[target_node_id]/2;
             node_xl = db.align2site(node_xl);
             target_node_xl = db.align2site(target_node_xl);
-            int node2row2node_index = node2row2node_index_map[node_id]; 
-            T space_xl = (node2row2node_index > 0)? std::max(db.xl, db.x[row2node_map[row_id][node2row2node_index-1]]+db.node_size_x[row2node_map[row_id][node2row2node_index-1]]) : db.xl; 
-            T space_xh = (node2row2node_index+1 < (int)row2node_map[row_id].size())? std::min(db.xh, db.x[row2node_map[row_id][node2row2node_index+1]]) : db.xh; 
+            T space_xl, space_xh; 
+            row_occupancy.space(node_id, space_xl, space_xh); 
             if (space_xh-space_xl < db.node_size_x[target_node_id])
             {
                 return (db.xh-db.xl) + (db.yh-db.yl); // some large number 
             }
-            int target_node2row2node_index = node2row2node_index_map[target_node_id];
-            T target_space_xl = (target_node2row2node_index > 0)? std::max(db.xl, db.x[row2node_map[target_row_id][target_node2row2node_index-1]]+db.node_size_x[row2node_map[target_row_id][target_node2row2node_index-1]]) : db.xl; 
-            T target_space_xh = (target_node2row2node_index+1 < (int)row2node_map[target_row_id].size())? std::min(db.xh, db.x[row2node_map[target_row_id][target_node2row2node_index+1]]) : db.xh; 
+            T target_space_xl, target_space_xh; 
+            row_occupancy.space(target_node_id, target_space_xl, target_space_xh); 
             if (target_space_xh-target_space_xl < db.node_size_x[node_id])
             {
                 return (db.xh-db.xl) + (db.yh-db.yl); // some large number 
@@ -326,29 +260,10 @@ int globalSwapCPULauncher(DetailedPlaceDB<T> db, int max_iters)
                 timer_start = get_globaltime();
                 for (int sy = sitebox.yl; sy < sitebox.yh; ++sy)
                 {
-                    std::vector<int>& row2nodes = row2node_map.at(sy);
-                    int row2node_index_begin = 0; 
+                    auto const& row2nodes = row_occupancy.row(sy);
                     // search for the starting cell in the bin 
-                    // by scanning the row 
-                    // binary search 
-                    int low = 0; 
-                    int high = row2nodes.size(); 
-                    while (low < high)
-                    {
-                        int mid = (low+high)/2; 
-                        int mid_node_id = row2nodes[mid];
-                        T mid_node_xl = db.x[mid_node_id];
-                        T mid_node_xh = mid_node_xl+db.node_size_x[mid_node_id];
-                        if (mid_node_xh < bin.xl)
-                        {
-                            low = mid+1; 
-                        }
-                        else
-                        {
-                            high = mid-1; 
-                        }
-                    }
-                    row2node_index_begin = low; 
+                    // by binary search in the row 
+                    int row2node_index_begin = row_occupancy.lowerBound(sy, bin.xl); 
                     for (unsigned int k = row2node_index_begin; k < row2nodes.size(); ++k)
                     {
                         int target_node_id = row2nodes[k];
@@ -415,14 +330,13 @@ int globalSwapCPULauncher(DetailedPlaceDB<T> db, int max_iters)
                 {
                     ++num_moved; 
                 }
-                int row_id = db.pos2site_y(db.y[best_cand.node_id]);
-                int target_node_row_id = db.pos2site_y(db.y[best_cand.target_node_id]);
                 db.x[best_cand.node_id] = best_cand.node_xl; 
                 db.y[best_cand.node_id] = best_cand.node_yl; 
                 db.x[best_cand.target_node_id] = best_cand.target_node_xl; 
                 db.y[best_cand.target_node_id] = best_cand.target_node_yl; 
-                std::swap(row2node_map[row_id][node2row2node_index_map[best_cand.node_id]], row2node_map[target_node_row_id][node2row2node_index_map[best_cand.target_node_id]]);
-                std::swap(node2row2node_index_map[best_cand.node_id], node2row2node_index_map[best_cand.target_node_id]);
+                row_occupancy.swap(best_cand.node_id, best_cand.target_node_id); 
+                net_boxes.update(best_cand.node_id); 
+                net_boxes.update(best_cand.target_node_id); 
                 //T target_hpwl = compute_total_hpwl();
                 //dreamplacePrint(kDEBUG, "total hpwl %g, delta %g\n", target_hpwl, target_hpwl-orig_hpwl);
                 timer_stop = get_globaltime(); 
@@ -0,0 +1,819 @@
+/**
+ * @file   global_swap_concurrent_cpu.h
+ * @author Yibo Lin
+ * @date   Apr 2019
+ * @brief  Concurrent global swap on CPU, where batches of cells are swapped with candidates near their optimal regions
+ */
+
+#ifndef _DREAMPLACE_GLOBAL_SWAP_GLOBAL_SWAP_CONCURRENT_CPU_H
+#define _DREAMPLACE_GLOBAL_SWAP_GLOBAL_SWAP_CONCURRENT_CPU_H
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <atomic>
+#include "utility/src/Msg.h"
+#include "utility/src/diamond_search.h"
+#include "utility/src/DetailedPlaceDB.h"
+#include "utility/src/DetailedPlaceContext.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+template <typename T>
+struct SwapCandidate
+{
+    T cost; 
+    T node_xl[2][2]; ///< [0][] for node, [1][] for target node, [][0] for old, [][1] for new 
+    T node_yl[2][2]; 
+    int node_id[2]; ///< [0] for node, [1] for target node 
+};
+
+/// @brief cells whose versions are checked before applying a candidate 
+struct SwapSnapshot
+{
+    int node_id[6]; ///< node, target node, left and right neighbors of node, left and right neighbors of target node, -1 if none 
+    unsigned int version[6]; ///< versions of the cells when the candidate is chosen 
+};
+
+/// @brief marker of a cell taken while applying a candidate 
+struct NodeLock
+{
+    int node_id; 
+    int exclusive; ///< 1 for cells to move, 0 for cells that must stay 
+};
+
+enum SwapApplyStatus 
+{
+    kSwapApplied, 
+    kSwapRejected, ///< no longer legal or better 
+    kSwapConflict ///< cells are taken by other candidates, retry later 
+};
+
+template <typename T>
+struct SwapState 
+{
+    std::vector<int> ordered_nodes; 
+    std::mt19937 rng; ///< random order of cells, kept per run so concurrent runs are deterministic 
+
+    RowOccupancy<T> row_occupancy; ///< cells in rows and locations of cells 
+    NetBoxCache<T> net_boxes; ///< extreme pins of nets for wirelength of swaps 
+
+    std::vector<std::vector<int> > bin2node_map; 
+    std::vector<BinMapIndex> node2bin_map; 
+
+    std::vector<int> search_bins; 
+    int search_bin_strategy; ///< how to compute search bins for eahc cell: 0 for cell bin, 1 for optimal region 
+
+    std::vector<std::vector<SwapCandidate<T> > > candidates; 
+
+    std::vector<T> net_hpwls; ///< HPWL for each net
+    std::vector<std::atomic<int> > node_markers; ///< markers for cells, see try_lock_node 
+    std::vector<unsigned int> node_versions; ///< number of moves of each cell 
+    std::vector<SwapSnapshot> snapshots; ///< snapshots of the best candidates in a batch 
+    std::vector<int> pending_candidates; ///< candidates to apply or retry 
+    std::vector<SwapApplyStatus> apply_status; ///< result of applying each candidate 
+    long num_retries; ///< number of candidates retried for conflicts 
+    bool deterministic; ///< apply candidates with one thread in the order of the batch 
+
+    int batch_size; 
+    int max_num_candidates;
+    int max_num_candidates_all; 
+    int num_threads; 
+};
+
+template <typename T>
+void compute_search_bins(const DetailedPlaceDB<T>& db, SwapState<T>& state, int begin, int end)
+{
+#pragma omp parallel for num_threads(state.num_threads) 
+    for (int node_id = begin; node_id < end; node_id += 1)
+    {
+        // compute optimal region 
+        Box<T> opt_box = (state.search_bin_strategy)? 
+            db.compute_optimal_region(node_id, state.net_boxes) 
+            : Box<T>(db.x[node_id], 
+                db.y[node_id], 
+                db.x[node_id]+db.node_size_x[node_id], 
+                db.y[node_id]+db.node_size_y[node_id]);
+        //Box<T> opt_box = Box<T>(db.x[node_id], 
+        //        db.y[node_id], 
+        //        db.x[node_id]+db.node_size_x[node_id], 
+        //        db.y[node_id]+db.node_size_y[node_id]);
+        int cx = db.pos2bin_x(opt_box.center_x()); 
+        int cy = db.pos2bin_y(opt_box.center_y()); 
+        state.search_bins[node_id] = cx*db.num_bins_y+cy; 
+    }
+}
+
+template <typename T>
+void reset_state(DetailedPlaceDB<T>& db, SwapState<T>& state)
+{
+    state.candidates.resize(state.batch_size);
+#pragma omp parallel for num_threads(state.num_threads) 
+    for (int i = 0; i < state.batch_size; ++i)
+    {
+        auto& candidates = state.candidates[i]; 
+        candidates.clear();
+        candidates.reserve(state.max_num_candidates);
+    }
+
+#ifdef DEBUG 
+    for (int i = 0; i < db.num_movable_nodes; ++i)
+    {
+        dreamplaceAssert(state.node_markers[0] == 0); 
+    }
+#endif
+}
+
+template <typename T>
+Space<T> get_space(const DetailedPlaceDB<T>& db, const SwapState<T>& state, int node_id)
+{
+    Space<T> space; 
+    state.row_occupancy.space(node_id, space.xl, space.xh); 
+    // align space to sites 
+    T space_xl = db.align2site(space.xl);
+    space.xl = (space_xl < space.xl)? space_xl+db.site_width : space.xl;
+    space.xh = db.align2site(space.xh);
+    return space; 
+}
+
+template <typename T>
+T compute_positions_hint(const DetailedPlaceDB<T>& db, const SwapState<T>& state, SwapCandidate<T>& cand, 
+        T node_xl, T node_yl, T node_width, const Space<T>& space)
+{
+    // case I: two cells are horizontally abutting 
+    cand.node_xl[0][0] = node_xl;
+    cand.node_yl[0][0] = node_yl;
+    cand.node_xl[1][0] = db.x[cand.node_id[1]];
+    cand.node_yl[1][0] = db.y[cand.node_id[1]];
+    T target_node_width = db.node_size_x[cand.node_id[1]]; 
+    auto target_space = get_space(db, state, cand.node_id[1]);
+    if (space.xh >= target_space.xl && target_space.xh >= space.xl && cand.node_yl[0][0] == cand.node_yl[1][0]) // case I: abutting, not exactly abutting, there might be space between two cells, this is a generalized case  
+    {
+        if (cand.node_xl[0][0] < cand.node_xl[1][0])
+        {
+            cand.node_xl[0][1] = cand.node_xl[1][0]+target_node_width-node_width;
+            cand.node_xl[1][1] = cand.node_xl[0][0]; 
+        }
+        else 
+        {
+            cand.node_xl[0][1] = cand.node_xl[1][0]; 
+            cand.node_xl[1][1] = cand.node_xl[0][0]+node_width-target_node_width;
+        }
+    }
+    else // case II: not abutting 
+    {
+        if (space.xh < target_node_width+space.xl || target_space.xh < node_width+target_space.xl)
+        {
+            // some large number 
+            return std::numeric_limits<T>::max(); 
+        }
+        cand.node_xl[0][1] = cand.node_xl[1][0]+(target_node_width-node_width)/2;
+        cand.node_xl[1][1] = cand.node_xl[0][0]+(node_width-target_node_width)/2;
+        cand.node_xl[0][1] = db.align2site(cand.node_xl[0][1]);
+        cand.node_xl[0][1] = std::max(cand.node_xl[0][1], target_space.xl);
+        cand.node_xl[0][1] = std::min(cand.node_xl[0][1], target_space.xh-node_width); 
+        cand.node_xl[1][1] = db.align2site(cand.node_xl[1][1]);
+        cand.node_xl[1][1] = std::max(cand.node_xl[1][1], space.xl); 
+        cand.node_xl[1][1] = std::min(cand.node_xl[1][1], space.xh-target_node_width); 
+    }
+    cand.node_yl[0][1] = cand.node_yl[1][0];
+    cand.node_yl[1][1] = cand.node_yl[0][0];
+
+    return 0; 
+}
+
+template <typename T>
+void collect_candidates(
+        const DetailedPlaceDB<T>& db, 
+        SwapState<T>& state, 
+        int idx_bgn, 
+        int idx_end
+        )
+{
+#pragma omp parallel for num_threads(state.num_threads) 
+    for (int i = idx_bgn; i < idx_end; ++i)
+    {
+        int node_id = state.ordered_nodes.at(i); 
+        T node_xl = db.x[node_id]; 
+        T node_yl = db.y[node_id]; 
+        T node_width = db.node_size_x[node_id];
+        auto space = get_space(db, state, node_id);
+        int seed_bin_id = state.search_bins[node_id]; 
+        int bx = seed_bin_id/db.num_bins_y; 
+        int by = seed_bin_id%db.num_bins_y; 
+        auto& candidates = state.candidates.at(i-idx_bgn); 
+
+        auto collect = [&](int ix, int iy){
+            int bin_id = ix*db.num_bins_y + iy; 
+            auto const& bin2nodes = state.bin2node_map.at(bin_id); 
+            int num_nodes_in_bin = state.bin2node_map.at(bin_id).size() * (db.node_size_y[node_id] == db.row_height); // only consider single-row height cell 
+            int iters = std::min(state.max_num_candidates/5, num_nodes_in_bin); 
+
+            for (int j = 0; j < iters; ++j)
+            {
+                SwapCandidate<T> cand; 
+                cand.node_id[0] = node_id; 
+                cand.node_id[1] = bin2nodes.at(j);
+                if (db.node_size_y[cand.node_id[1]] == db.row_height)
+                {
+                    cand.cost = compute_positions_hint(db, state, cand, 
+                            node_xl, node_yl, node_width, space);
+                    if (cand.cost == 0)
+                    {
+                        candidates.push_back(cand);
+                    }
+                }
+            }
+        };
+
+        // consider left, right, bottom, top bins 
+        collect(bx, by);
+        if (bx)
+        {
+            collect(bx-1, by); 
+        }
+        if (bx+1 < db.num_bins_x)
+        {
+            collect(bx+1, by); 
+        }
+        if (by)
+        {
+            collect(bx, by-1); 
+        }
+        if (by+1 < db.num_bins_y)
+        {
+            collect(bx, by+1); 
+        }
+    }
+}
+
+template <typename T>
+T compute_pair_hpwl_general (const DetailedPlaceDB<T>& db, const SwapState<T>& state, 
+        int node_id, T node_xl, T node_yl, 
+        int target_node_id, T target_node_xl, T target_node_yl, 
+        int skip_node_id) 
+{
+    T cost = 0; 
+    int node2pin_id = db.flat_node2pin_start_map[node_id];
+    const int node2pin_id_end = db.flat_node2pin_start_map[node_id+1];
+    for (; node2pin_id < node2pin_id_end; ++node2pin_id)
+    {
+        int node_pin_id = db.flat_node2pin_map[node2pin_id];
+        int net_id = db.pin2net_map[node_pin_id];
+        if (db.net_mask[net_id])
+        {
+            // other pins from the cache, then the pins of the two cells at the given locations 
+            Box<T> box = state.net_boxes.boxWithout(net_id, node_id, target_node_id); 
+            box.xl = std::min(box.xl, db.xh);
+            box.yl = std::min(box.yl, db.yh);
+            box.xh = std::max(box.xh, db.xl);
+            box.yh = std::max(box.yh, db.yl);
+            if (node_id != skip_node_id)
+            {
+                db.encompass_node_pins(box, node_id, node_xl, node_yl, net_id); 
+            }
+            if (target_node_id != skip_node_id)
+            {
+                db.encompass_node_pins(box, target_node_id, target_node_xl, target_node_yl, net_id); 
+            }
+            cost += (box.xh-box.xl + box.yh-box.yl); 
+        }
+    }
+    return cost; 
+}
+
+/// @brief wirelength change of a candidate with other cells at their current locations 
+template <typename T>
+T compute_swap_cost(const DetailedPlaceDB<T>& db, const SwapState<T>& state, const SwapCandidate<T>& cand)
+{
+    // consider FENCE region 
+    if (db.num_regions 
+            && (!db.inside_fence(cand.node_id[0], cand.node_xl[0][1], cand.node_yl[0][1])
+                || !db.inside_fence(cand.node_id[1], cand.node_xl[1][1], cand.node_yl[1][1])))
+    {
+        return std::numeric_limits<T>::max();
+    }
+    T cost = -compute_pair_hpwl_general(db, state, 
+            cand.node_id[0], cand.node_xl[0][0], cand.node_yl[0][0], 
+            cand.node_id[1], cand.node_xl[1][0], cand.node_yl[1][0], 
+            std::numeric_limits<int>::max());
+    cost -= compute_pair_hpwl_general(db, state, 
+            cand.node_id[1], cand.node_xl[1][0], cand.node_yl[1][0], 
+            cand.node_id[0], cand.node_xl[0][0], cand.node_yl[0][0], 
+            cand.node_id[0]);
+    cost += compute_pair_hpwl_general(db, state, 
+            cand.node_id[0], cand.node_xl[0][1], cand.node_yl[0][1], 
+            cand.node_id[1], cand.node_xl[1][1], cand.node_yl[1][1], 
+            std::numeric_limits<int>::max());
+    cost += compute_pair_hpwl_general(db, state, 
+            cand.node_id[1], cand.node_xl[1][1], cand.node_yl[1][1], 
+            cand.node_id[0], cand.node_xl[0][1], cand.node_yl[0][1], 
+            cand.node_id[0]);
+    return cost; 
+}
+
+template <typename T>
+void compute_candidate_cost(
+        const DetailedPlaceDB<T>& db, 
+        SwapState<T>& state
+        )
+{
+#pragma omp parallel for num_threads(state.num_threads) 
+    for (int i = 0; i < state.batch_size; i += 1)
+    {
+        auto& candidates = state.candidates.at(i);
+        for (unsigned int j = 0; j < candidates.size(); ++j)
+        {
+            auto& cand = candidates[j];
+            if (cand.node_id[0] < db.num_movable_nodes && cand.node_id[1] < db.num_movable_nodes)
+            {
+                cand.cost = compute_swap_cost(db, state, cand); 
+            }
+        }
+    }
+}
+
+template <typename T>
+void reduce_min_2d(const SwapState<T>& state, std::vector<std::vector<SwapCandidate<T> > >& candidates, int batch_size)
+{
+#pragma omp parallel for num_threads(state.num_threads) 
+    for (int i = 0; i < batch_size; ++i)
+    {
+        auto& row_candidates = candidates.at(i);
+        for (unsigned int j = 1; j < row_candidates.size(); ++j)
+        {
+            if (row_candidates[j].cost < row_candidates[0].cost)
+            {
+                row_candidates[0] = row_candidates[j];
+            }
+        }
+        //if (!row_candidates.empty())
+        //{
+        //    dreamplacePrint(kDEBUG, "best candidate cost %g\n", (float)row_candidates.at(0).cost);
+        //}
+    }
+}
+
+/// @brief try to take the marker of a cell without waiting. 
+/// A marker is 0 for a free cell, the number of holders for a cell that must stay, 
+/// and -1 for a cell that is being moved. 
+inline bool try_lock_node(std::atomic<int>& marker, int exclusive)
+{
+    int value = marker.load(std::memory_order_relaxed); 
+    if (exclusive)
+    {
+        return value == 0 && marker.compare_exchange_strong(value, -1, std::memory_order_acquire); 
+    }
+    while (value >= 0)
+    {
+        if (marker.compare_exchange_weak(value, value+1, std::memory_order_acquire))
+        {
+            return true; 
+        }
+    }
+    return false; 
+}
+
+/// @brief release the marker of a cell 
+inline void unlock_node(std::atomic<int>& marker, int exclusive)
+{
+    if (exclusive)
+    {
+        marker.store(0, std::memory_order_release); 
+    }
+    else 
+    {
+        marker.fetch_sub(1, std::memory_order_release); 
+    }
+}
+
+/// @brief record the row neighbors of the best candidates and the versions of all these cells, 
+/// so that applying a candidate can tell whether any of them has moved since its cost was computed 
+template <typename T>
+void snapshot_candidates(
+        const DetailedPlaceDB<T>& db, 
+        SwapState<T>& state, 
+        int num_candidates
+        )
+{
+#pragma omp parallel for num_threads(state.num_threads) 
+    for (int i = 0; i < num_candidates; ++i)
+    {
+        auto const& row_candidates = state.candidates.at(i);
+        if (row_candidates.empty() || row_candidates[0].cost >= 0)
+        {
+            continue; 
+        }
+        auto const& best_cand = row_candidates[0];
+        auto& snapshot = state.snapshots.at(i); 
+        for (int k = 0; k < 2; ++k)
+        {
+            int node_id = best_cand.node_id[k]; 
+            snapshot.node_id[k] = node_id; 
+            snapshot.node_id[2+2*k] = state.row_occupancy.prev(node_id); 
+            snapshot.node_id[3+2*k] = state.row_occupancy.next(node_id); 
+        }
+        for (int k = 0; k < 6; ++k)
+        {
+            int node_id = snapshot.node_id[k]; 
+            snapshot.version[k] = (node_id >= 0)? state.node_versions[node_id] : 0; 
+        }
+    }
+}
+
+/// @brief apply one candidate optimistically. 
+/// The two cells are locked for moving, their row neighbors and cells sharing nets with them are locked to stay. 
+/// Locks are only tried, so a conflict releases everything and leaves the candidate for a retry. 
+/// With the locks held, the candidate is validated against the versions, spaces and wirelength of the current placement. 
+template <typename T>
+SwapApplyStatus try_apply_candidate(
+        DetailedPlaceDB<T>& db, 
+        SwapState<T>& state, 
+        int i, 
+        std::vector<NodeLock>& locks
+        )
+{
+    auto const& best_cand = state.candidates[i][0];
+    auto const& snapshot = state.snapshots[i]; 
+
+    locks.clear(); 
+    for (int k = 0; k < 6; ++k)
+    {
+        int node_id = snapshot.node_id[k]; 
+        // fixed cells never move 
+        if (node_id >= 0 && node_id < db.num_movable_nodes)
+        {
+            locks.push_back(NodeLock{node_id, k < 2}); 
+        }
+    }
+    for (int k = 0; k < 2; ++k)
+    {
+        int node_id = best_cand.node_id[k]; 
+        for (int node2pin_id = db.flat_node2pin_start_map[node_id]; node2pin_id < db.flat_node2pin_start_map[node_id+1]; ++node2pin_id)
+        {
+            int net_id = db.pin2net_map[db.flat_node2pin_map[node2pin_id]];
+            if (db.net_mask[net_id])
+            {
+                for (int net2pin_id = db.flat_net2pin_start_map[net_id]; net2pin_id < db.flat_net2pin_start_map[net_id+1]; ++net2pin_id)
+                {
+                    int other_node_id = db.pin2node_map[db.flat_net2pin_map[net2pin_id]];
+                    if (other_node_id < db.num_movable_nodes)
+                    {
+                        locks.push_back(NodeLock{other_node_id, 0}); 
+                    }
+                }
+            }
+        }
+    }
+    // one lock per cell, the exclusive one first 
+    std::sort(locks.begin(), locks.end(), 
+            [](const NodeLock& l1, const NodeLock& l2) {
+            return l1.node_id < l2.node_id || (l1.node_id == l2.node_id && l1.exclusive > l2.exclusive); 
+            });
+    locks.erase(std::unique(locks.begin(), locks.end(), 
+                [](const NodeLock& l1, const NodeLock& l2) {
+                return l1.node_id == l2.node_id; 
+                }), locks.end()); 
+
+    for (unsigned int j = 0; j < locks.size(); ++j)
+    {
+        if (!try_lock_node(state.node_markers[locks[j].node_id], locks[j].exclusive))
+        {
+            for (unsigned int k = 0; k < j; ++k)
+            {
+                unlock_node(state.node_markers[locks[k].node_id], locks[k].exclusive); 
+            }
+            return kSwapConflict; 
+        }
+    }
+
+    SwapApplyStatus status = kSwapRejected; 
+    bool valid = true; 
+    for (int k = 0; k < 6; ++k)
+    {
+        int node_id = snapshot.node_id[k]; 
+        valid &= (node_id < 0 || state.node_versions[node_id] == snapshot.version[k]); 
+    }
+    // unchanged cells and neighbors keep the slots of the rows, so the spaces are safe to read 
+    if (valid)
+    {
+        T node_width = db.node_size_x[best_cand.node_id[0]]; 
+        T target_node_width = db.node_size_x[best_cand.node_id[1]]; 
+        Space<T> space = get_space(db, state, best_cand.node_id[0]); 
+        Space<T> target_space = get_space(db, state, best_cand.node_id[1]); 
+
+        // the cost may be different as cells sharing nets may have moved 
+        if (best_cand.node_xl[0][1] >= target_space.xl && best_cand.node_xl[0][1]+node_width <= target_space.xh 
+                && best_cand.node_xl[1][1] >= space.xl && best_cand.node_xl[1][1]+target_node_width <= space.xh
+                && compute_swap_cost(db, state, best_cand) < 0)
+        {
+#ifdef DEBUG
+            dreamplaceAssert(best_cand.node_id[0] < db.num_movable_nodes && best_cand.node_id[1] < db.num_movable_nodes);
+#endif
+
+            BinMapIndex& bin_id = state.node2bin_map.at(best_cand.node_id[0]); 
+            BinMapIndex& target_bin_id = state.node2bin_map.at(best_cand.node_id[1]); 
+#ifdef DEBUG
+            assert(state.bin2node_map(bin_id.bin_id, bin_id.sub_id) == best_cand.node_id[0]); 
+            assert(state.bin2node_map(target_bin_id.bin_id, target_bin_id.sub_id) == best_cand.node_id[1]); 
+            assert(db.x[best_cand.node_id[0]] == best_cand.node_xl[0][0]);
+            assert(db.y[best_cand.node_id[0]] == best_cand.node_yl[0][0]);
+            assert(db.x[best_cand.node_id[1]] == best_cand.node_xl[1][0]);
+            assert(db.y[best_cand.node_id[1]] == best_cand.node_yl[1][0]);
+#endif
+            db.x[best_cand.node_id[0]] = best_cand.node_xl[0][1]; 
+            db.y[best_cand.node_id[0]] = best_cand.node_yl[0][1]; 
+            db.x[best_cand.node_id[1]] = best_cand.node_xl[1][1]; 
+            db.y[best_cand.node_id[1]] = best_cand.node_yl[1][1]; 
+            int& bin2node_map_node_id = state.bin2node_map.at(bin_id.bin_id).at(bin_id.sub_id);
+            int& bin2node_map_target_node_id = state.bin2node_map.at(target_bin_id.bin_id).at(target_bin_id.sub_id);
+            std::swap(bin2node_map_node_id, bin2node_map_target_node_id);
+            std::swap(bin_id, target_bin_id);
+
+            // update row occupancy 
+            state.row_occupancy.swap(best_cand.node_id[0], best_cand.node_id[1]);
+
+            // nets of the two cells are only shared with cells locked by this candidate, 
+            // except for nets out of the mask, which the cache does not track 
+            state.net_boxes.update(best_cand.node_id[0]); 
+            state.net_boxes.update(best_cand.node_id[1]); 
+
+            state.node_versions[best_cand.node_id[0]] += 1; 
+            state.node_versions[best_cand.node_id[1]] += 1; 
+            status = kSwapApplied; 
+        }
+    }
+
+    for (auto const& lock : locks)
+    {
+        unlock_node(state.node_markers[lock.node_id], lock.exclusive); 
+    }
+    return status; 
+}
+
+/// @brief apply the best candidates of a batch in parallel. 
+/// Candidates failing to take their locks are retried in the next pass, 
+/// and a pass without any progress leaves the rest to a single thread. 
+/// Threads commit in whatever order they win the locks, so results may differ between runs, 
+/// unless state.deterministic applies all candidates with a single thread in the order of the batch. 
+template <typename T>
+void apply_candidates(
+        DetailedPlaceDB<T>& db, 
+        SwapState<T>& state, 
+        int num_candidates
+        )
+{
+    snapshot_candidates(db, state, num_candidates); 
+
+    auto& pending = state.pending_candidates; 
+    pending.clear(); 
+    for (int i = 0; i < num_candidates; ++i)
+    {
+        auto const& row_candidates = state.candidates.at(i);
+        if (!row_candidates.empty() && row_candidates[0].cost < 0)
+        {
+            pending.push_back(i); 
+        }
+    }
+
+    state.apply_status.resize(num_candidates); 
+    bool sequential = state.deterministic; 
+    while (!pending.empty())
+    {
+        int num_pending = pending.size(); 
+#pragma omp parallel num_threads(sequential? 1 : state.num_threads) 
+        {
+            std::vector<NodeLock> locks; 
+#pragma omp for schedule(dynamic, 1) 
+            for (int j = 0; j < num_pending; ++j)
+            {
+                state.apply_status[pending[j]] = try_apply_candidate(db, state, pending[j], locks); 
+            }
+        }
+
+        // keep the order of the batch for retries 
+        int num_conflicts = 0; 
+        for (int j = 0; j < num_pending; ++j)
+        {
+            if (state.apply_status[pending[j]] == kSwapConflict)
+            {
+                pending[num_conflicts++] = pending[j]; 
+            }
+        }
+        pending.resize(num_conflicts); 
+        sequential = state.deterministic || (num_conflicts == num_pending); 
+        state.num_retries += num_conflicts; 
+    }
+
+#ifdef DEBUG
+    for (int i = 0; i < db.num_nodes; ++i)
+    {
+        dreamplaceAssert(state.node_markers[i] == 0); 
+    }
+#endif
+}
+
+template <typename T>
+void check_candidate_costs(
+        const DetailedPlaceDB<T>& db, 
+        const SwapState<T>& state
+        )
+{
+    for (int i = 0; i < state.batch_size; ++i)
+    {
+        for (auto const& cand : state.candidates.at(i))
+        {
+            if (cand.cost < 0)
+            {
+                dreamplaceAssert(cand.node_id[0] < db.num_movable_nodes && cand.node_id[1] < db.num_movable_nodes); 
+            }
+        }
+    }
+}
+template <typename T>
+void global_swap(DetailedPlaceDB<T>& db, SwapState<T>& state)
+{
+	hr_clock_rep timer_start, timer_stop;
+    hr_clock_rep collect_candidates_time = 0, compute_candidate_cost_time = 0, reduce_min_2d_time = 0, apply_candidates_time = 0; 
+    int collect_candidates_runs = 0, compute_candidate_cost_runs = 0, reduce_min_2d_runs = 0, apply_candidates_runs = 0; 
+
+	timer_start = get_globaltime();
+    compute_search_bins(db, state, 0, db.num_movable_nodes);
+	timer_stop = get_globaltime();
+    dreamplacePrint(kDEBUG, "compute_search_bins takes %g ms\n", (timer_stop-timer_start)*get_timer_period()); 
+
+    for (int i = 0; i < db.num_movable_nodes; i += state.batch_size)
+    {
+        // all results are stored in state.candidates 
+        int idx_bgn = i; 
+        int idx_end = std::min(i+state.batch_size, db.num_movable_nodes);
+        //dreamplacePrint(kDEBUG, "batch %d - %d\n", idx_bgn, idx_end);
+
+        timer_start = get_globaltime();
+        reset_state(db, state);
+
+        collect_candidates(db, state, idx_bgn, idx_end); 
+        timer_stop = get_globaltime(); 
+        collect_candidates_time += timer_stop-timer_start; 
+        collect_candidates_runs += 1; 
+
+        timer_start = get_globaltime(); 
+        compute_candidate_cost(db, state); 
+        timer_stop = get_globaltime(); 
+        compute_candidate_cost_time += timer_stop-timer_start; 
+        compute_candidate_cost_runs += 1; 
+
+        //check_candidate_costs(db, state);
+        timer_start = get_globaltime(); 
+        // reduce min and apply 
+        reduce_min_2d(state, state.candidates, state.batch_size); 
+        timer_stop = get_globaltime(); 
+        reduce_min_2d_time += timer_stop-timer_start; 
+        reduce_min_2d_runs += 1; 
+
+        //check_candidate_costs(db, state);
+        timer_start = get_globaltime(); 
+        apply_candidates(db, state, idx_end-idx_bgn); 
+        timer_stop = get_globaltime(); 
+        apply_candidates_time += timer_stop-timer_start; 
+        apply_candidates_runs += 1; 
+    }
+
+    dreamplacePrint(kDEBUG, "collect_candidates takes %g ms for %d runs, average %g ms\n", collect_candidates_time*get_timer_period(), collect_candidates_runs, collect_candidates_time*get_timer_period()/collect_candidates_runs);
+    dreamplacePrint(kDEBUG, "compute_candidate_cost takes %g ms for %d runs, average %g ms\n", compute_candidate_cost_time*get_timer_period(), compute_candidate_cost_runs, compute_candidate_cost_time*get_timer_period()/compute_candidate_cost_runs);
+    dreamplacePrint(kDEBUG, "reduce_min_2d takes %g ms for %d runs, average %g ms\n", reduce_min_2d_time*get_timer_period(), reduce_min_2d_runs, reduce_min_2d_time*get_timer_period()/reduce_min_2d_runs);
+    dreamplacePrint(kDEBUG, "apply_candidates takes %g ms for %d runs, average %g ms, %ld retries for conflicts\n", apply_candidates_time*get_timer_period(), apply_candidates_runs, apply_candidates_time*get_timer_period()/apply_candidates_runs, state.num_retries);
+}
+
+template <typename T>
+T compute_total_hpwl(const DetailedPlaceDB<T>& db, const SwapState<T>& state, const T* x, const T* y, T* net_hpwls)
+{
+#pragma omp parallel for num_threads(state.num_threads) 
+    for (int i = 0; i < db.num_nets; ++i)
+    {
+        net_hpwls[i] = db.compute_net_hpwl(i);
+    }
+    T hpwl = 0; 
+    // I found OpenMP reduction cannot guarantee run-to-run determinism
+//#pragma omp parallel for num_threads(state.num_threads) default(shared) reduction(+:hpwl)
+    for (int i = 0; i < db.num_nets; ++i)
+    {
+        hpwl += net_hpwls[i];
+    }
+
+    return hpwl; 
+}
+
+/// @brief global swap algorithm for detailed placement 
+/// @param deterministic apply candidates in the order of the batch for reproducible results with multiple threads; 
+/// candidates are still searched and evaluated in parallel 
+/// @param context indices shared with other passes, taken over instead of built if not NULL; 
+/// bins are not shared, as passes may use different bin sizes 
+template <typename T>
+int globalSwapCPULauncher(DetailedPlaceDB<T> db, int batch_size, int max_iters, bool deterministic,
+                          int num_threads, DetailedPlaceContext<T>* context = NULL)
+{
+    dreamplacePrint(kDEBUG, "%dx%d bins, bin size %g x %g\n", db.num_bins_x, db.num_bins_y, db.bin_size_x, db.bin_size_y);
+
+    SwapState<T> state; 
+    state.num_threads = std::max(num_threads, 1);
+    state.deterministic = deterministic; 
+
+    const float stop_threshold = 0.1/100; 
+    state.batch_size = batch_size; 
+    int max_num_candidates_per_row = (2<<(int)log2(ceil(sqrt(std::max(db.num_nodes/(db.num_bins_x*db.num_bins_y), 1))))); 
+    state.max_num_candidates = (1<<(int)ceil(log2(ceil(db.bin_size_y/db.row_height))))*max_num_candidates_per_row*5; 
+    state.max_num_candidates_all = state.batch_size*state.max_num_candidates; 
+    dreamplacePrint(kDEBUG, "batch_size = %d, max_num_candidates = %d, max_num_candidates_all = %d\n", 
+            state.batch_size, state.max_num_candidates, state.max_num_candidates_all); 
+    state.search_bin_strategy = 1; 
+
+    // distribute cells to rows 
+    if (context)
+    {
+        std::swap(state.row_occupancy, context->row_occupancy); 
+        std::swap(state.net_boxes, context->net_boxes); 
+    }
+    else 
+    {
+        db.make_row_occupancy(db.x, db.y, state.row_occupancy, num_threads); 
+        db.make_net_box_cache(state.net_boxes, num_threads); 
+    }
+    // distribute cells to bin  
+    state.bin2node_map.resize(db.num_bins_x*db.num_bins_y);
+    state.node2bin_map.resize(db.num_movable_nodes);
+    db.make_bin2node_map(db.x, db.y, db.node_size_x, db.node_size_y, state.bin2node_map, state.node2bin_map); 
+
+    // fix random seed 
+    state.rng.seed(1000);
+
+    state.ordered_nodes.resize(db.num_movable_nodes);
+    std::iota(state.ordered_nodes.begin(), state.ordered_nodes.end(), 0);
+
+    state.candidates.resize(state.batch_size);
+    state.search_bins.resize(db.num_movable_nodes);
+    state.net_hpwls.resize(db.num_nets);
+    state.node_markers = std::vector<std::atomic<int> >(db.num_nodes); 
+    for (auto& marker : state.node_markers)
+    {
+        marker.store(0); 
+    }
+    state.node_versions.assign(db.num_nodes, 0); 
+    state.snapshots.resize(state.batch_size); 
+    state.num_retries = 0; 
+
+    hr_clock_rep kernel_time_start, kernel_time_stop; 
+	hr_clock_rep iter_time_start, iter_time_stop;
+
+    kernel_time_start = get_globaltime(); 
+    std::vector<T> hpwls (max_iters+1); 
+    hpwls[0] = (context)? context->hpwl : compute_total_hpwl(db, state, db.x, db.y, state.net_hpwls.data());
+    T hpwl = hpwls[0]; 
+    dreamplacePrint(kINFO, "initial hpwl = %.3f\n", hpwls[0]);
+    for (int iter = 0; iter < max_iters; ++iter)
+    {
+        iter_time_start = get_globaltime();
+        std::shuffle(state.ordered_nodes.begin(), state.ordered_nodes.end(), state.rng);
+        global_swap(db, state);
+        iter_time_stop = get_globaltime();
+        dreamplacePrint(kINFO, " Iteration time(ms) \t %g\n", get_timer_period() * (iter_time_stop - iter_time_start));
+
+        hpwls[iter+1] = compute_total_hpwl(db, state, db.x, db.y, state.net_hpwls.data());
+        hpwl = hpwls[iter+1]; 
+        dreamplacePrint(kINFO, "iteration %d: hpwl %.3f => %.3f (imp. %g%%)\n", iter, hpwls[0], hpwls[iter+1], (1.0-hpwls[iter+1]/(double)hpwls[0])*100);
+        state.search_bin_strategy = !state.search_bin_strategy;
+
+        if ((iter&1) && hpwls[iter]-hpwls[iter-1] > -stop_threshold*hpwls[0])
+        {
+            break; 
+        }
+    }
+    kernel_time_stop = get_globaltime(); 
+    dreamplacePrint(kINFO, " Global swap time: %g ms\n", get_timer_period()*(kernel_time_stop-kernel_time_start));
+
+    if (context)
+    {
+        std::swap(state.row_occupancy, context->row_occupancy); 
+        std::swap(state.net_boxes, context->net_boxes); 
+        context->hpwl = hpwl; 
+        context->moved_nodes.clear(); 
+        for (int i = 0; i < db.num_movable_nodes; ++i)
+        {
+            if (state.node_versions[i])
+            {
+                context->moved_nodes.push_back(i); 
+            }
+        }
+    }
+
+    return 0; 
+}
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
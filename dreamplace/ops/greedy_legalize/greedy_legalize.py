@@ -33,7 +33,8 @@ class GreedyLegalizeFunction(Function):
           num_bins_y, 
           num_movable_nodes, 
           num_terminal_NIs, 
-          num_filler_nodes
+          num_filler_nodes, 
+          num_threads
           ):
         if pos.is_cuda:
             output = greedy_legalize_cpp.forward(
@@ -54,7 +55,8 @@ class GreedyLegalizeFunction(Function):
                     num_bins_y, 
                     num_movable_nodes, 
                     num_terminal_NIs, 
-                    num_filler_nodes
+                    num_filler_nodes, 
+                    num_threads
                     ).cuda()
         else:
             output = greedy_legalize_cpp.forward(
@@ -75,7 +77,8 @@ class GreedyLegalizeFunction(Function):
                     num_bins_y, 
                     num_movable_nodes, 
                     num_terminal_NIs, 
-                    num_filler_nodes
+                    num_filler_nodes, 
+                    num_threads
                     )
         return output
 
@@ -84,7 +87,7 @@ class GreedyLegalize(object):
     """
     def __init__(self, node_size_x, node_size_y, 
             flat_region_boxes, flat_region_boxes_start, node2fence_region_map, 
-            xl, yl, xh, yh, site_width, row_height, num_bins_x, num_bins_y, num_movable_nodes, num_terminal_NIs, num_filler_nodes):
+            xl, yl, xh, yh, site_width, row_height, num_bins_x, num_bins_y, num_movable_nodes, num_terminal_NIs, num_filler_nodes, num_threads=8):
         super(GreedyLegalize, self).__init__()
         self.node_size_x = node_size_x
         self.node_size_y = node_size_y
@@ -102,6 +105,7 @@ class GreedyLegalize(object):
         self.num_movable_nodes = num_movable_nodes
         self.num_terminal_NIs = num_terminal_NIs
         self.num_filler_nodes = num_filler_nodes
+        self.num_threads = num_threads
     def __call__(self, init_pos, pos): 
         """ 
         @param init_pos the reference position for displacement minization
@@ -125,5 +129,6 @@ class GreedyLegalize(object):
                 num_bins_y=self.num_bins_y,
                 num_movable_nodes=self.num_movable_nodes, 
                 num_terminal_NIs=self.num_terminal_NIs, 
-                num_filler_nodes=self.num_filler_nodes
+                num_filler_nodes=self.num_filler_nodes, 
+                num_threads=self.num_threads
                 )
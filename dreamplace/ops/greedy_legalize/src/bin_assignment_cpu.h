@@ -90,9 +90,12 @@ void distributeBlanks2BinsCPU(
         T xl, T yl, T xh, T yh, 
         T site_width, T row_height, 
         int num_bins_x, int num_bins_y, int blank_num_bins_y, 
-        std::vector<std::vector<Blank<T> > >& bin_blanks
+        std::vector<std::vector<Blank<T> > >& bin_blanks, 
+        int num_threads
         )
 {
+    // each bin only writes its own blank rows 
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 1)
     for (int i = 0; i < num_bins_x*num_bins_y; i += 1) 
     {
         int bin_id_x = i/num_bins_y; 
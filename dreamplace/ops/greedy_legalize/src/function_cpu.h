@@ -29,7 +29,8 @@ void legalizeBinCPU(
         T alpha, // a parameter to tune anchor initial locations and current locations 
         T beta, // a parameter to tune space reserving 
         bool lr_flag, // from left to right 
-        int* num_unplaced_cells 
+        int* num_unplaced_cells, 
+        int num_threads 
         );
 
 template <typename T>
@@ -42,7 +43,8 @@ int greedyLegalizationCPU(
         const T site_width, const T row_height, 
         int num_bins_x, int num_bins_y, 
         const int num_nodes, 
-        const int num_movable_nodes
+        const int num_movable_nodes, 
+        const int num_threads
         );
 
 DREAMPLACE_END_NAMESPACE
@@ -6,6 +6,7 @@
 #include "utility/src/torch.h"
 #include "utility/src/LegalizationDB.h"
 #include "utility/src/LegalizationDBUtils.h"
+#include "utility/src/LegalizationRegions.h"
 #include "greedy_legalize/src/function_cpu.h"
 
 DREAMPLACE_BEGIN_NAMESPACE
@@ -28,20 +29,24 @@ DREAMPLACE_BEGIN_NAMESPACE
 /// @param num_nodes total number of nodes, including movable nodes, fixed nodes, and filler nodes; fixed nodes are in the range of [num_movable_nodes, num_nodes-num_filler_nodes)
 /// @param num_movable_nodes number of movable nodes, movable nodes are in the range of [0, num_movable_nodes)
 /// @param number of filler nodes, filler nodes are in the range of [num_nodes-num_filler_nodes, num_nodes)
+/// @param num_threads number of threads, fence regions and bins are legalized in parallel 
 template <typename T>
-int greedyLegalizationLauncher(LegalizationDB<T> db)
+int greedyLegalizationLauncher(LegalizationDB<T> db, int num_threads)
 {
-    greedyLegalizationCPU(
-            db, 
-            db.init_x, db.init_y, 
-            db.node_size_x, db.node_size_y, 
-            db.x, db.y, 
-            db.xl, db.yl, db.xh, db.yh, 
-            db.site_width, db.row_height, 
-            db.num_bins_x, db.num_bins_y, 
-            db.num_nodes, 
-            db.num_movable_nodes
-            );
+    legalizeFenceRegions(db, std::max(num_threads, 1), [](const LegalizationDB<T>& rdb, int rnum_threads){
+            greedyLegalizationCPU(
+                rdb, 
+                rdb.init_x, rdb.init_y, 
+                rdb.node_size_x, rdb.node_size_y, 
+                rdb.x, rdb.y, 
+                rdb.xl, rdb.yl, rdb.xh, rdb.yh, 
+                rdb.site_width, rdb.row_height, 
+                rdb.num_bins_x, rdb.num_bins_y, 
+                rdb.num_nodes, 
+                rdb.num_movable_nodes, 
+                rnum_threads
+                );
+            });
 
     return 0; 
 }
@@ -67,6 +72,7 @@ int greedyLegalizationLauncher(LegalizationDB<T> db)
 /// @param num_nodes total number of nodes, including movable nodes, fixed nodes, and filler nodes; fixed nodes are in the range of [num_movable_nodes, num_nodes-num_filler_nodes)
 /// @param num_movable_nodes number of movable nodes, movable nodes are in the range of [0, num_movable_nodes)
 /// @param number of filler nodes, filler nodes are in the range of [num_nodes-num_filler_nodes, num_nodes)
+/// @param num_threads number of threads, bins are legalized in parallel 
 at::Tensor greedy_legalization_forward(
         at::Tensor init_pos,
         at::Tensor pos, 
@@ -84,7 +90,8 @@ at::Tensor greedy_legalization_forward(
         int num_bins_y,
         int num_movable_nodes, 
         int num_terminal_NIs, 
-        int num_filler_nodes
+        int num_filler_nodes, 
+        int num_threads
         )
 {
     CHECK_FLAT(init_pos); 
@@ -111,7 +118,7 @@ at::Tensor greedy_legalization_forward(
                     num_terminal_NIs, 
                     num_filler_nodes
                     );
-            greedyLegalizationLauncher<scalar_t>(db);
+            greedyLegalizationLauncher<scalar_t>(db, num_threads);
             //db.check_legality();
             });
     timer_stop = get_globaltime(); 
@@ -25,22 +25,36 @@ int greedyLegalizationCPU(
         const T site_width, const T row_height, 
         int num_bins_x, int num_bins_y, 
         const int num_nodes, 
-        const int num_movable_nodes
+        const int num_movable_nodes, 
+        const int num_threads
         )
 {
     float milliseconds = 0; 
+    hr_clock_rep timer_start; 
+    // bins are legalized in parallel, and then merged pairwise in each iteration 
+    const int init_num_bins_x = std::max(num_bins_x, 1); 
+    const int init_num_bins_y = std::max(num_bins_y, 1); 
+    // bins must be tall enough for multi-row cells 
+    int max_num_node_rows = 1; 
+    for (int i = 0; i < num_movable_nodes; ++i)
+    {
+        if (!db.is_dummy_fixed(i))
+        {
+            max_num_node_rows = std::max(max_num_node_rows, db.num_node_rows(i)); 
+        }
+    }
 
     // first from right to left 
     // then from left to right 
     for (int i = 0; i < 2; ++i)
     {
-        num_bins_x = 1; 
-        num_bins_y = 1;
+        num_bins_x = init_num_bins_x; 
+        num_bins_y = init_num_bins_y;
         // adjust bin sizes 
         T bin_size_x = (xh-xl)/num_bins_x; 
         //bin_size_x = std::max(floor(bin_size_x/site_width)*site_width, site_width); 
         T bin_size_y = (yh-yl)/num_bins_y; 
-        bin_size_y = std::max((T)(ceil(bin_size_y/row_height)*row_height), (T)row_height);
+        bin_size_y = std::max((T)(ceil(bin_size_y/row_height)*row_height), (T)(row_height*max_num_node_rows));
 
         //num_bins_x = ceil((xh-xl)/bin_size_x);
         num_bins_y = ceil((yh-yl)/bin_size_y);
@@ -95,13 +109,19 @@ int greedyLegalizationCPU(
                 xl, yl, xh, yh, 
                 site_width, row_height, 
                 num_bins_x, num_bins_y, blank_num_bins_y, 
-                bin_blanks
+                bin_blanks, 
+                num_threads
                 ); 
 
         int num_unplaced_cells_host;
         // minimum width in sites 
         int min_unplaced_node_size_x_host;
-        int num_iters = floor(log((T)std::min(num_bins_x, num_bins_y))/log(2.0))+1;
+        // merge until a single bin is left, so the last iteration is the same as legalization with 1x1 bin 
+        int num_iters = 1; 
+        for (int nx = num_bins_x, ny = num_bins_y; nx > 1 || ny > 1; nx = (nx>>1)+(nx&1), ny = (ny>>1)+(ny&1))
+        {
+            ++num_iters; 
+        }
         for (int iter = 0; iter < num_iters; ++iter)
         {
             dreamplacePrint(kDEBUG, "%s iteration %d with %dx%d bins\n", "Standard cell legalization", iter, num_bins_x, num_bins_y);
@@ -110,7 +130,7 @@ int greedyLegalizationCPU(
             dreamplacePrint(kDEBUG, "%s #bin_blanks\n", "Standard cell legalization");
             countBinObjects(bin_blanks);
 
-            milliseconds = clock(); 
+            timer_start = get_globaltime(); 
             legalizeBinCPU<T>(
                     init_x, init_y, 
                     node_size_x, node_size_y, 
@@ -124,9 +144,10 @@ int greedyLegalizationCPU(
                     0.5, 
                     4.0, 
                     i%2,  
-                    &num_unplaced_cells_host
+                    &num_unplaced_cells_host, 
+                    num_threads
                     );
-            milliseconds = (clock()-milliseconds)/CLOCKS_PER_SEC*1000; 
+            milliseconds = (get_globaltime()-timer_start)*get_timer_period(); 
             dreamplacePrint(kINFO, "%s legalizeBin takes %.3f ms\n", "Standard cell legalization", milliseconds);
 
             dreamplacePrint(kDEBUG, "%s num_unplaced_cells = %d\n", "Standard cell legalization", num_unplaced_cells_host); 
@@ -139,7 +160,7 @@ int greedyLegalizationCPU(
             }
 
             // compute minimum size of unplaced cells 
-            milliseconds = clock(); 
+            timer_start = get_globaltime(); 
             min_unplaced_node_size_x_host = int((xh-xl)/site_width);
             minNodeSizeCPU(
                     bin_cells, 
@@ -148,17 +169,18 @@ int greedyLegalizationCPU(
                     num_bins_x, num_bins_y, 
                     &min_unplaced_node_size_x_host
                     );
-            milliseconds = (clock()-milliseconds)/CLOCKS_PER_SEC*1000; 
+            milliseconds = (get_globaltime()-timer_start)*get_timer_period(); 
             dreamplacePrint(kINFO, "%s minNodeSize takes %.3f ms\n", "Standard cell legalization", milliseconds);
             dreamplacePrint(kDEBUG, "%s minimum unplaced node_size_x %d sites\n", "Standard cell legalization", min_unplaced_node_size_x_host);
 
             // ceil(num_bins_x/2), ceil(num_bins_y/2)
             int dst_num_bins_x = (num_bins_x>>1)+(num_bins_x&1); 
             int dst_num_bins_y = (num_bins_y>>1)+(num_bins_y&1); 
-            int scale_ratio_x = (num_bins_x == dst_num_bins_x)? 1 : num_bins_x/dst_num_bins_x; 
-            int scale_ratio_y = (num_bins_y == dst_num_bins_y)? 1 : num_bins_y/dst_num_bins_y; 
+            // always merge pairs; for odd numbers of bins, the last dst bin takes only one src bin 
+            int scale_ratio_x = (num_bins_x == dst_num_bins_x)? 1 : 2; 
+            int scale_ratio_y = (num_bins_y == dst_num_bins_y)? 1 : 2; 
 
-            milliseconds = clock(); 
+            timer_start = get_globaltime(); 
             resizeBinObjectsCPU(
                     bin_cells_copy, 
                     dst_num_bins_x, dst_num_bins_y
@@ -168,11 +190,12 @@ int greedyLegalizationCPU(
                     num_bins_x, num_bins_y, // dimensions for the src
                     bin_cells_copy, // ceil(src_num_bins_x/2) * ceil(src_num_bins_y/2)
                     dst_num_bins_x, dst_num_bins_y, 
-                    scale_ratio_x, scale_ratio_y
+                    scale_ratio_x, scale_ratio_y, 
+                    num_threads
                     );
-            milliseconds = (clock()-milliseconds)/CLOCKS_PER_SEC*1000; 
+            milliseconds = (get_globaltime()-timer_start)*get_timer_period(); 
             dreamplacePrint(kDEBUG, "%s mergeBinCells takes %.3f ms\n", "Standard cell legalization", milliseconds);
-            milliseconds = clock(); 
+            timer_start = get_globaltime(); 
             resizeBinObjectsCPU(
                     bin_blanks_copy, 
                     dst_num_bins_x, blank_num_bins_y
@@ -183,9 +206,10 @@ int greedyLegalizationCPU(
                     bin_blanks_copy, // ceil(src_num_bins_x/2) * ceil(src_num_bins_y/2)
                     dst_num_bins_x, blank_num_bins_y, 
                     scale_ratio_x, 
-                    min_unplaced_node_size_x_host*site_width
+                    min_unplaced_node_size_x_host*site_width, 
+                    num_threads
                     );
-            milliseconds = (clock()-milliseconds)/CLOCKS_PER_SEC*1000; 
+            milliseconds = (get_globaltime()-timer_start)*get_timer_period(); 
             dreamplacePrint(kDEBUG, "%s mergeBinBlanks takes %.3f ms\n", "Standard cell legalization", milliseconds);
 
             // update bin dimensions
@@ -212,7 +236,8 @@ int instantiateGreedyLegalizationCPU(
         const float site_width, const float row_height, 
         int num_bins_x, int num_bins_y, 
         const int num_nodes, 
-        const int num_movable_nodes
+        const int num_movable_nodes, 
+        const int num_threads
         )
 {
     return greedyLegalizationCPU(
@@ -224,7 +249,8 @@ int instantiateGreedyLegalizationCPU(
             site_width, row_height, 
             num_bins_x, num_bins_y, 
             num_nodes, 
-            num_movable_nodes
+            num_movable_nodes, 
+            num_threads
             );
 }
 
@@ -237,7 +263,8 @@ int instantiateGreedyLegalizationCPU(
         const double site_width, const double row_height, 
         int num_bins_x, int num_bins_y, 
         const int num_nodes, 
-        const int num_movable_nodes
+        const int num_movable_nodes, 
+        const int num_threads
         )
 {
     return greedyLegalizationCPU(
@@ -249,7 +276,8 @@ int instantiateGreedyLegalizationCPU(
             site_width, row_height, 
             num_bins_x, num_bins_y, 
             num_nodes, 
-            num_movable_nodes
+            num_movable_nodes, 
+            num_threads
             );
 }
 
@@ -21,9 +21,13 @@ void legalizeBinCPU(
         T alpha, // a parameter to tune anchor initial locations and current locations 
         T beta, // a parameter to tune space reserving 
         bool lr_flag, // from left to right 
-        int* num_unplaced_cells 
+        int* num_unplaced_cells, 
+        int num_threads 
         ) 
 {
+    // bins own disjoint cells and blank rows, so they are legalized in parallel 
+    int count = 0; 
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 1) reduction(+:count)
     for (int i = 0; i < num_bins_x*num_bins_y; i += 1) 
     {
         //int num_cells = 0; 
@@ -82,6 +86,11 @@ void legalizeBinCPU(
                 {
                     continue; 
                 }
+                // multi-row cells must match the power rails of the rows 
+                if (!isPowerRailAligned(blank_bin_id_y, num_node_rows))
+                {
+                    continue; 
+                }
                 //T bin_xl = xl+bin_id_x*bin_size_x; 
                 //T bin_xh = std::min(bin_xl+bin_size_x, xh);
                 //T bin_yl = yl+blank_bin_id_y*blank_bin_size_y; 
@@ -251,8 +260,9 @@ void legalizeBinCPU(
                 bin_cells.at(i).erase(bin_cells.at(i).begin()+ci);
             }
         }
-        *num_unplaced_cells += bin_cells.at(i).size();
+        count += bin_cells.at(i).size();
     }
+    *num_unplaced_cells += count; 
 }
 
 void instantiateLegalizeBinCPU(
@@ -268,7 +278,8 @@ void instantiateLegalizeBinCPU(
         float alpha, // a parameter to tune anchor initial locations and current locations 
         float beta, // a parameter to tune space reserving 
         bool lr_flag, // from left to right 
-        int* num_unplaced_cells 
+        int* num_unplaced_cells, 
+        int num_threads 
         ) 
 {
     legalizeBinCPU(
@@ -284,7 +295,8 @@ void instantiateLegalizeBinCPU(
             alpha, 
             beta, 
             lr_flag,  
-            num_unplaced_cells 
+            num_unplaced_cells, 
+            num_threads 
             );
 }
 
@@ -301,7 +313,8 @@ void instantiateLegalizeBinCPU(
         double alpha, // a parameter to tune anchor initial locations and current locations 
         double beta, // a parameter to tune space reserving 
         bool lr_flag, // from left to right 
-        int* num_unplaced_cells 
+        int* num_unplaced_cells, 
+        int num_threads 
         ) 
 {
     legalizeBinCPU(
@@ -317,8 +330,43 @@ void instantiateLegalizeBinCPU(
             alpha, 
             beta, 
             lr_flag, 
-            num_unplaced_cells 
+            num_unplaced_cells, 
+            num_threads 
             );
 }
 
+// explicit instantiation, as the body may be fully inlined into the functions above 
+template void legalizeBinCPU<float>(
+        const float* init_x, const float* init_y, 
+        const float* node_size_x, const float* node_size_y, 
+        std::vector<std::vector<Blank<float> > >& bin_blanks, 
+        std::vector<std::vector<int> >& bin_cells, 
+        float* x, float* y, 
+        int num_bins_x, int num_bins_y, int blank_num_bins_y, 
+        float bin_size_x, float bin_size_y, float blank_bin_size_y, 
+        float site_width, float row_height, 
+        float xl, float yl, float xh, float yh,
+        float alpha, 
+        float beta, 
+        bool lr_flag, 
+        int* num_unplaced_cells, 
+        int num_threads 
+        ); 
+template void legalizeBinCPU<double>(
+        const double* init_x, const double* init_y, 
+        const double* node_size_x, const double* node_size_y, 
+        std::vector<std::vector<Blank<double> > >& bin_blanks, 
+        std::vector<std::vector<int> >& bin_cells, 
+        double* x, double* y, 
+        int num_bins_x, int num_bins_y, int blank_num_bins_y, 
+        double bin_size_x, double bin_size_y, double blank_bin_size_y, 
+        double site_width, double row_height, 
+        double xl, double yl, double xh, double yh,
+        double alpha, 
+        double beta, 
+        bool lr_flag, 
+        int* num_unplaced_cells, 
+        int num_threads 
+        ); 
+
 DREAMPLACE_END_NAMESPACE
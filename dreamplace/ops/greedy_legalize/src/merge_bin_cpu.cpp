@@ -13,9 +13,12 @@ void mergeBinCellsCPU(
         int src_num_bins_x, int src_num_bins_y, // dimensions for the src
         std::vector<std::vector<int> >& dst_bin_cells, 
         int dst_num_bins_x, int dst_num_bins_y, // dimensions for the dst
-        int scale_ratio_x, int scale_ratio_y // roughly src_num_bins_x/dst_num_bins_x, but may not be exactly the same due to even/odd numbers
+        int scale_ratio_x, int scale_ratio_y, // roughly src_num_bins_x/dst_num_bins_x, but may not be exactly the same due to even/odd numbers
+        int num_threads
         )
 {
+    // each dst bin is written by one iteration 
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 16)
     for (int i = 0; i < dst_num_bins_x*dst_num_bins_y; i += 1) 
     {
         int dst_bin_id_x = i/dst_num_bins_y; 
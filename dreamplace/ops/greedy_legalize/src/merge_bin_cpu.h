@@ -41,9 +41,12 @@ void mergeBinBlanksCPU(
         std::vector<std::vector<Blank<T> > >& dst_bin_blanks, 
         int dst_num_bins_x, int dst_num_bins_y, // dimensions for the dst
         int scale_ratio_x, // roughly src_num_bins_x/dst_num_bins_x 
-        T min_blank_width // minimum blank width to consider
+        T min_blank_width, // minimum blank width to consider
+        int num_threads
         )
 {
+    // each dst bin is written by one iteration 
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 16)
     for (int i = 0; i < dst_num_bins_x*dst_num_bins_y; i += 1) 
     {
         // assume src_num_bins_y == dst_num_bins_y
@@ -102,7 +105,8 @@ void mergeBinCellsCPU(
         int src_num_bins_x, int src_num_bins_y, // dimensions for the src
         std::vector<std::vector<int> >& dst_bin_cells, 
         int dst_num_bins_x, int dst_num_bins_y, // dimensions for the dst
-        int scale_ratio_x, int scale_ratio_y // roughly src_num_bins_x/dst_num_bins_x, but may not be exactly the same due to even/odd numbers
+        int scale_ratio_x, int scale_ratio_y, // roughly src_num_bins_x/dst_num_bins_x, but may not be exactly the same due to even/odd numbers
+        int num_threads
         );
 
 DREAMPLACE_END_NAMESPACE
@@ -54,6 +54,8 @@ class IndependentSetMatchingFunction(Function):
           set_size, 
           max_iters, 
           algorithm, 
+          lap_solver, 
+          num_shards, 
           num_threads
           ):
         if pos.is_cuda:
@@ -119,7 +121,8 @@ class IndependentSetMatchingFunction(Function):
                     num_filler_nodes, 
                     batch_size, 
                     set_size, 
-                    max_iters
+                    max_iters, 
+                    lap_solver
                     )
         else:
             output = independent_set_matching_cpp.independent_set_matching(
@@ -152,6 +155,8 @@ class IndependentSetMatchingFunction(Function):
                     batch_size, 
                     set_size, 
                     max_iters, 
+                    lap_solver, 
+                    num_shards, 
                     num_threads
                     )
         return output
@@ -174,8 +179,14 @@ class IndependentSetMatching(object):
             set_size, 
             max_iters, 
             algorithm="concurrent", 
+            lap_solver="auto", 
+            num_shards=1, 
             num_threads=8
             ):
+        """
+        @param lap_solver solver of assignment problems on CPU, auto | auction | hungarian | min_cost_flow | lapjv 
+        @param num_shards number of rectangular shards placed concurrently by the concurrent CPU algorithm, 1 for the whole layout 
+        """
         super(IndependentSetMatching, self).__init__()
         self.node_size_x = node_size_x
         self.node_size_y = node_size_y
@@ -206,6 +217,8 @@ class IndependentSetMatching(object):
         self.set_size = set_size 
         self.max_iters = max_iters
         self.algorithm = algorithm
+        self.lap_solver = lap_solver 
+        self.num_shards = num_shards 
         self.num_threads = num_threads 
     def __call__(self, pos): 
         return IndependentSetMatchingFunction.forward(
@@ -239,5 +252,7 @@ class IndependentSetMatching(object):
                 set_size=self.set_size, 
                 max_iters=self.max_iters, 
                 algorithm=self.algorithm, 
+                lap_solver=self.lap_solver, 
+                num_shards=self.num_shards, 
                 num_threads=self.num_threads
                 )
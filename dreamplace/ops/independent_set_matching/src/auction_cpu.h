@@ -9,6 +9,7 @@
 #include <iostream>
 #include <cstring>
 #include <cassert>
+#include <vector>
 
 DREAMPLACE_BEGIN_NAMESPACE
 
@@ -39,15 +40,22 @@ int run_auction(
     // --
     // Declare variables
     
-    bool allocate_flag = false; 
+    // local storage if no workspace is given; 
+    // callers running many problems should pass a workspace, e.g., through AuctionAlgorithmCPULauncher 
+    std::vector<int> local_item2person; 
+    std::vector<T> local_bids; 
+    std::vector<T> local_prices; 
+    std::vector<int> local_sbids; 
     if (!item2person_ptr)
     {
-        item2person_ptr = (int*)malloc(num_nodes * sizeof(int));
-        bids_ptr      = (T*)malloc(num_nodes * num_nodes * sizeof(T));
-        prices_ptr    = (T*)malloc(num_nodes * sizeof(T));
-        //bidders_ptr     = (int*)malloc(num_nodes * num_nodes * sizeof(int)); // unused
-        sbids_ptr       = (int*)malloc(num_nodes * sizeof(int));
-        allocate_flag = true; 
+        local_item2person.resize(num_nodes); 
+        local_bids.resize(num_nodes*num_nodes); 
+        local_prices.resize(num_nodes); 
+        local_sbids.resize(num_nodes); 
+        item2person_ptr = local_item2person.data(); 
+        bids_ptr = local_bids.data(); 
+        prices_ptr = local_prices.data(); 
+        sbids_ptr = local_sbids.data(); 
     }
 
     int   *data           = data_ptr;
@@ -159,15 +167,6 @@ int run_auction(
     // }
     // std::cerr << "score=" <<score << std::endl;   
 
-    if (allocate_flag)
-    {
-        free(item2person_ptr); 
-        free(bids_ptr);
-        free(prices_ptr);  
-        //free(bidders_ptr); 
-        free(sbids_ptr); 
-    }
-
     return (num_assigned >= num_nodes);
 } // end run_auction
 
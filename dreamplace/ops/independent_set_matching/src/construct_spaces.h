@@ -6,6 +6,8 @@
 #ifndef _DREAMPLACE_INDEPENDENT_SET_MATCHING_CONSTRUCT_SPACES_H
 #define _DREAMPLACE_INDEPENDENT_SET_MATCHING_CONSTRUCT_SPACES_H
 
+#include "utility/src/RowOccupancy.h"
+
 DREAMPLACE_BEGIN_NAMESPACE
 
 template <typename T>
@@ -42,51 +44,78 @@ inline bool adjust_pos(T& x, T width, const Space<T>& space)
 /// @brief generate array of spaces for each cell 
 /// This is specifically designed for independent set, as we only consider the whitespace on the right side of a cell. 
 /// It will make it much easier for apply_solution without keeping a structure of row2node_map. 
+/// The row occupancy must be built on host_x and host_y. 
 template <typename DetailedPlaceDBType>
 void construct_spaces(const DetailedPlaceDBType& db, 
         const typename DetailedPlaceDBType::type* host_x, const typename DetailedPlaceDBType::type* host_y, 
+        const RowOccupancy<typename DetailedPlaceDBType::type>& row_occupancy, 
         std::vector<Space<typename DetailedPlaceDBType::type> >& host_spaces, 
         int num_threads
         )
 {
-    std::vector<std::vector<int> > row2node_map (db.num_sites_y);
-    db.make_row2node_map(host_x, host_y, row2node_map, num_threads);
-
     // construct spaces 
     host_spaces.resize(db.num_movable_nodes);
-    for (int i = 0; i < db.num_sites_y; ++i)
+#pragma omp parallel for num_threads (num_threads) 
+    for (int node_id = 0; node_id < db.num_movable_nodes; ++node_id)
     {
-        for (unsigned int j = 0; j < row2node_map[i].size(); ++j)
+        auto& space = host_spaces[node_id];
+        int left_node_id = row_occupancy.prev(node_id); 
+        space.xl = (left_node_id >= 0)? host_x[node_id] : db.xl; 
+
+        auto right_bound = db.xh; 
+        int right_node_id = row_occupancy.next(node_id); 
+        if (right_node_id >= 0)
         {
-            auto const& row2nodes = row2node_map[i];
-            int node_id = row2nodes[j];
-            auto& space = host_spaces[node_id];
-            if (node_id < db.num_movable_nodes)
-            {
-                auto left_bound = db.xl; 
-                if (j)
-                {
-                    left_bound = host_x[node_id];
-                }
-                space.xl = left_bound; 
+            right_bound = std::min(right_bound, host_x[right_node_id]);
+        }
+        space.xh = right_bound;
 
-                auto right_bound = db.xh; 
-                if (j+1 < row2nodes.size())
-                {
-                    int right_node_id = row2nodes[j+1];
-                    right_bound = std::min(right_bound, host_x[right_node_id]);
-                }
-                space.xh = right_bound; 
+        // the location only refers to the bottom row,
+        // so a multi-row cell is bounded by its neighbors in the other rows as well
+        auto const& loc = row_occupancy.location(node_id);
+        int num_rows = (loc.row_id >= 0)? std::min((int)CPUCeilDiv(host_y[node_id]+db.node_size_y[node_id]-db.yl, db.row_height), row_occupancy.numRows()) : 0;
+        for (int row_id = loc.row_id+1; row_id < num_rows; ++row_id)
+        {
+            auto const& row2nodes = row_occupancy.row(row_id);
+            int j = row_occupancy.lowerBound(row_id, host_x[node_id]);
+            while (j < (int)row2nodes.size() && row2nodes[j] != node_id)
+            {
+                ++j;
+            }
+            if (j == (int)row2nodes.size())
+            {
+                continue;
+            }
+            if (j > 0)
+            {
+                space.xl = host_x[node_id];
+            }
+            if (j+1 < (int)row2nodes.size())
+            {
+                space.xh = std::min(space.xh, host_x[row2nodes[j+1]]);
+            }
+        }
 
 #ifdef DEBUG
-                dreamplaceAssert(space.xl <= db.x[node_id]);
-                dreamplaceAssert(space.xh >= db.x[node_id]+db.node_size_x[node_id]);
+        dreamplaceAssert(space.xl <= db.x[node_id]);
+        dreamplaceAssert(space.xh >= db.x[node_id]+db.node_size_x[node_id]);
 #endif
-            }
-        }
     }
 }
 
+/// @brief generate array of spaces for each cell with its own row occupancy 
+template <typename DetailedPlaceDBType>
+void construct_spaces(const DetailedPlaceDBType& db, 
+        const typename DetailedPlaceDBType::type* host_x, const typename DetailedPlaceDBType::type* host_y, 
+        std::vector<Space<typename DetailedPlaceDBType::type> >& host_spaces, 
+        int num_threads
+        )
+{
+    RowOccupancy<typename DetailedPlaceDBType::type> row_occupancy; 
+    db.make_row_occupancy(host_x, host_y, row_occupancy, num_threads);
+    construct_spaces(db, host_x, host_y, row_occupancy, host_spaces, num_threads); 
+}
+
 DREAMPLACE_END_NAMESPACE
 
 #endif
@@ -6,40 +6,69 @@
 #ifndef _DREAMPLACE_INDEPENDENT_SET_MATCHING_COST_MATRIX_CONSTRUCTION_H
 #define _DREAMPLACE_INDEPENDENT_SET_MATCHING_COST_MATRIX_CONSTRUCTION_H
 
+#include "utility/src/NetBoxCache.h"
+
 DREAMPLACE_BEGIN_NAMESPACE
 
-/// construct a NxN cost matrix 
-/// row indices are for cells 
-/// column indices are for locations 
-template <typename DetailedPlaceDBType, typename IndependentSetMatchingStateType>
-void cost_matrix_construction(const DetailedPlaceDBType& db, IndependentSetMatchingStateType& state, 
-        bool major, ///< false: row major, true: column major 
-        int i ///< entry in the batch 
-        )
+/// @brief temporary storage of cost matrix construction,
+/// kept by each thread and reused across independent sets and iterations.
+/// Pins of cells in a set are stored in flat arrays.
+template <typename T>
+struct CostMatrixWorkspace
 {
-    typedef typename DetailedPlaceDBType::type T; 
-    
-    auto const& independent_set = state.independent_sets[i];
-    auto& cost_matrix = state.cost_matrices[i]; 
-    unsigned int independent_set_size = independent_set.size();
-    std::vector<Box<T> > bboxes;
-    // cells 
-    for (unsigned int k = 0; k < independent_set_size; ++k)
+    std::vector<int> node2pin_start; ///< pins of each cell in the set, only those on valid nets
+    std::vector<T> pin_offset_x; ///< offset of each pin
+    std::vector<T> pin_offset_y;
+    std::vector<T> box_xl; ///< bounding box of the net of each pin, excluding the cell of the pin
+    std::vector<T> box_yl;
+    std::vector<T> box_xh;
+    std::vector<T> box_yh;
+    std::vector<T> target_x; ///< location of the current cell at each position
+    std::vector<T> target_y;
+    std::vector<unsigned char> target_valid; ///< whether the current cell fits at each position
+    std::vector<T> target_hpwls; ///< cost of the current cell at each position
+};
+
+/// @brief collect pins of cells in an independent set,
+/// with the bounding box of each net excluding the cell itself.
+/// @param net_boxes cached boxes of nets, NULL to scan the pins of each net
+template <typename DetailedPlaceDBType>
+void collect_cost_matrix_pins(const DetailedPlaceDBType& db, const std::vector<int>& independent_set,
+        const NetBoxCache<typename DetailedPlaceDBType::type>* net_boxes,
+        CostMatrixWorkspace<typename DetailedPlaceDBType::type>& workspace)
+{
+    typedef typename DetailedPlaceDBType::type T;
+
+    workspace.node2pin_start.assign(1, 0);
+    workspace.pin_offset_x.clear();
+    workspace.pin_offset_y.clear();
+    workspace.box_xl.clear();
+    workspace.box_yl.clear();
+    workspace.box_xh.clear();
+    workspace.box_yh.clear();
+    for (auto node_id : independent_set)
     {
-        int node_id = independent_set[k];
-        T node_width = db.node_size_x[node_id];
-        bboxes.resize(db.flat_node2pin_start_map[node_id+1]-db.flat_node2pin_start_map[node_id]);
-        int idx = 0; 
-        for (int node2pin_id = db.flat_node2pin_start_map[node_id]; node2pin_id < db.flat_node2pin_start_map[node_id+1]; ++node2pin_id, ++idx)
+        for (int node2pin_id = db.flat_node2pin_start_map[node_id]; node2pin_id < db.flat_node2pin_start_map[node_id+1]; ++node2pin_id)
         {
             int node_pin_id = db.flat_node2pin_map[node2pin_id];
             int net_id = db.pin2net_map[node_pin_id];
-            Box<T>& box = bboxes[idx];
-            box.xl = db.xh;
-            box.yl = db.yh;
-            box.xh = db.xl;
-            box.yh = db.yl;
-            if (db.net_mask[net_id])
+            if (!db.net_mask[net_id])
+            {
+                continue;
+            }
+            T bxl = db.xh;
+            T byl = db.yh;
+            T bxh = db.xl;
+            T byh = db.yl;
+            if (net_boxes)
+            {
+                Box<T> box = net_boxes->boxWithout(net_id, node_id);
+                bxl = std::min(bxl, box.xl);
+                byl = std::min(byl, box.yl);
+                bxh = std::max(bxh, box.xh);
+                byh = std::max(byh, box.yh);
+            }
+            else
             {
                 for (int net2pin_id = db.flat_net2pin_start_map[net_id]; net2pin_id < db.flat_net2pin_start_map[net_id+1]; ++net2pin_id)
                 {
@@ -47,75 +76,103 @@ void cost_matrix_construction(const DetailedPlaceDBType& db, IndependentSetMatch
                     int other_node_id = db.pin2node_map[net_pin_id];
                     if (other_node_id != node_id)
                     {
-                        T xxl = db.x[other_node_id];
-                        T yyl = db.y[other_node_id];
-                        box.xl = std::min(box.xl, xxl+db.pin_offset_x[net_pin_id]);
-                        box.xh = std::max(box.xh, xxl+db.pin_offset_x[net_pin_id]);
-                        box.yl = std::min(box.yl, yyl+db.pin_offset_y[net_pin_id]);
-                        box.yh = std::max(box.yh, yyl+db.pin_offset_y[net_pin_id]);
+                        T xx = db.x[other_node_id]+db.pin_offset_x[net_pin_id];
+                        T yy = db.y[other_node_id]+db.pin_offset_y[net_pin_id];
+                        bxl = std::min(bxl, xx);
+                        bxh = std::max(bxh, xx);
+                        byl = std::min(byl, yy);
+                        byh = std::max(byh, yy);
                     }
                 }
             }
+            workspace.pin_offset_x.push_back(db.pin_offset_x[node_pin_id]);
+            workspace.pin_offset_y.push_back(db.pin_offset_y[node_pin_id]);
+            workspace.box_xl.push_back(bxl);
+            workspace.box_yl.push_back(byl);
+            workspace.box_xh.push_back(bxh);
+            workspace.box_yh.push_back(byh);
         }
-        for (unsigned int j = 0; j < independent_set_size; ++j)
-        {
-            int pos_id = independent_set[j]; 
-            T target_x = db.x[pos_id]; 
-            T target_y = db.y[pos_id]; 
-            T target_hpwl = 0; 
+        workspace.node2pin_start.push_back(workspace.pin_offset_x.size());
+    }
+}
 
-            auto const& target_space = state.spaces[pos_id];
-            if (adjust_pos(target_x, node_width, target_space))
-            {
-                //adjust_pos(target_x, db.node_size_x[pos_id], target_space);
-                // consider FENCE region 
-                if (db.num_regions && !db.inside_fence(node_id, target_x, target_y))
-                {
-                    target_hpwl = state.large_number; 
-                }
-                else 
-                {
-                    idx = 0; 
-                    for (int node2pin_id = db.flat_node2pin_start_map[node_id]; node2pin_id < db.flat_node2pin_start_map[node_id+1]; ++node2pin_id, ++idx)
-                    {
-                        int node_pin_id = db.flat_node2pin_map[node2pin_id];
-                        int net_id = db.pin2net_map[node_pin_id];
-                        const Box<T>& box = bboxes[idx];
-                        if (db.net_mask[net_id])
-                        {
-                            T xxl = target_x;
-                            T yyl = target_y;
-                            T bxl = std::min(box.xl, xxl+db.pin_offset_x[node_pin_id]);
-                            T bxh = std::max(box.xh, xxl+db.pin_offset_x[node_pin_id]);
-                            T byl = std::min(box.yl, yyl+db.pin_offset_y[node_pin_id]);
-                            T byh = std::max(box.yh, yyl+db.pin_offset_y[node_pin_id]);
-                            target_hpwl += (bxh-bxl) + (byh-byl); 
-                        }
-                    }
-                }
-            }
-            else 
+/// construct a NxN cost matrix
+/// row indices are for cells
+/// column indices are for locations
+/// Each row is computed for all locations at once,
+/// so the inner loops run over contiguous arrays of locations.
+template <typename DetailedPlaceDBType, typename IndependentSetMatchingStateType>
+void cost_matrix_construction(const DetailedPlaceDBType& db, const IndependentSetMatchingStateType& state,
+        const NetBoxCache<typename DetailedPlaceDBType::type>* net_boxes, ///< cached boxes of nets, NULL to scan nets
+        CostMatrixWorkspace<typename DetailedPlaceDBType::type>& workspace,
+        bool major, ///< false: row major, true: column major
+        int i, ///< entry in the batch
+        int* cost_matrix ///< NxN output
+        )
+{
+    typedef typename DetailedPlaceDBType::type T;
+
+    auto const& independent_set = state.independent_sets[i];
+    int independent_set_size = independent_set.size();
+    collect_cost_matrix_pins(db, independent_set, net_boxes, workspace);
+    workspace.target_x.resize(independent_set_size);
+    workspace.target_y.resize(independent_set_size);
+    workspace.target_valid.resize(independent_set_size);
+    workspace.target_hpwls.resize(independent_set_size);
+    T* target_x = workspace.target_x.data();
+    T* target_y = workspace.target_y.data();
+    T* target_hpwls = workspace.target_hpwls.data();
+
+    // cells
+    for (int k = 0; k < independent_set_size; ++k)
+    {
+        int node_id = independent_set[k];
+        T node_width = db.node_size_x[node_id];
+        for (int j = 0; j < independent_set_size; ++j)
+        {
+            int pos_id = independent_set[j];
+            target_x[j] = db.x[pos_id];
+            target_y[j] = db.y[pos_id];
+            // consider FENCE region
+            workspace.target_valid[j] = adjust_pos(target_x[j], node_width, state.spaces[pos_id])
+                && !(db.num_regions && !db.inside_fence(node_id, target_x[j], target_y[j]));
+            target_hpwls[j] = 0;
+        }
+        // accumulate pin by pin in the same order for every location
+        for (int pin_id = workspace.node2pin_start[k]; pin_id < workspace.node2pin_start[k+1]; ++pin_id)
+        {
+            T offset_x = workspace.pin_offset_x[pin_id];
+            T offset_y = workspace.pin_offset_y[pin_id];
+            T box_xl = workspace.box_xl[pin_id];
+            T box_yl = workspace.box_yl[pin_id];
+            T box_xh = workspace.box_xh[pin_id];
+            T box_yh = workspace.box_yh[pin_id];
+            for (int j = 0; j < independent_set_size; ++j)
             {
-                //dreamplaceAssertMsg(node_id != pos_id, "node %d, pos %d", node_id, pos_id);
-                target_hpwl = state.large_number; 
+                T xx = target_x[j]+offset_x;
+                T yy = target_y[j]+offset_y;
+                target_hpwls[j] += (std::max(box_xh, xx)-std::min(box_xl, xx)) + (std::max(box_yh, yy)-std::min(box_yl, yy));
             }
-
-            if (!major) // row major 
+        }
+        for (int j = 0; j < independent_set_size; ++j)
+        {
+            T target_hpwl = (workspace.target_valid[j])? target_hpwls[j] : state.large_number;
+            if (!major) // row major
             {
-                cost_matrix[independent_set.size()*k + j] = target_hpwl; 
+                cost_matrix[independent_set_size*k + j] = target_hpwl;
             }
-            else // column major 
+            else // column major
             {
-                cost_matrix[independent_set.size()*j + k] = target_hpwl; 
+                cost_matrix[independent_set_size*j + k] = target_hpwl;
             }
         }
     }
 #ifdef DEBUG
-    for (unsigned int k = 0; k < independent_set.size(); ++k)
+    for (int k = 0; k < independent_set_size; ++k)
     {
-        for (unsigned int j = 0; j < independent_set.size(); ++j)
+        for (int j = 0; j < independent_set_size; ++j)
         {
-            dreamplacePrint(kNONE, "%d ", cost_matrix[independent_set.size()*k + j]);
+            dreamplacePrint(kNONE, "%d ", cost_matrix[independent_set_size*k + j]);
         }
         dreamplacePrint(kNONE, "\n");
     }
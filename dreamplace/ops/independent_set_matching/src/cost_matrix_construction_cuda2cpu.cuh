@@ -126,13 +126,14 @@ void cost_matrix_construction_cuda2cpu(const DetailedPlaceDBType& db, Independen
         }
     }
     bool major = false; // row major 
+    CostMatrixWorkspace<typename DetailedPlaceDBType::type> workspace; 
     for (int i = 0; i < state.num_independent_sets; ++i)
     {
         auto const& independent_set = host_state.independent_sets.at(i);
         auto& cost_matrix = host_state.cost_matrices.at(i);
         cost_matrix.resize(independent_set.size()*independent_set.size());
 
-        cost_matrix_construction(host_db, host_state, major, i);
+        cost_matrix_construction(host_db, host_state, (const NetBoxCache<typename DetailedPlaceDBType::type>*)NULL, workspace, major, i, cost_matrix.data());
 
         // map to large matrix 
         std::vector<int> tmp_cost_matrix (state.set_size*state.set_size, state.large_number);
@@ -0,0 +1,391 @@
+/**
+ * @file   independent_set_matching_cpu.h
+ * @author Yibo Lin
+ * @date   Jan 2019
+ * @brief  Independent set matching on CPU, where cells of independent sets are assigned to the locations of each other
+ */
+
+#ifndef _DREAMPLACE_INDEPENDENT_SET_MATCHING_INDEPENDENT_SET_MATCHING_CPU_H
+#define _DREAMPLACE_INDEPENDENT_SET_MATCHING_INDEPENDENT_SET_MATCHING_CPU_H
+
+#include <limits>
+#include <chrono>
+#include <random>
+#include <omp.h>
+
+#include "utility/src/Msg.h"
+#include "utility/src/Box.h"
+#include "independent_set_matching/src/lap_solver_cpu.h"
+
+//#define DEBUG 
+//#define DEBUG_PROFILE 
+
+#include "utility/src/DetailedPlaceDB.h"
+#include "utility/src/DetailedPlaceContext.h"
+#include "utility/src/diamond_search.h"
+#include "utility/src/RadixSort.h"
+#include "draw_place/src/draw_place.h"
+#include "independent_set_matching/src/bin2node_3d_map.h"
+#include "independent_set_matching/src/bin2node_map.h"
+#include "independent_set_matching/src/construct_spaces.h"
+#include "independent_set_matching/src/maximal_independent_set.h"
+#include "independent_set_matching/src/collect_independent_sets.h"
+#include "independent_set_matching/src/cost_matrix_construction.h"
+#include "independent_set_matching/src/apply_solution.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+template <typename T>
+struct IndependentSetMatchingState
+{
+    std::vector<int> ordered_nodes; 
+    std::vector<int> ordered_nodes_buffer; ///< temporary storage to sort ordered_nodes 
+    std::vector<int> node_ranks; ///< position of each node in ordered_nodes 
+    std::vector<int> undecided_nodes; ///< nodes not decided yet in maximal independent set 
+    std::vector<std::vector<int> > independent_sets; 
+    std::vector<unsigned char> dependent_markers; 
+    std::vector<unsigned char> selected_markers; 
+    std::vector<int> num_selected_markers; 
+    std::vector<GridIndex<int> > search_grids; 
+
+    std::vector<std::vector<int> > bin2node_map; ///< the first dimension is size, all the cells are categorized by width 
+    std::vector<BinMapIndex> node2bin_map;  
+    std::vector<Space<T> > spaces; ///< not used yet 
+    NetBoxCache<T> net_boxes; ///< extreme pins of nets for cost matrices 
+    RowOccupancy<T> row_occupancy; ///< cells in rows, only kept up to date with a context 
+
+    std::vector<int> cost_matrices; ///< flat cost matrices, set_size*set_size for each set; the convergence rate is related to numerical scale 
+    std::vector<CostMatrixWorkspace<T> > cost_matrix_workspaces; ///< temporary storage of cost matrix construction for each thread 
+    std::vector<std::vector<int> > solutions; 
+    std::vector<int> orig_costs; ///< original cost before matching 
+    std::vector<int> target_costs; ///< target cost after matching
+    std::vector<std::vector<T> > target_pos_x; ///< temporary storage of cell locations 
+    std::vector<std::vector<T> > target_pos_y; 
+    std::vector<std::vector<Space<T> > > target_spaces; ///< not used yet 
+    std::vector<std::vector<typename RowOccupancy<T>::Location> > target_locations; ///< slots of cells in rows before matching 
+    std::vector<int> moved_nodes; ///< cells of improved sets in the current batch 
+
+    int batch_size; 
+    int set_size; 
+    int grid_size; 
+    int max_diamond_search_sequence; 
+    int num_moved; 
+    T large_number; 
+    T skip_threshold; ///< ignore connections if cells are far apart 
+    int num_threads; 
+};
+
+/// @param context indices shared with other passes, taken over instead of built if not NULL 
+template <typename T>
+void independentSetMatchingCPULauncher(DetailedPlaceDB<T> db, 
+        int batch_size, int set_size, int max_iters, LapSolverType lap_solver, int num_threads, 
+        DetailedPlaceContext<T>* context = NULL)
+{
+    // fix random seed 
+    std::srand(1000);
+    //const double threshold = 0.00001/100; 
+    IndependentSetMatchingState<T> state; 
+    state.batch_size = batch_size; 
+    state.set_size = set_size; 
+    state.num_moved = 0; 
+    state.large_number = (db.xh-db.xl + db.yh-db.yl)*10; 
+    state.skip_threshold = (db.xh-db.xl+db.yh-db.yl)*0.01;
+    state.num_threads = std::max(num_threads, 1);
+
+    state.bin2node_map.resize(db.num_bins_x*db.num_bins_y);
+    state.node2bin_map.resize(db.num_movable_nodes);
+    //make_bin2node_map(db, db.x, db.y, db.node_size_x, db.node_size_y, state);
+    if (context)
+    {
+        std::swap(state.row_occupancy, context->row_occupancy); 
+        std::swap(state.net_boxes, context->net_boxes); 
+        context->moved_nodes.clear(); 
+        construct_spaces(db, db.x, db.y, state.row_occupancy, state.spaces, state.num_threads);
+    }
+    else 
+    {
+        construct_spaces(db, db.x, db.y, state.spaces, state.num_threads);
+        db.make_net_box_cache(state.net_boxes, state.num_threads); 
+    }
+    // multi-row cells are in several rows, so the rows are rebuilt if they move 
+    int multi_row_moved = 0; 
+    state.grid_size = ceil_power2(std::max(std::max(db.num_bins_x, db.num_bins_y)/8, 2));
+    state.max_diamond_search_sequence = state.grid_size*state.grid_size/2; 
+    dreamplacePrint(kINFO, "diamond search grid size %d, sequence length %d\n", state.grid_size, state.max_diamond_search_sequence);
+
+    state.ordered_nodes.resize(db.num_movable_nodes); 
+    std::iota(state.ordered_nodes.begin(), state.ordered_nodes.end(), 0);
+    // random ties in the order keep dependency chains short in maximal independent set 
+    std::shuffle(state.ordered_nodes.begin(), state.ordered_nodes.end(), std::mt19937(1000)); 
+    state.independent_sets.resize(state.batch_size, std::vector<int>(state.set_size)); 
+    state.dependent_markers.assign(db.num_nodes, 0); 
+    state.selected_markers.assign(db.num_movable_nodes, 0); 
+    state.num_selected_markers.assign(db.num_movable_nodes, 0);
+    state.search_grids = diamond_search_sequence(state.grid_size, state.grid_size); 
+
+    state.cost_matrices.resize(state.batch_size*state.set_size*state.set_size);
+    state.cost_matrix_workspaces.resize(state.num_threads);
+    state.solutions.resize(state.batch_size);
+    state.orig_costs.resize(state.batch_size); 
+    state.target_costs.resize(state.batch_size); 
+    state.target_pos_x.resize(state.batch_size); 
+    state.target_pos_y.resize(state.batch_size); 
+    state.target_spaces.resize(state.batch_size);
+    state.target_locations.resize(state.batch_size);
+    std::vector<LapSolverCPULauncher<int> > solvers(state.num_threads, LapSolverCPULauncher<int>(lap_solver)); 
+
+    bool major = false; // row major 
+
+    // runtime profiling 
+    hr_clock_rep iter_timer_start, iter_timer_stop; 
+    hr_clock_rep timer_start, timer_stop; 
+    int random_shuffle_runs = 0, maximal_independent_set_runs=0, collect_independent_sets_runs = 0, cost_matrix_construction_runs = 0, hungarian_runs = 0, apply_solution_runs = 0; 
+    hr_clock_rep random_shuffle_time = 0, maximal_independent_set_time = 0, collect_independent_sets_time = 0, cost_matrix_construction_time = 0, hungarian_time = 0, apply_solution_time = 0; 
+
+    // HPWL is only computed for reporting 
+    T initial_hpwl = (context)? context->hpwl : db.compute_total_hpwl();
+    T hpwl = initial_hpwl; 
+    dreamplacePrint(kINFO, "initial hpwl %g\n", initial_hpwl);
+    for (int iter = 0; iter < max_iters; ++iter)
+    {
+        iter_timer_start = get_globaltime();
+
+        timer_start = get_globaltime();
+        //std::random_shuffle(state.ordered_nodes.begin(), state.ordered_nodes.end()); 
+        // stable, so ties stay in the previous order 
+        radixSort(state.ordered_nodes, state.ordered_nodes_buffer, 
+                [&](int node_id){return state.num_selected_markers[node_id];}, state.num_threads);
+        timer_stop = get_globaltime();
+        random_shuffle_time += timer_stop-timer_start; 
+        random_shuffle_runs += 1; 
+        std::fill(state.selected_markers.begin(), state.selected_markers.end(), 0);
+
+        timer_start = get_globaltime();
+        // the parallel version gives the same set as the sequential one 
+        if (state.num_threads > 1)
+        {
+            maximal_independent_set_parallel(db, state);
+        }
+        else 
+        {
+            maximal_independent_set_sequential(db, state);
+        }
+        timer_stop = get_globaltime();
+        maximal_independent_set_time += timer_stop-timer_start; 
+        maximal_independent_set_runs += 1; 
+
+        timer_start = get_globaltime(); 
+        int num_independent_sets = collect_independent_sets(db, state);
+#pragma omp parallel for num_threads(state.num_threads) 
+        for (int i = 0; i < num_independent_sets; ++i)
+        {
+            for (auto node_id : state.independent_sets.at(i))
+            {
+                if (node_id < db.num_movable_nodes)
+                {
+                    state.num_selected_markers.at(node_id) += 1; 
+                }
+            }
+        }
+        timer_stop = get_globaltime(); 
+        collect_independent_sets_time += timer_stop-timer_start; 
+        collect_independent_sets_runs += 1; 
+
+        if (num_independent_sets > state.batch_size)
+        {
+            state.cost_matrices.resize(num_independent_sets*state.set_size*state.set_size); 
+            state.solutions.resize(num_independent_sets);
+            state.orig_costs.resize(num_independent_sets); 
+            state.target_costs.resize(num_independent_sets); 
+            state.target_pos_x.resize(num_independent_sets); 
+            state.target_pos_y.resize(num_independent_sets); 
+            state.target_spaces.resize(num_independent_sets);
+            state.target_locations.resize(num_independent_sets);
+        }
+
+        timer_start = get_globaltime();
+#pragma omp parallel for num_threads(state.num_threads) 
+        for (int i = 0; i < num_independent_sets; ++i)
+        {
+            int tid = omp_get_thread_num();
+            cost_matrix_construction(db, state, &state.net_boxes, state.cost_matrix_workspaces.at(tid), major, i, 
+                    state.cost_matrices.data()+i*state.set_size*state.set_size);
+        }
+        timer_stop = get_globaltime();
+        cost_matrix_construction_time += timer_stop-timer_start; 
+        cost_matrix_construction_runs += 1; 
+
+        timer_start = get_globaltime();
+#pragma omp parallel for num_threads(state.num_threads) 
+        for (int i = 0; i < num_independent_sets; ++i)
+        {
+            auto const& independent_set = state.independent_sets.at(i);
+            const int* cost_matrix = state.cost_matrices.data()+i*state.set_size*state.set_size;
+            auto& solution = state.solutions.at(i);
+            auto& orig_cost = state.orig_costs.at(i);
+            auto& target_cost = state.target_costs.at(i);
+            solution.resize(independent_set.size());
+
+            // solve bipartite assignment problem 
+            // compute initial cost 
+            orig_cost = 0; 
+            for (unsigned int j = 0; j < independent_set.size(); ++j)
+            {
+                orig_cost += cost_matrix[j*independent_set.size()+j];
+            }
+            int tid = omp_get_thread_num();
+            target_cost = solvers.at(tid).run(cost_matrix, solution.data(), independent_set.size());
+            // large_number scales with the layout, so on small layouts such as shards
+            // it may be below the cost of cells with many pins and get chosen;
+            // such a solution puts a cell where it does not fit and is dropped
+            for (unsigned int j = 0; j < independent_set.size(); ++j)
+            {
+                if (cost_matrix[j*independent_set.size()+solution[j]] == (int)state.large_number)
+                {
+                    target_cost = orig_cost;
+                    break;
+                }
+            }
+        }
+        timer_stop = get_globaltime();
+        hungarian_time += timer_stop-timer_start; 
+        hungarian_runs += 1; 
+
+        timer_start = get_globaltime();
+#pragma omp parallel for num_threads(state.num_threads) reduction(|:multi_row_moved)
+        for (int i = 0; i < num_independent_sets; ++i)
+        {
+            auto const& independent_set = state.independent_sets[i]; 
+            bool improved = (state.target_costs[i] < state.orig_costs[i]); 
+            if (context && improved)
+            {
+                auto& target_locations = state.target_locations[i]; 
+                target_locations.resize(independent_set.size()); 
+                for (unsigned int j = 0; j < independent_set.size(); ++j)
+                {
+                    if (independent_set[j] < db.num_movable_nodes)
+                    {
+                        target_locations[j] = state.row_occupancy.location(independent_set[j]); 
+                    }
+                }
+            }
+            apply_solution(db, state, i);
+            // each cell takes the slot of the cell whose location it takes, 
+            // and slots of different sets are disjoint 
+            if (context && improved)
+            {
+                auto const& solution = state.solutions[i]; 
+                for (unsigned int j = 0; j < independent_set.size(); ++j)
+                {
+                    int node_id = independent_set[j]; 
+                    if (node_id < db.num_movable_nodes)
+                    {
+                        if (db.node_size_y[node_id] > db.row_height)
+                        {
+                            multi_row_moved |= 1; 
+                        }
+                        else 
+                        {
+                            state.row_occupancy.assign(state.target_locations[i][solution[j]], node_id); 
+                        }
+                    }
+                }
+            }
+        }
+        // cells of different sets may still share nets, 
+        // because nets between cells farther than skip_threshold do not make them dependent, 
+        // so the nets are refreshed after all sets are applied, each net once 
+        state.moved_nodes.clear(); 
+        for (int i = 0; i < num_independent_sets; ++i)
+        {
+            if (state.target_costs[i] < state.orig_costs[i])
+            {
+                for (auto node_id : state.independent_sets[i])
+                {
+                    if (node_id < db.num_movable_nodes)
+                    {
+                        state.moved_nodes.push_back(node_id); 
+                    }
+                }
+            }
+        }
+        state.net_boxes.update(state.moved_nodes, state.num_threads); 
+        if (context)
+        {
+            context->moved_nodes.insert(context->moved_nodes.end(), state.moved_nodes.begin(), state.moved_nodes.end()); 
+        }
+        timer_stop = get_globaltime();
+        apply_solution_time += timer_stop-timer_start; 
+        apply_solution_runs += 1; 
+
+        iter_timer_stop = get_globaltime(); 
+        if ((iter%(std::max(max_iters/10, 1))) == 0 || iter+1 == max_iters)
+        {
+            hpwl = db.compute_total_hpwl(); 
+            state.num_moved = 0; 
+            for (int i = 0; i < db.num_movable_nodes; ++i)
+            {
+                if (db.x[i] != db.init_x[i] || db.y[i] != db.init_y[i])
+                {
+                    state.num_moved += 1; 
+                }
+            }
+            dreamplacePrint(kINFO, "iteration %d, target hpwl %g, delta %g(%g%%), solved %d sets, moved %g%% cells, runtime %g ms\n", 
+                    iter, 
+                    hpwl, hpwl-initial_hpwl, (hpwl-initial_hpwl)/initial_hpwl*100, 
+                    num_independent_sets, 
+                    state.num_moved/(double)db.num_movable_nodes*100, 
+                    get_timer_period()*(iter_timer_stop-iter_timer_start)
+                    );
+        }
+
+        //if (iter && hpwls.at(iter)-hpwls.at(iter+1) < threshold*hpwls.at(iter))
+        //{
+        //    break; 
+        //}
+    }
+    if (context)
+    {
+        std::swap(state.row_occupancy, context->row_occupancy); 
+        std::swap(state.net_boxes, context->net_boxes); 
+        if (multi_row_moved)
+        {
+            db.make_row_occupancy(db.x, db.y, context->row_occupancy, state.num_threads); 
+        }
+        // the last iteration is always reported 
+        context->hpwl = hpwl; 
+    }
+
+    dreamplacePrint(kDEBUG, "random_shuffle takes %g ms, %d runs, average %g ms\n", 
+            get_timer_period()*random_shuffle_time, random_shuffle_runs, get_timer_period()*random_shuffle_time/random_shuffle_runs);
+    dreamplacePrint(kDEBUG, "maximal_independent_set takes %g ms, %d runs, average %g ms\n", 
+            get_timer_period()*maximal_independent_set_time, maximal_independent_set_runs, get_timer_period()*maximal_independent_set_time/maximal_independent_set_runs);
+    dreamplacePrint(kDEBUG, "collect_independent_sets takes %g ms, %d runs, average %g ms\n", 
+            get_timer_period()*collect_independent_sets_time, collect_independent_sets_runs, get_timer_period()*collect_independent_sets_time/collect_independent_sets_runs);
+    dreamplacePrint(kDEBUG, "cost_matrix_construction takes %g ms, %d runs, average %g ms\n", 
+            get_timer_period()*cost_matrix_construction_time, cost_matrix_construction_runs, get_timer_period()*cost_matrix_construction_time/cost_matrix_construction_runs);
+    dreamplacePrint(kDEBUG, "%s takes %g ms, %d runs, average %g ms\n", 
+            solvers.front().name(), 
+            get_timer_period()*hungarian_time, hungarian_runs, get_timer_period()*hungarian_time/hungarian_runs);
+    dreamplacePrint(kDEBUG, "apply solution takes %g ms, %d runs, average %g ms\n", 
+            get_timer_period()*apply_solution_time, apply_solution_runs, get_timer_period()*apply_solution_time/apply_solution_runs);
+
+    //drawPlaceLauncher<T>(
+    //        db.x, db.y, 
+    //        db.node_size_x, db.node_size_y, 
+    //        db.pin_offset_x, db.pin_offset_y, 
+    //        db.pin2node_map, 
+    //        db.num_nodes, 
+    //        db.num_movable_nodes, 
+    //        0, 
+    //        db.flat_net2pin_start_map[db.num_nets], 
+    //        db.xl, db.yl, db.xh, db.yh, 
+    //        db.site_width, db.row_height, 
+    //        db.bin_size_x, db.bin_size_y, 
+    //        "final.gds"
+    //        );
+}
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
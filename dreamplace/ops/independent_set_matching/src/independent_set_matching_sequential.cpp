@@ -9,17 +9,11 @@
 #include "utility/src/torch.h"
 #include "utility/src/Msg.h"
 #include "utility/src/Box.h"
-#include "independent_set_matching/src/hungarian_cpu.h"
-#include "independent_set_matching/src/min_cost_flow_cpu.h"
-#include "independent_set_matching/src/auction_cpu.h"
+#include "independent_set_matching/src/lap_solver_cpu.h"
 
 //#define DEBUG 
 //#define DEBUG_PROFILE 
 
-//#define LAP_SOLVER HungarianAlgorithmCPULauncher 
-//#define LAP_SOLVER MinCostFlowCPULauncher 
-#define LAP_SOLVER AuctionAlgorithmCPULauncher
-
 #include "utility/src/DetailedPlaceDB.h"
 #include "utility/src/DetailedPlaceDBUtils.h"
 #include "utility/src/diamond_search.h"
@@ -46,8 +40,10 @@ struct IndependentSetMatchingState
     std::vector<std::vector<int> > bin2node_map; ///< the first dimension is size, all the cells are categorized by width 
     std::vector<BinMapIndex> node2bin_map;  
     std::vector<Space<T> > spaces; 
+    NetBoxCache<T> net_boxes; ///< extreme pins of nets for cost matrices 
 
-    std::vector<std::vector<int> > cost_matrices; ///< the convergence rate is related to numerical scale 
+    std::vector<int> cost_matrices; ///< flat cost matrices, set_size*set_size for each set; the convergence rate is related to numerical scale 
+    CostMatrixWorkspace<T> cost_matrix_workspace; ///< temporary storage of cost matrix construction 
     std::vector<std::vector<int> > solutions; 
     std::vector<int> orig_costs; ///< original cost before matching 
     std::vector<int> target_costs; ///< target cost after matching
@@ -220,7 +216,7 @@ void apply_solution_sequential(DetailedPlaceDBType& db, IndependentSetMatchingSt
 
 template <typename T>
 void independentSetMatchingCPULauncher(DetailedPlaceDB<T> db, 
-        int set_size, int max_iters)
+        int set_size, int max_iters, LapSolverType lap_solver)
 {
     // fix random seed 
     std::srand(1000);
@@ -233,6 +229,7 @@ void independentSetMatchingCPULauncher(DetailedPlaceDB<T> db,
 
     make_bin2node_map(db, db.x, db.y, db.node_size_x, db.node_size_y, state);
     construct_spaces(db, db.x, db.y, state.spaces, 1);
+    db.make_net_box_cache(state.net_boxes, 1); 
 #ifdef DEBUG
     for (int node_id = 0; node_id < db.num_movable_nodes; ++node_id)
     {
@@ -253,7 +250,7 @@ void independentSetMatchingCPULauncher(DetailedPlaceDB<T> db,
     state.search_grids = diamond_search_sequence(state.grid_size, state.grid_size); 
     //state.bin_marker.assign(db.num_bins_x*db.num_bins_y, 0);
 
-    state.cost_matrices.resize(state.batch_size);
+    state.cost_matrices.resize(state.batch_size*state.set_size*state.set_size);
     state.solutions.resize(state.batch_size);
     state.orig_costs.resize(state.batch_size); 
     state.target_costs.resize(state.batch_size); 
@@ -261,7 +258,7 @@ void independentSetMatchingCPULauncher(DetailedPlaceDB<T> db,
     state.target_pos_y.resize(state.batch_size); 
     state.target_node2bin_map.resize(state.batch_size);
     state.target_spaces.resize(state.batch_size);
-    LAP_SOLVER<int> solver; 
+    LapSolverCPULauncher<int> solver (lap_solver); 
     bool major = false; // row major 
 
     // runtime profiling 
@@ -319,11 +316,8 @@ void independentSetMatchingCPULauncher(DetailedPlaceDB<T> db,
 //#pragma omp parallel for schedule(dynamic, 1)
             for (int i = 0; i < num_independent_sets; ++i)
             {
-                auto const& independent_set = state.independent_sets.at(i);
-                auto& cost_matrix = state.cost_matrices.at(i);
-                cost_matrix.resize(independent_set.size()*independent_set.size());
-
-                cost_matrix_construction(db, state, major, i);
+                cost_matrix_construction(db, state, &state.net_boxes, state.cost_matrix_workspace, major, i, 
+                        state.cost_matrices.data()+i*state.set_size*state.set_size);
 
             }
             timer_stop = get_globaltime();
@@ -335,7 +329,7 @@ void independentSetMatchingCPULauncher(DetailedPlaceDB<T> db,
             for (int i = 0; i < num_independent_sets; ++i)
             {
                 auto const& independent_set = state.independent_sets.at(i);
-                auto& cost_matrix = state.cost_matrices.at(i);
+                const int* cost_matrix = state.cost_matrices.data()+i*state.set_size*state.set_size;
                 auto& solution = state.solutions.at(i);
                 auto& orig_cost = state.orig_costs.at(i);
                 auto& target_cost = state.target_costs.at(i);
@@ -348,7 +342,7 @@ void independentSetMatchingCPULauncher(DetailedPlaceDB<T> db,
                 {
                     orig_cost += cost_matrix[j*independent_set.size()+j];
                 }
-                target_cost = solver.run(cost_matrix.data(), solution.data(), independent_set.size());
+                target_cost = solver.run(cost_matrix, solution.data(), independent_set.size());
             }
             timer_stop = get_globaltime();
             hungarian_time += timer_stop-timer_start; 
@@ -359,6 +353,16 @@ void independentSetMatchingCPULauncher(DetailedPlaceDB<T> db,
             for (int i = 0; i < num_independent_sets; ++i)
             {
                 apply_solution_sequential(db, state, i);
+                if (state.target_costs[i] < state.orig_costs[i])
+                {
+                    for (auto node_id : state.independent_sets[i])
+                    {
+                        if (node_id < db.num_movable_nodes)
+                        {
+                            state.net_boxes.update(node_id); 
+                        }
+                    }
+                }
             }
             timer_stop = get_globaltime();
             apply_solution_time += timer_stop-timer_start; 
@@ -455,7 +459,8 @@ at::Tensor independent_set_matching_forward(
         int num_filler_nodes, 
         int batch_size, 
         int set_size, 
-        int max_iters
+        int max_iters, 
+        std::string lap_solver
         )
 {
     CHECK_FLAT(init_pos); 
@@ -483,7 +488,7 @@ at::Tensor independent_set_matching_forward(
                     num_bins_x, num_bins_y,
                     num_movable_nodes, num_terminal_NIs, num_filler_nodes
                     );
-            independentSetMatchingCPULauncher<scalar_t>(db, set_size, max_iters);
+            independentSetMatchingCPULauncher<scalar_t>(db, set_size, max_iters, lapSolverType(lap_solver));
             });
     timer_stop = get_globaltime(); 
     dreamplacePrint(kINFO, "Independent set matching sequential takes %g ms\n", (timer_stop-timer_start)*get_timer_period()); 
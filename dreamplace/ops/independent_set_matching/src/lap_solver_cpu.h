@@ -0,0 +1,131 @@
+/**
+ * @file   lap_solver_cpu.h
+ * @author agent
+ * @date   Oct 2026
+ */
+#ifndef _DREAMPLACE_GLOBAL_MOVE_LAP_SOLVER_CPU_H
+#define _DREAMPLACE_GLOBAL_MOVE_LAP_SOLVER_CPU_H
+
+#include <string>
+#include "utility/src/Msg.h"
+#include "independent_set_matching/src/hungarian_cpu.h"
+#include "independent_set_matching/src/min_cost_flow_cpu.h"
+#include "independent_set_matching/src/auction_cpu.h"
+#include "independent_set_matching/src/lapjv_cpu.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// @brief solvers of linear assignment problems
+enum LapSolverType
+{
+    kLapAuto = 0, ///< choose by problem size
+    kLapAuction,
+    kLapHungarian,
+    kLapMinCostFlow,
+    kLapJV
+};
+
+/// @brief convert solver name to type
+/// @param name auto | auction | hungarian | min_cost_flow | lapjv
+inline LapSolverType lapSolverType(const std::string& name)
+{
+    if (name == "auto")
+    {
+        return kLapAuto;
+    }
+    else if (name == "auction")
+    {
+        return kLapAuction;
+    }
+    else if (name == "hungarian")
+    {
+        return kLapHungarian;
+    }
+    else if (name == "min_cost_flow")
+    {
+        return kLapMinCostFlow;
+    }
+    else if (name == "lapjv")
+    {
+        return kLapJV;
+    }
+    dreamplaceAssertMsg(0, "unknown LAP solver %s", name.c_str());
+    return kLapAuto;
+}
+
+/// @brief linear assignment solver selected at runtime.
+/// Each solver keeps its own workspace, so one launcher should be used by one thread.
+template <typename T>
+class LapSolverCPULauncher
+{
+    public:
+        LapSolverCPULauncher(LapSolverType type = kLapAuto)
+            : m_type(type)
+        {
+        }
+        const char* name() const
+        {
+            switch (m_type)
+            {
+                case kLapAuction:
+                    return m_auction.name();
+                case kLapHungarian:
+                    return m_hungarian.name();
+                case kLapMinCostFlow:
+                    return m_min_cost_flow.name();
+                case kLapJV:
+                    return m_lapjv.name();
+                default:
+                    return "LapSolverCPULauncher(auto)";
+            }
+        }
+        /// @brief solver for a problem of dimension n.
+        /// In automatic mode, a single node is assigned directly,
+        /// and LAPJV is used otherwise, as it is exact and faster than auction
+        /// from a few nodes to hundreds of nodes.
+        LapSolverType select(int n) const
+        {
+            if (m_type != kLapAuto)
+            {
+                return m_type;
+            }
+            return (n <= 1)? kLapAuto : kLapJV;
+        }
+        /// @brief solve assignment problem with the selected solver
+        /// @param cost a nxn row-major cost matrix
+        /// @param sol solution mapping from row to column
+        /// @param n dimension
+        /// @param skip_threshold if the weight is larger than the threshold, do not add the edge
+        T run(const T* cost, int* sol, int n, T skip_threshold = std::numeric_limits<T>::max())
+        {
+            switch (select(n))
+            {
+                case kLapAuction:
+                    return m_auction.run(cost, sol, n, skip_threshold);
+                case kLapHungarian:
+                    return m_hungarian.run(cost, sol, n, skip_threshold);
+                case kLapMinCostFlow:
+                    return m_min_cost_flow.run(cost, sol, n, skip_threshold);
+                case kLapJV:
+                    return m_lapjv.run(cost, sol, n, skip_threshold);
+                default:
+                    if (n == 1)
+                    {
+                        sol[0] = 0;
+                        return (cost[0] < skip_threshold)? cost[0] : std::numeric_limits<T>::max();
+                    }
+                    return 0;
+            }
+        }
+
+    protected:
+        LapSolverType m_type;
+        AuctionAlgorithmCPULauncher<T> m_auction;
+        HungarianAlgorithmCPULauncher<T> m_hungarian;
+        MinCostFlowCPULauncher<T> m_min_cost_flow;
+        LapJVCPULauncher<T> m_lapjv;
+};
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
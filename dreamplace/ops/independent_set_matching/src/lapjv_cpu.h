@@ -0,0 +1,342 @@
+/**
+ * @file   lapjv_cpu.h
+ * @author agent
+ * @date   Oct 2026
+ */
+#ifndef _DREAMPLACE_GLOBAL_MOVE_LAPJV_CPU_H
+#define _DREAMPLACE_GLOBAL_MOVE_LAPJV_CPU_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// @brief Jonker-Volgenant algorithm for sparse assignment problems.
+/// Column reduction gives the initial dual solution and a partial assignment,
+/// augmenting row reduction assigns most of the free rows cheaply,
+/// and each remaining row is assigned by a shortest augmenting path on reduced costs.
+/// The dual of a row is c(i, j)-v(j) on its assigned edge, which is the minimum over the row.
+/// All storage is kept in the launcher and reused across runs.
+template <typename T>
+class LapJVCPULauncher
+{
+    public:
+        const char* name() const
+        {
+            return "LapJVCPULauncher";
+        }
+        /// @brief solve assignment problem with Jonker-Volgenant algorithm
+        /// @param cost a nxn row-major cost matrix
+        /// @param sol solution mapping from row to column
+        /// @param n dimension
+        /// @param skip_threshold if the weight is larger than the threshold, do not add the edge
+        /// @return total cost, or maximum value of T if there is no perfect matching, in which case sol is identity
+        T run(const T* cost, int* sol, int n, T skip_threshold = std::numeric_limits<T>::max())
+        {
+            build(cost, n, skip_threshold);
+
+            m_row2col.assign(n, -1);
+            m_col2row.assign(n, -1);
+            m_v.resize(n);
+            m_dist.resize(n);
+            m_pred.resize(n);
+            m_scanned.assign(n, 0);
+            m_reached.assign(n, 0);
+            m_u.resize(n);
+
+            bool feasible = reduce_columns(n);
+            for (int pass = 0; feasible && pass < 2; ++pass)
+            {
+                reduce_rows(n);
+            }
+            for (int i = 0; feasible && i < n; ++i)
+            {
+                if (m_row2col[i] < 0)
+                {
+                    feasible = augment(i, n);
+                }
+            }
+
+            T total_cost = 0;
+            if (feasible)
+            {
+                for (int row = 0; row < n; ++row)
+                {
+                    sol[row] = m_row2col[row];
+                    total_cost += cost[n*row+sol[row]];
+                }
+            }
+            else
+            {
+                total_cost = std::numeric_limits<T>::max();
+                for (int row = 0; row < n; ++row)
+                {
+                    sol[row] = row;
+                }
+            }
+            return total_cost;
+        }
+
+    protected:
+        /// @brief collect edges in compressed rows
+        void build(const T* cost, int n, T skip_threshold)
+        {
+            m_row_start.resize(n+1);
+            m_cols.clear();
+            m_costs.clear();
+            for (int row = 0; row < n; ++row)
+            {
+                m_row_start[row] = m_cols.size();
+                for (int col = 0; col < n; ++col)
+                {
+                    T c = cost[n*row+col];
+                    if (c < skip_threshold)
+                    {
+                        m_cols.push_back(col);
+                        m_costs.push_back(c);
+                    }
+                }
+            }
+            m_row_start[n] = m_cols.size();
+        }
+        /// @brief set column duals to the minimum cost in each column,
+        /// and assign each column to its cheapest row if the row is still free
+        /// @return false if a column has no edge
+        bool reduce_columns(int n)
+        {
+            std::fill(m_v.begin(), m_v.end(), std::numeric_limits<T>::max());
+            std::fill(m_pred.begin(), m_pred.end(), -1);
+            // scan rows backward so that ties go to the first row, as in the original algorithm
+            for (int row = n-1; row >= 0; --row)
+            {
+                for (int e = m_row_start[row]; e < m_row_start[row+1]; ++e)
+                {
+                    int col = m_cols[e];
+                    if (m_costs[e] <= m_v[col])
+                    {
+                        m_v[col] = m_costs[e];
+                        m_pred[col] = row;
+                    }
+                }
+            }
+            for (int col = n-1; col >= 0; --col)
+            {
+                int row = m_pred[col];
+                if (row < 0)
+                {
+                    return false;
+                }
+                if (m_row2col[row] < 0)
+                {
+                    m_row2col[row] = col;
+                    m_col2row[col] = row;
+                    m_u[row] = 0;
+                }
+            }
+            return true;
+        }
+        /// @brief augmenting row reduction;
+        /// a free row takes the column of its smallest reduced cost,
+        /// and lowers the dual of the column so that the column becomes as good as its second choice.
+        /// A row losing its column is reassigned immediately if the dual was lowered, or left to the next pass otherwise.
+        void reduce_rows(int n)
+        {
+            m_todo.clear();
+            for (int row = 0; row < n; ++row)
+            {
+                if (m_row2col[row] < 0)
+                {
+                    m_todo.push_back(row);
+                }
+            }
+            // bound the number of steps, as a row might keep taking back its column by small decrements
+            int num_steps = 0;
+            int max_steps = n*m_todo.size();
+            int num_free_rows = m_todo.size();
+            int k = 0;
+            while (k < num_free_rows && num_steps++ < max_steps)
+            {
+                int row = m_todo[k++];
+                int col1 = -1;
+                int col2 = -1;
+                T u1 = std::numeric_limits<T>::max();
+                T u2 = std::numeric_limits<T>::max();
+                for (int e = m_row_start[row]; e < m_row_start[row+1]; ++e)
+                {
+                    int col = m_cols[e];
+                    T h = m_costs[e]-m_v[col];
+                    if (h < u2)
+                    {
+                        if (h < u1)
+                        {
+                            u2 = u1;
+                            col2 = col1;
+                            u1 = h;
+                            col1 = col;
+                        }
+                        else
+                        {
+                            u2 = h;
+                            col2 = col;
+                        }
+                    }
+                }
+                if (col1 < 0)
+                {
+                    continue;
+                }
+                int prev_row = m_col2row[col1];
+                bool lowered = (col2 >= 0 && u1 < u2);
+                if (lowered)
+                {
+                    m_v[col1] -= u2-u1;
+                    u1 = u2;
+                }
+                else if (prev_row >= 0 && col2 >= 0)
+                {
+                    col1 = col2;
+                    prev_row = m_col2row[col1];
+                }
+                m_row2col[row] = col1;
+                m_col2row[col1] = row;
+                m_u[row] = u1;
+                if (prev_row >= 0)
+                {
+                    m_row2col[prev_row] = -1;
+                    if (lowered)
+                    {
+                        m_todo[--k] = prev_row;
+                    }
+                    else
+                    {
+                        m_todo.push_back(prev_row);
+                    }
+                }
+            }
+        }
+        /// @brief assign a free row with a shortest augmenting path,
+        /// with Dijkstra's algorithm on reduced costs c(i, j)-v(j)-u(i)
+        /// @return false if no free column is reachable
+        bool augment(int free_row, int n)
+        {
+            m_todo.clear();
+            m_done.clear();
+            for (int e = m_row_start[free_row]; e < m_row_start[free_row+1]; ++e)
+            {
+                int col = m_cols[e];
+                m_dist[col] = m_costs[e]-m_v[col];
+                m_pred[col] = free_row;
+                m_reached[col] = 1;
+                m_todo.push_back(col);
+            }
+
+            int end_col = -1;
+            T min_dist = 0;
+            while (end_col < 0)
+            {
+                if (m_todo.empty())
+                {
+                    break;
+                }
+                // pick the closest column not scanned yet
+                int best = 0;
+                for (int k = 1, ke = m_todo.size(); k < ke; ++k)
+                {
+                    if (m_dist[m_todo[k]] < m_dist[m_todo[best]])
+                    {
+                        best = k;
+                    }
+                }
+                int col = m_todo[best];
+                m_todo[best] = m_todo.back();
+                m_todo.pop_back();
+                min_dist = m_dist[col];
+
+                int row = m_col2row[col];
+                if (row < 0)
+                {
+                    end_col = col;
+                    break;
+                }
+                m_scanned[col] = 1;
+                m_done.push_back(col);
+                T u = m_u[row];
+                for (int e = m_row_start[row]; e < m_row_start[row+1]; ++e)
+                {
+                    int next_col = m_cols[e];
+                    if (m_scanned[next_col])
+                    {
+                        continue;
+                    }
+                    T d = min_dist + m_costs[e]-m_v[next_col]-u;
+                    if (!m_reached[next_col])
+                    {
+                        m_reached[next_col] = 1;
+                        m_dist[next_col] = d;
+                        m_pred[next_col] = row;
+                        m_todo.push_back(next_col);
+                    }
+                    else if (d < m_dist[next_col])
+                    {
+                        m_dist[next_col] = d;
+                        m_pred[next_col] = row;
+                    }
+                }
+            }
+
+            // update duals of scanned columns and their rows to keep reduced costs non-negative,
+            // so edges on the shortest path become tight and row duals stay the same after flipping
+            for (auto col : m_done)
+            {
+                m_v[col] += m_dist[col]-min_dist;
+                m_u[m_col2row[col]] -= m_dist[col]-min_dist;
+                m_scanned[col] = 0;
+                m_reached[col] = 0;
+            }
+            for (auto col : m_todo)
+            {
+                m_reached[col] = 0;
+            }
+            if (end_col < 0)
+            {
+                return false;
+            }
+            m_reached[end_col] = 0;
+            m_u[free_row] = min_dist;
+
+            // flip the path
+            int col = end_col;
+            while (true)
+            {
+                int row = m_pred[col];
+                m_col2row[col] = row;
+                int prev_col = m_row2col[row];
+                m_row2col[row] = col;
+                if (row == free_row)
+                {
+                    break;
+                }
+                col = prev_col;
+            }
+            return true;
+        }
+
+        std::vector<int> m_row_start; ///< edges of each row
+        std::vector<int> m_cols; ///< column of each edge
+        std::vector<T> m_costs; ///< cost of each edge
+        std::vector<int> m_row2col; ///< assigned column of each row
+        std::vector<int> m_col2row; ///< assigned row of each column
+        std::vector<T> m_u; ///< dual of each assigned row
+        std::vector<T> m_v; ///< dual of each column
+        std::vector<T> m_dist; ///< shortest distance to each column
+        std::vector<int> m_pred; ///< previous row on the shortest path to each column
+        std::vector<unsigned char> m_scanned; ///< whether a column is scanned in the current augmentation
+        std::vector<unsigned char> m_reached; ///< whether a column has a distance in the current augmentation
+        std::vector<int> m_todo; ///< reached columns not scanned yet
+        std::vector<int> m_done; ///< scanned columns
+};
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
@@ -30,89 +30,111 @@ void maximal_independent_set_sequential(const DetailedPlaceDBType& db, Independe
     }
 }
 
+/// @brief decide a node in the parallel maximal independent set.
+/// A node is removed if an earlier neighbor is selected,
+/// selected if all earlier neighbors are removed,
+/// and left undecided otherwise.
+/// @return decision, 0 for undecided, 1 for removed, 2 for selected
 template <typename DetailedPlaceDBType, typename IndependentSetMatchingStateType>
-void maximal_independent_set_parallel(const DetailedPlaceDBType& db, IndependentSetMatchingStateType& state, int max_iters=10)
+unsigned char decide_independent_node(const DetailedPlaceDBType& db, const IndependentSetMatchingStateType& state, int node_id)
 {
-    dreamplacePrint(kDEBUG, "%s\n", __func__);
-    // if dependent_markers is 1, it means "cannot be selected"
-    // if selected_markers is 1, it means "already selected"
-    std::fill(state.selected_markers.begin(), state.selected_markers.end(), 0);
-    std::fill(state.dependent_markers.begin(), state.dependent_markers.end(), 0);
-
-    bool empty = false; 
-    int iteration = 0; 
-    while (!empty && iteration < max_iters)
+    bool wait = false; 
+#ifdef SOFT_DEPENDENCY
+    typename DetailedPlaceDBType::type node_xl = db.x[node_id];
+    typename DetailedPlaceDBType::type node_yl = db.y[node_id];
+#endif
+    int rank = state.node_ranks[node_id];
+    // in case all nets are masked 
+    int node2pin_start = db.flat_node2pin_start_map[node_id];
+    int node2pin_end = db.flat_node2pin_start_map[node_id+1];
+    for (int node2pin_id = node2pin_start; node2pin_id < node2pin_end; ++node2pin_id)
     {
-        empty = true; 
-#pragma omp parallel for num_threads(state.num_threads) 
-        for (int node_id = 0; node_id < db.num_movable_nodes; ++node_id)
+        int node_pin_id = db.flat_node2pin_map[node2pin_id];
+        int net_id = db.pin2net_map[node_pin_id];
+        if (db.net_mask[net_id])
         {
-            if (!state.dependent_markers[node_id])
+            int net2pin_start = db.flat_net2pin_start_map[net_id];
+            int net2pin_end = db.flat_net2pin_start_map[net_id+1];
+            for (int net2pin_id = net2pin_start; net2pin_id < net2pin_end; ++net2pin_id)
             {
-#pragma omp atomic
-                empty &= false; 
-                bool min_node_flag = true; 
+                int net_pin_id = db.flat_net2pin_map[net2pin_id];
+                int other_node_id = db.pin2node_map[net_pin_id];
+                if (other_node_id < db.num_movable_nodes && state.node_ranks[other_node_id] < rank
 #ifdef SOFT_DEPENDENCY
-                typename DetailedPlaceDBType::type node_xl = db.x[node_id];
-                typename DetailedPlaceDBType::type node_yl = db.y[node_id];
+                        && std::abs(node_xl-db.x[other_node_id]) + std::abs(node_yl-db.y[other_node_id]) < state.skip_threshold
 #endif
-                int rank = state.ordered_nodes[node_id];
-                // in case all nets are masked 
-                int node2pin_start = db.flat_node2pin_start_map[node_id];
-                int node2pin_end = db.flat_node2pin_start_map[node_id+1];
-                for (int node2pin_id = node2pin_start; node2pin_id < node2pin_end; ++node2pin_id)
+                        )
                 {
-                    int node_pin_id = db.flat_node2pin_map[node2pin_id];
-                    int net_id = db.pin2net_map[node_pin_id];
-                    if (db.net_mask[net_id])
+                    unsigned char other_decision = state.dependent_markers[other_node_id];
+                    if (other_decision == 2)
                     {
-                        int net2pin_start = db.flat_net2pin_start_map[net_id];
-                        int net2pin_end = db.flat_net2pin_start_map[net_id+1];
-                        for (int net2pin_id = net2pin_start; net2pin_id < net2pin_end; ++net2pin_id)
-                        {
-                            int net_pin_id = db.flat_net2pin_map[net2pin_id];
-                            int other_node_id = db.pin2node_map[net_pin_id];
-#ifdef SOFT_DEPENDENCY
-                            typename DetailedPlaceDBType::type other_node_xl = db.x[other_node_id];
-                            typename DetailedPlaceDBType::type other_node_yl = db.y[other_node_id];
-#endif
-                            if (other_node_id < db.num_movable_nodes 
-                                    && state.ordered_nodes[other_node_id] < rank && state.dependent_markers[other_node_id] == 0
-#ifdef SOFT_DEPENDENCY
-                                    && std::abs(node_xl-other_node_xl) + std::abs(node_yl-other_node_yl) < state.skip_threshold
-#endif
-                                    )
-                            {
-                                min_node_flag = false; 
-                                break; 
-                            }
-                        }
-                        if (!min_node_flag)
-                        {
-                            break; 
-                        }
+                        return 1; 
                     }
-                }
-                if (min_node_flag)
-                {
-                    state.selected_markers[node_id] = 1; 
+                    wait |= (other_decision == 0); 
                 }
             }
         }
+    }
+    return (wait)? 0 : 2; 
+}
+
+/// @brief greedy maximal independent set in the order of state.ordered_nodes, computed in parallel rounds. 
+/// It gives the same set as maximal_independent_set_sequential (deterministic reservations). 
+/// In each round, a window of the earliest undecided nodes is decided in parallel, 
+/// where a node waits for its undecided earlier neighbors to the next round. 
+/// The number of rounds is small if ties in the order are random. 
+template <typename DetailedPlaceDBType, typename IndependentSetMatchingStateType>
+void maximal_independent_set_parallel(const DetailedPlaceDBType& db, IndependentSetMatchingStateType& state)
+{
+    dreamplacePrint(kDEBUG, "%s\n", __func__);
+    // dependent_markers records decisions in rounds, 0 for undecided, 1 for removed, 2 for selected 
+    std::fill(state.selected_markers.begin(), state.selected_markers.end(), 0);
+    std::fill(state.dependent_markers.begin(), state.dependent_markers.end(), 0);
+
+    int num_nodes = db.num_movable_nodes; 
+    state.node_ranks.resize(num_nodes); 
 #pragma omp parallel for num_threads(state.num_threads) 
-        for (int node_id = 0; node_id < db.num_movable_nodes; ++node_id)
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        state.node_ranks[state.ordered_nodes[i]] = i; 
+    }
+    auto& undecided_nodes = state.undecided_nodes; 
+    undecided_nodes.assign(state.ordered_nodes.begin(), state.ordered_nodes.end()); 
+
+    // a small window wastes rounds, and a large one wastes checks on waiting nodes 
+    int window = std::max(num_nodes/64, 1024*state.num_threads); 
+    int begin = 0; 
+    int num_rounds = 0; 
+    while (begin < num_nodes)
+    {
+        int end = std::min(begin+window, num_nodes); 
+#pragma omp parallel for num_threads(state.num_threads) schedule(dynamic, 64)
+        for (int i = begin; i < end; ++i)
+        {
+            int node_id = undecided_nodes[i]; 
+            state.dependent_markers[node_id] = decide_independent_node(db, state, node_id); 
+        }
+        // move undecided nodes in the window next to the rest, keeping the order 
+        int pos = end; 
+        for (int i = end-1; i >= begin; --i)
         {
+            int node_id = undecided_nodes[i]; 
             if (!state.dependent_markers[node_id])
             {
-                // there wil be no data race if use *_self function 
-                // the other version may result in parallel issue 
-                mark_dependent_nodes_self(db, state, node_id);
+                undecided_nodes[--pos] = node_id; 
             }
         }
-        //dreamplacePrint(kDEBUG, "selected %lu nodes\n", std::count(state.selected_markers.begin(), state.selected_markers.end(), 1));
-        ++iteration; 
+        begin = pos; 
+        ++num_rounds; 
+    }
+
+#pragma omp parallel for num_threads(state.num_threads) 
+    for (int node_id = 0; node_id < num_nodes; ++node_id)
+    {
+        state.selected_markers[node_id] = (state.dependent_markers[node_id] == 2); 
+        state.dependent_markers[node_id] = 1; 
     }
-    dreamplacePrint(kDEBUG, "selected %lu nodes\n", std::count(state.selected_markers.begin(), state.selected_markers.end(), 1));
+    dreamplacePrint(kDEBUG, "selected %lu nodes in %d rounds\n", std::count(state.selected_markers.begin(), state.selected_markers.end(), 1), num_rounds);
 }
 
 DREAMPLACE_END_NAMESPACE
@@ -6,6 +6,8 @@
 #ifndef _DREAMPLACE_GLOBAL_MOVE_MIN_COST_FLOW_CPU_H
 #define _DREAMPLACE_GLOBAL_MOVE_MIN_COST_FLOW_CPU_H
 
+#include <limits>
+#include <algorithm>
 #include "lemon/smart_graph.h"
 #include "lemon/network_simplex.h"
 
@@ -112,6 +114,88 @@ class MinCostFlowCPULauncher
         }
 };
 
+/// @brief min-cost flow on a general network, 
+/// e.g., transportation of cell area among bins in legalization 
+/// @tparam T integral cost type, as network simplex is only exact on integers; 
+/// callers with floating-point costs scale them to integral units 
+template <typename T>
+class MinCostFlowNetworkCPULauncher
+{
+    static_assert(std::numeric_limits<T>::is_integer, "network simplex requires integral costs"); 
+
+    public:
+        const char* name() const 
+        {
+            return "MinCostFlowNetworkCPULauncher";
+        }
+        /// @brief solve min-cost flow with network simplex 
+        /// @param num_nodes number of nodes 
+        /// @param supplies supply of each node, positive for sources and negative for sinks; they must sum to zero 
+        /// @param num_arcs number of arcs 
+        /// @param arc_sources source node of each arc 
+        /// @param arc_targets target node of each arc 
+        /// @param arc_capacities capacity of each arc 
+        /// @param arc_costs cost of unit flow on each arc 
+        /// @param flows solution of flow on each arc 
+        /// @return total cost, or the maximum value of T if no feasible flow exists 
+        T run(int num_nodes, const int* supplies, 
+                int num_arcs, const int* arc_sources, const int* arc_targets, const int* arc_capacities, const T* arc_costs, 
+                int* flows)
+        {
+            typedef lemon::SmartDigraph graph_type;
+            graph_type graph; 
+            graph.reserveNode(num_nodes);
+            for (int i = 0; i < num_nodes; ++i)
+            {
+                graph.addNode();
+            }
+            graph.reserveArc(num_arcs);
+            graph_type::ArcMap<T> edge_costs (graph); 
+            graph_type::ArcMap<int> edge_capacities (graph); 
+            graph_type::NodeMap<int> node_supply (graph);
+
+            for (int i = 0; i < num_arcs; ++i)
+            {
+                auto arc = graph.addArc(graph.nodeFromId(arc_sources[i]), graph.nodeFromId(arc_targets[i]));
+                edge_costs[arc] = arc_costs[i];
+                edge_capacities[arc] = arc_capacities[i]; 
+            }
+            for (int i = 0; i < num_nodes; ++i)
+            {
+                node_supply[graph.nodeFromId(i)] = supplies[i]; 
+            }
+
+            typedef lemon::NetworkSimplex<graph_type, 
+                    int, 
+                    T> alg_type;
+
+            // 1. choose algorithm 
+            alg_type alg (graph);
+
+            // 2. run 
+            typename alg_type::ProblemType status = alg.resetParams()
+                .upperMap(edge_capacities)
+                .costMap(edge_costs)
+                .supplyMap(node_supply)
+                .run();
+
+            // 3. check results 
+            if (status != alg_type::OPTIMAL)
+            {
+                dreamplacePrint(kDEBUG, "status is not OPTIMAL, no flow is applied\n");
+                std::fill(flows, flows+num_arcs, 0); 
+                return std::numeric_limits<T>::max();
+            }
+
+            // 4. apply results, arc ids follow the order of insertion 
+            for (graph_type::ArcIt a (graph); a != lemon::INVALID; ++a)
+            {
+                flows[graph.id(a)] = alg.flow(a); 
+            }
+            return alg.totalCost(); 
+        }
+};
+
 DREAMPLACE_END_NAMESPACE
 
 #endif
@@ -51,6 +51,7 @@ class KReorderFunction(Function):
           num_filler_nodes, 
           K, 
           max_iters, 
+          num_shards, 
           num_threads
           ):
         if pos.is_cuda:
@@ -115,6 +116,7 @@ class KReorderFunction(Function):
                     num_filler_nodes, 
                     K, 
                     max_iters, 
+                    num_shards, 
                     num_threads
                     )
         return output
@@ -135,7 +137,11 @@ class KReorder(object):
             num_movable_nodes, num_terminal_NIs, num_filler_nodes, 
             K, 
             max_iters=10, 
+            num_shards=1, 
             num_threads=8):
+        """
+        @param num_shards number of rectangular shards placed concurrently on CPU, 1 for the whole layout 
+        """
         super(KReorder, self).__init__()
         self.node_size_x = node_size_x
         self.node_size_y = node_size_y
@@ -164,6 +170,7 @@ class KReorder(object):
         self.num_filler_nodes = num_filler_nodes
         self.K = K
         self.max_iters = max_iters
+        self.num_shards = num_shards
         self.num_threads = num_threads
     def __call__(self, pos): 
         return KReorderFunction.forward(
@@ -195,5 +202,6 @@ class KReorder(object):
                 num_filler_nodes=self.num_filler_nodes, 
                 K=self.K, 
                 max_iters=self.max_iters, 
+                num_shards=self.num_shards, 
                 num_threads=self.num_threads
                 )
@@ -8,95 +8,107 @@
 
 DREAMPLACE_BEGIN_NAMESPACE
 
+/// @brief build the sparse conflict graph of rows. 
+/// Two rows conflict if they have movable cells of the same net. 
+/// Each net first collects the distinct rows of its movable cells, 
+/// so the work is quadratic to the number of rows of a net instead of its pins. 
 template <typename DetailedPlaceDBType>
 void compute_row_conflict_graph(const DetailedPlaceDBType& db, 
         const std::vector<std::vector<int> >& state_row2node_map, 
-        std::vector<unsigned char>& state_adjacency_matrix, 
         std::vector<std::vector<int> >& state_row_graph, 
         int num_threads)
 {
-    // adjacency matrix 
-    state_adjacency_matrix.assign(db.num_sites_y*db.num_sites_y, 0);
-#pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1)
+    // distinct rows of each net, 
+    // stored in the slice of the net in flat_net2pin_map, as a net has no more rows than pins 
+    std::vector<int> flat_net2row_map (db.num_pins); 
+    std::vector<int> net_num_rows (db.num_nets, 0); 
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic, 64)
     for (int net_id = 0; net_id < db.num_nets; ++net_id)
     {
         if (db.net_mask[net_id])
         {
             int net2pin_start = db.flat_net2pin_start_map[net_id]; 
             int net2pin_end = db.flat_net2pin_start_map[net_id+1];
-            for (int net2pin_id1 = net2pin_start; net2pin_id1 < net2pin_end; ++net2pin_id1)
+            auto net2rows = flat_net2row_map.begin() + net2pin_start; 
+            int num_rows = 0; 
+            for (int net2pin_id = net2pin_start; net2pin_id < net2pin_end; ++net2pin_id)
             {
-                int net_pin_id1 = db.flat_net2pin_map[net2pin_id1];
-                int node_id1 = db.pin2node_map[net_pin_id1];
-                if (node_id1 < db.num_movable_nodes)
+                int net_pin_id = db.flat_net2pin_map[net2pin_id];
+                int node_id = db.pin2node_map[net_pin_id];
+                if (node_id < db.num_movable_nodes)
                 {
-                    int row_id1 = (db.y[node_id1]-db.yl)/db.row_height; 
-                    row_id1 = std::min(std::max(row_id1, 0), db.num_sites_y-1);
-                    for (int net2pin_id2 = net2pin_id1; net2pin_id2 < net2pin_end; ++net2pin_id2)
-                    {
-                        int net_pin_id2 = db.flat_net2pin_map[net2pin_id2];
-                        int node_id2 = db.pin2node_map[net_pin_id2];
-                        if (node_id2 < db.num_movable_nodes)
-                        {
-                            int row_id2 = (db.y[node_id2]-db.yl)/db.row_height; 
-                            row_id2 = std::min(std::max(row_id2, 0), db.num_sites_y-1);
-                            unsigned char& adjacency_matrix_element1 = state_adjacency_matrix.at(row_id1*db.num_sites_y + row_id2); 
-                            unsigned char& adjacency_matrix_element2 = state_adjacency_matrix.at(row_id2*db.num_sites_y + row_id1); 
-                            if (!adjacency_matrix_element1)
-                            {
-#pragma omp atomic 
-                                adjacency_matrix_element1 |= 1; 
-                            }
-                            if (!adjacency_matrix_element2)
-                            {
-#pragma omp atomic 
-                                adjacency_matrix_element2 |= 1; 
-                            }
-                        }
-                    }
+                    int row_id = (db.y[node_id]-db.yl)/db.row_height; 
+                    net2rows[num_rows++] = std::min(std::max(row_id, 0), db.num_sites_y-1);
                 }
             }
+            std::sort(net2rows, net2rows + num_rows); 
+            num_rows = std::unique(net2rows, net2rows + num_rows) - net2rows; 
+            // nets within one row introduce no conflict 
+            net_num_rows[net_id] = (num_rows > 1)? num_rows : 0; 
+        }
+    }
+
+    // nets of each row 
+    std::vector<int> row2net_start_map (db.num_sites_y+1, 0); 
+    for (int net_id = 0; net_id < db.num_nets; ++net_id)
+    {
+        auto net2rows = flat_net2row_map.begin() + db.flat_net2pin_start_map[net_id]; 
+        for (int i = 0; i < net_num_rows[net_id]; ++i)
+        {
+            row2net_start_map[net2rows[i]+1] += 1; 
         }
     }
-#ifdef DEBUG
     for (int row_id = 0; row_id < db.num_sites_y; ++row_id)
     {
-        for (int other_row_id = 0; other_row_id < db.num_sites_y; ++other_row_id)
+        row2net_start_map[row_id+1] += row2net_start_map[row_id]; 
+    }
+    std::vector<int> flat_row2net_map (row2net_start_map.back()); 
+    std::vector<int> row2net_count (row2net_start_map.begin(), row2net_start_map.end()-1); 
+    for (int net_id = 0; net_id < db.num_nets; ++net_id)
+    {
+        auto net2rows = flat_net2row_map.begin() + db.flat_net2pin_start_map[net_id]; 
+        for (int i = 0; i < net_num_rows[net_id]; ++i)
         {
-            if (!(state_adjacency_matrix.at(row_id*db.num_sites_y+other_row_id) == state_adjacency_matrix.at(other_row_id*db.num_sites_y+row_id)))
-            {
-                dreamplacePrint(kDEBUG, "row %d, other_row %d, %d, %d\n", row_id, other_row_id, 
-                        (int)state_adjacency_matrix.at(row_id*db.num_sites_y+other_row_id), 
-                        (int)state_adjacency_matrix.at(other_row_id*db.num_sites_y+row_id)
-                        );
-            }
-            dreamplaceAssert(state_adjacency_matrix.at(row_id*db.num_sites_y+other_row_id) == state_adjacency_matrix.at(other_row_id*db.num_sites_y+row_id));
-            dreamplacePrint(kNONE, "%d", int(state_adjacency_matrix.at(row_id*db.num_sites_y+other_row_id))); 
+            flat_row2net_map[row2net_count[net2rows[i]]++] = net_id; 
         }
-        dreamplacePrint(kNONE, "\n");
     }
-#endif
+
     // adjacency list 
     state_row_graph.assign(db.num_sites_y, std::vector<int>()); 
-#pragma omp parallel for num_threads(num_threads) 
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic, 16)
     for (int row_id = 0; row_id < db.num_sites_y; ++row_id)
     {
         auto& adjacency_vec = state_row_graph[row_id]; 
-        for (int other_row_id = 0; other_row_id < db.num_sites_y; ++other_row_id)
+        for (int row2net_id = row2net_start_map[row_id]; row2net_id < row2net_start_map[row_id+1]; ++row2net_id)
         {
-            if (row_id != other_row_id && state_adjacency_matrix.at(row_id*db.num_sites_y+other_row_id))
+            int net_id = flat_row2net_map[row2net_id]; 
+            auto net2rows = flat_net2row_map.begin() + db.flat_net2pin_start_map[net_id]; 
+            for (int i = 0; i < net_num_rows[net_id]; ++i)
             {
-                adjacency_vec.push_back(other_row_id); 
+                if (net2rows[i] != row_id)
+                {
+                    adjacency_vec.push_back(net2rows[i]); 
+                }
             }
         }
+        std::sort(adjacency_vec.begin(), adjacency_vec.end()); 
+        adjacency_vec.erase(std::unique(adjacency_vec.begin(), adjacency_vec.end()), adjacency_vec.end()); 
     }
-
+#ifdef DEBUG
+    for (int row_id = 0; row_id < db.num_sites_y; ++row_id)
+    {
+        for (auto other_row_id : state_row_graph[row_id])
+        {
+            dreamplaceAssert(std::binary_search(state_row_graph[other_row_id].begin(), state_row_graph[other_row_id].end(), row_id)); 
+        }
+    }
+#endif
 }
 
 template <typename DetailedPlaceDBType, typename KReorderState>
 void compute_row_conflict_graph(const DetailedPlaceDBType& db, KReorderState& state)
 {
-    compute_row_conflict_graph(db, state.row2node_map, state.adjacency_matrix, state.row_graph, state.num_threads); 
+    compute_row_conflict_graph(db, state.row_occupancy.rows(), state.row_graph, state.num_threads); 
 }
 
 
@@ -106,40 +118,35 @@ void compute_independent_rows(const DetailedPlaceDBType& db,
         std::vector<std::vector<int> >& state_independent_rows
         )
 {
-    // generate independent sets of rows 
-    std::vector<unsigned char> dependent_markers (db.num_sites_y, 0); 
-    std::vector<unsigned char> selected_markers (db.num_sites_y, 0); 
-    int num_selected = 0; 
-    while (num_selected < db.num_sites_y)
+    // generate independent sets of rows by greedy coloring in the order of rows, 
+    // which is the same as extracting maximal independent sets from the remaining rows one after another 
+    std::vector<int> row_colors (db.num_sites_y, -1); 
+    std::vector<int> color_markers; ///< the last row that cannot take a color 
+    for (int row_id = 0; row_id < db.num_sites_y; ++row_id)
     {
-        std::vector<int> independent_rows; 
-        for (int row_id = 0; row_id < db.num_sites_y; ++row_id)
+        for (auto other_row_id : state_row_graph[row_id])
         {
-            if (!dependent_markers[row_id] && !selected_markers[row_id])
+            if (row_colors[other_row_id] >= 0)
             {
-                independent_rows.push_back(row_id); 
-                dependent_markers[row_id] = 1; 
-                selected_markers[row_id] = 1; 
-                num_selected += 1; 
-
-                for (auto other_row_id : state_row_graph[row_id])
-                {
-                    dependent_markers[other_row_id] = 1; 
-                }
+                color_markers[row_colors[other_row_id]] = row_id; 
             }
         }
-        // recover marker 
-        for (auto i : independent_rows)
+        int color = 0; 
+        while (color < (int)color_markers.size() && color_markers[color] == row_id)
         {
-            for (auto other_row_id : state_row_graph[i])
-            {
-#ifdef DEBUG
-                dreamplaceAssert(std::count(independent_rows.begin(), independent_rows.end(), other_row_id) == 0); 
-#endif
-                dependent_markers[other_row_id] = 0; 
-            }
+            ++color; 
         }
-        state_independent_rows.push_back(independent_rows); 
+        if (color == (int)color_markers.size())
+        {
+            color_markers.push_back(-1); 
+        }
+        row_colors[row_id] = color; 
+    }
+    int num_groups = state_independent_rows.size(); 
+    state_independent_rows.resize(num_groups + color_markers.size()); 
+    for (int row_id = 0; row_id < db.num_sites_y; ++row_id)
+    {
+        state_independent_rows[num_groups + row_colors[row_id]].push_back(row_id); 
     }
 #ifdef DEBUG
     for (unsigned int i = 0; i < state_independent_rows.size(); ++i)
@@ -163,7 +170,7 @@ void compute_independent_rows(const DetailedPlaceDBType& db,
             }
         }
     }
-    dreamplaceAssert(std::count(selected_markers.begin(), selected_markers.end(), 0) == 0);
+    dreamplaceAssert(std::count(row_colors.begin(), row_colors.end(), -1) == 0);
 #endif
 }
 
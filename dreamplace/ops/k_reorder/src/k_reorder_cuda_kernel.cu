@@ -1054,7 +1054,6 @@ int kreorderCUDALauncher(DetailedPlaceDB<T> db, int K, int max_iters, int num_th
     std::vector<std::vector<int> > host_row2node_map (db.num_sites_y);
     std::vector<T> host_node_space_x (db.num_movable_nodes); 
     std::vector<std::vector<int> > host_permutations = quick_perm(K); 
-    std::vector<unsigned char> host_adjacency_matrix; 
     std::vector<std::vector<int> > host_row_graph; 
     std::vector<std::vector<int> > host_independent_rows; 
     std::vector<std::vector<KReorderInstance> > host_reorder_instances; 
@@ -1117,7 +1116,7 @@ int kreorderCUDALauncher(DetailedPlaceDB<T> db, int K, int max_iters, int num_th
         dreamplacePrint(kDEBUG, "initializing CPU DB takes %g ms\n", get_timer_period()*(iter_time_stop-iter_time_start));
 
         iter_time_start = get_globaltime(); 
-        compute_row_conflict_graph(cpu_db, host_row2node_map, host_adjacency_matrix, host_row_graph, num_threads); 
+        compute_row_conflict_graph(cpu_db, host_row2node_map, host_row_graph, num_threads); 
         compute_independent_rows(cpu_db, host_row_graph, host_independent_rows); 
         iter_time_stop = get_globaltime(); 
         dreamplacePrint(kDEBUG, "computing independent rows takes %g ms\n", get_timer_period()*(iter_time_stop-iter_time_start));
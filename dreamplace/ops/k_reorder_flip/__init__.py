@@ -0,0 +1,5 @@
+##
+# @file   __init__.py
+# @author agent
+# @date   Oct 2026
+#
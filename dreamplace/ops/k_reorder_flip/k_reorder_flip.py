@@ -0,0 +1,208 @@
+##
+# @file   k_reorder_flip.py
+# @author agent
+# @date   Oct 2026
+# @brief  detailed placement using local reordering with horizontal flipping
+#
+
+import math
+import torch
+from torch import nn
+from torch.autograd import Function
+
+import dreamplace.ops.k_reorder_flip.k_reorder_flip_cpp as k_reorder_flip_cpp
+
+class KReorderFlipFunction(Function):
+    """ Detailed placement with k-reorder and flipping.
+    Pin offsets of flipped cells are updated in place, and node_flip_x is toggled for them.
+    """
+    @staticmethod
+    def forward(
+          pos,
+          node_size_x,
+          node_size_y,
+          flat_region_boxes,
+          flat_region_boxes_start,
+          node2fence_region_map,
+          flat_net2pin_map,
+          flat_net2pin_start_map,
+          pin2net_map,
+          flat_node2pin_map,
+          flat_node2pin_start_map,
+          pin2node_map,
+          pin_offset_x,
+          pin_offset_y,
+          net_mask,
+          node_flip_x,
+          xl,
+          yl,
+          xh,
+          yh,
+          site_width,
+          row_height,
+          num_bins_x,
+          num_bins_y,
+          num_movable_nodes,
+          num_terminal_NIs,
+          num_filler_nodes,
+          K,
+          max_iters,
+          num_threads
+          ):
+        if pos.is_cuda:
+            pin_offset_x_cpu = pin_offset_x.cpu()
+            node_flip_x_cpu = node_flip_x.cpu()
+            output = k_reorder_flip_cpp.k_reorder_flip(
+                    pos.view(pos.numel()).cpu(),
+                    node_size_x.cpu(),
+                    node_size_y.cpu(),
+                    flat_region_boxes.cpu(),
+                    flat_region_boxes_start.cpu(),
+                    node2fence_region_map.cpu(),
+                    flat_net2pin_map.cpu(),
+                    flat_net2pin_start_map.cpu(),
+                    pin2net_map.cpu(),
+                    flat_node2pin_map.cpu(),
+                    flat_node2pin_start_map.cpu(),
+                    pin2node_map.cpu(),
+                    pin_offset_x_cpu,
+                    pin_offset_y.cpu(),
+                    net_mask.cpu(),
+                    node_flip_x_cpu,
+                    xl,
+                    yl,
+                    xh,
+                    yh,
+                    site_width,
+                    row_height,
+                    num_bins_x,
+                    num_bins_y,
+                    num_movable_nodes,
+                    num_terminal_NIs,
+                    num_filler_nodes,
+                    K,
+                    max_iters,
+                    num_threads
+                    ).cuda()
+            pin_offset_x.copy_(pin_offset_x_cpu)
+            node_flip_x.copy_(node_flip_x_cpu)
+        else:
+            output = k_reorder_flip_cpp.k_reorder_flip(
+                    pos.view(pos.numel()),
+                    node_size_x,
+                    node_size_y,
+                    flat_region_boxes,
+                    flat_region_boxes_start,
+                    node2fence_region_map,
+                    flat_net2pin_map,
+                    flat_net2pin_start_map,
+                    pin2net_map,
+                    flat_node2pin_map,
+                    flat_node2pin_start_map,
+                    pin2node_map,
+                    pin_offset_x,
+                    pin_offset_y,
+                    net_mask,
+                    node_flip_x,
+                    xl,
+                    yl,
+                    xh,
+                    yh,
+                    site_width,
+                    row_height,
+                    num_bins_x,
+                    num_bins_y,
+                    num_movable_nodes,
+                    num_terminal_NIs,
+                    num_filler_nodes,
+                    K,
+                    max_iters,
+                    num_threads
+                    )
+        return output
+
+class KReorderFlip(object):
+    """ Detailed placement with k-reorder and horizontal flipping
+    """
+    def __init__(self,
+            node_size_x, node_size_y,
+            flat_region_boxes, flat_region_boxes_start, node2fence_region_map,
+            flat_net2pin_map, flat_net2pin_start_map, pin2net_map,
+            flat_node2pin_map, flat_node2pin_start_map, pin2node_map,
+            pin_offset_x, pin_offset_y,
+            net_mask,
+            node_flip_x,
+            xl, yl, xh, yh,
+            site_width, row_height,
+            num_bins_x, num_bins_y,
+            num_movable_nodes, num_terminal_NIs, num_filler_nodes,
+            K,
+            max_iters=10,
+            num_threads=8):
+        """
+        @param pin_offset_x offsets of pins, updated in place for flipped cells
+        @param node_flip_x uint8 flags of cells, toggled in place for flipped cells, so orientations can be updated when applying the solution
+        """
+        super(KReorderFlip, self).__init__()
+        self.node_size_x = node_size_x
+        self.node_size_y = node_size_y
+        self.flat_region_boxes = flat_region_boxes
+        self.flat_region_boxes_start = flat_region_boxes_start
+        self.node2fence_region_map = node2fence_region_map
+        self.flat_net2pin_map = flat_net2pin_map
+        self.flat_net2pin_start_map = flat_net2pin_start_map
+        self.pin2net_map = pin2net_map
+        self.flat_node2pin_map = flat_node2pin_map
+        self.flat_node2pin_start_map = flat_node2pin_start_map
+        self.pin2node_map = pin2node_map
+        self.pin_offset_x = pin_offset_x
+        self.pin_offset_y = pin_offset_y
+        self.net_mask = net_mask
+        self.node_flip_x = node_flip_x
+        self.xl = xl
+        self.yl = yl
+        self.xh = xh
+        self.yh = yh
+        self.site_width = site_width
+        self.row_height = row_height
+        self.num_bins_x = num_bins_x
+        self.num_bins_y = num_bins_y
+        self.num_movable_nodes = num_movable_nodes
+        self.num_terminal_NIs = num_terminal_NIs
+        self.num_filler_nodes = num_filler_nodes
+        self.K = K
+        self.max_iters = max_iters
+        self.num_threads = num_threads
+    def __call__(self, pos):
+        return KReorderFlipFunction.forward(
+                pos,
+                node_size_x=self.node_size_x,
+                node_size_y=self.node_size_y,
+                flat_region_boxes=self.flat_region_boxes,
+                flat_region_boxes_start=self.flat_region_boxes_start,
+                node2fence_region_map=self.node2fence_region_map,
+                flat_net2pin_map=self.flat_net2pin_map,
+                flat_net2pin_start_map=self.flat_net2pin_start_map,
+                pin2net_map=self.pin2net_map,
+                flat_node2pin_map=self.flat_node2pin_map,
+                flat_node2pin_start_map=self.flat_node2pin_start_map,
+                pin2node_map=self.pin2node_map,
+                pin_offset_x=self.pin_offset_x,
+                pin_offset_y=self.pin_offset_y,
+                net_mask=self.net_mask,
+                node_flip_x=self.node_flip_x,
+                xl=self.xl,
+                yl=self.yl,
+                xh=self.xh,
+                yh=self.yh,
+                site_width=self.site_width,
+                row_height=self.row_height,
+                num_bins_x=self.num_bins_x,
+                num_bins_y=self.num_bins_y,
+                num_movable_nodes=self.num_movable_nodes,
+                num_terminal_NIs=self.num_terminal_NIs,
+                num_filler_nodes=self.num_filler_nodes,
+                K=self.K,
+                max_iters=self.max_iters,
+                num_threads=self.num_threads
+                )
@@ -0,0 +1,94 @@
+/**
+ * @file   k_reorder_flip.cpp
+ * @author agent
+ * @date   Oct 2026
+ * @brief  Detailed placement by jointly reordering and horizontally flipping consecutive cells in rows
+ */
+#include "utility/src/torch.h"
+#include "utility/src/Msg.h"
+#include "utility/src/DetailedPlaceDB.h"
+#include "utility/src/DetailedPlaceDBUtils.h"
+#include "k_reorder_flip/src/k_reorder_flip_cpu.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+#define CHECK_FLAT(x) AT_ASSERTM(!x.is_cuda() && x.ndimension() == 1, #x "must be a flat tensor on CPU")
+#define CHECK_EVEN(x) AT_ASSERTM((x.numel()&1) == 0, #x "must have even number of elements")
+#define CHECK_CONTIGUOUS(x) AT_ASSERTM(x.is_contiguous(), #x "must be contiguous")
+
+/// @brief the pin offsets of flipped cells are updated in place,
+/// and node_flip_x is toggled for them, so the orientation can be updated accordingly
+at::Tensor k_reorder_flip_forward(
+        at::Tensor init_pos,
+        at::Tensor node_size_x,
+        at::Tensor node_size_y,
+        at::Tensor flat_region_boxes,
+        at::Tensor flat_region_boxes_start,
+        at::Tensor node2fence_region_map,
+        at::Tensor flat_net2pin_map,
+        at::Tensor flat_net2pin_start_map,
+        at::Tensor pin2net_map,
+        at::Tensor flat_node2pin_map,
+        at::Tensor flat_node2pin_start_map,
+        at::Tensor pin2node_map,
+        at::Tensor pin_offset_x,
+        at::Tensor pin_offset_y,
+        at::Tensor net_mask,
+        at::Tensor node_flip_x,
+        double xl,
+        double yl,
+        double xh,
+        double yh,
+        double site_width, double row_height,
+        int num_bins_x,
+        int num_bins_y,
+        int num_movable_nodes,
+        int num_terminal_NIs,
+        int num_filler_nodes,
+        int K,
+        int max_iters,
+        int num_threads
+        )
+{
+    CHECK_FLAT(init_pos);
+    CHECK_EVEN(init_pos);
+    CHECK_CONTIGUOUS(init_pos);
+    CHECK_FLAT(pin_offset_x);
+    CHECK_CONTIGUOUS(pin_offset_x);
+    CHECK_FLAT(node_flip_x);
+    CHECK_CONTIGUOUS(node_flip_x);
+    AT_ASSERTM(node_flip_x.numel() >= num_movable_nodes, "node_flip_x must cover movable cells");
+
+    auto pos = init_pos.clone();
+
+	hr_clock_rep total_time_start, total_time_stop;
+    total_time_start = get_globaltime();
+
+    DREAMPLACE_DISPATCH_FLOATING_TYPES(pos.type(), "kreorderFlipCPULauncher", [&] {
+            auto db = make_placedb<scalar_t>(
+                    init_pos,
+                    pos,
+                    node_size_x, node_size_y,
+                    flat_region_boxes, flat_region_boxes_start, node2fence_region_map,
+                    flat_net2pin_map, flat_net2pin_start_map, pin2net_map,
+                    flat_node2pin_map, flat_node2pin_start_map, pin2node_map,
+                    pin_offset_x, pin_offset_y,
+                    net_mask,
+                    xl, yl, xh, yh,
+                    site_width, row_height,
+                    num_bins_x, num_bins_y,
+                    num_movable_nodes, num_terminal_NIs, num_filler_nodes
+                    );
+            kreorderFlipCPULauncher(db, pin_offset_x.data<scalar_t>(), node_flip_x.data<unsigned char>(), K, max_iters, num_threads);
+            });
+    total_time_stop = get_globaltime();
+    dreamplacePrint(kINFO, "K-reorder with flipping time: %g ms\n", get_timer_period()*(total_time_stop-total_time_start));
+
+    return pos;
+}
+
+DREAMPLACE_END_NAMESPACE
+
+PYBIND11_MODULE(TORCH_EXTENSION_NAME, m) {
+  m.def("k_reorder_flip", &DREAMPLACE_NAMESPACE::k_reorder_flip_forward, "K-reorder with flipping");
+}
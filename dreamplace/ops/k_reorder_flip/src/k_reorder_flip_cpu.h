@@ -0,0 +1,282 @@
+/**
+ * @file   k_reorder_flip_cpu.h
+ * @author agent
+ * @date   Oct 2026
+ * @brief  K-reorder with horizontal flipping of cells on CPU
+ */
+
+#ifndef _DREAMPLACE_K_REORDER_FLIP_K_REORDER_FLIP_CPU_H
+#define _DREAMPLACE_K_REORDER_FLIP_K_REORDER_FLIP_CPU_H
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <omp.h>
+#include "utility/src/Msg.h"
+#include "utility/src/DetailedPlaceDB.h"
+#include "utility/src/DetailedPlaceContext.h"
+#include "k_reorder/src/compute_independent_rows.h"
+#include "k_reorder_flip/src/reorder_flip_search.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+#define MAX_NUM_THREADS 128
+
+template <typename T>
+struct KReorderFlipState
+{
+    RowOccupancy<T> row_occupancy; ///< cells in rows
+    std::vector<T> node_space_x; ///< cell size with spaces
+    KReorderFlipSearch<T> searches[MAX_NUM_THREADS]; ///< search for the best order and flipping of a window
+    std::vector<T> target_sizes[MAX_NUM_THREADS];
+    std::vector<int> target_nodes[MAX_NUM_THREADS];
+    std::vector<int> moved_nodes[MAX_NUM_THREADS]; ///< cells moved or flipped by each thread, to refresh the nets of a context
+
+    std::vector<std::vector<int> > row_graph; ///< adjacency list for row graph
+    std::vector<std::vector<int> > independent_rows;
+
+    T* pin_offset_x; ///< same array as in the database, updated for flipped cells
+    unsigned char* node_flip_x; ///< toggled for flipped cells
+
+    int K;
+    int num_moved;
+    int num_flipped;
+    int num_threads;
+};
+
+/// @brief flip a cell horizontally by mirroring its pins about its center
+template <typename T>
+void flip_node(const DetailedPlaceDB<T>& db, KReorderFlipState<T>& state, int node_id)
+{
+    T width = db.node_size_x[node_id];
+    for (int node2pin_id = db.flat_node2pin_start_map[node_id]; node2pin_id < db.flat_node2pin_start_map[node_id+1]; ++node2pin_id)
+    {
+        int node_pin_id = db.flat_node2pin_map[node2pin_id];
+        state.pin_offset_x[node_pin_id] = width - state.pin_offset_x[node_pin_id];
+    }
+    state.node_flip_x[node_id] ^= 1;
+}
+
+template <typename T>
+void apply_reorder_flip(DetailedPlaceDB<T>& db, KReorderFlipState<T>& state, int row_id, int idx_bgn, int idx_end,
+        const std::vector<int>& permutation, const std::vector<unsigned char>& flips, const std::vector<T>& target_x)
+{
+    auto row2nodes = state.row_occupancy.row(row_id).data() + idx_bgn;
+    int K = idx_end-idx_bgn;
+
+    int tid = omp_get_thread_num();
+    auto& target_nodes = state.target_nodes[tid];
+    target_nodes.resize(K);
+
+    for (int i = 0; i < K; ++i)
+    {
+        int node_id = row2nodes[i];
+        target_nodes.at(i) = node_id;
+    }
+
+    for (int i = 0; i < K; ++i)
+    {
+        int node_id = row2nodes[i];
+        T xx = target_x.at(permutation.at(i));
+        if (db.x[node_id] != xx)
+        {
+#pragma omp atomic
+            state.num_moved += 1;
+        }
+        if (db.x[node_id] != xx || flips.at(i))
+        {
+            state.moved_nodes[tid].push_back(node_id);
+        }
+        db.x[node_id] = xx;
+        if (flips.at(i))
+        {
+            flip_node(db, state, node_id);
+#pragma omp atomic
+            state.num_flipped += 1;
+        }
+    }
+
+    for (int i = 0; i < K; ++i)
+    {
+        state.row_occupancy.assign(row_id, idx_bgn+permutation.at(i), target_nodes.at(i));
+    }
+}
+
+/// @brief k-reorder with flipping for detailed placement
+/// @param pin_offset_x mutable view of db.pin_offset_x
+/// @param node_flip_x whether each cell has been flipped, toggled when a cell is flipped
+/// @param context indices shared with other passes, taken over instead of built if not NULL
+template <typename T>
+int kreorderFlipCPULauncher(DetailedPlaceDB<T>& db, T* pin_offset_x, unsigned char* node_flip_x,
+        int K, int max_iters, int num_threads, DetailedPlaceContext<T>* context = NULL)
+{
+    dreamplacePrint(kDEBUG, "%d-reorder with flipping\n", K);
+    T stop_threshold = 0.1/100;
+
+    // profiling variables
+	hr_clock_rep timer_start[MAX_NUM_THREADS], timer_stop[MAX_NUM_THREADS];
+	hr_clock_rep search_reorder_time[MAX_NUM_THREADS] = {0};
+	int search_reorder_runs[MAX_NUM_THREADS] = {0};
+	hr_clock_rep iter_time_start, iter_time_stop;
+
+    KReorderFlipState<T> state;
+    state.K = K;
+    state.num_threads = std::min(std::max(num_threads, 1), MAX_NUM_THREADS);
+    state.pin_offset_x = pin_offset_x;
+    state.node_flip_x = node_flip_x;
+
+    // divide layout into rows
+    // distribute cells into them
+    if (context)
+    {
+        std::swap(state.row_occupancy, context->row_occupancy);
+    }
+    else
+    {
+        db.make_row_occupancy(db.x, db.y, state.row_occupancy, state.num_threads);
+    }
+
+    state.node_space_x.resize(db.num_movable_nodes);
+    for (int i = 0; i < db.num_sites_y; ++i)
+    {
+        auto const& row2nodes = state.row_occupancy.row(i);
+        for (unsigned int j = 0; j < row2nodes.size(); ++j)
+        {
+            int node_id = row2nodes[j];
+            if (node_id < db.num_movable_nodes)
+            {
+                auto& space = state.node_space_x[node_id];
+                T space_xl = db.x[node_id];
+                T space_xh = db.xh;
+                if (j+1 < row2nodes.size())
+                {
+                    int right_node_id = row2nodes[j+1];
+                    space_xh = std::min(space_xh, db.x[right_node_id]);
+                }
+                space = space_xh-space_xl;
+                space = floor(space / db.site_width) * db.site_width;
+                dreamplaceAssertMsg(space >= db.node_size_x[node_id], "space %g, node_size_x[%d] %g, original space (%g, %g), site_width %g", space, node_id, db.node_size_x[node_id], space_xl, space_xh, db.site_width);
+            }
+        }
+    }
+
+    timer_start[0] = get_globaltime();
+    compute_row_conflict_graph(db, state);
+    compute_independent_rows(db, state);
+    timer_stop[0] = get_globaltime();
+    dreamplacePrint(kDEBUG, "compute_independent_rows takes %g ms\n", get_timer_period()*(timer_stop[0]-timer_start[0]));
+
+    std::vector<T> best_target_x[MAX_NUM_THREADS];
+    std::vector<int> best_permutation[MAX_NUM_THREADS];
+    std::vector<unsigned char> best_flips[MAX_NUM_THREADS];
+
+    state.num_moved = 0;
+    state.num_flipped = 0;
+    std::vector<T> hpwls (max_iters+1);
+    hpwls[0] = (context)? context->hpwl : db.compute_total_hpwl();
+    T hpwl = hpwls[0];
+    dreamplacePrint(kINFO, "initial hpwl = %.3f\n", hpwls[0]);
+
+    for (int iter = 0; iter < max_iters; ++iter)
+    {
+        iter_time_start = get_globaltime();
+
+        for (unsigned int group_id = 0; group_id < state.independent_rows.size(); ++group_id)
+        {
+            auto const& independent_rows = state.independent_rows[group_id];
+            unsigned int num_independent_rows = independent_rows.size();
+#pragma omp parallel for num_threads (state.num_threads) schedule(dynamic, 1)
+            for (unsigned int group_row_id = 0; group_row_id < num_independent_rows; ++group_row_id)
+            {
+                int tid = omp_get_thread_num();
+                auto& target_sizes = state.target_sizes[tid];
+                auto& best_target_x_tid = best_target_x[tid];
+                auto& best_permutation_tid = best_permutation[tid];
+                auto& best_flips_tid = best_flips[tid];
+
+                int row_id = independent_rows.at(group_row_id);
+                auto const& row2nodes = state.row_occupancy.row(row_id);
+                for (int sub_id = 0; sub_id < (int)row2nodes.size(); sub_id += std::max(K/2, 1))
+                {
+                    int idx_bgn = sub_id;
+                    int idx_end = std::min(sub_id+K, (int)row2nodes.size());
+                    // stop at fixed cells and multi-row height cells
+                    for (int i = idx_bgn; i < idx_end; ++i)
+                    {
+                        int node_id = row2nodes.at(i);
+                        if (node_id >= db.num_movable_nodes || db.node_size_y[node_id] > db.row_height)
+                        {
+                            idx_end = i;
+                            break;
+                        }
+                    }
+                    // a single cell may still be flipped
+                    if (idx_end-idx_bgn < 1)
+                    {
+                        continue;
+                    }
+                    timer_start[tid] = get_globaltime();
+                    target_sizes.resize(idx_end-idx_bgn);
+                    for (int i = idx_bgn; i < idx_end; ++i)
+                    {
+                        target_sizes[i-idx_bgn] = state.node_space_x[row2nodes[i]];
+                    }
+                    T best_cost = state.searches[tid].run(db, row2nodes.data()+idx_bgn, target_sizes.data(), idx_end-idx_bgn,
+                            best_permutation_tid, best_flips_tid, best_target_x_tid);
+                    timer_stop[tid] = get_globaltime();
+                    search_reorder_time[tid] += timer_stop[tid]-timer_start[tid];
+                    search_reorder_runs[tid] += 1;
+                    // no order satisfies fence regions
+                    if (best_cost == std::numeric_limits<T>::max())
+                    {
+                        continue;
+                    }
+                    apply_reorder_flip(db, state, row_id, idx_bgn, idx_end, best_permutation_tid, best_flips_tid, best_target_x_tid);
+                }
+            }
+        }
+
+        iter_time_stop = get_globaltime();
+        dreamplacePrint(kINFO, "Iter %d time (ms) \t %g\n", iter, get_timer_period() * (iter_time_stop - iter_time_start));
+
+        hpwls[iter+1] = db.compute_total_hpwl();
+        hpwl = hpwls[iter+1];
+        dreamplacePrint(kINFO, "iteration %d: hpwl %.3f => %.3f (imp. %g%%), %d moved, %d flipped\n",
+                iter, hpwls[0], hpwls[iter+1], (1.0-hpwls[iter+1]/(double)hpwls[0])*100, state.num_moved, state.num_flipped);
+
+        if ((iter&1) && hpwls[iter]-hpwls[iter-1] > -stop_threshold*hpwls[0])
+        {
+            break;
+        }
+    }
+
+    {
+        auto time = std::accumulate(search_reorder_time, search_reorder_time+MAX_NUM_THREADS, (T)0);
+        auto runs = std::accumulate(search_reorder_runs, search_reorder_runs+MAX_NUM_THREADS, 0);
+        dreamplacePrint(kDEBUG, "search_reorder_flip \t %g ms \t %d runs\n", get_timer_period() * time, runs);
+    }
+
+    if (context)
+    {
+        // flipped cells change the pins of their nets, even if they stay
+        std::vector<int>& moved_nodes = context->moved_nodes;
+        moved_nodes.clear();
+        for (int i = 0; i < state.num_threads; ++i)
+        {
+            moved_nodes.insert(moved_nodes.end(), state.moved_nodes[i].begin(), state.moved_nodes[i].end());
+        }
+        context->net_boxes.update(moved_nodes, state.num_threads);
+        std::swap(state.row_occupancy, context->row_occupancy);
+        context->hpwl = hpwl;
+    }
+
+    return 0;
+}
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
@@ -0,0 +1,284 @@
+/**
+ * @file   reorder_flip_search.h
+ * @author agent
+ * @date   Oct 2026
+ */
+#ifndef _DREAMPLACE_K_REORDER_FLIP_REORDER_FLIP_SEARCH_H
+#define _DREAMPLACE_K_REORDER_FLIP_REORDER_FLIP_SEARCH_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "utility/src/Msg.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// @brief Branch and bound search for the best order and horizontal flipping of a window of consecutive cells in a row.
+/// It follows KReorderSearch, where each slot takes a cell and whether to flip it.
+/// A flipped cell mirrors its pins about its center, i.e., a pin at offset x moves to width - x.
+/// Cells whose pins are symmetric are never flipped, as it does not change the cost.
+template <typename T>
+class KReorderFlipSearch
+{
+    public:
+        /// @brief find the best order and flipping of cells
+        /// @param nodes cells of the window from left to right
+        /// @param spaces widths of cells with whitespace after them
+        /// @param permutation output slot of each cell
+        /// @param flips output whether to flip each cell
+        /// @param target_x output location of each slot
+        /// @return cost of the best solution, the sum of horizontal HPWL of nets touching the window
+        template <typename DetailedPlaceDBType>
+        T run(const DetailedPlaceDBType& db, const int* nodes, const T* spaces, int num_nodes,
+                std::vector<int>& permutation, std::vector<unsigned char>& flips, std::vector<T>& target_x)
+        {
+            collect(db, nodes, spaces, num_nodes);
+
+            m_slot_x.resize(num_nodes+1);
+            m_slot_x[0] = db.x[nodes[0]];
+            m_order.resize(num_nodes);
+            m_best_order.resize(num_nodes);
+            m_flips.assign(num_nodes, 0);
+            m_best_flips.assign(num_nodes, 0);
+            m_placed.assign(num_nodes, 0);
+            m_total_space = 0;
+            for (int i = 0; i < num_nodes; ++i)
+            {
+                m_total_space += m_spaces[i];
+            }
+
+            m_cost = 0;
+            for (unsigned int i = 0; i < m_net_xl.size(); ++i)
+            {
+                m_cost += span(i);
+            }
+
+            // the first complete solution explored is the current one without flipping,
+            // so cells are only changed for strictly better cost
+            m_best_cost = std::numeric_limits<T>::max();
+            m_num_explored = 0;
+            search(db, 0);
+
+            permutation.resize(num_nodes);
+            flips.assign(m_best_flips.begin(), m_best_flips.end());
+            target_x.resize(num_nodes);
+            for (int i = 0; i < num_nodes; ++i)
+            {
+                permutation[m_best_order[i]] = i;
+            }
+            T xx = m_slot_x[0];
+            for (int i = 0; i < num_nodes; ++i)
+            {
+                target_x[i] = xx;
+                xx += m_spaces[m_best_order[i]];
+            }
+            return m_best_cost;
+        }
+        /// @return number of partial solutions explored in the last run
+        int numExplored() const {return m_num_explored;}
+
+    protected:
+        /// @brief collect nets of the window and their bounding boxes of pins outside the window
+        template <typename DetailedPlaceDBType>
+        void collect(const DetailedPlaceDBType& db, const int* nodes, const T* spaces, int num_nodes)
+        {
+            m_nodes.assign(nodes, nodes+num_nodes);
+            m_spaces.assign(spaces, spaces+num_nodes);
+            m_net_ids.clear();
+            m_net_xl.clear();
+            m_net_xh.clear();
+            m_node2pin_start.assign(1, 0);
+            m_pin2net.clear();
+            m_pin_offset_x[0].clear();
+            m_pin_offset_x[1].clear();
+            m_flippable.assign(num_nodes, 0);
+
+            for (int i = 0; i < num_nodes; ++i)
+            {
+                int node_id = nodes[i];
+                T width = db.node_size_x[node_id];
+                for (int node2pin_id = db.flat_node2pin_start_map[node_id]; node2pin_id < db.flat_node2pin_start_map[node_id+1]; ++node2pin_id)
+                {
+                    int node_pin_id = db.flat_node2pin_map[node2pin_id];
+                    int net_id = db.pin2net_map[node_pin_id];
+                    if (!db.net_mask[net_id])
+                    {
+                        continue;
+                    }
+                    int local_net_id = std::find(m_net_ids.begin(), m_net_ids.end(), net_id) - m_net_ids.begin();
+                    if (local_net_id == (int)m_net_ids.size())
+                    {
+                        m_net_ids.push_back(net_id);
+                        T bxl = db.xh;
+                        T bxh = db.xl;
+                        for (int net2pin_id = db.flat_net2pin_start_map[net_id]; net2pin_id < db.flat_net2pin_start_map[net_id+1]; ++net2pin_id)
+                        {
+                            int net_pin_id = db.flat_net2pin_map[net2pin_id];
+                            int other_node_id = db.pin2node_map[net_pin_id];
+                            if (std::find(nodes, nodes+num_nodes, other_node_id) == nodes+num_nodes)
+                            {
+                                T other_pin_x = db.x[other_node_id] + db.pin_offset_x[net_pin_id];
+                                bxl = std::min(bxl, other_pin_x);
+                                bxh = std::max(bxh, other_pin_x);
+                            }
+                        }
+                        m_net_xl.push_back(bxl);
+                        m_net_xh.push_back(bxh);
+                    }
+                    T offset_x = db.pin_offset_x[node_pin_id];
+                    m_pin2net.push_back(local_net_id);
+                    m_pin_offset_x[0].push_back(offset_x);
+                    m_pin_offset_x[1].push_back(width - offset_x);
+                    m_flippable[i] |= (offset_x != width - offset_x);
+                }
+                m_node2pin_start.push_back(m_pin2net.size());
+            }
+            m_net_lower.assign(m_net_ids.size(), std::numeric_limits<T>::max());
+            m_net_upper.assign(m_net_ids.size(), std::numeric_limits<T>::lowest());
+        }
+        /// @return span of a net, 0 if it has no pin yet
+        T span(int local_net_id) const
+        {
+            return std::max(m_net_xh[local_net_id]-m_net_xl[local_net_id], (T)0);
+        }
+        /// @return least increase of cost to place the remaining cells after the slot.
+        /// Same as KReorderSearch, with the pin offset of either orientation that extends the box less.
+        T lower_bound(int slot) const
+        {
+            T xl = m_slot_x[slot];
+            T xh = m_slot_x[0] + m_total_space;
+            for (unsigned int i = 0; i < m_nodes.size(); ++i)
+            {
+                if (m_placed[i])
+                {
+                    continue;
+                }
+                for (int pin_id = m_node2pin_start[i]; pin_id < m_node2pin_start[i+1]; ++pin_id)
+                {
+                    int local_net_id = m_pin2net[pin_id];
+                    T offset_xl = std::min(m_pin_offset_x[0][pin_id], m_pin_offset_x[1][pin_id]);
+                    T offset_xh = std::max(m_pin_offset_x[0][pin_id], m_pin_offset_x[1][pin_id]);
+                    m_net_lower[local_net_id] = std::min(m_net_lower[local_net_id], xh - m_spaces[i] + offset_xh);
+                    m_net_upper[local_net_id] = std::max(m_net_upper[local_net_id], xl + offset_xl);
+                }
+            }
+            T extra = 0;
+            for (unsigned int i = 0; i < m_net_lower.size(); ++i)
+            {
+                if (m_net_upper[i] != std::numeric_limits<T>::lowest())
+                {
+                    T bxl = std::min(m_net_xl[i], m_net_lower[i]);
+                    T bxh = std::max(m_net_xh[i], m_net_upper[i]);
+                    extra += std::max(bxh - bxl, (T)0) - span(i);
+                }
+                m_net_lower[i] = std::numeric_limits<T>::max();
+                m_net_upper[i] = std::numeric_limits<T>::lowest();
+            }
+            return extra;
+        }
+        template <typename DetailedPlaceDBType>
+        void search(const DetailedPlaceDBType& db, int slot)
+        {
+            ++m_num_explored;
+            int num_nodes = m_nodes.size();
+            if (slot == num_nodes)
+            {
+                if (m_cost < m_best_cost)
+                {
+                    m_best_cost = m_cost;
+                    m_best_order = m_order;
+                    m_best_flips = m_flips;
+                }
+                return;
+            }
+            if (m_best_cost != std::numeric_limits<T>::max() && m_cost + lower_bound(slot) >= m_best_cost)
+            {
+                return;
+            }
+            T xx = m_slot_x[slot];
+            for (int i = 0; i < num_nodes; ++i)
+            {
+                if (m_placed[i])
+                {
+                    continue;
+                }
+                int node_id = m_nodes[i];
+                if (db.num_regions && !db.inside_fence(node_id, xx, db.y[node_id]))
+                {
+                    continue;
+                }
+                for (int flip = 0; flip <= m_flippable[i]; ++flip)
+                {
+                    // place the cell and extend bounding boxes
+                    const std::vector<T>& pin_offset_x = m_pin_offset_x[flip];
+                    int undo_size = m_undo.size();
+                    for (int pin_id = m_node2pin_start[i]; pin_id < m_node2pin_start[i+1]; ++pin_id)
+                    {
+                        int local_net_id = m_pin2net[pin_id];
+                        T pin_x = xx + pin_offset_x[pin_id];
+                        if (pin_x < m_net_xl[local_net_id] || pin_x > m_net_xh[local_net_id])
+                        {
+                            m_undo.push_back(Undo{local_net_id, m_net_xl[local_net_id], m_net_xh[local_net_id]});
+                            m_cost -= span(local_net_id);
+                            m_net_xl[local_net_id] = std::min(m_net_xl[local_net_id], pin_x);
+                            m_net_xh[local_net_id] = std::max(m_net_xh[local_net_id], pin_x);
+                            m_cost += span(local_net_id);
+                        }
+                    }
+                    m_placed[i] = 1;
+                    m_flips[i] = flip;
+                    m_order[slot] = i;
+                    m_slot_x[slot+1] = xx + m_spaces[i];
+
+                    search(db, slot+1);
+
+                    // restore in reverse order, as a net may be extended by several pins
+                    m_placed[i] = 0;
+                    m_flips[i] = 0;
+                    while ((int)m_undo.size() > undo_size)
+                    {
+                        const Undo& u = m_undo.back();
+                        m_cost -= span(u.local_net_id);
+                        m_net_xl[u.local_net_id] = u.xl;
+                        m_net_xh[u.local_net_id] = u.xh;
+                        m_cost += span(u.local_net_id);
+                        m_undo.pop_back();
+                    }
+                }
+            }
+        }
+
+        struct Undo
+        {
+            int local_net_id;
+            T xl;
+            T xh;
+        };
+
+        std::vector<int> m_nodes; ///< cells in the window
+        std::vector<T> m_spaces; ///< widths of cells with whitespace
+        std::vector<unsigned char> m_flippable; ///< whether flipping a cell moves any of its pins
+        std::vector<int> m_net_ids; ///< nets touching the window
+        std::vector<T> m_net_xl; ///< current left of bounding box of each net
+        std::vector<T> m_net_xh; ///< current right of bounding box of each net
+        mutable std::vector<T> m_net_lower; ///< leftmost upper bound of remaining pins of each net
+        mutable std::vector<T> m_net_upper; ///< rightmost lower bound of remaining pins of each net
+        std::vector<int> m_node2pin_start; ///< pins of each cell in the window
+        std::vector<int> m_pin2net; ///< local net of each pin
+        std::vector<T> m_pin_offset_x[2]; ///< offset of each pin, without and with flipping
+        std::vector<T> m_slot_x; ///< location of each slot in the current partial solution
+        std::vector<int> m_order; ///< cell in each slot in the current partial solution
+        std::vector<int> m_best_order; ///< cell in each slot in the best solution
+        std::vector<unsigned char> m_flips; ///< whether each cell is flipped in the current partial solution
+        std::vector<unsigned char> m_best_flips; ///< whether each cell is flipped in the best solution
+        std::vector<unsigned char> m_placed; ///< whether a cell is in the current partial solution
+        std::vector<Undo> m_undo; ///< changed bounding boxes to restore when backtracking
+        T m_total_space; ///< total width of the window
+        T m_cost; ///< cost of the current partial solution
+        T m_best_cost; ///< cost of the best solution
+        int m_num_explored; ///< number of partial solutions explored
+};
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
@@ -18,12 +18,24 @@ class LegalityCheck(object):
     3. overlap 
     4. fence region 
     """
+    # violation types in the report 
+    kOutOfBoundary = 0 
+    kMisaligned = 1 
+    kOverlap = 2 
+    kOutOfFence = 3 
+
     def __init__(self, node_size_x, node_size_y, 
             flat_region_boxes, flat_region_boxes_start, node2fence_region_map, 
             xl, yl, xh, yh, site_width, row_height, 
             num_terminals, 
-            num_movable_nodes
+            num_movable_nodes, 
+            num_threads=8, 
+            max_num_violations=10 
             ):
+        """
+        @param num_threads number of threads 
+        @param max_num_violations maximum number of violations to report 
+        """
         super(LegalityCheck, self).__init__()
         self.node_size_x = node_size_x.cpu()
         self.node_size_y = node_size_y.cpu()
@@ -38,6 +50,11 @@ class LegalityCheck(object):
         self.row_height = row_height 
         self.num_terminals = num_terminals 
         self.num_movable_nodes = num_movable_nodes
+        self.num_threads = num_threads
+        self.max_num_violations = max_num_violations
+        # persistent row index and position for incremental check 
+        self.row_index = legality_check_cpp.RowIndex()
+        self.last_pos = None 
 
     def __call__(self, pos):
         return self.forward(pos)
@@ -45,6 +62,7 @@ class LegalityCheck(object):
     def forward(self, pos): 
         """ 
         @param pos current roughly legal position
+        @return true if legal; the first max_num_violations violations are printed 
         """
         if pos.is_cuda:
             pos_cpu = pos.cpu()
@@ -64,5 +82,94 @@ class LegalityCheck(object):
                 self.site_width, 
                 self.row_height, 
                 self.num_terminals, 
-                self.num_movable_nodes
+                self.num_movable_nodes, 
+                self.num_threads, 
+                self.max_num_violations
+                )
+
+    def report(self, pos): 
+        """ 
+        @param pos current roughly legal position
+        @return the first max_num_violations violations as an integer tensor of shape (#violations, 4), 
+        each row is (type, node id, other node id, row id) where ids are -1 if not applicable, 
+        and the total number of violations 
+        """
+        if pos.is_cuda:
+            pos_cpu = pos.cpu()
+        else:
+            pos_cpu = pos 
+        violations, num_violations = legality_check_cpp.report(
+                pos_cpu, 
+                self.node_size_x,
+                self.node_size_y,
+                self.flat_region_boxes, 
+                self.flat_region_boxes_start, 
+                self.node2fence_region_map, 
+                self.xl, 
+                self.yl, 
+                self.xh, 
+                self.yh, 
+                self.site_width, 
+                self.row_height, 
+                self.num_terminals, 
+                self.num_movable_nodes, 
+                self.num_threads, 
+                self.max_num_violations
+                )
+        return violations, num_violations.item()
+
+    def incremental(self, pos, moved_nodes=None): 
+        """ 
+        @brief check nodes moved since the last incremental check and the rows they touch. 
+        The first call checks all nodes. 
+        The previously checked position is expected to be legal, 
+        as violations only involving unmoved nodes in other rows are not reported. 
+        Hence, the next call checks all nodes again if this one fails. 
+        @param pos current roughly legal position
+        @param moved_nodes indices of all nodes moved since the last incremental check; 
+        inferred from the last checked position if None 
+        @return true if legal 
+        """
+        if pos.is_cuda:
+            pos_cpu = pos.cpu()
+        else:
+            pos_cpu = pos 
+        num_nodes = pos_cpu.numel() // 2
+        if self.last_pos is None or self.last_pos.numel() != pos_cpu.numel(): 
+            # check from scratch 
+            self.row_index.clear()
+            moved_nodes = torch.zeros(0, dtype=torch.int32)
+        elif moved_nodes is None: 
+            # only movable and fixed cells are indexed, not terminal NIs or fillers 
+            num_indexed_nodes = self.num_movable_nodes + self.num_terminals
+            diff = pos_cpu != self.last_pos
+            moved_nodes = (diff[:num_indexed_nodes] | diff[num_nodes:num_nodes+num_indexed_nodes]).nonzero().view(-1).to(torch.int32)
+        else:
+            moved_nodes = moved_nodes.cpu().to(torch.int32).contiguous()
+        legal = legality_check_cpp.incremental(
+                pos_cpu, 
+                self.node_size_x,
+                self.node_size_y,
+                self.flat_region_boxes, 
+                self.flat_region_boxes_start, 
+                self.node2fence_region_map, 
+                moved_nodes, 
+                self.xl, 
+                self.yl, 
+                self.xh, 
+                self.yh, 
+                self.site_width, 
+                self.row_height, 
+                self.num_terminals, 
+                self.num_movable_nodes, 
+                self.num_threads, 
+                self.max_num_violations, 
+                self.row_index
                 )
+        if legal: 
+            self.last_pos = pos_cpu.clone()
+        else: 
+            # unmoved violations would be hidden from later calls 
+            self.row_index.clear()
+            self.last_pos = None 
+        return legal
@@ -20,7 +20,9 @@ bool legality_check_forward(
         double xl, double yl, double xh, double yh,
         double site_width, double row_height, 
         const int num_fixed_nodes, 
-        const int num_movable_nodes
+        const int num_movable_nodes, 
+        int num_threads, 
+        int max_num_violations
         )
 {
     CHECK_FLAT(pos); 
@@ -42,7 +44,9 @@ bool legality_check_forward(
                     site_width, row_height, 
                     num_movable_nodes + num_fixed_nodes, ///< movable and fixed cells 
                     num_movable_nodes, 
-                    flat_region_boxes_start.numel() - 1
+                    flat_region_boxes_start.numel() - 1, 
+                    num_threads, 
+                    max_num_violations
                     );
             });
     timer_stop = get_globaltime(); 
@@ -51,8 +55,126 @@ bool legality_check_forward(
     return legal_flag; 
 }
 
+/// @brief check legality and report violations 
+/// @return a tensor of the first max_num_violations violations, each row is (type, node_id, other_node_id, row_id) 
+/// with type defined by LegalityViolation::Type, and the total number of violations 
+std::vector<at::Tensor> legality_check_report(
+        at::Tensor pos, 
+        at::Tensor node_size_x, at::Tensor node_size_y, 
+        at::Tensor flat_region_boxes, at::Tensor flat_region_boxes_start, at::Tensor node2fence_region_map, 
+        double xl, double yl, double xh, double yh,
+        double site_width, double row_height, 
+        const int num_fixed_nodes, 
+        const int num_movable_nodes, 
+        int num_threads, 
+        int max_num_violations
+        )
+{
+    CHECK_FLAT(pos); 
+    CHECK_EVEN(pos);
+    CHECK_CONTIGUOUS(pos);
+
+    int num_nodes = pos.numel() / 2; 
+    LegalityViolationList violations (max_num_violations); 
+
+    DREAMPLACE_DISPATCH_FLOATING_TYPES(pos.type(), "legalityCheckKernelCPU", [&] {
+            legalityCheckKernelCPU<scalar_t>(
+                    pos.data<scalar_t>(), pos.data<scalar_t>() + num_nodes, 
+                    node_size_x.data<scalar_t>(), node_size_y.data<scalar_t>(), 
+                    flat_region_boxes.data<scalar_t>(), flat_region_boxes_start.data<int>(), node2fence_region_map.data<int>(), 
+                    xl, yl, xh, yh,
+                    site_width, row_height, 
+                    num_movable_nodes + num_fixed_nodes, ///< movable and fixed cells 
+                    num_movable_nodes, 
+                    flat_region_boxes_start.numel() - 1, 
+                    num_threads, 
+                    violations
+                    );
+            });
+
+    int num_recorded = violations.violations().size(); 
+    at::Tensor report = at::zeros({num_recorded, 4}, at::CPU(at::kInt)); 
+    auto report_a = report.accessor<int, 2>(); 
+    for (int i = 0; i < num_recorded; ++i)
+    {
+        LegalityViolation const& violation = violations.violations()[i]; 
+        report_a[i][0] = violation.type; 
+        report_a[i][1] = violation.node_id; 
+        report_a[i][2] = violation.other_node_id; 
+        report_a[i][3] = violation.row_id; 
+    }
+    at::Tensor num_violations = at::zeros({1}, at::CPU(at::kLong)); 
+    num_violations.fill_((int64_t)violations.numViolations()); 
+
+    return {report, num_violations}; 
+}
+
+/// @brief incremental legality check restricted to moved nodes 
+/// @param moved_nodes nodes moved since the last check with the same index 
+/// @param index persistent row index, built and checked from scratch if empty 
+bool legality_check_incremental(
+        at::Tensor pos, 
+        at::Tensor node_size_x, at::Tensor node_size_y, 
+        at::Tensor flat_region_boxes, at::Tensor flat_region_boxes_start, at::Tensor node2fence_region_map, 
+        at::Tensor moved_nodes, 
+        double xl, double yl, double xh, double yh,
+        double site_width, double row_height, 
+        const int num_fixed_nodes, 
+        const int num_movable_nodes, 
+        int num_threads, 
+        int max_num_violations, 
+        LegalityCheckRowIndex& index 
+        )
+{
+    CHECK_FLAT(pos); 
+    CHECK_EVEN(pos);
+    CHECK_CONTIGUOUS(pos);
+    CHECK_FLAT(moved_nodes); 
+    CHECK_CONTIGUOUS(moved_nodes);
+
+    int num_nodes = pos.numel() / 2; 
+    bool legal_flag = true; 
+    LegalityViolationList violations (max_num_violations); 
+
+    hr_clock_rep timer_start, timer_stop; 
+    timer_start = get_globaltime(); 
+    DREAMPLACE_DISPATCH_FLOATING_TYPES(pos.type(), "legalityCheckIncrementalKernelCPU", [&] {
+            legal_flag = legalityCheckIncrementalKernelCPU<scalar_t>(
+                    pos.data<scalar_t>(), pos.data<scalar_t>() + num_nodes, 
+                    node_size_x.data<scalar_t>(), node_size_y.data<scalar_t>(), 
+                    flat_region_boxes.data<scalar_t>(), flat_region_boxes_start.data<int>(), node2fence_region_map.data<int>(), 
+                    xl, yl, xh, yh,
+                    site_width, row_height, 
+                    num_movable_nodes + num_fixed_nodes, ///< movable and fixed cells 
+                    num_movable_nodes, 
+                    flat_region_boxes_start.numel() - 1, 
+                    moved_nodes.data<int>(), moved_nodes.numel(), 
+                    num_threads, 
+                    index, 
+                    violations
+                    );
+            printLegalityViolations(
+                    pos.data<scalar_t>(), pos.data<scalar_t>() + num_nodes, 
+                    node_size_x.data<scalar_t>(), node_size_y.data<scalar_t>(), 
+                    (scalar_t)yl, (scalar_t)row_height, 
+                    violations
+                    ); 
+            });
+    timer_stop = get_globaltime(); 
+    dreamplacePrint(kINFO, "Incremental legality check of %d moved nodes takes %g ms\n", (int)moved_nodes.numel(), (timer_stop-timer_start)*get_timer_period());
+
+    return legal_flag; 
+}
+
 DREAMPLACE_END_NAMESPACE
 
 PYBIND11_MODULE(TORCH_EXTENSION_NAME, m) {
   m.def("forward", &DREAMPLACE_NAMESPACE::legality_check_forward, "Legality check forward");
+  m.def("report", &DREAMPLACE_NAMESPACE::legality_check_report, "Legality check with violation report");
+  m.def("incremental", &DREAMPLACE_NAMESPACE::legality_check_incremental, "Incremental legality check of moved nodes");
+  pybind11::class_<DREAMPLACE_NAMESPACE::LegalityCheckRowIndex>(m, "RowIndex")
+      .def(pybind11::init<>())
+      .def("empty", &DREAMPLACE_NAMESPACE::LegalityCheckRowIndex::empty)
+      .def("clear", &DREAMPLACE_NAMESPACE::LegalityCheckRowIndex::clear)
+      ;
 }
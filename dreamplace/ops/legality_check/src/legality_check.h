@@ -11,6 +11,7 @@
 #include <vector>
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include "utility/src/Msg.h"
 
 DREAMPLACE_BEGIN_NAMESPACE
@@ -37,113 +38,171 @@ struct CompareByNodeXCenter
     }
 };
 
+/// @brief a violation found by legality check 
+struct LegalityViolation
+{
+    enum Type 
+    {
+        kOutOfBoundary = 0, 
+        kMisaligned = 1, 
+        kOverlap = 2, 
+        kOutOfFence = 3
+    };
+
+    int type; ///< Type 
+    int node_id; 
+    int other_node_id; ///< the other node for overlap, -1 otherwise 
+    int row_id; ///< the row for overlap or misalignment, -1 otherwise 
+
+    LegalityViolation(int t, int i, int j, int r) : type(t), node_id(i), other_node_id(j), row_id(r) {}
+};
+
+/// @brief violations found by legality check. 
+/// Only the first max_num_violations violations are recorded, 
+/// while all of them are counted. 
+class LegalityViolationList
+{
+    public:
+        /// @param max_num_violations maximum number of violations to record 
+        explicit LegalityViolationList(int max_num_violations = 10) 
+            : m_maxNumViolations(std::max(max_num_violations, 0))
+            , m_numViolations(0)
+        {
+        }
+
+        /// @brief record a violation 
+        void add(int type, int node_id, int other_node_id = -1, int row_id = -1)
+        {
+            if ((int)m_vViolation.size() < m_maxNumViolations)
+            {
+                m_vViolation.push_back(LegalityViolation(type, node_id, other_node_id, row_id)); 
+            }
+            ++m_numViolations; 
+        }
+        /// @brief append violations of another list, 
+        /// which is found later than the ones in this list 
+        void merge(LegalityViolationList const& rhs)
+        {
+            for (std::vector<LegalityViolation>::const_iterator it = rhs.m_vViolation.begin(); 
+                    it != rhs.m_vViolation.end() && (int)m_vViolation.size() < m_maxNumViolations; ++it)
+            {
+                m_vViolation.push_back(*it); 
+            }
+            m_numViolations += rhs.m_numViolations; 
+        }
+        /// @brief whether the list is full, so later violations are only counted 
+        bool full() const {return (int)m_vViolation.size() >= m_maxNumViolations;}
+        int maxNumViolations() const {return m_maxNumViolations;}
+        /// @return total number of violations found, including unrecorded ones 
+        long numViolations() const {return m_numViolations;}
+        std::vector<LegalityViolation> const& violations() const {return m_vViolation;}
+
+    protected:
+        int m_maxNumViolations; 
+        long m_numViolations; 
+        std::vector<LegalityViolation> m_vViolation; 
+};
+
+/// @brief run check(i, list) for i in [0, n), or ids[i] if ids is not NULL, with multiple threads. 
+/// The range is split into contiguous chunks, each with its own list, 
+/// and the lists are merged in order, so the result is the same as a sequential run. 
+template <typename CheckType>
+void legalityCheckParallelFor(int n, const int* ids, int num_threads, LegalityViolationList& violations, CheckType const& check)
+{
+    num_threads = std::max(std::min(num_threads, n), 1); 
+    std::vector<LegalityViolationList> chunk_violations (num_threads, LegalityViolationList(violations.maxNumViolations())); 
+#pragma omp parallel for num_threads (num_threads) schedule(static, 1)
+    for (int t = 0; t < num_threads; ++t)
+    {
+        int first = (long)n*t/num_threads; 
+        int last = (long)n*(t+1)/num_threads; 
+        for (int i = first; i < last; ++i)
+        {
+            check((ids)? ids[i] : i, chunk_violations[t]); 
+        }
+    }
+    for (int t = 0; t < num_threads; ++t)
+    {
+        violations.merge(chunk_violations[t]); 
+    }
+}
+
 template <typename T>
-bool boundaryCheck(
+void boundaryCheck(
         const T* x, const T* y, 
         const T* node_size_x, const T* node_size_y, 
         T xl, T yl, T xh, T yh,
-        const int num_movable_nodes
+        const int num_movable_nodes, 
+        int num_threads, 
+        LegalityViolationList& violations, 
+        const int* node_ids = NULL, ///< only check these movable nodes if not NULL 
+        int num_node_ids = 0 
         )
 {
-    bool legal_flag = true; 
     // check node within boundary
-    for (int i = 0; i < num_movable_nodes; ++i)
-    {
-        T node_xl = x[i]; 
-        T node_yl = y[i];
-        T node_xh = node_xl+node_size_x[i];
-        T node_yh = node_yl+node_size_y[i];
-        if (node_xl < xl || node_xh > xh || node_yl < yl || node_yh > yh)
-        {
-            dreamplacePrint(kDEBUG, "node %d (%g, %g, %g, %g) out of boundary\n", i, node_xl, node_yl, node_xh, node_yh);
-            legal_flag = false; 
-        }
-    }
-    return legal_flag; 
+    legalityCheckParallelFor((node_ids)? num_node_ids : num_movable_nodes, node_ids, num_threads, violations, [&](int i, LegalityViolationList& list){
+            T node_xl = x[i]; 
+            T node_yl = y[i];
+            T node_xh = node_xl+node_size_x[i];
+            T node_yh = node_yl+node_size_y[i];
+            if (node_xl < xl || node_xh > xh || node_yl < yl || node_yh > yh)
+            {
+                list.add(LegalityViolation::kOutOfBoundary, i); 
+            }
+            });
 }
 
 template <typename T>
-bool siteAlignmentCheck(
+void siteAlignmentCheck(
         const T* x, const T* y, 
         const T site_width, const T row_height, 
         const T xl, const T yl, 
-        const int num_movable_nodes 
+        const int num_movable_nodes, 
+        int num_threads, 
+        LegalityViolationList& violations, 
+        const int* node_ids = NULL, ///< only check these movable nodes if not NULL 
+        int num_node_ids = 0 
         )
 {
-    bool legal_flag = true; 
     // check row and site alignment 
-    for (int i = 0; i < num_movable_nodes; ++i)
-    {
-        T node_xl = x[i]; 
-        T node_yl = y[i];
-
-        T row_id = (node_yl - yl) / row_height; 
-        T row_yl = yl + row_height * (int)row_id; 
-        T row_yh = row_yl + row_height; 
-
-        if (row_id != int(row_id))
-        {
-            dreamplacePrint(kERROR, "node %d (%g, %g) failed to align to row %d (%g, %g)\n", i, node_xl, node_yl, (int)row_id, row_yl, row_yh);
-            legal_flag = false; 
-        }
-
-        T site_id = (node_xl - xl) / site_width; 
-        if (site_id != int(site_id))
-        {
-            dreamplacePrint(kERROR, "node %d (%g, %g) failed to align to row %d (%g, %g) and site\n", i, node_xl, node_yl, (int)row_id, row_yl, row_yh);
-            legal_flag = false; 
-        }
-    }
-
-    return legal_flag; 
+    legalityCheckParallelFor((node_ids)? num_node_ids : num_movable_nodes, node_ids, num_threads, violations, [&](int i, LegalityViolationList& list){
+            T row_id = (y[i] - yl) / row_height; 
+            T site_id = (x[i] - xl) / site_width; 
+            if (row_id != int(row_id) || site_id != int(site_id))
+            {
+                list.add(LegalityViolation::kMisaligned, i, -1, (int)row_id); 
+            }
+            });
 }
 
 template <typename T>
-bool fenceRegionCheck(
+void fenceRegionCheck(
         const T* node_size_x, const T* node_size_y, 
         const T* flat_region_boxes, const int* flat_region_boxes_start, const int* node2fence_region_map, 
         const T* x, const T* y, 
         const int num_movable_nodes, 
-        const int num_regions
+        const int num_regions, 
+        int num_threads, 
+        LegalityViolationList& violations, 
+        const int* node_ids = NULL, ///< only check these movable nodes if not NULL 
+        int num_node_ids = 0 
         )
 {
-    bool legal_flag = true; 
     // check fence regions 
-    for (int i = 0; i < num_movable_nodes; ++i)
-    {
-        T node_xl = x[i]; 
-        T node_yl = y[i];
-        T node_xh = node_xl + node_size_x[i];
-        T node_yh = node_yl + node_size_y[i];
-
-        int region_id = node2fence_region_map[i]; 
-        if (region_id < num_regions)
-        {
-            int box_bgn = flat_region_boxes_start[region_id];
-            int box_end = flat_region_boxes_start[region_id + 1];
-            T node_area = (node_xh - node_xl) * (node_yh - node_yl);
-            // I assume there is no overlap between boxes of a region 
-            // otherwise, preprocessing is required 
-            for (int box_id = box_bgn; box_id < box_end; ++box_id)
-            {
-                int box_offset = box_id*4; 
-                T box_xl = flat_region_boxes[box_offset];
-                T box_yl = flat_region_boxes[box_offset + 1];
-                T box_xh = flat_region_boxes[box_offset + 2];
-                T box_yh = flat_region_boxes[box_offset + 3];
-
-                T dx = std::max(std::min(node_xh, box_xh) - std::max(node_xl, box_xl), (T)0); 
-                T dy = std::max(std::min(node_yh, box_yh) - std::max(node_yl, box_yl), (T)0); 
-                T overlap = dx*dy; 
-                if (overlap > 0)
-                {
-                    node_area -= overlap; 
-                }
-            }
-            if (node_area > 0) // not consumed by boxes within a region 
+    legalityCheckParallelFor((node_ids)? num_node_ids : num_movable_nodes, node_ids, num_threads, violations, [&](int i, LegalityViolationList& list){
+            T node_xl = x[i]; 
+            T node_yl = y[i];
+            T node_xh = node_xl + node_size_x[i];
+            T node_yh = node_yl + node_size_y[i];
+
+            int region_id = node2fence_region_map[i]; 
+            if (region_id < num_regions)
             {
-                dreamplacePrint(kERROR, "node %d (%g, %g, %g, %g), out of fence region %d", 
-                        i, node_xl, node_yl, node_xh, node_yh, region_id);
+                int box_bgn = flat_region_boxes_start[region_id];
+                int box_end = flat_region_boxes_start[region_id + 1];
+                T node_area = (node_xh - node_xl) * (node_yh - node_yl);
+                // I assume there is no overlap between boxes of a region 
+                // otherwise, preprocessing is required 
                 for (int box_id = box_bgn; box_id < box_end; ++box_id)
                 {
                     int box_offset = box_id*4; 
@@ -152,154 +211,202 @@ bool fenceRegionCheck(
                     T box_xh = flat_region_boxes[box_offset + 2];
                     T box_yh = flat_region_boxes[box_offset + 3];
 
-                    dreamplacePrint(kNONE, " (%g, %g, %g, %g)", box_xl, box_yl, box_xh, box_yh);
+                    T dx = std::max(std::min(node_xh, box_xh) - std::max(node_xl, box_xl), (T)0); 
+                    T dy = std::max(std::min(node_yh, box_yh) - std::max(node_yl, box_yl), (T)0); 
+                    T overlap = dx*dy; 
+                    if (overlap > 0)
+                    {
+                        node_area -= overlap; 
+                    }
+                }
+                if (node_area > 0) // not consumed by boxes within a region 
+                {
+                    list.add(LegalityViolation::kOutOfFence, i); 
                 }
-                dreamplacePrint(kNONE, "\n");
-                legal_flag = false; 
             }
+            });
+}
+
+/// @brief an interval of a node in a row 
+template <typename T>
+struct LegalityCheckInterval
+{
+    T xl; 
+    T xh; 
+    int node_id; 
+
+    bool operator<(LegalityCheckInterval const& rhs) const 
+    {
+        return xl < rhs.xl || (xl == rhs.xl && node_id < rhs.node_id); 
+    }
+};
+
+/// @brief compute rows overlapping with a node, [row_idxl, row_idxh) 
+template <typename T>
+inline void legalityCheckRowRange(T node_yl, T node_size_y, T yl, T row_height, int num_rows, int& row_idxl, int& row_idxh)
+{
+    T node_yh = node_yl+node_size_y; 
+    row_idxl = std::max((int)floor((node_yl-yl)/row_height), 0); 
+    row_idxh = std::min((int)ceil((node_yh-yl)/row_height), num_rows); 
+    // zero-height nodes do not overlap with rows 
+    if (!(node_yh > node_yl))
+    {
+        row_idxh = row_idxl; 
+    }
+}
+
+/// @brief detect overlaps in a row from intervals sorted by left edges. 
+/// Keep the interval reaching furthest to the right among all nodes and among movable nodes. 
+/// A movable node overlaps with any previous node if it starts before the former, 
+/// and a fixed node overlaps with a previous movable node if it starts before the latter. 
+/// Overlaps between two fixed nodes are ignored. 
+template <typename T>
+void sweepRowOverlaps(
+        const LegalityCheckInterval<T>* first, const LegalityCheckInterval<T>* last, 
+        const int num_movable_nodes, 
+        int row_id, 
+        LegalityViolationList& violations 
+        )
+{
+    const LegalityCheckInterval<T>* furthest = NULL; 
+    const LegalityCheckInterval<T>* furthest_movable = NULL; 
+    for (const LegalityCheckInterval<T>* it = first; it != last; ++it)
+    {
+        bool movable = (it->node_id < num_movable_nodes); 
+        const LegalityCheckInterval<T>* prev = (movable)? furthest : furthest_movable; 
+        if (prev && prev->xh > it->xl) // detect overlap 
+        {
+            violations.add(LegalityViolation::kOverlap, prev->node_id, it->node_id, row_id); 
+        }
+        if (!furthest || it->xh > furthest->xh)
+        {
+            furthest = it; 
+        }
+        if (movable && (!furthest_movable || it->xh > furthest_movable->xh))
+        {
+            furthest_movable = it; 
         }
     }
-    return legal_flag; 
 }
 
+/// @brief check overlap with a sweep over sorted intervals in each row. 
+/// Rows are processed in parallel. 
+/// The memory is linear to the number of node-row pairs instead of the number of sites. 
 template <typename T>
-bool overlapCheck(
+void overlapCheck(
         const T* node_size_x, const T* node_size_y, 
         const T* x, const T* y, 
         T row_height, 
         T xl, T yl, T xh, T yh,
         const int num_nodes, 
-        const int num_movable_nodes
+        const int num_movable_nodes, 
+        int num_threads, 
+        LegalityViolationList& violations 
         )
 {
-    bool legal_flag = true; 
     int num_rows = ceil((yh-yl)/row_height);
     dreamplaceAssert(num_rows > 0); 
-    std::vector<std::vector<int> > row_nodes (num_rows);
 
-    // general to node and fixed boxes 
-    auto getXL = [&](int id) {
-        return x[id];
-    };
-    auto getYL = [&](int id) {
-        return y[id];
-    };
-    auto getXH = [&](int id) {
-        return x[id] + node_size_x[id];
-    };
-    auto getYH = [&](int id) {
-        return y[id] + node_size_y[id];
+    auto getRowRange = [&](int id, int& row_idxl, int& row_idxh){
+        legalityCheckRowRange(y[id], node_size_y[id], yl, row_height, num_rows, row_idxl, row_idxh); 
     };
-    // add a box to row 
-    auto addBox2Row = [&](int id, T bxl, T byl, T bxh, T byh){
-        int row_idxl = (byl-yl)/row_height; 
-        int row_idxh = ceil((byh-yl)/row_height)+1;
-        row_idxl = std::max(row_idxl, 0); 
-        row_idxh = std::min(row_idxh, num_rows); 
 
+    // distribute nodes to rows in a CSR map 
+    std::vector<int> row_start (num_rows+1, 0); 
+#pragma omp parallel for num_threads (num_threads)
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        int row_idxl, row_idxh; 
+        getRowRange(i, row_idxl, row_idxh); 
         for (int row_id = row_idxl; row_id < row_idxh; ++row_id)
         {
-            T row_yl = yl+row_id*row_height; 
-            T row_yh = row_yl+row_height; 
-
-            if (byl < row_yh && byh > row_yl) // overlap with row 
-            {
-                row_nodes[row_id].push_back(id); 
-            }
+#pragma omp atomic 
+            row_start[row_id+1] += 1; 
         }
-    };
-    // distribute movable cells to rows 
-    for (int i = 0; i < num_nodes; ++i)
-    {
-        T node_xl = x[i]; 
-        T node_yl = y[i];
-        T node_xh = node_xl+node_size_x[i];
-        T node_yh = node_yl+node_size_y[i];
-
-        addBox2Row(i, node_xl, node_yl, node_xh, node_yh); 
     }
-
-    // sort cells within rows 
     for (int i = 0; i < num_rows; ++i)
     {
-        auto& nodes_in_row = row_nodes.at(i);
-        // using left edge 
-        std::sort(nodes_in_row.begin(), nodes_in_row.end(), 
-                [&](int node_id1, int node_id2){
-                    T x1 = getXL(node_id1);
-                    T x2 = getXL(node_id2);
-                    return x1 < x2 || (x1 == x2 && (node_id1 < node_id2));
-                });
-        // After sorting by left edge, 
-        // there is a special case for fixed cells where 
-        // one fixed cell is completely within another in a row. 
-        // This will cause failure to detect some overlaps. 
-        // We need to remove the "small" fixed cell that is inside another. 
-        if (!nodes_in_row.empty())
+        row_start[i+1] += row_start[i]; 
+    }
+    std::vector<LegalityCheckInterval<T> > row_intervals (row_start.back()); 
+    std::vector<int> row_fill (row_start.begin(), row_start.end()-1); 
+#pragma omp parallel for num_threads (num_threads)
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        int row_idxl, row_idxh; 
+        getRowRange(i, row_idxl, row_idxh); 
+        for (int row_id = row_idxl; row_id < row_idxh; ++row_id)
         {
-            std::vector<int> tmp_nodes; 
-            tmp_nodes.reserve(nodes_in_row.size());
-            tmp_nodes.push_back(nodes_in_row.front()); 
-            for (int j = 1, je = nodes_in_row.size(); j < je; ++j)
-            {
-                int node_id1 = nodes_in_row.at(j-1);
-                int node_id2 = nodes_in_row.at(j);
-                // two fixed cells 
-                if (node_id1 >= num_movable_nodes && node_id2 >= num_movable_nodes)
-                {
-                    T xh1 = getXH(node_id1); 
-                    T xh2 = getXH(node_id2); 
-                    if (xh1 < xh2)
-                    {
-                        tmp_nodes.push_back(node_id2);
-                    }
-                }
-                else 
-                {
-                    tmp_nodes.push_back(node_id2);
-                }
-            }
-            nodes_in_row.swap(tmp_nodes);
+            int pos; 
+#pragma omp atomic capture 
+            pos = row_fill[row_id]++; 
+            LegalityCheckInterval<T>& interval = row_intervals[pos]; 
+            interval.xl = x[i]; 
+            interval.xh = x[i]+node_size_x[i]; 
+            interval.node_id = i; 
         }
     }
 
-    // check overlap 
-    for (int i = 0; i < num_rows; ++i)
+    // sort intervals by left edge and sweep 
+    legalityCheckParallelFor(num_rows, NULL, num_threads, violations, [&](int row_id, LegalityViolationList& list){
+            LegalityCheckInterval<T>* first = row_intervals.data()+row_start[row_id]; 
+            LegalityCheckInterval<T>* last = row_intervals.data()+row_start[row_id+1]; 
+            std::sort(first, last); 
+            sweepRowOverlaps(first, last, num_movable_nodes, row_id, list); 
+            });
+}
+
+/// @brief print recorded violations and the number of unrecorded ones 
+template <typename T>
+void printLegalityViolations(
+        const T* x, const T* y, 
+        const T* node_size_x, const T* node_size_y, 
+        T yl, T row_height, 
+        LegalityViolationList const& violations 
+        )
+{
+    for (std::vector<LegalityViolation>::const_iterator it = violations.violations().begin(); it != violations.violations().end(); ++it)
     {
-        for (unsigned int j = 0; j < row_nodes.at(i).size(); ++j)
+        int i = it->node_id; 
+        T node_xl = x[i]; 
+        T node_yl = y[i]; 
+        T node_xh = node_xl+node_size_x[i]; 
+        T node_yh = node_yl+node_size_y[i]; 
+        switch (it->type)
         {
-            if (j > 0)
-            {
-                int node_id = row_nodes[i][j]; 
-                int prev_node_id = row_nodes[i][j-1]; 
-
-                if (node_id < num_movable_nodes || prev_node_id < num_movable_nodes) // ignore two fixed nodes
+            case LegalityViolation::kOutOfBoundary:
+                dreamplacePrint(kERROR, "node %d (%g, %g, %g, %g) out of boundary\n", i, node_xl, node_yl, node_xh, node_yh);
+                break; 
+            case LegalityViolation::kMisaligned:
+                dreamplacePrint(kERROR, "node %d (%g, %g) failed to align to row %d (%g, %g) and site\n", i, node_xl, node_yl, 
+                        it->row_id, yl+it->row_id*row_height, yl+(it->row_id+1)*row_height);
+                break; 
+            case LegalityViolation::kOverlap:
                 {
-                    T prev_xl = getXL(prev_node_id); 
-                    T prev_yl = getYL(prev_node_id); 
-                    T prev_xh = getXH(prev_node_id); 
-                    T prev_yh = getYH(prev_node_id); 
-                    T cur_xl = getXL(node_id); 
-                    T cur_yl = getYL(node_id); 
-                    T cur_xh = getXH(node_id); 
-                    T cur_yh = getYH(node_id); 
-                    if (prev_xh > cur_xl) // detect overlap 
-                    {
-                        dreamplacePrint(kERROR, "row %d, overlap node %d (%g, %g, %g, %g) with node %d (%g, %g, %g, %g)\n", 
-                                i, 
-                                prev_node_id, prev_xl, prev_yl, prev_xh, prev_yh, 
-                                node_id, cur_xl, cur_yl, cur_xh, cur_yh 
-                              );
-                        legal_flag = false; 
-                    }
+                    int j = it->other_node_id; 
+                    dreamplacePrint(kERROR, "row %d, overlap node %d (%g, %g, %g, %g) with node %d (%g, %g, %g, %g)\n", 
+                            it->row_id, 
+                            i, node_xl, node_yl, node_xh, node_yh, 
+                            j, x[j], y[j], x[j]+node_size_x[j], y[j]+node_size_y[j]
+                            );
                 }
-            }
+                break; 
+            case LegalityViolation::kOutOfFence:
+                dreamplacePrint(kERROR, "node %d (%g, %g, %g, %g) out of fence region\n", i, node_xl, node_yl, node_xh, node_yh);
+                break; 
+            default:
+                break; 
         }
     }
-
-    return legal_flag; 
+    if (violations.numViolations() > (long)violations.violations().size())
+    {
+        dreamplacePrint(kERROR, "%ld violations in total, only the first %lu are reported\n", 
+                violations.numViolations(), violations.violations().size());
+    }
 }
 
+/// @brief collect violations of boundary, alignment, overlap and fence regions in this order 
+/// @return true if legal 
 template <typename T>
 bool legalityCheckKernelCPU(
         const T* x, const T* y, 
@@ -309,154 +416,359 @@ bool legalityCheckKernelCPU(
         T site_width, T row_height, 
         const int num_nodes, ///< movable and fixed cells 
         const int num_movable_nodes, 
-        const int num_regions
+        const int num_regions, 
+        int num_threads, 
+        LegalityViolationList& violations 
         )
 {
-    bool legal_flag = true; 
-    int num_rows = ceil((yh-yl)/row_height);
-    dreamplaceAssert(num_rows > 0); 
-    fflush(stdout);
-    std::vector<std::vector<int> > row_nodes (num_rows);
+    num_threads = std::max(num_threads, 1); 
 
     // check node within boundary 
-    if (!boundaryCheck(x, y, node_size_x, node_size_y, xl, yl, xh, yh, num_movable_nodes))
-    {
-        legal_flag = false; 
-    }
+    boundaryCheck(x, y, node_size_x, node_size_y, xl, yl, xh, yh, num_movable_nodes, num_threads, violations); 
 
     // check row and site alignment 
-    if (!siteAlignmentCheck(
-                x, y, 
-                site_width, row_height, 
-                xl, yl, 
-                num_movable_nodes
-                ))
-    {
-        legal_flag = false; 
-    }
-
-    if (!overlapCheck(
-                node_size_x, node_size_y, 
-                x, y, 
-                row_height, 
-                xl, yl, xh, yh, 
-                num_nodes, num_movable_nodes
-                ))
-    {
-        legal_flag = false; 
-    }
+    siteAlignmentCheck(
+            x, y, 
+            site_width, row_height, 
+            xl, yl, 
+            num_movable_nodes, 
+            num_threads, 
+            violations
+            );
+
+    overlapCheck(
+            node_size_x, node_size_y, 
+            x, y, 
+            row_height, 
+            xl, yl, xh, yh, 
+            num_nodes, num_movable_nodes, 
+            num_threads, 
+            violations
+            );
 
     // check fence regions 
-    if (!fenceRegionCheck(
-                node_size_x, node_size_y, 
-                flat_region_boxes, flat_region_boxes_start, node2fence_region_map, 
-                x, y, 
-                num_movable_nodes, 
-                num_regions
-                ))
-    {
-        legal_flag = false; 
-    }
-
-    return legal_flag;
+    fenceRegionCheck(
+            node_size_x, node_size_y, 
+            flat_region_boxes, flat_region_boxes_start, node2fence_region_map, 
+            x, y, 
+            num_movable_nodes, 
+            num_regions, 
+            num_threads, 
+            violations
+            );
+
+    return violations.numViolations() == 0;
 }
 
+/// @brief check legality and print the first max_num_violations violations 
+/// @return true if legal 
 template <typename T>
-bool legalityCheckSiteMapKernelCPU(
-        const T* init_x, const T* init_y, 
-        const T* node_size_x, const T* node_size_y, 
+bool legalityCheckKernelCPU(
         const T* x, const T* y, 
+        const T* node_size_x, const T* node_size_y, 
+        const T* flat_region_boxes, const int* flat_region_boxes_start, const int* node2fence_region_map, 
         T xl, T yl, T xh, T yh,
         T site_width, T row_height, 
-        const int num_nodes, 
-        const int num_movable_nodes
+        const int num_nodes, ///< movable and fixed cells 
+        const int num_movable_nodes, 
+        const int num_regions, 
+        int num_threads = 1, 
+        int max_num_violations = 10 
         )
 {
-    int num_rows = ceil((yh-yl))/row_height; 
-    int num_sites = ceil((xh-xl)/site_width);
-    std::vector<std::vector<unsigned char> > site_map (num_rows, std::vector<unsigned char>(num_sites, 0)); 
+    LegalityViolationList violations (max_num_violations); 
+    bool legal_flag = legalityCheckKernelCPU(
+            x, y, 
+            node_size_x, node_size_y, 
+            flat_region_boxes, flat_region_boxes_start, node2fence_region_map, 
+            xl, yl, xh, yh, 
+            site_width, row_height, 
+            num_nodes, 
+            num_movable_nodes, 
+            num_regions, 
+            num_threads, 
+            violations
+            );
+    printLegalityViolations(x, y, node_size_x, node_size_y, yl, row_height, violations); 
+    return legal_flag;
+}
 
-    // fixed macros 
-    for (int i = num_movable_nodes; i < num_nodes; ++i)
-    {
-        T node_xl = x[i]; 
-        T node_yl = y[i];
-        T node_xh = node_xl+node_size_x[i];
-        T node_yh = node_yl+node_size_y[i];
-
-        int idxl = (node_xl-xl)/site_width;
-        int idxh = ceil((node_xh-xl)/site_width)+1;
-        int idyl = (node_yl-yl)/row_height;
-        int idyh = ceil((node_yh-yl)/row_height)+1;
-        idxl = std::max(idxl, 0); 
-        idxh = std::min(idxh, num_sites); 
-        idyl = std::max(idyl, 0); 
-        idyh = std::min(idyh, num_rows);
-
-        for (int iy = idyl; iy < idyh; ++iy)
+/// @brief persistent index of nodes in each row sorted by left edges. 
+/// It allows legality check restricted to moved nodes and the rows they touch. 
+class LegalityCheckRowIndex
+{
+    public:
+        bool empty() const {return m_vRowNodes.empty();}
+        void clear() 
         {
-            for (int ix = idxl; ix < idxh; ++ix)
+            m_vRowNodes.clear(); 
+            m_vNodeRowL.clear(); 
+            m_vNodeRowH.clear(); 
+            m_vMovedFlag.clear(); 
+            m_vRowDirtyId.clear(); 
+        }
+        int numRows() const {return m_vRowNodes.size();}
+        int numNodes() const {return m_vNodeRowL.size();}
+        /// @return nodes in a row sorted by left edges 
+        std::vector<int> const& rowNodes(int row_id) const {return m_vRowNodes[row_id];}
+
+        /// @brief build the index from scratch 
+        template <typename T>
+        void build(
+                const T* x, const T* y, 
+                const T* node_size_y, 
+                T yl, T yh, T row_height, 
+                const int num_nodes, 
+                int num_threads 
+                )
+        {
+            int num_rows = ceil((yh-yl)/row_height);
+            dreamplaceAssert(num_rows > 0); 
+            m_vRowNodes.assign(num_rows, std::vector<int>()); 
+            m_vNodeRowL.resize(num_nodes); 
+            m_vNodeRowH.resize(num_nodes); 
+            m_vMovedFlag.assign(num_nodes, 0); 
+            m_vRowDirtyId.assign(num_rows, 0); 
+
+#pragma omp parallel for num_threads (num_threads)
+            for (int i = 0; i < num_nodes; ++i)
             {
-                T site_xl = xl+ix*site_width; 
-                T site_xh = site_xl+site_width;
-                T site_yl = yl+iy*row_height;
-                T site_yh = site_yl+row_height;
-
-                if (node_xl < site_xh && node_xh > site_xl 
-                        && node_yl < site_yh && node_yh > site_yl) // overlap 
+                legalityCheckRowRange(y[i], node_size_y[i], yl, row_height, num_rows, m_vNodeRowL[i], m_vNodeRowH[i]); 
+            }
+            for (int i = 0; i < num_nodes; ++i)
+            {
+                for (int row_id = m_vNodeRowL[i]; row_id < m_vNodeRowH[i]; ++row_id)
                 {
-                    site_map[iy][ix] = 255; 
+                    m_vRowNodes[row_id].push_back(i); 
                 }
             }
+            CompareByNodeXL<T> comp (x); 
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 16)
+            for (int row_id = 0; row_id < num_rows; ++row_id)
+            {
+                std::sort(m_vRowNodes[row_id].begin(), m_vRowNodes[row_id].end(), comp); 
+            }
         }
-    }
 
-    bool legal_flag = true; 
-    // movable cells 
-    for (int i = 0; i < num_movable_nodes; ++i)
-    {
-        T node_xl = x[i]; 
-        T node_yl = y[i];
-        T node_xh = node_xl+node_size_x[i];
-        T node_yh = node_yl+node_size_y[i];
-
-        int idxl = (node_xl-xl)/site_width;
-        int idxh = ceil((node_xh-xl)/site_width)+1;
-        int idyl = (node_yl-yl)/row_height;
-        int idyh = ceil((node_yh-yl)/row_height)+1;
-        idxl = std::max(idxl, 0); 
-        idxh = std::min(idxh, num_sites); 
-        idyl = std::max(idyl, 0); 
-        idyh = std::min(idyh, num_rows);
-
-        for (int iy = idyl; iy < idyh; ++iy)
+        /// @brief move nodes to the rows of their current positions and keep rows sorted. 
+        /// Other nodes must stay where they were at the last build or update. 
+        /// @param dirty_rows rows whose nodes changed, including rows the moved nodes leave 
+        template <typename T>
+        void update(
+                const T* x, const T* y, 
+                const T* node_size_y, 
+                T yl, T row_height, 
+                const int* moved_nodes, int num_moved_nodes, 
+                int num_threads, 
+                std::vector<int>& dirty_rows 
+                )
         {
-            for (int ix = idxl; ix < idxh; ++ix)
+            int num_rows = numRows(); 
+            dirty_rows.clear(); 
+            auto markDirty = [&](int row_id){
+                if (!m_vRowDirtyId[row_id])
+                {
+                    dirty_rows.push_back(row_id); 
+                    m_vRowDirtyId[row_id] = dirty_rows.size(); 
+                }
+            };
+            for (int k = 0; k < num_moved_nodes; ++k)
             {
-                T site_xl = xl+ix*site_width; 
-                T site_xh = site_xl+site_width;
-                T site_yl = yl+iy*row_height;
-                T site_yh = site_yl+row_height;
-
-                if (node_xl < site_xh && node_xh > site_xl 
-                        && node_yl < site_yh && node_yh > site_yl) // overlap 
+                int node_id = moved_nodes[k]; 
+                m_vMovedFlag[node_id] = 1; 
+                for (int row_id = m_vNodeRowL[node_id]; row_id < m_vNodeRowH[node_id]; ++row_id)
                 {
-                    if (site_map[iy][ix])
-                    {
-                        dreamplacePrint(kERROR, "detect overlap at site (%g, %g, %g, %g) for node %d (%g, %g, %g, %g)\n", 
-                                site_xl, site_yl, site_xh, site_yh, 
-                                i, 
-                                node_xl, node_yl, node_xh, node_yh
-                                );
-                        legal_flag = false; 
-                    }
-                    site_map[iy][ix] += 1; 
+                    markDirty(row_id); 
+                }
+                legalityCheckRowRange(y[node_id], node_size_y[node_id], yl, row_height, num_rows, m_vNodeRowL[node_id], m_vNodeRowH[node_id]); 
+                for (int row_id = m_vNodeRowL[node_id]; row_id < m_vNodeRowH[node_id]; ++row_id)
+                {
+                    markDirty(row_id); 
                 }
             }
+            // moved nodes entering each dirty row 
+            std::vector<std::vector<int> > dirty_row_moved_nodes (dirty_rows.size()); 
+            for (int k = 0; k < num_moved_nodes; ++k)
+            {
+                int node_id = moved_nodes[k]; 
+                for (int row_id = m_vNodeRowL[node_id]; row_id < m_vNodeRowH[node_id]; ++row_id)
+                {
+                    dirty_row_moved_nodes[m_vRowDirtyId[row_id]-1].push_back(node_id); 
+                }
+            }
+
+            // remaining nodes are still sorted, so merge them with sorted moved nodes 
+            CompareByNodeXL<T> comp (x); 
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 4)
+            for (unsigned int k = 0; k < dirty_rows.size(); ++k)
+            {
+                std::vector<int>& row_nodes = m_vRowNodes[dirty_rows[k]]; 
+                std::vector<int>& entering_nodes = dirty_row_moved_nodes[k]; 
+                row_nodes.erase(std::remove_if(row_nodes.begin(), row_nodes.end(), 
+                            [&](int node_id){return m_vMovedFlag[node_id];}), row_nodes.end()); 
+                std::sort(entering_nodes.begin(), entering_nodes.end(), comp); 
+                std::vector<int> merged_nodes (row_nodes.size()+entering_nodes.size()); 
+                std::merge(row_nodes.begin(), row_nodes.end(), entering_nodes.begin(), entering_nodes.end(), merged_nodes.begin(), comp); 
+                row_nodes.swap(merged_nodes); 
+            }
+
+            for (int k = 0; k < num_moved_nodes; ++k)
+            {
+                m_vMovedFlag[moved_nodes[k]] = 0; 
+            }
+            for (unsigned int k = 0; k < dirty_rows.size(); ++k)
+            {
+                m_vRowDirtyId[dirty_rows[k]] = 0; 
+            }
+            std::sort(dirty_rows.begin(), dirty_rows.end()); 
         }
+
+    protected:
+        /// compare nodes with left edges 
+        /// resolve ambiguity by index 
+        template <typename T>
+        struct CompareByNodeXL
+        {
+            const T* x; 
+
+            CompareByNodeXL(const T* xx) : x(xx) {}
+
+            bool operator()(int i, int j) const 
+            {
+                return x[i] < x[j] || (x[i] == x[j] && i < j); 
+            }
+        };
+
+        std::vector<std::vector<int> > m_vRowNodes; ///< nodes in each row sorted by left edges 
+        std::vector<int> m_vNodeRowL; ///< first row of each node 
+        std::vector<int> m_vNodeRowH; ///< last row + 1 of each node 
+        std::vector<unsigned char> m_vMovedFlag; ///< temporary flags of moved nodes for update 
+        std::vector<int> m_vRowDirtyId; ///< temporary, index in dirty rows + 1 for update, 0 if not dirty 
+};
+
+/// @brief incremental legality check with a persistent row index. 
+/// If the index is empty, it is built and all nodes are checked. 
+/// Otherwise, only moved nodes are checked for boundary, alignment and fence regions, 
+/// and overlaps are only checked in the rows they touch. 
+/// Violations only involving nodes that did not move are not reported outside these rows, 
+/// so the previous placement is expected to be legal. 
+/// @param moved_nodes nodes moved since the last check, 
+/// where nodes other than movable and fixed cells are ignored 
+/// @return true if no violation is found 
+template <typename T>
+bool legalityCheckIncrementalKernelCPU(
+        const T* x, const T* y, 
+        const T* node_size_x, const T* node_size_y, 
+        const T* flat_region_boxes, const int* flat_region_boxes_start, const int* node2fence_region_map, 
+        T xl, T yl, T xh, T yh,
+        T site_width, T row_height, 
+        const int num_nodes, ///< movable and fixed cells 
+        const int num_movable_nodes, 
+        const int num_regions, 
+        const int* moved_nodes, int num_moved_nodes, 
+        int num_threads, 
+        LegalityCheckRowIndex& index, 
+        LegalityViolationList& violations 
+        )
+{
+    num_threads = std::max(num_threads, 1); 
+
+    std::vector<int> rows; 
+    // movable nodes to check, all movable nodes if NULL 
+    const int* node_ids = NULL; 
+    std::vector<int> moved_movable_nodes; 
+    if (index.empty() || index.numNodes() != num_nodes)
+    {
+        index.build(x, y, node_size_y, yl, yh, row_height, num_nodes, num_threads); 
+        rows.resize(index.numRows()); 
+        for (int i = 0; i < index.numRows(); ++i)
+        {
+            rows[i] = i; 
+        }
+    }
+    else 
+    {
+        // the index only covers movable and fixed cells, 
+        // so terminal NIs and fillers are dropped, and each node is updated once 
+        std::vector<int> moved_indexed_nodes; 
+        moved_indexed_nodes.reserve(num_moved_nodes); 
+        for (int k = 0; k < num_moved_nodes; ++k)
+        {
+            if (moved_nodes[k] >= 0 && moved_nodes[k] < num_nodes)
+            {
+                moved_indexed_nodes.push_back(moved_nodes[k]); 
+            }
+        }
+        std::sort(moved_indexed_nodes.begin(), moved_indexed_nodes.end()); 
+        moved_indexed_nodes.erase(std::unique(moved_indexed_nodes.begin(), moved_indexed_nodes.end()), moved_indexed_nodes.end()); 
+        index.update(x, y, node_size_y, yl, row_height, moved_indexed_nodes.data(), moved_indexed_nodes.size(), num_threads, rows); 
+        for (auto node_id : moved_indexed_nodes)
+        {
+            if (node_id < num_movable_nodes)
+            {
+                moved_movable_nodes.push_back(node_id); 
+            }
+        }
+        node_ids = moved_movable_nodes.data(); 
     }
+    int num_node_ids = moved_movable_nodes.size(); 
+
+    boundaryCheck(x, y, node_size_x, node_size_y, xl, yl, xh, yh, num_movable_nodes, num_threads, violations, node_ids, num_node_ids); 
+    siteAlignmentCheck(x, y, site_width, row_height, xl, yl, num_movable_nodes, num_threads, violations, node_ids, num_node_ids); 
+    legalityCheckParallelFor(rows.size(), rows.data(), num_threads, violations, [&](int row_id, LegalityViolationList& list){
+            std::vector<int> const& row_nodes = index.rowNodes(row_id); 
+            std::vector<LegalityCheckInterval<T> > intervals (row_nodes.size()); 
+            for (unsigned int k = 0; k < row_nodes.size(); ++k)
+            {
+                int node_id = row_nodes[k]; 
+                intervals[k].xl = x[node_id]; 
+                intervals[k].xh = x[node_id]+node_size_x[node_id]; 
+                intervals[k].node_id = node_id; 
+            }
+            sweepRowOverlaps(intervals.data(), intervals.data()+intervals.size(), num_movable_nodes, row_id, list); 
+            });
+    fenceRegionCheck(
+            node_size_x, node_size_y, 
+            flat_region_boxes, flat_region_boxes_start, node2fence_region_map, 
+            x, y, 
+            num_movable_nodes, 
+            num_regions, 
+            num_threads, 
+            violations, 
+            node_ids, num_node_ids
+            );
+
+    return violations.numViolations() == 0; 
+}
 
-    return legal_flag; 
+/// @brief check overlap between nodes. 
+/// It used to be implemented with a map of all sites, 
+/// which is now replaced by the interval-based overlapCheck. 
+template <typename T>
+bool legalityCheckSiteMapKernelCPU(
+        const T* init_x, const T* init_y, 
+        const T* node_size_x, const T* node_size_y, 
+        const T* x, const T* y, 
+        T xl, T yl, T xh, T yh,
+        T site_width, T row_height, 
+        const int num_nodes, 
+        const int num_movable_nodes, 
+        int num_threads = 1, 
+        int max_num_violations = 10 
+        )
+{
+    LegalityViolationList violations (max_num_violations); 
+    overlapCheck(
+            node_size_x, node_size_y, 
+            x, y, 
+            row_height, 
+            xl, yl, xh, yh, 
+            num_nodes, num_movable_nodes, 
+            num_threads, 
+            violations
+            );
+    printLegalityViolations(x, y, node_size_x, node_size_y, yl, row_height, violations); 
+    return violations.numViolations() == 0; 
 }
 
 DREAMPLACE_END_NAMESPACE
@@ -33,7 +33,8 @@ class MacroLegalizeFunction(Function):
           num_bins_y, 
           num_movable_nodes, 
           num_terminal_NIs, 
-          num_filler_nodes
+          num_filler_nodes, 
+          num_threads
           ):
         if pos.is_cuda:
             output = macro_legalize_cpp.forward(
@@ -54,7 +55,8 @@ class MacroLegalizeFunction(Function):
                     num_bins_y, 
                     num_movable_nodes, 
                     num_terminal_NIs, 
-                    num_filler_nodes
+                    num_filler_nodes, 
+                    num_threads
                     ).cuda()
         else:
             output = macro_legalize_cpp.forward(
@@ -75,7 +77,8 @@ class MacroLegalizeFunction(Function):
                     num_bins_y, 
                     num_movable_nodes, 
                     num_terminal_NIs, 
-                    num_filler_nodes
+                    num_filler_nodes, 
+                    num_threads
                     )
         return output
 
@@ -84,7 +87,7 @@ class MacroLegalize(object):
     """
     def __init__(self, node_size_x, node_size_y, 
             flat_region_boxes, flat_region_boxes_start, node2fence_region_map, 
-            xl, yl, xh, yh, site_width, row_height, num_bins_x, num_bins_y, num_movable_nodes, num_terminal_NIs, num_filler_nodes):
+            xl, yl, xh, yh, site_width, row_height, num_bins_x, num_bins_y, num_movable_nodes, num_terminal_NIs, num_filler_nodes, num_threads=8):
         super(MacroLegalize, self).__init__()
         self.node_size_x = node_size_x
         self.node_size_y = node_size_y
@@ -102,6 +105,7 @@ class MacroLegalize(object):
         self.num_movable_nodes = num_movable_nodes
         self.num_terminal_NIs = num_terminal_NIs
         self.num_filler_nodes = num_filler_nodes
+        self.num_threads = num_threads
     def __call__(self, init_pos, pos): 
         """ 
         @param init_pos the reference position for displacement minization
@@ -126,4 +130,5 @@ class MacroLegalize(object):
                 num_movable_nodes=self.num_movable_nodes, 
                 num_terminal_NIs=self.num_terminal_NIs, 
                 num_filler_nodes=self.num_filler_nodes, 
+                num_threads=self.num_threads
                 )
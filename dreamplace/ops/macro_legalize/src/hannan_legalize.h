@@ -9,6 +9,8 @@
 
 #include <vector>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include "utility/src/diamond_search.h"
 
 DREAMPLACE_BEGIN_NAMESPACE
@@ -126,108 +128,155 @@ class HannanGrids
         std::vector<T> m_coordy; ///< coordinates of grid lines in y direction
 };
 
-/// @brief A class models binary maps on Hannan grids. 
+/// @brief A uniform bin grid of rectangles for overlap queries. 
+/// Each rectangle is recorded in all bins it covers, 
+/// so a query only scans rectangles in the bins of the query window. 
+/// Queries are read-only and can run concurrently. 
 template <typename T>
-class HannanGridMap : public HannanGrids<T>
+class RectangleBinIndex
 {
     public:
-        typedef HannanGrids<T> base_type;
+        RectangleBinIndex(const T xl, const T yl, const T xh, const T yh, int num_bins_x, int num_bins_y)
+            : m_xl(xl)
+            , m_yl(yl)
+            , m_numBinsX(std::max(num_bins_x, 1))
+            , m_numBinsY(std::max(num_bins_y, 1))
+        {
+            m_binSizeX = std::max((xh-xl)/m_numBinsX, std::numeric_limits<T>::epsilon()); 
+            m_binSizeY = std::max((yh-yl)/m_numBinsY, std::numeric_limits<T>::epsilon()); 
+            m_vBinRects.resize(m_numBinsX*m_numBinsY); 
+        }
 
-        HannanGridMap(const T* x, const T* y, const T* width, const T* height, std::size_t n, 
-                const T xl, const T yl, const T xh, const T yh, 
-                const T spacing_x, const T spacing_y)
-            : base_type(x, y, width, height, n, xl, yl, xh, yh, spacing_x, spacing_y)
+        /// @brief add a rectangle, empty ones are ignored 
+        void add(T xl, T yl, T xh, T yh) 
         {
-            // construct 2D binary map 
-            m_map.assign(this->dim_x()*this->dim_y(), 0);
-            // the right and top boundary should always be occupied 
-            for (std::size_t ix = 0; ix < this->dim_x(); ++ix)
+            if (!(xl < xh && yl < yh))
             {
-                set(ix, this->dim_y()-1, 1);
+                return; 
             }
-            for (std::size_t iy = 0; iy < this->dim_y(); ++iy)
+            int id = m_vRect.size(); 
+            m_vRect.push_back(Rectangle(xl, yl, xh, yh)); 
+            int bxl = bin_x(xl); 
+            int bxh = bin_x(xh); 
+            int byl = bin_y(yl); 
+            int byh = bin_y(yh); 
+            for (int bx = bxl; bx <= bxh; ++bx)
             {
-                set(this->dim_x()-1, iy, 1);
+                for (int by = byl; by <= byh; ++by)
+                {
+                    m_vBinRects[bx*m_numBinsY+by].push_back(id); 
+                }
             }
-            for (std::size_t i = 0; i < n; ++i)
+        }
+
+        /// @brief check whether a rectangle overlaps with any rectangle in the index. 
+        /// Touching is not considered as overlap. 
+        bool overlap(T xl, T yl, T xh, T yh) const 
+        {
+            int bxl = bin_x(xl); 
+            int bxh = bin_x(xh); 
+            int byl = bin_y(yl); 
+            int byh = bin_y(yh); 
+            for (int bx = bxl; bx <= bxh; ++bx)
             {
-                T xl = x[i];
-                T xh = xl+width[i]; 
-                T yl = y[i];
-                T yh = yl+height[i];
-                std::size_t ixl = this->grid_x(xl); 
-                std::size_t ixh = this->grid_x(xh); 
-                std::size_t iyl = this->grid_y(yl); 
-                std::size_t iyh = this->grid_y(yh); 
-
-                for (std::size_t ix = ixl; ix <= ixh; ++ix)
+                for (int by = byl; by <= byh; ++by)
                 {
-                    for (std::size_t iy = iyl; iy <= iyh; ++iy)
+                    for (auto id : m_vBinRects[bx*m_numBinsY+by])
                     {
-                        if (this->base_type::overlap(ix, iy, xl, yl, xh, yh))
+                        Rectangle const& rect = m_vRect[id]; 
+                        if (std::max(rect.xl, xl) < std::min(rect.xh, xh) 
+                                && std::max(rect.yl, yl) < std::min(rect.yh, yh))
                         {
-                            this->set(ix, iy, 1); 
+                            return true; 
                         }
                     }
                 }
             }
+            return false; 
         }
 
-        /// @brief set an entry in grid map 
-        void set(std::size_t ix, std::size_t iy, bool value) 
+    protected:
+        struct Rectangle
+        {
+            T xl, yl, xh, yh; 
+
+            Rectangle(T a, T b, T c, T d) : xl(a), yl(b), xh(c), yh(d) {}
+        };
+
+        int bin_x(T x) const 
+        {
+            return std::min(std::max((int)floor((x-m_xl)/m_binSizeX), 0), m_numBinsX-1); 
+        }
+        int bin_y(T y) const 
         {
-            m_map[ix*this->dim_y()+iy] = value; 
+            return std::min(std::max((int)floor((y-m_yl)/m_binSizeY), 0), m_numBinsY-1); 
         }
 
-        /// @brief get an entry in grid map 
-        bool at(std::size_t ix, std::size_t iy) const 
+        T m_xl; 
+        T m_yl; 
+        T m_binSizeX; 
+        T m_binSizeY; 
+        int m_numBinsX; 
+        int m_numBinsY; 
+        std::vector<Rectangle> m_vRect; ///< all rectangles 
+        std::vector<std::vector<int> > m_vBinRects; ///< rectangles in each bin 
+};
+
+/// @brief A class models occupied areas on Hannan grids. 
+/// The grids provide candidate locations, 
+/// while occupied areas are stored as rectangles in a spatial index, 
+/// so the memory does not grow with the number of grids. 
+template <typename T>
+class HannanGridMap : public HannanGrids<T>
+{
+    public:
+        typedef HannanGrids<T> base_type;
+
+        HannanGridMap(const T* x, const T* y, const T* width, const T* height, std::size_t n, 
+                const T xl, const T yl, const T xh, const T yh, 
+                const T spacing_x, const T spacing_y, 
+                std::size_t num_macros)
+            : base_type(x, y, width, height, n, xl, yl, xh, yh, spacing_x, spacing_y)
+            , m_xl(xl)
+            , m_yl(yl)
+            , m_xh(xh)
+            , m_yh(yh)
+            , m_index(xl, yl, xh, yh, num_index_bins(n+num_macros), num_index_bins(n+num_macros))
         {
-            return m_map[ix*this->dim_y()+iy];
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                add(x[i], y[i], x[i]+width[i], y[i]+height[i]);
+            }
         }
 
-        /// @brief check whether a rectangle overlaps with any grid in the map 
+        /// @brief check whether a rectangle overlaps with any occupied area or is out of the layout 
         bool overlap(T xl, T yl, T xh, T yh) const 
         {
-            std::size_t ixl = this->grid_x(xl); 
-            std::size_t ixh = this->grid_x(xh); 
-            std::size_t iyl = this->grid_y(yl); 
-            std::size_t iyh = this->grid_y(yh); 
-
-            for (std::size_t ix = ixl; ix <= ixh; ++ix)
+            if (xl < m_xl || yl < m_yl || xh > m_xh || yh > m_yh)
             {
-                for (std::size_t iy = iyl; iy <= iyh; ++iy)
-                {
-                    if (this->base_type::overlap(ix, iy, xl, yl, xh, yh) && this->at(ix, iy))
-                    {
-                        return true; 
-                    }
-                }
+                return true; 
             }
-            return false; 
+            return m_index.overlap(xl, yl, xh, yh); 
         }
 
-        /// @brief add a rectangle to the grid map 
+        /// @brief add a rectangle to the occupied areas 
         void add(T xl, T yl, T xh, T yh) 
         {
-            std::size_t ixl = this->grid_x(xl); 
-            std::size_t ixh = this->grid_x(xh); 
-            std::size_t iyl = this->grid_y(yl); 
-            std::size_t iyh = this->grid_y(yh); 
-
-            for (std::size_t ix = ixl; ix <= ixh; ++ix)
-            {
-                for (std::size_t iy = iyl; iy <= iyh; ++iy)
-                {
-                    if (this->base_type::overlap(ix, iy, xl, yl, xh, yh))
-                    {
-                        this->set(ix, iy, 1); 
-                    }
-                }
-            }
+            m_index.add(xl, yl, xh, yh); 
         }
         
     protected:
-        std::vector<unsigned char> m_map; ///< 2D map indicating whether a grid is taken or not 
+        /// @brief about one rectangle per bin in each dimension 
+        static int num_index_bins(std::size_t num_rects)
+        {
+            return std::min(std::max((int)std::sqrt((double)num_rects), 1), 1024); 
+        }
+
+        T m_xl; 
+        T m_yl; 
+        T m_xh; 
+        T m_yh; 
+        RectangleBinIndex<T> m_index; ///< spatial index of occupied areas 
 };
 
 /// @brief A greedy macro legalization algorithm manipulating on Hannan grids. 
@@ -236,9 +285,12 @@ class HannanGridMap : public HannanGrids<T>
 ///     Perfrom spiral/diamond search to the locations; 
 ///     Find the first one with minimum displacement; 
 ///     Update the grid map; 
+/// Candidate locations of a macro are evaluated in parallel in batches, 
+/// and the first legal one in the search sequence is taken, 
+/// so the result does not depend on the number of threads. 
 /// If the layout is very tight, it may not be able to find a solution. 
 template <typename T>
-void hannanLegalizeLauncher(LegalizationDB<T> db, std::vector<int>& macros)
+void hannanLegalizeLauncher(LegalizationDB<T> db, std::vector<int>& macros, int num_threads)
 {
     dreamplacePrint(kINFO, "Legalize movable macros on Hannan grids\n");
 
@@ -269,11 +321,17 @@ void hannanLegalizeLauncher(LegalizationDB<T> db, std::vector<int>& macros)
     HannanGridMap<T> grid_map (db.init_x+db.num_movable_nodes, db.init_y+db.num_movable_nodes, 
             db.node_size_x+db.num_movable_nodes, db.node_size_y+db.num_movable_nodes, db.num_nodes-db.num_movable_nodes, 
             db.xl, db.yl, db.xh, db.yh, 
-            spacing_x, spacing_y);
+            spacing_x, spacing_y, 
+            macros.size());
 
     auto search_grids = diamond_search_sequence(grid_map.dim_y(), grid_map.dim_x()); 
     dreamplacePrint(kDEBUG, "Construct %lux%lu Hannan grids, diamond search sequence %lu\n", grid_map.dim_x(), grid_map.dim_y(), search_grids.size());
 
+    num_threads = std::max(num_threads, 1); 
+    // number of candidates evaluated together, 
+    // starting small as the first candidates are usually legal 
+    const int max_batch_size = num_threads*64; 
+    std::vector<unsigned char> batch_legal (max_batch_size); 
     for (auto node_id : macros)
     {
         T node_x = db.x[node_id];
@@ -283,17 +341,18 @@ void hannanLegalizeLauncher(LegalizationDB<T> db, std::vector<int>& macros)
         std::size_t init_ix = grid_map.grid_x(node_x);
         std::size_t init_iy = grid_map.grid_y(node_y);
 
-        bool found = false; 
-        for (auto grid_offset : search_grids)
-        {
+        // compute the lower left corner of a candidate location aligned to row and site 
+        // @return false if the grid is invalid 
+        auto candidate = [&](int k, T& xl, T& yl){
+            auto const& grid_offset = search_grids[k]; 
             std::size_t ix = init_ix + grid_offset.ic;
             std::size_t iy = init_iy + grid_offset.ir;
 
             // valid grid 
             if (ix < grid_map.dim_x() && iy < grid_map.dim_y())
             {
-                T xl = grid_map.coord_x(ix);
-                T yl = grid_map.coord_y(iy);
+                xl = grid_map.coord_x(ix);
+                yl = grid_map.coord_y(iy);
                 // make sure the coordinates are aligned to row and site 
                 T aligned_xl = db.align2site(xl, width);
                 T aligned_yl = db.align2row(yl, height);
@@ -305,14 +364,32 @@ void hannanLegalizeLauncher(LegalizationDB<T> db, std::vector<int>& macros)
                 {
                     yl = aligned_yl+db.row_height;
                 }
-                T xh = xl + width;
-                T yh = yl + height; 
+                return true; 
+            }
+            return false; 
+        };
 
-                if (!grid_map.overlap(xl, yl, xh, yh))
+        bool found = false; 
+        int batch_size = num_threads; 
+        for (int batch_begin = 0, num_grids = search_grids.size(); batch_begin < num_grids && !found; batch_begin += batch_size, batch_size = std::min(batch_size*2, max_batch_size))
+        {
+            int batch_end = std::min(batch_begin+batch_size, num_grids); 
+            // small batches are not worth the parallel overhead 
+#pragma omp parallel for num_threads (num_threads) schedule(static, 8) if (batch_size > num_threads*4)
+            for (int k = batch_begin; k < batch_end; ++k)
+            {
+                T xl, yl; 
+                batch_legal[k-batch_begin] = (candidate(k, xl, yl) && !grid_map.overlap(xl, yl, xl+width, yl+height)); 
+            }
+            for (int k = batch_begin; k < batch_end; ++k)
+            {
+                if (batch_legal[k-batch_begin])
                 {
+                    T xl, yl; 
+                    candidate(k, xl, yl); 
                     db.x[node_id] = xl; 
                     db.y[node_id] = yl; 
-                    grid_map.add(xl, yl, xh, yh);
+                    grid_map.add(xl, yl, xl+width, yl+height);
                     found = true; 
                     break; 
                 }
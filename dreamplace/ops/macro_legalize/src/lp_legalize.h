@@ -8,270 +8,409 @@
 #define DREAMPLACE_MACRO_LEGALIZE_LP_LEGALIZE_H
 
 #include <vector>
+#include <numeric>
+#include <limits>
+#include <cmath>
+#include <cstdint>
 #include <limbo/solvers/DualMinCostFlow.h>
 
 DREAMPLACE_BEGIN_NAMESPACE
 
-/// @brief A linear programming (LP) based algorithm to legalize macros. 
-/// It assumes the relative order of macros are determined. 
-/// By constructing the horizontal and vertical constraint graph, 
-/// an optimization problem is formulated to minimize the total displacement. 
-/// The LP problem can be solved by dual min-cost flow algorithm. 
-/// 
-/// If the input macro solution is not legal, there is no guarantee to find a legal solution. 
-/// But if it is legal, the output should still be legal. 
+/// @brief decide whether the relative position of two macros
+/// goes to the horizontal or vertical constraint graph.
+/// The decision is symmetric to the two macros.
+/// @return true for horizontal constraint graph
 template <typename T>
-void lpLegalizeLauncher(LegalizationDB<T> db, std::vector<int>& macros)
+inline bool lpLegalizeHorizontalDecision(T xl1, T yl1, T width1, T height1, T xl2, T yl2, T width2, T height2)
 {
-    dreamplacePrint(kINFO, "Legalize movable macros with linear programming on constraint graphs\n");
-
-    // numeric type can be int, long ,double, not never use float. 
-    // It will cause incorrect results and introduce overlap. 
-    // Meanwhile, integers are recommended, as the coefficients are forced to be integers. 
-    typedef long numeric_type; 
-    typedef limbo::solvers::LinearModel<numeric_type, numeric_type> model_type;
-    typedef limbo::solvers::DualMinCostFlow<numeric_type, numeric_type> solver_type; 
-    typedef limbo::solvers::NetworkSimplex<numeric_type, numeric_type> solver_alg_type; 
+    T xh1 = xl1 + width1;
+    T yh1 = yl1 + height1;
+    T xh2 = xl2 + width2;
+    T yh2 = yl2 + height2;
+    T dx = std::max(xl1, xl2) - std::min(xh1, xh2);
+    T dy = std::max(yl1, yl2) - std::min(yh1, yh2);
 
-    char buf[64];
-    // two linear programming models represent horizontal and vertical constraint graphs
-    model_type model_hcg; 
-    model_hcg.reserveVariables(macros.size()*3); // position variables + displace variables (l, u)
-    typename model_type::expression_type obj_hcg; 
-    model_type model_vcg; 
-    model_vcg.reserveVariables(macros.size()*3); // position variables + displace variables (l, u)
-    typename model_type::expression_type obj_vcg; 
-
-    // position variables x
-    for (unsigned int i = 0, ie = macros.size(); i < ie; ++i)
+    if (dx < 0 && dy < 0) // case I: overlap
     {
-        int node_id = macros[i];
-        T width = db.node_size_x[node_id];
-        T height = db.node_size_y[node_id];
-
-        dreamplaceSPrint(kNONE, buf, "x%d", node_id);
-        model_hcg.addVariable(db.xl, db.xh-width, limbo::solvers::CONTINUOUS, buf);
-        model_vcg.addVariable(db.yl, db.yh-height, limbo::solvers::CONTINUOUS, buf);
+        // horizontal movement has better displacement
+        return fabs(dx) < fabs(dy);
     }
-    // displacement variables l = min(x, x0)
-    for (unsigned int i = 0, ie = macros.size(); i < ie; ++i)
+    else if (dx >= 0 && dy < 0) // case II: two cells intersect in y direction
     {
-        int node_id = macros[i];
-
-        dreamplaceSPrint(kNONE, buf, "l%d", node_id);
-        model_hcg.addVariable(0, db.xh, limbo::solvers::CONTINUOUS, buf);
-        model_vcg.addVariable(0, db.yh, limbo::solvers::CONTINUOUS, buf);
+        return true;
     }
-    // displacement variables u = max(x, x0)
-    for (unsigned int i = 0, ie = macros.size(); i < ie; ++i)
+    else if (dx < 0 && dy >= 0) // case III: two cells intersect in x direction
     {
-        int node_id = macros[i];
-
-        dreamplaceSPrint(kNONE, buf, "u%d", node_id);
-        model_hcg.addVariable(0, db.xh, limbo::solvers::CONTINUOUS, buf);
-        model_vcg.addVariable(0, db.yh, limbo::solvers::CONTINUOUS, buf);
+        return false;
+    }
+    else // case IV: diagonal, dx > 0 && dy > 0
+    {
+        // vertical constraint is easier to satisfy if dx < dy
+        return !(dx < dy);
     }
+}
 
-    auto add2Hcg = [&](int i, T xl1, T width1, int j, T xl2, T width2){
-        auto var1 = model_hcg.variable(i);
-        if (j < db.num_movable_nodes) // movable macro 
+/// @brief build the transitive reduction of a constraint graph in one sweep.
+/// An edge (u, v) means x_u + size_u <= x_v with nonnegative sizes,
+/// so it is implied by any other path from u to v,
+/// and removing it does not change the feasible region.
+/// Nodes are visited from the last to the first in topological order,
+/// and each node scans the later nodes in order.
+/// A later node already reachable through a kept successor is skipped without deciding the pair,
+/// so only the edges of the reduction are stored.
+/// @param order topological order of nodes
+/// @param is_edge predicate whether (u, v) is an edge, only called with u before v in the order
+/// @param successors reduced successors of each node in topological order
+/// @return number of pairs decided by the predicate
+template <typename EdgePredicate>
+inline std::size_t lpLegalizeReducedGraph(std::vector<int> const& order, EdgePredicate const& is_edge, std::vector<std::vector<int> >& successors)
+{
+    int num_nodes = order.size();
+    successors.assign(num_nodes, std::vector<int>());
+    // reachable nodes in rank, one bit per node
+    std::size_t num_words = (num_nodes+63)/64;
+    std::vector<uint64_t> reach (num_words*num_nodes, 0);
+    std::size_t num_decisions = 0;
+    for (int k = num_nodes-1; k >= 0; --k)
+    {
+        int v = order[k];
+        uint64_t* reach_v = reach.data()+k*num_words;
+        // a later node reachable through a successor with lower rank is redundant
+        for (int rw = k+1; rw < num_nodes; ++rw)
         {
-            auto var2 = model_hcg.variable(j);
-            if (xl1 < xl2)
+            if (reach_v[rw>>6] & (uint64_t(1)<<(rw&63)))
             {
-                dreamplaceAssertMsg(model_hcg.addConstraint(var1 - var2 <= -width1), "failed to add HCG constraint");
+                continue;
             }
-            else 
+            int w = order[rw];
+            ++num_decisions;
+            if (is_edge(v, w))
             {
-                dreamplaceAssertMsg(model_hcg.addConstraint(var2 - var1 <= -width2), "failed to add HCG constraint");
+                successors[v].push_back(w);
+                const uint64_t* reach_w = reach.data()+rw*num_words;
+                for (std::size_t word = (rw>>6); word < num_words; ++word)
+                {
+                    reach_v[word] |= reach_w[word];
+                }
+                reach_v[rw>>6] |= (uint64_t(1)<<(rw&63));
             }
         }
-        else // j is fixed macro 
+    }
+    return num_decisions;
+}
+
+/// @brief A linear programming (LP) based algorithm to legalize macros.
+/// It assumes the relative order of macros are determined.
+/// By constructing the horizontal and vertical constraint graph,
+/// an optimization problem is formulated to minimize the total displacement.
+/// The LP problem can be solved by dual min-cost flow algorithm.
+///
+/// Each pair of macros is constrained in either graph.
+/// Each graph is built directly as its transitive reduction by a sweep in the order of positions,
+/// which skips pairs already ordered through other macros in the graph.
+/// A visibility sweep that only links neighboring macros is not used,
+/// because a diagonal pair far apart may still be constrained in either graph by lpLegalizeHorizontalDecision,
+/// and dropping such a pair changes the feasible region, so macros may overlap after the LP.
+/// The reachability sets take n^2 bits in each direction.
+/// Constraints from fixed macros are reduced to the tightest bounds of variables
+/// by scanning fixed macros in sorted order.
+/// The LP of each graph is separable into connected components,
+/// which are solved independently in parallel.
+/// Starting from the Hannan solution,
+/// components with zero displacement are already optimal and skipped,
+/// and single macros are solved in closed form.
+///
+/// If the input macro solution is not legal, there is no guarantee to find a legal solution.
+/// But if it is legal, the output should still be legal.
+template <typename T>
+void lpLegalizeLauncher(LegalizationDB<T> db, std::vector<int>& macros, int num_threads)
+{
+    dreamplacePrint(kINFO, "Legalize movable macros with linear programming on constraint graphs\n");
+
+    // numeric type can be int, long ,double, not never use float.
+    // It will cause incorrect results and introduce overlap.
+    // Meanwhile, integers are recommended, as the coefficients are forced to be integers.
+    typedef long numeric_type;
+    typedef limbo::solvers::LinearModel<numeric_type, numeric_type> model_type;
+    typedef limbo::solvers::DualMinCostFlow<numeric_type, numeric_type> solver_type;
+    typedef limbo::solvers::NetworkSimplex<numeric_type, numeric_type> solver_alg_type;
+
+    num_threads = std::max(num_threads, 1);
+    int num_macros = macros.size();
+
+    // data of one direction, 0 for horizontal, 1 for vertical
+    struct Direction
+    {
+        const T* init_pos; ///< initial positions of nodes
+        T* pos; ///< current positions of nodes
+        const T* node_size;
+        T lower; ///< layout boundary
+        T upper; ///< layout boundary
+        std::vector<std::vector<int> > successors; ///< constraint graph on indices of macros
+        std::vector<numeric_type> lower_bounds; ///< bounds of macros
+        std::vector<numeric_type> upper_bounds; ///< bounds of macros
+    };
+    Direction dirs[2];
+    dirs[0].init_pos = db.init_x;
+    dirs[0].pos = db.x;
+    dirs[0].node_size = db.node_size_x;
+    dirs[0].lower = db.xl;
+    dirs[0].upper = db.xh;
+    dirs[1].init_pos = db.init_y;
+    dirs[1].pos = db.y;
+    dirs[1].node_size = db.node_size_y;
+    dirs[1].lower = db.yl;
+    dirs[1].upper = db.yh;
+
+    // current location of macro i, or initial location of a fixed macro
+    auto decide = [&](int i, int node_id2, T xl2, T yl2){
+        int node_id1 = macros[i];
+        return lpLegalizeHorizontalDecision(db.x[node_id1], db.y[node_id1], db.node_size_x[node_id1], db.node_size_y[node_id1],
+                xl2, yl2, db.node_size_x[node_id2], db.node_size_y[node_id2]);
+    };
+
+    // construct horizontal and vertical constraint graphs among movable macros
+    // use current locations for constraint graphs.
+    // An edge goes from a macro with smaller (position, -index) to the other.
+    std::size_t num_decisions[2] = {0, 0};
+    std::size_t num_reduced_edges[2] = {0, 0};
+#pragma omp parallel for num_threads (std::min(num_threads, 2))
+    for (int d = 0; d < 2; ++d)
+    {
+        Direction& dir = dirs[d];
+        std::vector<int> order (num_macros);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](int i, int j){
+                T p1 = dir.pos[macros[i]];
+                T p2 = dir.pos[macros[j]];
+                return p1 < p2 || (p1 == p2 && i > j);
+                });
+        num_decisions[d] = lpLegalizeReducedGraph(order, [&](int i, int j){
+                int node_id2 = macros[j];
+                return decide(i, node_id2, db.x[node_id2], db.y[node_id2]) == (d == 0);
+                }, dir.successors);
+        for (auto const& succ : dir.successors)
+        {
+            num_reduced_edges[d] += succ.size();
+        }
+    }
+    dreamplacePrint(kDEBUG, "HCG %lu edges from %lu pairs decided, VCG %lu edges from %lu pairs decided\n",
+            num_reduced_edges[0], num_decisions[0], num_reduced_edges[1], num_decisions[1]);
+
+    // constraints with fixed macros become bounds of variables.
+    // when considering fixed macros, there is no guarantee to find legal solution
+    // with current ad-hoc constraint graphs.
+    // Fixed macros are scanned in the order of positions,
+    // so the scan stops once the bound cannot be tighter.
+    for (int d = 0; d < 2; ++d)
+    {
+        Direction& dir = dirs[d];
+        std::vector<int> fixed_nodes (db.num_nodes-db.num_movable_nodes);
+        std::iota(fixed_nodes.begin(), fixed_nodes.end(), db.num_movable_nodes);
+        std::sort(fixed_nodes.begin(), fixed_nodes.end(), [&](int i, int j){
+                return dir.init_pos[i] < dir.init_pos[j] || (dir.init_pos[i] == dir.init_pos[j] && i < j);
+                });
+        // maximum upper edge of fixed macros in prefixes
+        std::vector<T> prefix_max_high (fixed_nodes.size());
+        for (unsigned int k = 0; k < fixed_nodes.size(); ++k)
         {
-            if (xl1 < xl2)
+            int node_id = fixed_nodes[k];
+            T high = dir.init_pos[node_id]+dir.node_size[node_id];
+            prefix_max_high[k] = (k)? std::max(prefix_max_high[k-1], high) : high;
+        }
+
+        dir.lower_bounds.resize(num_macros);
+        dir.upper_bounds.resize(num_macros);
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 16)
+        for (int i = 0; i < num_macros; ++i)
+        {
+            int node_id1 = macros[i];
+            T p1 = dir.pos[node_id1];
+            T size1 = dir.node_size[node_id1];
+            numeric_type lower_bound = dir.lower;
+            numeric_type upper_bound = dir.upper-size1;
+            auto match = [&](int node_id2){
+                return decide(i, node_id2, db.init_x[node_id2], db.init_y[node_id2]) == (d == 0);
+            };
+            // fixed macros at the upper side, the first matched one gives the tightest bound
+            auto first = std::upper_bound(fixed_nodes.begin(), fixed_nodes.end(), p1,
+                    [&](T p, int node_id){return p < dir.init_pos[node_id];});
+            for (auto it = first; it != fixed_nodes.end(); ++it)
             {
-                model_hcg.updateVariableUpperBound(var1, floor(xl2 - width1));
-                //dreamplacePrint(kDEBUG, "HCG: %s <= x%d (%g) - %g\n", model_hcg.variableName(var1).c_str(), j, xl2, width1);
+                if (match(*it))
+                {
+                    upper_bound = std::min(upper_bound, (numeric_type)floor(dir.init_pos[*it] - size1));
+                    break;
+                }
             }
-            else 
+            // fixed macros at the lower side
+            for (int k = std::distance(fixed_nodes.begin(), first)-1; k >= 0 && prefix_max_high[k] > lower_bound; --k)
             {
-                model_hcg.updateVariableLowerBound(var1, ceil(xl2 + width2));
-                //dreamplacePrint(kDEBUG, "HCG: %s >= x%d (%g) + %g\n", model_hcg.variableName(var1).c_str(), j, xl2, width2);
+                int node_id2 = fixed_nodes[k];
+                if (match(node_id2))
+                {
+                    lower_bound = std::max(lower_bound, (numeric_type)ceil(dir.init_pos[node_id2] + dir.node_size[node_id2]));
+                }
             }
+            dir.lower_bounds[i] = lower_bound;
+            dir.upper_bounds[i] = upper_bound;
         }
-    };
-    auto add2Vcg = [&](int i, T yl1, T height1, int j, T yl2, T height2){
-        auto var1 = model_vcg.variable(i);
-        if (j < db.num_movable_nodes) // movable macro 
+    }
+
+    // solve the LP of each connected component in each direction
+    for (int d = 0; d < 2; ++d)
+    {
+        Direction& dir = dirs[d];
+        // connected components with union-find
+        std::vector<int> parent (num_macros);
+        std::iota(parent.begin(), parent.end(), 0);
+        auto find = [&](int i){
+            while (parent[i] != i)
+            {
+                parent[i] = parent[parent[i]];
+                i = parent[i];
+            }
+            return i;
+        };
+        for (int i = 0; i < num_macros; ++i)
         {
-            auto var2 = model_vcg.variable(j);
-            if (yl1 < yl2)
+            for (auto j : dir.successors[i])
             {
-                dreamplaceAssertMsg(model_vcg.addConstraint(var1 - var2 <= -height1), "failed to add VCG constraint");
+                int ri = find(i);
+                int rj = find(j);
+                if (ri != rj)
+                {
+                    parent[std::max(ri, rj)] = std::min(ri, rj);
+                }
             }
-            else 
+        }
+        std::vector<std::vector<int> > components;
+        std::vector<int> component_id (num_macros, -1);
+        for (int i = 0; i < num_macros; ++i)
+        {
+            int r = find(i);
+            if (component_id[r] < 0)
             {
-                dreamplaceAssertMsg(model_vcg.addConstraint(var2 - var1 <= -height2), "failed to add VCG constraint");
+                component_id[r] = components.size();
+                components.push_back(std::vector<int>());
             }
+            component_id[i] = component_id[r];
+            components[component_id[i]].push_back(i);
         }
-        else // j is fixed macro 
+        // large components first for load balance
+        std::vector<int> component_order (components.size());
+        std::iota(component_order.begin(), component_order.end(), 0);
+        std::sort(component_order.begin(), component_order.end(), [&](int a, int b){
+                return components[a].size() > components[b].size() || (components[a].size() == components[b].size() && a < b);
+                });
+
+        int num_solved = 0;
+        int num_skipped = 0;
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 1) reduction(+:num_solved, num_skipped)
+        for (unsigned int c = 0; c < component_order.size(); ++c)
         {
-            if (yl1 < yl2)
+            std::vector<int> const& component = components[component_order[c]];
+            int num_vars = component.size();
+
+            // closed form for a single macro
+            if (num_vars == 1)
             {
-                model_vcg.updateVariableUpperBound(var1, floor(yl2 - height1)); 
-                //dreamplacePrint(kDEBUG, "VCG: %s <= x%d (%g) - %g\n", model_vcg.variableName(var1).c_str(), j, yl2, height1);
+                int i = component.front();
+                dreamplaceAssertMsg(dir.lower_bounds[i] <= dir.upper_bounds[i], "%s graph not solved optimally", (d == 0)? "Horizontal" : "Vertical");
+                numeric_type p0 = round(dir.init_pos[macros[i]]);
+                dir.pos[macros[i]] = std::min(std::max(p0, dir.lower_bounds[i]), dir.upper_bounds[i]);
+                continue;
             }
-            else 
+            // the current solution is optimal if it is feasible and has zero displacement
+            bool optimal = true;
+            for (int k = 0; k < num_vars && optimal; ++k)
             {
-                model_vcg.updateVariableLowerBound(var1, ceil(yl2 + height2));
-                //dreamplacePrint(kDEBUG, "VCG: %s >= x%d (%g) + %g\n", model_vcg.variableName(var1).c_str(), j, yl2, height2);
+                int i = component[k];
+                T p = dir.pos[macros[i]];
+                optimal = (p == round(dir.init_pos[macros[i]]) && p >= dir.lower_bounds[i] && p <= dir.upper_bounds[i]);
+                for (auto j : dir.successors[i])
+                {
+                    optimal = optimal && (p + dir.node_size[macros[i]] <= dir.pos[macros[j]]);
+                }
+            }
+            if (optimal)
+            {
+                ++num_skipped;
+                continue;
             }
-        }
-    };
-
-    auto process2Nodes = [&](int i, T xl1, T yl1, T width1, T height1, int j, T xl2, T yl2, T width2, T height2) {
-        T xh1 = xl1 + width1;
-        T yh1 = yl1 + height1;
-        T xh2 = xl2 + width2;
-        T yh2 = yl2 + height2;
-        T dx = std::max(xl1, xl2) - std::min(xh1, xh2);
-        T dy = std::max(yl1, yl2) - std::min(yh1, yh2);
 
-        if (dx < 0 && dy < 0) // case I: overlap
-        {
-            if (fabs(dx) < fabs(dy)) // horizontal movement has better displacement
+            char buf[64];
+            model_type model;
+            model.reserveVariables(num_vars*3); // position variables + displace variables (l, u)
+            typename model_type::expression_type obj;
+            std::vector<int> local_id (num_vars);
+            // position variables x
+            for (int k = 0; k < num_vars; ++k)
             {
-                add2Hcg(i, xl1, width1, j, xl2, width2);
+                int i = component[k];
+                dreamplaceSPrint(kNONE, buf, "x%d", macros[i]);
+                model.addVariable(dir.lower_bounds[i], dir.upper_bounds[i], limbo::solvers::CONTINUOUS, buf);
             }
-            else // vertical movement has better displacement
+            // displacement variables l = min(x, x0)
+            for (int k = 0; k < num_vars; ++k)
             {
-                add2Vcg(i, yl1, height1, j, yl2, height2);
+                dreamplaceSPrint(kNONE, buf, "l%d", macros[component[k]]);
+                model.addVariable(0, dir.upper, limbo::solvers::CONTINUOUS, buf);
             }
-        }
-        else if (dx >= 0 && dy < 0) // case II: two cells intersect in y direction
-        {
-            add2Hcg(i, xl1, width1, j, xl2, width2);
-        }
-        else if (dx < 0 && dy >= 0) // case III: two cells intersect in x direction
-        {
-            add2Vcg(i, yl1, height1, j, yl2, height2);
-        }
-        else // case IV: diagonal, dx > 0 && dy > 0
-        {
-            if (dx < dy) // vertical constraint is easier to satisfy 
+            // displacement variables u = max(x, x0)
+            for (int k = 0; k < num_vars; ++k)
             {
-                add2Vcg(i, yl1, height1, j, yl2, height2);
+                dreamplaceSPrint(kNONE, buf, "u%d", macros[component[k]]);
+                model.addVariable(0, dir.upper, limbo::solvers::CONTINUOUS, buf);
             }
-            else // horizontal constraint is easier to satisfy
+            // constraint graph, macros in a component are sorted, so local indices can be found by binary search
+            for (int k = 0; k < num_vars; ++k)
             {
-                add2Hcg(i, xl1, width1, j, xl2, width2);
+                int i = component[k];
+                auto var1 = model.variable(k);
+                for (auto j : dir.successors[i])
+                {
+                    auto var2 = model.variable(std::distance(component.begin(), std::lower_bound(component.begin(), component.end(), j)));
+                    dreamplaceAssertMsg(model.addConstraint(var1 - var2 <= -(numeric_type)dir.node_size[macros[i]]), "failed to add %s constraint", (d == 0)? "HCG" : "VCG");
+                }
             }
-        }
-    };
-
-    // construct horizontal and vertical constraint graph 
-    // use current locations for constraint graphs 
-    for (unsigned int i = 0, ie = macros.size(); i < ie; ++i)
-    {
-        int node_id1 = macros[i];
-        T xl1 = db.x[node_id1];
-        T yl1 = db.y[node_id1];
-        T width1 = db.node_size_x[node_id1];
-        T height1 = db.node_size_y[node_id1];
-        // constraints with other macros 
-        for (unsigned int j = i+1; j < ie; ++j)
-        {
-            int node_id2 = macros[j];
-            T xl2 = db.x[node_id2];
-            T yl2 = db.y[node_id2];
-            T width2 = db.node_size_x[node_id2];
-            T height2 = db.node_size_y[node_id2];
-
-            process2Nodes(i, xl1, yl1, width1, height1, j, xl2, yl2, width2, height2);
-        }
-        // constraints with fixed macros 
-        // when considering fixed macros, there is no guarantee to find legal solution 
-        // with current ad-hoc constraint graphs 
-        for (int j = db.num_movable_nodes; j < db.num_nodes; ++j)
-        {
-            int node_id2 = j; 
-            T xl2 = db.init_x[node_id2];
-            T yl2 = db.init_y[node_id2];
-            T width2 = db.node_size_x[node_id2];
-            T height2 = db.node_size_y[node_id2];
-
-            process2Nodes(i, xl1, yl1, width1, height1, j, xl2, yl2, width2, height2);
-        }
-    }
-
-    // displacement constraints and objectives
-    // Use initial locations for objective computation 
-    for (unsigned int i = 0, ie = macros.size(); i < ie; ++i)
-    {
-        int node_id = macros[i];
-        T xl = round(db.init_x[node_id]);
-        T yl = round(db.init_y[node_id]);
-
-        auto var_x = model_hcg.variable(i); 
-        auto var_l = model_hcg.variable(i + macros.size());
-        auto var_u = model_hcg.variable(i + macros.size()*2);
-        dreamplaceAssertMsg(model_hcg.addConstraint(var_l - var_x <= 0), "failed to add HCG lower bound constraint");
-        model_hcg.updateVariableUpperBound(var_l, xl);
-        dreamplaceAssertMsg(model_hcg.addConstraint(var_u - var_x >= 0), "failed to add HCG upper bound constraint");
-        model_hcg.updateVariableLowerBound(var_u, xl);
-        obj_hcg += var_u - var_l;
-
-        var_x = model_vcg.variable(i); 
-        var_l = model_vcg.variable(i + macros.size());
-        var_u = model_vcg.variable(i + macros.size()*2);
-        dreamplaceAssertMsg(model_vcg.addConstraint(var_l - var_x <= 0), "failed to add VCG lower bound constraint");
-        model_vcg.updateVariableUpperBound(var_l, yl);
-        dreamplaceAssertMsg(model_vcg.addConstraint(var_u - var_x >= 0), "failed to add VCG upper bound constraint");
-        model_vcg.updateVariableLowerBound(var_u, yl);
-        obj_vcg += var_u - var_l;
-    }
+            // displacement constraints and objectives
+            // Use initial locations for objective computation
+            for (int k = 0; k < num_vars; ++k)
+            {
+                T p0 = round(dir.init_pos[macros[component[k]]]);
 
-    model_hcg.setObjective(obj_hcg);
-    model_hcg.setOptimizeType(limbo::solvers::MIN);
-    model_vcg.setObjective(obj_vcg);
-    model_vcg.setOptimizeType(limbo::solvers::MIN);
+                auto var_x = model.variable(k);
+                auto var_l = model.variable(k + num_vars);
+                auto var_u = model.variable(k + num_vars*2);
+                dreamplaceAssertMsg(model.addConstraint(var_l - var_x <= 0), "failed to add lower bound constraint");
+                model.updateVariableUpperBound(var_l, p0);
+                dreamplaceAssertMsg(model.addConstraint(var_u - var_x >= 0), "failed to add upper bound constraint");
+                model.updateVariableLowerBound(var_u, p0);
+                obj += var_u - var_l;
+            }
+            model.setObjective(obj);
+            model.setOptimizeType(limbo::solvers::MIN);
 
 #ifdef DEBUG
-    model_hcg.print("hcg.lp");
-    model_vcg.print("vcg.lp");
+            dreamplaceSPrint(kNONE, buf, "%s%u.lp", (d == 0)? "hcg" : "vcg", c);
+            model.print(buf);
 #endif
 
-    // solve linear programming for horizontal constraint graph
-    {
-        solver_alg_type alg; 
-        solver_type solver (&model_hcg); 
-        auto status = solver(&alg);
-        dreamplaceAssertMsg(status == limbo::solvers::OPTIMAL, "Horizontal graph not solved optimally");
-
-        for (unsigned int i = 0, ie = macros.size(); i < ie; ++i)
-        {
-            int node_id = macros[i];
-            db.x[node_id] = model_hcg.variableSolution(model_hcg.variable(i));
-        }
-    }
-    // solve linear programming for vertical constraint graph
-    {
-        solver_alg_type alg; 
-        solver_type solver (&model_vcg); 
-        auto status = solver(&alg);
-        dreamplaceAssertMsg(status == limbo::solvers::OPTIMAL, "Vertical graph not solved optimally");
+            solver_alg_type alg;
+            solver_type solver (&model);
+            auto status = solver(&alg);
+            dreamplaceAssertMsg(status == limbo::solvers::OPTIMAL, "%s graph not solved optimally", (d == 0)? "Horizontal" : "Vertical");
 
-        for (unsigned int i = 0, ie = macros.size(); i < ie; ++i)
-        {
-            int node_id = macros[i];
-            db.y[node_id] = model_vcg.variableSolution(model_vcg.variable(i));
+            for (int k = 0; k < num_vars; ++k)
+            {
+                dir.pos[macros[component[k]]] = model.variableSolution(model.variable(k));
+            }
+            ++num_solved;
         }
+        dreamplacePrint(kDEBUG, "%s graph: %lu components, %d solved by LP, %d already optimal\n",
+                (d == 0)? "Horizontal" : "Vertical", components.size(), num_solved, num_skipped);
     }
-
-#ifdef DEBUG
-    model_hcg.printSolution("hcg.sol");
-    model_vcg.printSolution("vcg.sol");
-#endif
 }
 
 DREAMPLACE_END_NAMESPACE
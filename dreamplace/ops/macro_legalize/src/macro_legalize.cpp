@@ -14,7 +14,7 @@ DREAMPLACE_BEGIN_NAMESPACE
 /// @brief The macro legalization follows the way of floorplanning, 
 /// because macros have quite different sizes. 
 template <typename T>
-void macroLegalizationLauncher(LegalizationDB<T> db);
+void macroLegalizationLauncher(LegalizationDB<T> db, int num_threads);
 
 /// @brief legalize movable macros only. 
 /// Standard cells are not considered, but overlaps with fixed macros will be avoided. 
@@ -79,6 +79,7 @@ int macroLegalizationLauncher(
 /// @param num_nodes total number of nodes, including movable nodes, fixed nodes, and filler nodes; fixed nodes are in the range of [num_movable_nodes, num_nodes-num_filler_nodes)
 /// @param num_movable_nodes number of movable nodes, movable nodes are in the range of [0, num_movable_nodes)
 /// @param number of filler nodes, filler nodes are in the range of [num_nodes-num_filler_nodes, num_nodes)
+/// @param num_threads number of threads 
 at::Tensor macro_legalization_forward(
         at::Tensor init_pos,
         at::Tensor pos, 
@@ -96,7 +97,8 @@ at::Tensor macro_legalization_forward(
         int num_bins_y,
         int num_movable_nodes, 
         int num_terminal_NIs, 
-        int num_filler_nodes
+        int num_filler_nodes, 
+        int num_threads
         )
 {
     CHECK_FLAT(init_pos); 
@@ -123,7 +125,7 @@ at::Tensor macro_legalization_forward(
                     num_terminal_NIs, 
                     num_filler_nodes
                     );
-            macroLegalizationLauncher<scalar_t>(db);
+            macroLegalizationLauncher<scalar_t>(db, num_threads);
             });
     timer_stop = get_globaltime(); 
     dreamplacePrint(kINFO, "Macro legalization takes %g ms\n", (timer_stop-timer_start)*get_timer_period());
@@ -216,7 +218,7 @@ T compute_displace(const LegalizationDB<T>& db, const std::vector<int>& macros)
 }
 
 template <typename T>
-void macroLegalizationLauncher(LegalizationDB<T> db)
+void macroLegalizationLauncher(LegalizationDB<T> db, int num_threads)
 {
     // collect macros 
     std::vector<int> macros; 
@@ -238,13 +240,13 @@ void macroLegalizationLauncher(LegalizationDB<T> db)
         return;
     }
 
-    hannanLegalizeLauncher(db, macros);
+    hannanLegalizeLauncher(db, macros, num_threads);
     dreamplacePrint(kINFO, "Macro displacement %g\n", compute_displace(db, macros));
 #ifdef DEBUG
     check_macro_legality(db, macros);
 #endif
 
-    lpLegalizeLauncher(db, macros);
+    lpLegalizeLauncher(db, macros, num_threads);
     dreamplacePrint(kINFO, "Macro displacement %g\n", compute_displace(db, macros));
 #ifdef DEBUG
     check_macro_legality(db, macros);
@@ -30,6 +30,10 @@ class PlaceIOFunction(Function):
             args += " --verilog_input %s" % (params.verilog_input)
         if "sort_nets_by_degree" in params.__dict__:
             args += " --sort_nets_by_degree %s" % (params.sort_nets_by_degree)
+        if "num_threads" in params.__dict__:
+            args += " --num_threads %s" % (params.num_threads)
+        if "placedb_snapshot" in params.__dict__ and params.placedb_snapshot:
+            args += " --snapshot %s" % (params.placedb_snapshot)
 
         return place_io_cpp.forward(args.split(' '))
 
@@ -47,7 +51,7 @@ class PlaceIOFunction(Function):
         @brief write solution in specific format 
         @param raw_db original placement database 
         @param filename output file 
-        @param sol_file_format solution file format, DEF|DEFSIMPLE|BOOKSHELF|BOOKSHELFALL
+        @param sol_file_format solution file format, DEF|DEFSIMPLE|DEFDELTA|BOOKSHELF|BOOKSHELFALL
         @param node_x x coordinates of cells, only need movable cells; if none, use original position 
         @param node_y y coordinates of cells, only need movable cells; if none, use original position
         """
@@ -62,3 +66,12 @@ class PlaceIOFunction(Function):
         @param node_y y coordinates of cells, only need movable cells
         """
         return place_io_cpp.apply(raw_db, node_x, node_y)
+
+    @staticmethod 
+    def apply_flip(raw_db, node_flip_x):
+        """
+        @brief flip cells horizontally, together with the offsets of their pins 
+        @param raw_db original placement database 
+        @param node_flip_x uint8 flags of cells to flip
+        """
+        return place_io_cpp.apply_flip(raw_db, node_flip_x)
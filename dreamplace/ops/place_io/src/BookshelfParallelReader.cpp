@@ -0,0 +1,681 @@
+/**
+ * @file   BookshelfParallelReader.cpp
+ * @author agent
+ * @date   Oct 2026
+ */
+
+#include "BookshelfParallelReader.h"
+#include "MappedFile.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <omp.h>
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+namespace bookshelf_parallel
+{
+
+/// a token refers to a range of characters in the mapped file
+struct Token
+{
+    char const* first;
+    char const* last;
+
+    Token() : first(NULL), last(NULL) {}
+    std::size_t size() const {return last-first;}
+    std::string str() const {return std::string(first, last);}
+    bool equals(char const* s) const
+    {
+        std::size_t n = std::strlen(s);
+        return size() == n && std::strncmp(first, s, n) == 0;
+    }
+    /// case-insensitive comparison
+    bool iequals(char const* s) const
+    {
+        std::size_t n = std::strlen(s);
+        if (size() != n)
+        {
+            return false;
+        }
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            if (std::tolower(first[i]) != std::tolower(s[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    /// the mapped file is not null-terminated, so copy to a buffer before conversion
+    double toDouble() const
+    {
+        char buf[64];
+        std::size_t n = std::min(size(), sizeof(buf)-1);
+        std::memcpy(buf, first, n);
+        buf[n] = '\0';
+        return std::strtod(buf, NULL);
+    }
+    int toInt() const
+    {
+        return (int)std::round(toDouble());
+    }
+};
+
+inline bool isDelimiter(char c)
+{
+    // colons are only separators in Bookshelf
+    return c == ' ' || c == '\t' || c == '\r' || c == ':';
+}
+
+/// split one line into tokens; comments starting with '#' are skipped
+class LineTokenizer
+{
+    public:
+        /// @param first beginning of the line
+        /// @param last end of the file
+        LineTokenizer(char const* first, char const* last) : m_cur(first)
+        {
+            m_last = first;
+            while (m_last != last && *m_last != '\n' && *m_last != '#')
+            {
+                ++m_last;
+            }
+        }
+        bool next(Token& t)
+        {
+            while (m_cur != m_last && isDelimiter(*m_cur))
+            {
+                ++m_cur;
+            }
+            if (m_cur == m_last)
+            {
+                return false;
+            }
+            t.first = m_cur;
+            while (m_cur != m_last && !isDelimiter(*m_cur))
+            {
+                ++m_cur;
+            }
+            t.last = m_cur;
+            return true;
+        }
+        /// tokenize the whole line
+        /// @return number of tokens
+        std::size_t tokenize(std::vector<Token>& vToken)
+        {
+            vToken.clear();
+            Token t;
+            while (next(t))
+            {
+                vToken.push_back(t);
+            }
+            return vToken.size();
+        }
+    protected:
+        char const* m_cur;
+        char const* m_last;
+};
+
+/// skip leading spaces
+inline char const* skipSpaces(char const* first, char const* last)
+{
+    while (first != last && (*first == ' ' || *first == '\t'))
+    {
+        ++first;
+    }
+    return first;
+}
+
+/// a chunk in .nets file must start from a net
+struct NetDegreeLine
+{
+    bool operator()(char const* first, char const* last) const
+    {
+        first = skipSpaces(first, last);
+        return (std::size_t)(last-first) >= 9 && std::strncmp(first, "NetDegree", 9) == 0;
+    }
+};
+
+/// error of a chunk, the first one is reported
+struct ChunkError
+{
+    char const* line; ///< NULL if no error
+
+    ChunkError() : line(NULL) {}
+    void set(char const* l)
+    {
+        if (line == NULL)
+        {
+            line = l;
+        }
+    }
+};
+
+/// print the first error among chunks
+inline bool reportErrors(std::vector<ChunkError> const& vError, std::string const& filename, char const* last)
+{
+    for (std::vector<ChunkError>::const_iterator it = vError.begin(), ite = vError.end(); it != ite; ++it)
+    {
+        if (it->line)
+        {
+            char const* eol = it->line;
+            while (eol != last && *eol != '\n')
+            {
+                ++eol;
+            }
+            dreamplacePrint(kERROR, "failed to parse %s at \"%s\"\n", filename.c_str(), std::string(it->line, eol).c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief a line that is not a record, i.e., empty, header, or comment
+inline bool isHeader(std::vector<Token> const& vToken)
+{
+    return vToken.empty() || vToken[0].equals("UCLA");
+}
+
+struct NodeRecord
+{
+    std::string name;
+    int width;
+    int height;
+    bool terminal;
+};
+
+struct PlRecord
+{
+    std::string name;
+    double x;
+    double y;
+    std::string orient;
+    std::string status;
+};
+
+struct WtsRecord
+{
+    std::string name;
+    double weight;
+};
+
+void parseNodes(char const* first, char const* last, std::vector<NodeRecord>& vRecord, ChunkError& error)
+{
+    std::vector<Token> vToken;
+    for (char const* line = first; line != last; line = nextLine(line, last))
+    {
+        LineTokenizer tokenizer (line, last);
+        tokenizer.tokenize(vToken);
+        if (isHeader(vToken) || vToken[0].equals("NumNodes") || vToken[0].equals("NumTerminals"))
+        {
+            continue;
+        }
+        if (vToken.size() < 3)
+        {
+            error.set(line);
+            return;
+        }
+        vRecord.push_back(NodeRecord());
+        NodeRecord& record = vRecord.back();
+        record.name = vToken[0].str();
+        record.width = vToken[1].toInt();
+        record.height = vToken[2].toInt();
+        // both terminal and terminal_NI are treated as terminals
+        record.terminal = (vToken.size() > 3 && vToken[3].size() >= 8 && std::strncmp(vToken[3].first, "terminal", 8) == 0);
+    }
+}
+
+void parseNets(char const* first, char const* last, std::vector<BookshelfParser::Net>& vRecord, std::size_t& numPins, ChunkError& error)
+{
+    std::vector<Token> vToken;
+    numPins = 0;
+    for (char const* line = first; line != last; line = nextLine(line, last))
+    {
+        LineTokenizer tokenizer (line, last);
+        tokenizer.tokenize(vToken);
+        if (isHeader(vToken) || vToken[0].equals("NumNets") || vToken[0].equals("NumPins"))
+        {
+            continue;
+        }
+        if (vToken[0].equals("NetDegree"))
+        {
+            if (vToken.size() < 2)
+            {
+                error.set(line);
+                return;
+            }
+            vRecord.push_back(BookshelfParser::Net());
+            BookshelfParser::Net& net = vRecord.back();
+            net.vNetPin.reserve(vToken[1].toInt());
+            if (vToken.size() > 2) // net name is optional
+            {
+                net.net_name = vToken[2].str();
+            }
+        }
+        else // pin line: node direction [offset_x offset_y]
+        {
+            if (vRecord.empty() || vToken.size() < 2)
+            {
+                error.set(line);
+                return;
+            }
+            vRecord.back().vNetPin.push_back(BookshelfParser::NetPin());
+            BookshelfParser::NetPin& netPin = vRecord.back().vNetPin.back();
+            netPin.node_name = vToken[0].str();
+            netPin.direct = *vToken[1].first;
+            netPin.offset[0] = (vToken.size() > 2)? vToken[2].toDouble() : 0;
+            netPin.offset[1] = (vToken.size() > 3)? vToken[3].toDouble() : 0;
+            netPin.size[0] = netPin.size[1] = 0;
+            ++numPins;
+        }
+    }
+}
+
+void parsePl(char const* first, char const* last, std::vector<PlRecord>& vRecord, ChunkError& error)
+{
+    std::vector<Token> vToken;
+    for (char const* line = first; line != last; line = nextLine(line, last))
+    {
+        LineTokenizer tokenizer (line, last);
+        tokenizer.tokenize(vToken);
+        if (isHeader(vToken))
+        {
+            continue;
+        }
+        if (vToken.size() < 3)
+        {
+            error.set(line);
+            return;
+        }
+        vRecord.push_back(PlRecord());
+        PlRecord& record = vRecord.back();
+        record.name = vToken[0].str();
+        record.x = vToken[1].toDouble();
+        record.y = vToken[2].toDouble();
+        record.orient = "N";
+        for (std::size_t i = 3; i < vToken.size(); ++i)
+        {
+            if (*vToken[i].first == '/')
+            {
+                // /FIXED and /FIXED_NI are both fixed
+                if (vToken[i].size() >= 6 && std::strncmp(vToken[i].first, "/FIXED", 6) == 0)
+                {
+                    record.status = "FIXED";
+                }
+                else
+                {
+                    record.status = std::string(vToken[i].first+1, vToken[i].last);
+                }
+            }
+            else
+            {
+                record.orient = vToken[i].str();
+            }
+        }
+    }
+}
+
+/// .wts file: net weight
+void parseWts(char const* first, char const* last, std::vector<WtsRecord>& vRecord, ChunkError& error)
+{
+    std::vector<Token> vToken;
+    for (char const* line = first; line != last; line = nextLine(line, last))
+    {
+        LineTokenizer tokenizer (line, last);
+        tokenizer.tokenize(vToken);
+        if (isHeader(vToken))
+        {
+            continue;
+        }
+        if (vToken.size() < 2)
+        {
+            error.set(line);
+            return;
+        }
+        vRecord.push_back(WtsRecord());
+        WtsRecord& record = vRecord.back();
+        record.name = vToken[0].str();
+        record.weight = vToken[1].toDouble();
+    }
+}
+
+/// concatenate per-chunk records
+template <typename T>
+inline std::size_t countRecords(std::vector<std::vector<T> > const& vChunk)
+{
+    std::size_t count = 0;
+    for (typename std::vector<std::vector<T> >::const_iterator it = vChunk.begin(), ite = vChunk.end(); it != ite; ++it)
+    {
+        count += it->size();
+    }
+    return count;
+}
+
+} // namespace bookshelf_parallel
+
+bool BookshelfParallelReader::read(std::string const& auxFile)
+{
+    using namespace bookshelf_parallel;
+
+    MappedFile file;
+    if (!file.open(auxFile))
+    {
+        dreamplacePrint(kERROR, "unable to open %s\n", auxFile.c_str());
+        return false;
+    }
+
+    // files are relative to the directory of .aux file
+    std::size_t found = auxFile.rfind('/');
+    std::string auxPath = (found == std::string::npos)? std::string() : auxFile.substr(0, found+1);
+    std::string nodesFile, netsFile, wtsFile, plFile, sclFile;
+    std::vector<Token> vToken;
+    for (char const* line = file.begin(); line != file.end(); line = nextLine(line, file.end()))
+    {
+        LineTokenizer tokenizer (line, file.end());
+        tokenizer.tokenize(vToken);
+        // RowBasedPlacement : a.nodes a.nets a.wts a.pl a.scl ...
+        for (std::size_t i = 1; i < vToken.size(); ++i)
+        {
+            std::string filename = vToken[i].str();
+            std::size_t dot = filename.rfind('.');
+            std::string suffix = (dot == std::string::npos)? std::string() : filename.substr(dot);
+            if (suffix == ".nodes") nodesFile = auxPath + filename;
+            else if (suffix == ".nets") netsFile = auxPath + filename;
+            else if (suffix == ".wts") wtsFile = auxPath + filename;
+            else if (suffix == ".pl") plFile = auxPath + filename;
+            else if (suffix == ".scl") sclFile = auxPath + filename;
+            else dreamplacePrint(kINFO, "ignore %s\n", filename.c_str());
+        }
+    }
+    file.close();
+
+    // design name from .aux file
+    std::string designName = auxFile.substr(auxPath.size());
+    designName = designName.substr(0, designName.rfind('.'));
+    m_db.set_bookshelf_design(designName);
+
+    // the order matters, as .pl file requires rows
+    if (!nodesFile.empty() && !readNodes(nodesFile)) return false;
+    if (!netsFile.empty() && !readNets(netsFile)) return false;
+    if (!wtsFile.empty() && !readWts(wtsFile)) return false;
+    if (!sclFile.empty() && !readScl(sclFile)) return false;
+    if (!plFile.empty() && !readPl(plFile, false)) return false;
+
+    m_db.bookshelf_end();
+
+    return true;
+}
+
+bool BookshelfParallelReader::readNodes(std::string const& filename)
+{
+    using namespace bookshelf_parallel;
+
+    dreamplacePrint(kINFO, "reading %s\n", filename.c_str());
+    hr_clock_rep timer_start = get_globaltime();
+    MappedFile file;
+    if (!file.open(filename))
+    {
+        dreamplacePrint(kERROR, "unable to open %s\n", filename.c_str());
+        return false;
+    }
+    std::vector<char const*> vBoundary = splitLines(file.begin(), file.end(), m_numThreads*4, AnyLine());
+    int numChunks = vBoundary.size()-1;
+    std::vector<std::vector<NodeRecord> > vChunk (numChunks);
+    std::vector<ChunkError> vError (numChunks);
+#pragma omp parallel for num_threads(m_numThreads) schedule(dynamic, 1)
+    for (int i = 0; i < numChunks; ++i)
+    {
+        parseNodes(vBoundary[i], vBoundary[i+1], vChunk[i], vError[i]);
+    }
+    if (!reportErrors(vError, filename, file.end()))
+    {
+        return false;
+    }
+
+    // merge in file order
+    std::size_t numNodes = countRecords(vChunk);
+    std::size_t numTerminals = 0;
+    for (int i = 0; i < numChunks; ++i)
+    {
+        for (std::vector<NodeRecord>::const_iterator it = vChunk[i].begin(), ite = vChunk[i].end(); it != ite; ++it)
+        {
+            numTerminals += it->terminal;
+        }
+    }
+    m_db.resize_bookshelf_node_terminals(numNodes-numTerminals, numTerminals);
+    for (int i = 0; i < numChunks; ++i)
+    {
+        for (std::vector<NodeRecord>::iterator it = vChunk[i].begin(), ite = vChunk[i].end(); it != ite; ++it)
+        {
+            if (it->terminal)
+            {
+                m_db.add_bookshelf_terminal(it->name, it->width, it->height);
+            }
+            else
+            {
+                m_db.add_bookshelf_node(it->name, it->width, it->height);
+            }
+        }
+        std::vector<NodeRecord>().swap(vChunk[i]); // release memory early
+    }
+    dreamplacePrint(kINFO, "reading %lu nodes with %d threads takes %g ms\n", numNodes, m_numThreads, (get_globaltime()-timer_start)*get_timer_period());
+
+    return true;
+}
+
+bool BookshelfParallelReader::readNets(std::string const& filename)
+{
+    using namespace bookshelf_parallel;
+
+    dreamplacePrint(kINFO, "reading %s\n", filename.c_str());
+    hr_clock_rep timer_start = get_globaltime();
+    MappedFile file;
+    if (!file.open(filename))
+    {
+        dreamplacePrint(kERROR, "unable to open %s\n", filename.c_str());
+        return false;
+    }
+    std::vector<char const*> vBoundary = splitLines(file.begin(), file.end(), m_numThreads*4, NetDegreeLine());
+    int numChunks = vBoundary.size()-1;
+    std::vector<std::vector<BookshelfParser::Net> > vChunk (numChunks);
+    std::vector<std::size_t> vNumPins (numChunks, 0);
+    std::vector<ChunkError> vError (numChunks);
+#pragma omp parallel for num_threads(m_numThreads) schedule(dynamic, 1)
+    for (int i = 0; i < numChunks; ++i)
+    {
+        parseNets(vBoundary[i], vBoundary[i+1], vChunk[i], vNumPins[i], vError[i]);
+    }
+    if (!reportErrors(vError, filename, file.end()))
+    {
+        return false;
+    }
+
+    // merge in file order
+    std::size_t numNets = countRecords(vChunk);
+    std::size_t numPins = 0;
+    for (int i = 0; i < numChunks; ++i)
+    {
+        numPins += vNumPins[i];
+    }
+    m_db.resize_bookshelf_net(numNets);
+    m_db.resize_bookshelf_pin(numPins);
+    std::size_t netId = 0;
+    for (int i = 0; i < numChunks; ++i)
+    {
+        for (std::vector<BookshelfParser::Net>::iterator it = vChunk[i].begin(), ite = vChunk[i].end(); it != ite; ++it, ++netId)
+        {
+            if (it->net_name.empty()) // name nets without names by their indices
+            {
+                char buf[32];
+                dreamplaceSPrint(kNONE, buf, "n%lu", netId);
+                it->net_name = buf;
+            }
+            m_db.add_bookshelf_net(*it);
+        }
+        std::vector<BookshelfParser::Net>().swap(vChunk[i]); // release memory early
+    }
+    dreamplacePrint(kINFO, "reading %lu nets, %lu pins with %d threads takes %g ms\n", numNets, numPins, m_numThreads, (get_globaltime()-timer_start)*get_timer_period());
+
+    return true;
+}
+
+bool BookshelfParallelReader::readScl(std::string const& filename)
+{
+    using namespace bookshelf_parallel;
+
+    // .scl file is small, so read it sequentially
+    dreamplacePrint(kINFO, "reading %s\n", filename.c_str());
+    MappedFile file;
+    if (!file.open(filename))
+    {
+        dreamplacePrint(kERROR, "unable to open %s\n", filename.c_str());
+        return false;
+    }
+    std::vector<BookshelfParser::Row> vRow;
+    std::vector<Token> vToken;
+    for (char const* line = file.begin(); line != file.end(); line = nextLine(line, file.end()))
+    {
+        LineTokenizer tokenizer (line, file.end());
+        tokenizer.tokenize(vToken);
+        if (isHeader(vToken) || vToken[0].iequals("NumRows"))
+        {
+            continue;
+        }
+        if (vToken[0].iequals("CoreRow"))
+        {
+            vRow.push_back(BookshelfParser::Row());
+            BookshelfParser::Row& row = vRow.back();
+            row.origin[0] = row.origin[1] = 0;
+            row.height = row.site_width = row.site_spacing = row.site_num = 0;
+            row.site_orient = 1;
+            row.site_symmetry = 1;
+            row.orient = (vToken.size() > 1)? vToken[1].str() : std::string("HORIZONTAL");
+            for (std::string::iterator it = row.orient.begin(), ite = row.orient.end(); it != ite; ++it)
+            {
+                *it = std::toupper(*it);
+            }
+            continue;
+        }
+        if (vToken[0].iequals("End"))
+        {
+            continue;
+        }
+        if (vRow.empty() || vToken.size() < 2)
+        {
+            dreamplacePrint(kERROR, "failed to parse %s at \"%s\"\n", filename.c_str(), std::string(line, nextLine(line, file.end())).c_str());
+            return false;
+        }
+        BookshelfParser::Row& row = vRow.back();
+        if (vToken[0].iequals("Coordinate")) row.origin[1] = vToken[1].toInt();
+        else if (vToken[0].iequals("Height")) row.height = vToken[1].toInt();
+        else if (vToken[0].iequals("Sitewidth")) row.site_width = vToken[1].toInt();
+        else if (vToken[0].iequals("Sitespacing")) row.site_spacing = vToken[1].toInt();
+        else if (vToken[0].iequals("Siteorient"))
+        {
+            // either an integer or N/FS
+            if (vToken[1].equals("N")) row.site_orient = 1;
+            else if (vToken[1].equals("FS")) row.site_orient = 0;
+            else row.site_orient = vToken[1].toInt();
+        }
+        else if (vToken[0].iequals("Sitesymmetry")) row.site_symmetry = (vToken[1].equals("Y"))? 1 : vToken[1].toInt();
+        else if (vToken[0].iequals("SubrowOrigin"))
+        {
+            // SubrowOrigin : x NumSites : n
+            row.origin[0] = vToken[1].toInt();
+            if (vToken.size() > 3 && vToken[2].iequals("NumSites"))
+            {
+                row.site_num = vToken[3].toInt();
+            }
+        }
+    }
+
+    m_db.resize_bookshelf_row(vRow.size());
+    for (std::vector<BookshelfParser::Row>::const_iterator it = vRow.begin(), ite = vRow.end(); it != ite; ++it)
+    {
+        m_db.add_bookshelf_row(*it);
+    }
+
+    return true;
+}
+
+bool BookshelfParallelReader::readWts(std::string const& filename)
+{
+    using namespace bookshelf_parallel;
+
+    dreamplacePrint(kINFO, "reading %s\n", filename.c_str());
+    hr_clock_rep timer_start = get_globaltime();
+    MappedFile file;
+    if (!file.open(filename))
+    {
+        dreamplacePrint(kERROR, "unable to open %s\n", filename.c_str());
+        return false;
+    }
+    std::vector<char const*> vBoundary = splitLines(file.begin(), file.end(), m_numThreads*4, AnyLine());
+    int numChunks = vBoundary.size()-1;
+    std::vector<std::vector<WtsRecord> > vChunk (numChunks);
+    std::vector<ChunkError> vError (numChunks);
+#pragma omp parallel for num_threads(m_numThreads) schedule(dynamic, 1)
+    for (int i = 0; i < numChunks; ++i)
+    {
+        parseWts(vBoundary[i], vBoundary[i+1], vChunk[i], vError[i]);
+    }
+    if (!reportErrors(vError, filename, file.end()))
+    {
+        return false;
+    }
+
+    // merge in file order, so the last weight of a net wins as in Limbo
+    for (int i = 0; i < numChunks; ++i)
+    {
+        for (std::vector<WtsRecord>::const_iterator it = vChunk[i].begin(), ite = vChunk[i].end(); it != ite; ++it)
+        {
+            m_db.set_bookshelf_net_weight(it->name, it->weight);
+        }
+    }
+    dreamplacePrint(kINFO, "reading %lu net weights with %d threads takes %g ms\n", countRecords(vChunk), m_numThreads, (get_globaltime()-timer_start)*get_timer_period());
+
+    return true;
+}
+
+bool BookshelfParallelReader::readPl(std::string const& filename, bool plFlag)
+{
+    using namespace bookshelf_parallel;
+
+    dreamplacePrint(kINFO, "reading %s\n", filename.c_str());
+    hr_clock_rep timer_start = get_globaltime();
+    MappedFile file;
+    if (!file.open(filename))
+    {
+        dreamplacePrint(kERROR, "unable to open %s\n", filename.c_str());
+        return false;
+    }
+    std::vector<char const*> vBoundary = splitLines(file.begin(), file.end(), m_numThreads*4, AnyLine());
+    int numChunks = vBoundary.size()-1;
+    std::vector<std::vector<PlRecord> > vChunk (numChunks);
+    std::vector<ChunkError> vError (numChunks);
+#pragma omp parallel for num_threads(m_numThreads) schedule(dynamic, 1)
+    for (int i = 0; i < numChunks; ++i)
+    {
+        parsePl(vBoundary[i], vBoundary[i+1], vChunk[i], vError[i]);
+    }
+    if (!reportErrors(vError, filename, file.end()))
+    {
+        return false;
+    }
+
+    // merge in file order, as positions update statistics in PlaceDB
+    for (int i = 0; i < numChunks; ++i)
+    {
+        for (std::vector<PlRecord>::const_iterator it = vChunk[i].begin(), ite = vChunk[i].end(); it != ite; ++it)
+        {
+            m_db.set_bookshelf_node_position(it->name, it->x, it->y, it->orient, it->status, plFlag);
+        }
+    }
+    dreamplacePrint(kINFO, "reading %lu positions with %d threads takes %g ms\n", countRecords(vChunk), m_numThreads, (get_globaltime()-timer_start)*get_timer_period());
+
+    return true;
+}
+
+DREAMPLACE_END_NAMESPACE
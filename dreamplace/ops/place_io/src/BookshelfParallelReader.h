@@ -0,0 +1,50 @@
+/**
+ * @file   BookshelfParallelReader.h
+ * @author agent
+ * @date   Oct 2026
+ * @brief  Multi-threaded reader for Bookshelf files.
+ *
+ * Each file is memory-mapped and split into chunks at record boundaries.
+ * Chunks are tokenized by multiple threads into plain records;
+ * the records are then merged into PlaceDB in file order through the same
+ * callbacks as the Bookshelf parser in Limbo, so the resulting database is identical.
+ */
+
+#ifndef DREAMPLACE_BOOKSHELFPARALLELREADER_H
+#define DREAMPLACE_BOOKSHELFPARALLELREADER_H
+
+#include <string>
+#include "PlaceDB.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+class BookshelfParallelReader
+{
+    public:
+        /// @param db placement database
+        /// @param numThreads number of threads for tokenization
+        BookshelfParallelReader(PlaceDB& db, int numThreads) : m_db(db), m_numThreads(std::max(numThreads, 1)) {}
+
+        /// @brief read .aux file and all files listed in it,
+        /// equivalent to BookshelfParser::read
+        bool read(std::string const& auxFile);
+        /// @brief read an additional .pl file,
+        /// equivalent to BookshelfParser::readPl
+        bool readPl(std::string const& plFile) {return readPl(plFile, true);}
+
+    protected:
+        bool readNodes(std::string const& filename);
+        bool readNets(std::string const& filename);
+        /// @brief read net weights, after nets
+        bool readWts(std::string const& filename);
+        bool readScl(std::string const& filename);
+        /// @param plFlag false for the .pl file in .aux, true for additional .pl files
+        bool readPl(std::string const& filename, bool plFlag);
+
+        PlaceDB& m_db;
+        int m_numThreads;
+};
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
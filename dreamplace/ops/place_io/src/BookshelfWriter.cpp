@@ -8,6 +8,7 @@
 #include "BookshelfWriter.h"
 #include "Iterators.h"
 #include "PlaceDB.h"
+#include "TextBuffer.h"
 #include <cstdio>
 #include <limbo/string/String.h>
 
@@ -116,9 +117,9 @@ bool BookShelfWriter::writeNets(std::string const& outFileNoSuffix) const
     // write nets 
     for (std::vector<Net>::const_iterator it = vNet.begin(), ite = vNet.end(); it != ite; ++it)
     {
-        std::vector<index_type> const& vNetPin = it->pins();
+        IndexRange<index_type const> vNetPin = m_db.netPins(*it);
         fprintf(out, "NetDegree : %lu %s\n", vNetPin.size(), m_db.netName(*it).c_str());
-        for (std::vector<index_type>::const_iterator itp = vNetPin.begin(), itpe = vNetPin.end(); itp != itpe; ++itp)
+        for (IndexRange<index_type const>::const_iterator itp = vNetPin.begin(), itpe = vNetPin.end(); itp != itpe; ++itp)
         {
             Pin const& pin = vPin[*itp];
             Node const& node = m_db.getNode(pin); 
@@ -205,32 +206,40 @@ bool BookShelfWriter::writePlx(std::string const& outFileNoSuffix,
 
     writeHeader(out, "pl"); // use pl instead of plx to accommodate parser
 
+    // format nodes in parallel and write them in order 
     std::vector<Node> const& vNode = m_db.nodes();
-    for (std::vector<Node>::const_iterator it = vNode.begin(), ite = vNode.end(); it != ite; ++it)
-    {
-        Node const& node = *it; 
-
-        PlaceDB::coordinate_type xx = node.xl(); 
-        PlaceDB::coordinate_type yy = node.yl(); 
-        if (node.id() < m_db.numMovable())
-        {
-            if (x)
-            {
-                xx = x[node.id()];
-            }
-            if (y)
-            {
-                yy = y[node.id()];
-            }
-        }
-
-        fprintf(out, "%s %d %d : %s", m_db.nodeName(node).c_str(), xx, yy, std::string(Orient(node.orient())).c_str());
-        if (node.id() < m_db.numMovable()+m_db.numFixed() && node.status() == PlaceStatusEnum::FIXED) // fixed instance
-            fprintf(out, " /FIXED"); 
-        else if (node.id() >= m_db.numMovable()+m_db.numFixed()) // io pins
-            fprintf(out, " /FIXED_NI"); 
-        fprintf(out, "\n"); 
-    }
+    writeRecordsParallel(out, vNode.size(), m_db.userParam().numThreads, 
+            [&](std::string& buf, std::size_t i){
+                Node const& node = vNode[i]; 
+
+                PlaceDB::coordinate_type xx = node.xl(); 
+                PlaceDB::coordinate_type yy = node.yl(); 
+                if (node.id() < m_db.numMovable())
+                {
+                    if (x)
+                    {
+                        xx = x[node.id()];
+                    }
+                    if (y)
+                    {
+                        yy = y[node.id()];
+                    }
+                }
+
+                // equivalent to "%s %d %d : %s" 
+                buf += m_db.nodeName(node);
+                buf += ' ';
+                appendInt(buf, xx);
+                buf += ' ';
+                appendInt(buf, yy);
+                buf += " : ";
+                buf += std::string(Orient(node.orient()));
+                if (node.id() < m_db.numMovable()+m_db.numFixed() && node.status() == PlaceStatusEnum::FIXED) // fixed instance
+                    buf += " /FIXED"; 
+                else if (node.id() >= m_db.numMovable()+m_db.numFixed()) // io pins
+                    buf += " /FIXED_NI"; 
+                buf += '\n'; 
+            });
 
     closeFile(out);
     return true;
@@ -330,6 +339,8 @@ FILE* BookShelfWriter::openFile(std::string const& outFileNoSuffix, std::string
     FILE* out = fopen((outFileNoSuffix+"."+fileType).c_str(), "w");
     if (out == NULL)
         dreamplacePrint(kERROR, "unable to open %s for write\n", (outFileNoSuffix+"."+fileType).c_str());
+    else 
+        setLargeBuffer(out);
     return out;
 }
 void BookShelfWriter::closeFile(FILE* os) const 
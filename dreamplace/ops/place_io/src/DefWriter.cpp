@@ -6,67 +6,89 @@
  ************************************************************************/
 
 #include "DefWriter.h"
-#include <fstream>
+#include "MappedFile.h"
+#include "TextBuffer.h"
+#include <cstring>
 
 DREAMPLACE_BEGIN_NAMESPACE
 
+/// @brief whether [first, last) contains a keyword 
+inline bool containsKeyword(char const* first, char const* last, char const* keyword, std::size_t n)
+{
+    return std::search(first, last, keyword, keyword+n) != last;
+}
+/// @brief same whitespaces as DefWriter::trim 
+inline bool isTrimSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\v';
+}
+
 bool DefWriter::write(std::string const& outFile, std::string const& inFile, 
         std::vector<Node>::const_iterator first, std::vector<Node>::const_iterator last, 
         PlaceDB::coordinate_type const* x, PlaceDB::coordinate_type const* y) const 
 {
-    std::ifstream in (inFile.c_str());
-    FILE* out = fopen(outFile.c_str(), "w");
-    std::string line;
-    std::string nodeName;
-    std::size_t pos1, pos2;
+    MappedFile in;
     bool flag = false; // whether in COMPONENTS block 
     std::size_t rowCount = 0; 
 
     dreamplacePrint(kINFO, "writing placement to %s\n", outFile.c_str());
 
-    if (!in.good())
+    if (!in.open(inFile))
     {
         dreamplacePrint(kERROR, "unable to open %s for read\n", inFile.c_str());
         return false;
     }
+    FILE* out = fopen(outFile.c_str(), "w");
     if (out == NULL)
     {
         dreamplacePrint(kERROR, "unable to open %s for write\n", outFile.c_str());
         return false;
     }
+    setLargeBuffer(out);
 
-    while (getline(in, line))
+    // copy lines of the input file without constructing strings 
+    char const* fileEnd = in.end();
+    for (char const* line = in.begin(); line != fileEnd; line = nextLine(line, fileEnd))
     {
-        line = trim(line);
-        pos1 = line.find("END");
-        pos2 = line.find("COMPONENTS");
-        if (pos1 != std::string::npos && 
-                pos2 != std::string::npos) // match "END COMPONENTS"
-        {
-            // found "END COMPONENTS"
-            // dump positions here 
-            writeCompBlock(out, first, last, x, y);
+        // trim leading and tailing whitespaces 
+        char const* eol = line; 
+        while (eol != fileEnd && *eol != '\n')
+            ++eol;
+        char const* lineBegin = line;
+        while (lineBegin != eol && isTrimSpace(*lineBegin))
+            ++lineBegin;
+        char const* lineEnd = eol;
+        while (lineEnd != lineBegin && isTrimSpace(lineEnd[-1]))
+            --lineEnd;
 
-            flag = false;
-            continue;
-        }
-        else if (pos2 != std::string::npos) // match "COMPONENTS"
+        if (containsKeyword(lineBegin, lineEnd, "COMPONENTS", 10))
         {
-            flag = true;
+            if (containsKeyword(lineBegin, lineEnd, "END", 3)) // match "END COMPONENTS"
+            {
+                // found "END COMPONENTS"
+                // dump positions here 
+                writeCompBlock(out, first, last, x, y);
+
+                flag = false;
+            }
+            else // match "COMPONENTS"
+            {
+                flag = true;
+            }
             continue;
         }
 
         if (flag) {/* skip everything in a COMPONENTS block */}
         else 
         {
-            if (line.substr(0, 3) == "ROW") // match "ROW" entry, it does not hurt even if not matched; mainly for modification of benchmarks   
+            if (lineEnd-lineBegin >= 3 && std::strncmp(lineBegin, "ROW", 3) == 0) // match "ROW" entry, it does not hurt even if not matched; mainly for modification of benchmarks   
             {
                 Row const& row = m_db.row(rowCount);
                 fprintf(out, "ROW %s %s %d %d %s DO %u BY %u STEP %d %d ", 
                         row.name().c_str(), row.macroName().c_str(), 
                         row.xl(), row.yl(), std::string(row.orient()).c_str(), 
                         row.numSites(kX), (row.step(kY) == 0)? 1 : row.numSites(kY), row.step(kX), row.step(kY));
-                if (line.back() == ';')
+                if (lineEnd[-1] == ';')
                 {
                     fprintf(out, ";");
                 }
@@ -75,7 +97,8 @@ bool DefWriter::write(std::string const& outFile, std::string const& inFile,
             }
             else 
             {
-                fprintf(out, "%s\n", line.c_str()); 
+                fwrite(lineBegin, 1, lineEnd-lineBegin, out);
+                fputc('\n', out);
             }
         }
     }
@@ -96,6 +119,7 @@ bool DefWriter::writeSimple(std::string const& outFile, std::string const& versi
         dreamplacePrint(kERROR, "failed to open %s for write\n", outFile.c_str());
         return false;
     }
+    setLargeBuffer(out);
 
     fprintf(out, "VERSION %s ;\n", version.c_str());
     fprintf(out, "DESIGN %s ;\n\n", designName.c_str());
@@ -105,15 +129,79 @@ bool DefWriter::writeSimple(std::string const& outFile, std::string const& versi
     fclose(out);
     return true;
 }
+bool DefWriter::writeDelta(std::string const& outFile, std::string const& version, std::string const& designName, 
+        std::vector<Node>::const_iterator first, std::vector<Node>::const_iterator last, 
+        PlaceDB::coordinate_type const* x, PlaceDB::coordinate_type const* y) const 
+{
+    dreamplacePrint(kINFO, "writing placement changes to %s\n", outFile.c_str());
+
+    // initial positions and orientations record the placement in the input file, 
+    // so components only re-oriented, e.g., flipped or moved to a row of different orientation, are also written 
+    std::vector<PlaceDB::index_type> vNodeId; 
+    for (std::vector<Node>::const_iterator it = first; it != last; ++it)
+    {
+        if (it->status() == PlaceStatusEnum::UNPLACED || position(*it, x, y) != it->initPos() || it->orient() != it->initOrient())
+        {
+            vNodeId.push_back(it->id());
+        }
+    }
+    dreamplacePrint(kINFO, "%lu out of %lu components changed\n", vNodeId.size(), last-first);
+
+    FILE* out = fopen(outFile.c_str(), "w");
+    if (out == NULL)
+    {
+        dreamplacePrint(kERROR, "failed to open %s for write\n", outFile.c_str());
+        return false;
+    }
+    setLargeBuffer(out);
+
+    fprintf(out, "VERSION %s ;\n", version.c_str());
+    fprintf(out, "DESIGN %s ;\n\n", designName.c_str());
+    writeCompBlock(out, vNodeId, x, y);
+    fprintf(out, "\nEND DESIGN");
+
+    fclose(out);
+    return true;
+}
 void DefWriter::writeCompBlock(FILE* os, std::vector<Node>::const_iterator first, std::vector<Node>::const_iterator last, 
                 PlaceDB::coordinate_type const* x, PlaceDB::coordinate_type const* y) const 
 {
     fprintf(os, "COMPONENTS %lu ;\n", last-first);
-    for (; first != last; ++first)
-        writeComp(os, *first, x, y);
+    writeRecordsParallel(os, last-first, m_db.userParam().numThreads, 
+            [&](std::string& buf, std::size_t i){formatComp(buf, *(first+i), x, y);});
+    fprintf(os, "END COMPONENTS\n");
+}
+void DefWriter::writeCompBlock(FILE* os, std::vector<PlaceDB::index_type> const& vNodeId, 
+                PlaceDB::coordinate_type const* x, PlaceDB::coordinate_type const* y) const 
+{
+    fprintf(os, "COMPONENTS %lu ;\n", vNodeId.size());
+    writeRecordsParallel(os, vNodeId.size(), m_db.userParam().numThreads, 
+            [&](std::string& buf, std::size_t i){formatComp(buf, m_db.node(vNodeId[i]), x, y);});
     fprintf(os, "END COMPONENTS\n");
 }
-void DefWriter::writeComp(FILE* os, Node const& n, 
+void DefWriter::formatComp(std::string& buf, Node const& n, 
+                PlaceDB::coordinate_type const* x, PlaceDB::coordinate_type const* y) const
+{
+    Point<PlaceDB::coordinate_type> pos = position(n, x, y); 
+
+    // equivalent to 
+    // "  - %s %s\n"
+    // "    + %s ( %d %d ) %s ;\n"
+    buf += "  - ";
+    buf += m_db.nodeName(n);
+    buf += ' ';
+    buf += m_db.macroName(n);
+    buf += "\n    + ";
+    buf += std::string(PlaceStatus(n.status()));
+    buf += " ( ";
+    appendInt(buf, pos.x());
+    buf += ' ';
+    appendInt(buf, pos.y());
+    buf += " ) ";
+    buf += std::string(Orient(n.orient()));
+    buf += " ;\n";
+}
+Point<PlaceDB::coordinate_type> DefWriter::position(Node const& n, 
                 PlaceDB::coordinate_type const* x, PlaceDB::coordinate_type const* y) const
 {
     PlaceDB::coordinate_type xx = n.xl(); 
@@ -129,12 +217,7 @@ void DefWriter::writeComp(FILE* os, Node const& n,
             yy = y[n.id()];
         }
     }
-
-    fprintf(os, "  - %s %s\n", m_db.nodeName(n).c_str(), m_db.macroName(n).c_str());
-    fprintf(os, "    + %s ( %d %d ) %s ;\n", 
-            std::string(PlaceStatus(n.status())).c_str(), 
-            xx, yy, 
-            std::string(Orient(n.orient())).c_str());
+    return Point<PlaceDB::coordinate_type>(xx, yy);
 }
 std::string DefWriter::ltrim(std::string const& s) const 
 {
@@ -32,12 +32,25 @@ class DefWriter : public PlaceSolWriter
         bool writeSimple(std::string const& outFile, std::string const& version, std::string const& designName, 
                 std::vector<Node>::const_iterator first, std::vector<Node>::const_iterator last, 
                 PlaceDB::coordinate_type const* x = NULL, PlaceDB::coordinate_type const* y = NULL) const;
+        /// write simplified DEF file with only components that are unplaced 
+        /// or moved away from their positions in the input file 
+        /// \param first, last should contain components to check 
+        bool writeDelta(std::string const& outFile, std::string const& version, std::string const& designName, 
+                std::vector<Node>::const_iterator first, std::vector<Node>::const_iterator last, 
+                PlaceDB::coordinate_type const* x = NULL, PlaceDB::coordinate_type const* y = NULL) const;
 
     protected:
-        /// write components block 
+        /// write components block, components are formatted in parallel 
         void writeCompBlock(FILE* os, std::vector<Node>::const_iterator first, std::vector<Node>::const_iterator last, 
                 PlaceDB::coordinate_type const* x, PlaceDB::coordinate_type const* y) const;
-        void writeComp(FILE* os, Node const& n, 
+        /// write components block for a subset of nodes 
+        void writeCompBlock(FILE* os, std::vector<PlaceDB::index_type> const& vNodeId, 
+                PlaceDB::coordinate_type const* x, PlaceDB::coordinate_type const* y) const;
+        /// append a component to a buffer 
+        void formatComp(std::string& buf, Node const& n, 
+                PlaceDB::coordinate_type const* x, PlaceDB::coordinate_type const* y) const;
+        /// position of a node in the solution 
+        Point<PlaceDB::coordinate_type> position(Node const& n, 
                 PlaceDB::coordinate_type const* x, PlaceDB::coordinate_type const* y) const;
         /// trim leading whitespaces 
         std::string ltrim(std::string const& s) const; 
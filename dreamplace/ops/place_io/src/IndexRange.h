@@ -0,0 +1,51 @@
+/**
+ * @file   IndexRange.h
+ * @author agent
+ * @date   Oct 2026
+ * @brief  A lightweight view of consecutive indices in a flat array.
+ */
+
+#ifndef DREAMPLACE_INDEXRANGE_H
+#define DREAMPLACE_INDEXRANGE_H
+
+#include <cstddef>
+#include "utility/src/Msg.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// a view of [first, last) in a flat array, e.g., pins of a node in a CSR map.
+/// It does not own the data and is invalidated when the array is reallocated.
+/// @tparam T element type, can be const qualified for read-only views
+template <typename T>
+class IndexRange
+{
+    public:
+        typedef T value_type;
+        typedef T* iterator;
+        typedef T* const_iterator;
+        typedef std::size_t size_type;
+
+        IndexRange() : m_first(NULL), m_last(NULL) {}
+        IndexRange(T* first, T* last) : m_first(first), m_last(last) {}
+
+        iterator begin() const {return m_first;}
+        iterator end() const {return m_last;}
+        size_type size() const {return m_last-m_first;}
+        bool empty() const {return m_first == m_last;}
+        T& operator[](size_type i) const {return m_first[i];}
+        T& at(size_type i) const
+        {
+            dreamplaceAssertMsg(i < size(), "index %lu out of range %lu", i, size());
+            return m_first[i];
+        }
+        T& front() const {return *m_first;}
+        T& back() const {return *(m_last-1);}
+
+    protected:
+        T* m_first;
+        T* m_last;
+};
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * @file   MappedFile.h
+ * @author agent
+ * @date   Oct 2026
+ * @brief  Read-only memory-mapped file and helpers to split it into chunks.
+ */
+
+#ifndef DREAMPLACE_MAPPEDFILE_H
+#define DREAMPLACE_MAPPEDFILE_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "utility/src/Msg.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// class MappedFile maps a whole file into memory as read-only.
+/// The content is not null-terminated.
+class MappedFile
+{
+    public:
+        MappedFile() : m_data(NULL), m_size(0), m_fd(-1) {}
+        ~MappedFile() {close();}
+
+        /// @brief map a file
+        /// @param filename input file
+        /// @param advice madvise hint, e.g., MADV_SEQUENTIAL
+        /// @return true if succeed
+        bool open(std::string const& filename, int advice = MADV_SEQUENTIAL)
+        {
+            close();
+            m_fd = ::open(filename.c_str(), O_RDONLY);
+            if (m_fd < 0)
+            {
+                return false;
+            }
+            struct stat st;
+            if (fstat(m_fd, &st) != 0)
+            {
+                close();
+                return false;
+            }
+            m_size = st.st_size;
+            if (m_size == 0) // mmap does not accept empty files
+            {
+                return true;
+            }
+            void* addr = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+            if (addr == MAP_FAILED)
+            {
+                close();
+                return false;
+            }
+            m_data = static_cast<char const*>(addr);
+            madvise(addr, m_size, advice);
+            return true;
+        }
+        void close()
+        {
+            if (m_data)
+            {
+                munmap(const_cast<char*>(m_data), m_size);
+                m_data = NULL;
+            }
+            if (m_fd >= 0)
+            {
+                ::close(m_fd);
+                m_fd = -1;
+            }
+            m_size = 0;
+        }
+
+        char const* data() const {return m_data;}
+        char const* begin() const {return m_data;}
+        char const* end() const {return m_data+m_size;}
+        std::size_t size() const {return m_size;}
+    protected:
+        /// not copyable
+        MappedFile(MappedFile const&);
+        MappedFile& operator=(MappedFile const&);
+
+        char const* m_data;
+        std::size_t m_size;
+        int m_fd;
+};
+
+/// @brief move to the beginning of the next line, or last if there is no more line
+inline char const* nextLine(char const* first, char const* last)
+{
+    while (first != last && *first != '\n')
+    {
+        ++first;
+    }
+    return (first == last)? last : first+1;
+}
+
+/// @brief split [first, last) into at most n chunks whose boundaries are line starts
+/// @param pred only a line start for which pred(line, last) is true can be a boundary
+/// @return boundaries of length #chunks+1
+template <typename PredicateType>
+inline std::vector<char const*> splitLines(char const* first, char const* last, std::size_t n, PredicateType pred)
+{
+    std::vector<char const*> vBoundary (1, first);
+    std::size_t size = last-first;
+    n = std::max(n, (std::size_t)1);
+    for (std::size_t i = 1; i < n; ++i)
+    {
+        char const* p = std::max(first+size*i/n, vBoundary.back());
+        // if already at a line start, keep it
+        if (p != first && p[-1] != '\n')
+        {
+            p = nextLine(p, last);
+        }
+        while (p != last && !pred(p, last))
+        {
+            p = nextLine(p, last);
+        }
+        if (p != vBoundary.back() && p != last)
+        {
+            vBoundary.push_back(p);
+        }
+    }
+    vBoundary.push_back(last);
+    return vBoundary;
+}
+
+/// any line start is a valid boundary
+struct AnyLine
+{
+    bool operator()(char const*, char const*) const {return true;}
+};
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
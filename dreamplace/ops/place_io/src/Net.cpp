@@ -13,7 +13,6 @@ Net::Net()
     : Net::base_type()
     , m_bbox()
     , m_weight(1)
-    , m_vPinId()
 {
 }
 Net::Net(Net const& rhs)
@@ -34,7 +33,6 @@ void Net::copy(Net const& rhs)
 {
     m_bbox = rhs.m_bbox;
     m_weight = rhs.m_weight; 
-    m_vPinId = rhs.m_vPinId;
 }
 
 NetProperty::NetProperty() 
@@ -39,17 +39,11 @@ class Net : public Object
         weight_type weight() const {return m_weight;}
         Net& setWeight(weight_type w) {m_weight = w; return *this;}
 
-        std::vector<index_type> const& pins() const {return m_vPinId;}
-        std::vector<index_type>& pins() {return m_vPinId;}
-
-        /// \return the source pin index of the net 
-        index_type source() const {return (!m_vPinId.empty())? m_vPinId.front() : std::numeric_limits<index_type>::max();}
     protected:
         void copy(Net const& rhs);
 
         box_type m_bbox; ///< bounding box of net 
         weight_type m_weight; ///< weight of net 
-        std::vector<index_type> m_vPinId; ///< index of pins, the first one is source  
 };
 
 class NetProperty
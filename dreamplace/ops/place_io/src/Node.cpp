@@ -16,7 +16,7 @@ Node::Node()
     , m_status(PlaceStatusEnum::UNKNOWN)
     , m_multiRowAttr(MultiRowAttrEnum::SINGLE_ROW)
     , m_orient(OrientEnum::UNKNOWN)
-    , m_vPinId()
+    , m_initOrient(OrientEnum::UNKNOWN)
 {
 }
 Node::Node(Node const& rhs)
@@ -41,7 +41,7 @@ void Node::copy(Node const& rhs)
     m_status = rhs.m_status;
     m_multiRowAttr = rhs.m_multiRowAttr;
     m_orient = rhs.m_orient;
-    m_vPinId = rhs.m_vPinId;
+    m_initOrient = rhs.m_initOrient;
 }
 
 NodeProperty::NodeProperty() 
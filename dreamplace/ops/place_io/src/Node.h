@@ -47,8 +47,8 @@ class Node : public Box<Object::coordinate_type>, public Object
         point_type const& initPos() const {return m_initPos;}
         Node& setInitPos(point_type const& p) {m_initPos = p; return *this;}
 
-        std::vector<index_type> const& pins() const {return m_vPinId;}
-        std::vector<index_type>& pins() {return m_vPinId;}
+        OrientEnum::OrientType initOrient() const {return (OrientEnum::OrientType)m_initOrient;}
+        Node& setInitOrient(OrientEnum::OrientType o) {m_initOrient = o; return *this;}
 
         ///====  helper functions ====
         /// \return absolute position of a pin with given position of the node 
@@ -78,7 +78,7 @@ class Node : public Box<Object::coordinate_type>, public Object
         char m_status; ///< placement status, 2 bits are enough 
         char m_multiRowAttr; ///< multi-row attributes, 2 bits are enough 
         char m_orient; ///< orientation, 4 bits are enough
-        std::vector<index_type> m_vPinId; ///< index of pins 
+        char m_initOrient; ///< initial orientation 
 };
 
 /// cell property class 
@@ -21,6 +21,7 @@ std::string toString(SolutionFileFormat ff)
     {
         case DEF: return "DEF";
         case DEFSIMPLE: return "DEFSIMPLE";
+        case DEFDELTA: return "DEFDELTA";
         case BOOKSHELF: return "BOOKSHELF";
         case BOOKSHELFALL: return "BOOKSHELFALL";
         default: return "UNKNOWN";
@@ -31,6 +32,7 @@ UserParam::UserParam()
 {
     defOutput = "";
     rptOutput = "";
+    snapshotFile = "";
     targetUtil = 0;
     targetPinUtil = 0;
     targetPPR = 0;
@@ -57,6 +59,7 @@ UserParam::UserParam()
 
     fileFormat = DEF;
     maxIters = 6;
+    numThreads = 1;
 }
 bool UserParam::read(int argc, char** argv)
 {
@@ -91,6 +94,7 @@ bool UserParam::readNormal(int argc, char** argv, UserParamExtHelper const& help
         .add_option(Value<std::string>("--def_size_input", &defSizeInput, "input def size file for benchmarks from CUHK"))
         .add_option(Value<std::string>("--def_output", &defOutput, "output DEF file"))
         .add_option(Value<std::string>("--rpt_output", &rptOutput, "output HTML report file"))
+        .add_option(Value<std::string>("--snapshot", &snapshotFile, "binary snapshot of the database; load it if up to date, otherwise write it after parsing"))
         .add_option(Value<double>("--target_util", &targetUtil, "target utilization").default_value(defaultParam.targetUtil))
         .add_option(Value<double>("--target_pin_util", &targetPinUtil, "target pin utilization per site").default_value(defaultParam.targetPinUtil))
         .add_option(Value<double>("--target_ppr", &targetPPR, "target pin pair ratio").default_value(defaultParam.targetPPR))
@@ -116,8 +120,9 @@ bool UserParam::readNormal(int argc, char** argv, UserParamExtHelper const& help
         .add_option(Value<bool>("--draw_place_final", &drawPlaceFinal, "draw final placement").default_value(defaultParam.drawPlaceFinal))
         .add_option(Value<bool>("--draw_place_anime", &drawPlaceAnime, "draw placement for animation").default_value(defaultParam.drawPlaceAnime))
         .add_option(Value<std::string>("--draw_region", &drawRegionStr, "draw placement region").default_value(defaultDrawRegionStr))
-        .add_option(Value<std::string>("--file_format", &fileFormatStr, "file format to write placement solution <DEF | DEFSIMPLE | BOOKSHELF | BOOKSHELFALL>").default_value(toString(defaultParam.fileFormat)))
+        .add_option(Value<std::string>("--file_format", &fileFormatStr, "file format to write placement solution <DEF | DEFSIMPLE | DEFDELTA | BOOKSHELF | BOOKSHELFALL>").default_value(toString(defaultParam.fileFormat)))
         .add_option(Value<unsigned>("--max_iters", &maxIters, "maximum optimization iterations").default_value(defaultParam.maxIters))
+        .add_option(Value<int>("--num_threads", &numThreads, "number of threads for reading input files and writing solutions").default_value(defaultParam.numThreads))
         ;
     helper.addOptions(desc); // extension
 
@@ -161,12 +166,14 @@ bool UserParam::readNormal(int argc, char** argv, UserParamExtHelper const& help
             fileFormat = DEF;
         else if (limbo::iequals(fileFormatStr, "DEFSIMPLE"))
             fileFormat = DEFSIMPLE;
+        else if (limbo::iequals(fileFormatStr, "DEFDELTA"))
+            fileFormat = DEFDELTA;
         else if (limbo::iequals(fileFormatStr, "BOOKSHELF"))
             fileFormat = BOOKSHELF;
         else if (limbo::iequals(fileFormatStr, "BOOKSHELFALL"))
             fileFormat = BOOKSHELFALL;
         // if specified Bookshelf input, fileFormat should also be Bookshelf
-        if (defInput.empty() && (fileFormat == DEF || fileFormat == DEFSIMPLE))
+        if (defInput.empty() && (fileFormat == DEF || fileFormat == DEFSIMPLE || fileFormat == DEFDELTA))
         {
             fileFormat = BOOKSHELF;
             dreamplacePrint(kWARN, "DEF input file not specified, cannot output DEF file; set to DEFSIMPLE\n");
@@ -208,6 +215,7 @@ void UserParam::printParams() const
     dreamplacePrint(kINFO, "def_size_input = %s\n", defSizeInput.c_str());
     dreamplacePrint(kINFO, "def_output = %s\n", defOutput.c_str());
     dreamplacePrint(kINFO, "rpt_output = %s\n", rptOutput.c_str());
+    dreamplacePrint(kINFO, "snapshot = %s\n", snapshotFile.c_str());
     dreamplacePrint(kINFO, "target_util = %g\n", targetUtil);
     dreamplacePrint(kINFO, "max_displace = %g\n", maxDisplace);
     dreamplacePrint(kINFO, "bin size = (%u, %u) #rows\n", binSize[kX], binSize[kY]);
@@ -234,6 +242,7 @@ void UserParam::printParams() const
     dreamplacePrint(kINFO, "sort_nets_by_degree = %s\n", ((sortNetsByDegree)? "true" : "false"));
     dreamplacePrint(kINFO, "file_format = %s\n", toString(fileFormat).c_str());
     dreamplacePrint(kINFO, "max_iters = %u\n", maxIters);
+    dreamplacePrint(kINFO, "num_threads = %d\n", numThreads);
 }
 
 void UserParam::printWelcome() const
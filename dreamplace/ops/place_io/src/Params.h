@@ -22,6 +22,7 @@ enum SolutionFileFormat
 {
     DEF, // full DEF format
     DEFSIMPLE, // simplified DEF format with only component positions
+    DEFDELTA, // simplified DEF format with only components changed from the input
     BOOKSHELF, // write placement solution .plx in bookshlef format
     BOOKSHELFALL // write .nodes, .nets, ... in bookshlef format
 };
@@ -79,6 +80,9 @@ struct UserParam
     /// report output file
     std::string rptOutput; ///< report output in html format
 
+    /// binary snapshot of the built database
+    std::string snapshotFile; ///< load from it if up to date, otherwise write it after parsing
+
     /// specific metrics
     double targetUtil; ///< target utilization
     double targetPinUtil; ///< target pin utilization
@@ -109,6 +113,7 @@ struct UserParam
     /// additional options
     SolutionFileFormat fileFormat; ///< file format to write placement solution
     unsigned maxIters; ///< maximum optimization iterations
+    int numThreads; ///< number of threads for reading input files and writing solutions
 
     protected:
         /// read command line options
@@ -12,6 +12,7 @@
 #include "BookshelfWriter.h"
 #include "LefCbkHelper.h"
 #include "utility/src/utils.h"
+#include <numeric>
 //#include <boost/timer/timer.hpp>
 
 DREAMPLACE_BEGIN_NAMESPACE
@@ -254,7 +255,7 @@ void PlaceDB::add_def_component(DefParser::Component const& c)
     }
     deriveMultiRowAttr(node); // update MultiRowAttr
     if (node.status() == PlaceStatusEnum::FIXED || node.status() == PlaceStatusEnum::DUMMY_FIXED || node.status() == PlaceStatusEnum::PLACED)
-        node.setInitPos(ll(node));
+        node.setInitPos(ll(node)).setInitOrient(node.orient());
 
     // update statistics
     // may need to change the criteria of fixed cells according to benchmarks
@@ -268,9 +269,6 @@ void PlaceDB::add_def_component(DefParser::Component const& c)
         m_numMovable += 1;
         m_vMovableNodeIndex.push_back(node.id());
     }
-
-    // reserve space for pins in add_def_net
-    node.pins().reserve(m_vMacro.at(property.macroId()).macroPins().size());
 }
 void PlaceDB::resize_def_pin(int s)
 {
@@ -342,7 +340,7 @@ void PlaceDB::add_def_pin(DefParser::Pin const& p)
     if (node.status() == PlaceStatusEnum::FIXED || node.status() == PlaceStatusEnum::DUMMY_FIXED || node.status() == PlaceStatusEnum::PLACED)
     {
         node.set(p.origin[0]+bbox[0], p.origin[1]+bbox[1], p.origin[0]+bbox[2], p.origin[1]+bbox[3]);
-        node.setInitPos(ll(node));
+        node.setInitPos(ll(node)).setInitOrient(node.orient());
     }
 }
 void PlaceDB::resize_def_net(int s)
@@ -399,7 +397,6 @@ void PlaceDB::add_def_net(DefParser::Net const& n)
         m_numIgnoredNet += 1;
     }
     // nodes in a net may be IOPin
-    net.pins().reserve(n.vNetPin.size()); // reserve enough space
     for (unsigned i = 0, ie = n.vNetPin.size(); i < ie; ++i)
     {
         index_type nodeId;
@@ -452,7 +449,7 @@ void PlaceDB::add_def_placement_blockage(std::vector<std::vector<int> > const& v
         node.setOrient(OrientEnum::UNKNOWN);
         deriveMultiRowAttr(node);
         node.set(bbox[0], bbox[1], bbox[2], bbox[3]);
-        node.setInitPos(ll(node));
+        node.setInitPos(ll(node)).setInitOrient(node.orient());
 
         m_vPlaceBlockageIndex.push_back(node.id());
         ++m_numPlaceBlockages;
@@ -636,12 +633,14 @@ void PlaceDB::resize_bookshelf_node_terminals(int nn, int nt)
 {
     m_vNode.reserve(nn+nt);
     m_vNodeProperty.reserve(m_vNode.capacity());
+    m_mNodeName2Index.reserve(m_vNode.capacity());
 }
 void PlaceDB::resize_bookshelf_net(int n)
 {
     m_vNet.reserve(n);
     m_vNetProperty.reserve(n);
     m_vNetIgnoreFlag.reserve(n);
+    m_mNetName2Index.reserve(n);
 }
 void PlaceDB::resize_bookshelf_pin(int n)
 {
@@ -748,7 +747,6 @@ void PlaceDB::add_bookshelf_net(BookshelfParser::Net const& n)
         m_numIgnoredNet += 1;
     }
     // nodes in a net may be IOPin
-    net.pins().reserve(vNetPin.size()); // reserve enough space
     for (unsigned i = 0, ie = vNetPin.size(); i < ie; ++i)
     {
         BookshelfParser::NetPin const& netPin = vNetPin[i];
@@ -830,7 +828,7 @@ void PlaceDB::set_bookshelf_node_position(std::string const& name, double x, dou
         // simply fix them
         if (node.status() != PlaceStatusEnum::FIXED && node.height() > (rowHeight()*DUMMY_FIXED_NUM_ROWS))
         {
-            dreamplacePrint(kWARN, "detect large movable macros that will be handled differently from standard cells: %s %ldx%ld @(%d,%d) with %lu pins\n", nodeName(node).c_str(), node.width(), node.height(), node.xl(), node.yl(), node.pins().size());
+            dreamplacePrint(kWARN, "detect large movable macros that will be handled differently from standard cells: %s %ldx%ld @(%d,%d)\n", nodeName(node).c_str(), node.width(), node.height(), node.xl(), node.yl());
             node.setStatus(PlaceStatusEnum::DUMMY_FIXED);
         }
         deriveMultiRowAttr(node); // update MultiRowAttr
@@ -852,7 +850,7 @@ void PlaceDB::set_bookshelf_node_position(std::string const& name, double x, dou
         }
     }
     if (node.status() == PlaceStatusEnum::FIXED || node.status() == PlaceStatusEnum::DUMMY_FIXED || node.status() == PlaceStatusEnum::PLACED)
-        node.setInitPos(ll(node));
+        node.setInitPos(ll(node)).setInitOrient(node.orient());
 }
 void PlaceDB::set_bookshelf_net_weight(std::string const& name, double w) 
 {
@@ -958,6 +956,9 @@ bool PlaceDB::write(std::string const& filename, SolutionFileFormat ff, PlaceDB:
         case DEFSIMPLE:
             flag = DefWriter(*this).writeSimple(filename, defVersion(), designName(), nodes().begin(), nodes().begin()+m_numMovable+m_numFixed, x, y);
             break;
+        case DEFDELTA:
+            flag = DefWriter(*this).writeDelta(filename, defVersion(), designName(), nodes().begin(), nodes().begin()+m_numMovable+m_numFixed, x, y);
+            break;
         case BOOKSHELF:
             flag = BookShelfWriter(*this).write(filename, x, y);
             break;
@@ -1061,11 +1062,7 @@ Pin& PlaceDB::createPin(Net& net, Node& node, SignalDirect const& direct, Point<
     pin.setOffset(offset);
     pin.setDirect(direct);
 
-    // add pin index to net and node
-    node.pins().push_back(pin.id());
-    net.pins().push_back(pin.id());
-    if (pin.direct() == SignalDirectEnum::OUTPUT) // set the first pin in the net to be source
-        std::swap(net.pins().front(), net.pins().back());
+    // pin indices of nets and nodes are collected by buildPinMaps() after parsing 
 
     return pin;
 }
@@ -1119,7 +1116,8 @@ void PlaceDB::updateNodePinOffset(Node const& node, Orient const& origOrient, Or
 {
     index_type hvflip = computeFlipFlag(origOrient, newOrient);
 
-    for (std::vector<index_type>::const_iterator it = node.pins().begin(), ite = node.pins().end(); it != ite; ++it)
+    IndexRange<index_type const> vNodePin = nodePins(node);
+    for (IndexRange<index_type const>::const_iterator it = vNodePin.begin(), ite = vNodePin.end(); it != ite; ++it)
     {
         Pin& pin = this->pin(*it);
         pin.setOffset(Point<coordinate_type>(
@@ -1130,14 +1128,17 @@ void PlaceDB::updateNodePinOffset(Node const& node, Orient const& origOrient, Or
 }
 
 
-void PlaceDB::prepare(unsigned numRows, unsigned numNodes, unsigned numIOPin, unsigned numNets, unsigned numBlockages)
+void PlaceDB::prepare(unsigned numRows, unsigned numNodes, unsigned numIOPin, unsigned numNets, unsigned numBlockages, unsigned numPins)
 {
     m_vRow.reserve(numRows);
     m_vNode.reserve(numNodes+numIOPin);
     m_vNodeProperty.reserve(m_vNode.capacity());
+    m_mNodeName2Index.reserve(m_vNode.capacity());
     m_vNet.reserve(numNets);
     m_vNetProperty.reserve(numNets);
     m_vNetIgnoreFlag.reserve(numNets);
+    m_mNetName2Index.reserve(numNets);
+    m_vPin.reserve(numPins);
     m_vPlaceBlockageIndex.reserve(numBlockages);
 }
 
@@ -1273,11 +1274,43 @@ IOPinMacroConstIterator PlaceDB::iopinMacroEnd() const
     index_type last = m_vMacro.size();
     return IOPinMacroConstIterator(last, m_numMacro, last, this);
 }
+void PlaceDB::buildPinMaps()
+{
+    // counting pass 
+    m_vNode2PinStart.assign(m_vNode.size()+1, 0);
+    m_vNet2PinStart.assign(m_vNet.size()+1, 0);
+    for (std::vector<Pin>::const_iterator it = m_vPin.begin(), ite = m_vPin.end(); it != ite; ++it)
+    {
+        m_vNode2PinStart[it->nodeId()+1] += 1;
+        m_vNet2PinStart[it->netId()+1] += 1;
+    }
+    std::partial_sum(m_vNode2PinStart.begin(), m_vNode2PinStart.end(), m_vNode2PinStart.begin());
+    std::partial_sum(m_vNet2PinStart.begin(), m_vNet2PinStart.end(), m_vNet2PinStart.begin());
+
+    // filling pass in the order of pin creation 
+    m_vNode2Pin.resize(m_vPin.size());
+    m_vNet2Pin.resize(m_vPin.size());
+    std::vector<index_type> vNodeCursor (m_vNode2PinStart.begin(), m_vNode2PinStart.end()-1);
+    std::vector<index_type> vNetCursor (m_vNet2PinStart.begin(), m_vNet2PinStart.end()-1);
+    for (index_type i = 0, ie = m_vPin.size(); i < ie; ++i)
+    {
+        Pin const& pin = m_vPin[i];
+        m_vNode2Pin[vNodeCursor[pin.nodeId()]++] = i;
+        index_type& cursor = vNetCursor[pin.netId()];
+        m_vNet2Pin[cursor] = i;
+        if (pin.direct() == SignalDirectEnum::OUTPUT) // set the first pin in the net to be source
+            std::swap(m_vNet2Pin[m_vNet2PinStart[pin.netId()]], m_vNet2Pin[cursor]);
+        ++cursor;
+    }
+}
 void PlaceDB::adjustParams()
 {
     dreamplacePrint(kWARN, "%lu nets with %lu pins from same nodes\n", m_numNetsWithDuplicatePins, m_numPinsDuplicatedInNets);
     dreamplacePrint(kWARN, "%lu nets should be ignored due to not enough pins\n", std::count(m_vNetIgnoreFlag.begin(), m_vNetIgnoreFlag.end(), true));
 
+    // collect pins of nodes and nets 
+    buildPinMaps();
+
     // sort nodes such that
     // movable cells are followed by fixed cells
     sortNodeByPlaceStatus();
@@ -1434,9 +1467,10 @@ void PlaceDB::printNode(PlaceDB::index_type id) const
 {
     Node const& node = nodes().at(id);
     dreamplacePrint(kNONE, "node %u: \n", node.id());
-    for (index_type i = 0; i < node.pins().size(); ++i)
+    IndexRange<index_type const> vNodePin = nodePins(node);
+    for (index_type i = 0; i < vNodePin.size(); ++i)
     {
-        Pin const& pin = pins().at(node.pins().at(i));
+        Pin const& pin = pins().at(vNodePin.at(i));
         dreamplacePrint(kNONE, "[%u] pin %u, net %u, offset (%d,%d)\n",
                 i, pin.id(), pin.netId(), pin.offset().x(), pin.offset().y());
     }
@@ -1445,9 +1479,10 @@ void PlaceDB::printNet(PlaceDB::index_type id) const
 {
     Net const& net = nets().at(id);
     dreamplacePrint(kNONE, "net %u: \n", net.id());
-    for (index_type i = 0; i < net.pins().size(); ++i)
+    IndexRange<index_type const> vNetPin = netPins(net);
+    for (index_type i = 0; i < vNetPin.size(); ++i)
     {
-        Pin const& pin = pins().at(net.pins().at(i));
+        Pin const& pin = pins().at(vNetPin.at(i));
         dreamplacePrint(kNONE, "[%u] pin %u, node %u, offset (%d,%d)\n",
                 i, pin.id(), pin.nodeId(), pin.offset().x(), pin.offset().y());
     }
@@ -1455,15 +1490,15 @@ void PlaceDB::printNet(PlaceDB::index_type id) const
 
 struct ArgSortNetByDegree
 {
-    std::vector<Net> const& vNet;
+    std::vector<PlaceDB::index_type> const& vNet2PinStart;
 
-    ArgSortNetByDegree(std::vector<Net> const& v) : vNet(v)
+    ArgSortNetByDegree(std::vector<PlaceDB::index_type> const& v) : vNet2PinStart(v)
     {
     }
     bool operator()(PlaceDB::index_type i, PlaceDB::index_type j) const
     {
-        PlaceDB::index_type degree1 = vNet[i].pins().size();
-        PlaceDB::index_type degree2 = vNet[j].pins().size();
+        PlaceDB::index_type degree1 = vNet2PinStart[i+1]-vNet2PinStart[i];
+        PlaceDB::index_type degree2 = vNet2PinStart[j+1]-vNet2PinStart[j];
         return degree1 < degree2 || (degree1 == degree2 && i < j);
     }
 };
@@ -1483,6 +1518,22 @@ struct ArgSortPinByNet
     }
 };
 
+/// reorder rows of a flat map in CSR format such that row i is old row vNew2Old[i]
+void permuteFlatMap(std::vector<PlaceDB::index_type>& vStart, std::vector<PlaceDB::index_type>& vFlat, std::vector<PlaceDB::index_type> const& vNew2Old)
+{
+    std::vector<PlaceDB::index_type> vNewStart (vStart.size());
+    std::vector<PlaceDB::index_type> vNewFlat (vFlat.size());
+    vNewStart[0] = 0;
+    for (PlaceDB::index_type i = 0, ie = vNew2Old.size(); i < ie; ++i)
+    {
+        PlaceDB::index_type old = vNew2Old[i];
+        std::copy(vFlat.begin()+vStart[old], vFlat.begin()+vStart[old+1], vNewFlat.begin()+vNewStart[i]);
+        vNewStart[i+1] = vNewStart[i] + (vStart[old+1]-vStart[old]);
+    }
+    vStart.swap(vNewStart);
+    vFlat.swap(vNewFlat);
+}
+
 void PlaceDB::sortNetByDegree()
 {
     dreamplacePrint(kINFO, "sort nets from small degree to large degree and pins with neighboring pins belonging to the same net\n");
@@ -1492,7 +1543,7 @@ void PlaceDB::sortNetByDegree()
     for (index_type i = 0, ie = vNetOrder.size(); i != ie; ++i)
         vNetOrder[i] = i;
 
-    std::sort(vNetOrder.begin(), vNetOrder.end(), ArgSortNetByDegree(m_vNet));
+    std::sort(vNetOrder.begin(), vNetOrder.end(), ArgSortNetByDegree(m_vNet2PinStart));
 
     // map net id to order
     std::vector<index_type> vNetId2Order (m_vNet.size());
@@ -1522,13 +1573,14 @@ void PlaceDB::sortNetByDegree()
     for (index_type i = 1, ie = vNetOrder.size(); i != ie; ++i)
     {
         dreamplaceAssert(m_vNet[i].id() == vNetOrder[i]);
-        dreamplaceAssertMsg(m_vNet[i-1].pins().size() <= m_vNet[i].pins().size(), "permuting nets error");
+        dreamplaceAssertMsg(netPins(m_vNet[i-1]).size() <= netPins(m_vNet[i]).size(), "permuting nets error");
     }
     // update net id and pin to net id
     for (index_type i = 0, ie = m_vNet.size(); i != ie; ++i)
     {
         Net& net = m_vNet[i];
-        for (std::vector<index_type>::const_iterator it = net.pins().begin(), ite = net.pins().end(); it != ite; ++it)
+        IndexRange<index_type const> vNetPin = netPins(net);
+        for (IndexRange<index_type const>::const_iterator it = vNetPin.begin(), ite = vNetPin.end(); it != ite; ++it)
         {
             // we have not update the net id yet
             // so it should be consistent
@@ -1537,6 +1589,8 @@ void PlaceDB::sortNetByDegree()
         }
         net.setId(i);
     }
+    // rows of net-to-pin map follow the new net order
+    permuteFlatMap(m_vNet2PinStart, m_vNet2Pin, vNetOrder);
 
     // sort m_vPin, m_vNode
     std::vector<index_type> vPinOrder (m_vPin.size());
@@ -1572,28 +1626,20 @@ void PlaceDB::sortNetByDegree()
     // update pins in node
     for (index_type i = 0, ie = vPinOrder.size(); i != ie; ++i)
         vPinId2Order[vPinOrder[i]] = i;
-    for (std::vector<Node>::iterator it = m_vNode.begin(), ite = m_vNode.end(); it != ite; ++it)
+    for (std::vector<index_type>::iterator itp = m_vNode2Pin.begin(), itpe = m_vNode2Pin.end(); itp != itpe; ++itp)
     {
-        Node& node = *it;
-        for (std::vector<index_type>::iterator itp = node.pins().begin(), itpe = node.pins().end(); itp != itpe; ++itp)
-        {
-            // since the pin id has not been updated yet
-            // we can check the correctness
-            dreamplaceAssert(m_vPin[vPinId2Order[*itp]].id() == *itp);
-            *itp = vPinId2Order[*itp];
-        }
+        // since the pin id has not been updated yet
+        // we can check the correctness
+        dreamplaceAssert(m_vPin[vPinId2Order[*itp]].id() == *itp);
+        *itp = vPinId2Order[*itp];
     }
     // update pins in net
-    for (std::vector<Net>::iterator it = m_vNet.begin(), ite = m_vNet.end(); it != ite; ++it)
+    for (std::vector<index_type>::iterator itp = m_vNet2Pin.begin(), itpe = m_vNet2Pin.end(); itp != itpe; ++itp)
     {
-        Net& net = *it;
-        for (std::vector<index_type>::iterator itp = net.pins().begin(), itpe = net.pins().end(); itp != itpe; ++itp)
-        {
-            // since the pin id has not been updated yet
-            // we can check the correctness
-            dreamplaceAssert(m_vPin[vPinId2Order[*itp]].id() == *itp);
-            *itp = vPinId2Order[*itp];
-        }
+        // since the pin id has not been updated yet
+        // we can check the correctness
+        dreamplaceAssert(m_vPin[vPinId2Order[*itp]].id() == *itp);
+        *itp = vPinId2Order[*itp];
     }
     // update pin id
     for (index_type i = 0, ie = m_vPin.size(); i != ie; ++i)
@@ -1606,7 +1652,8 @@ void PlaceDB::sortNetByDegree()
     for (std::vector<Node>::const_iterator it = m_vNode.begin(), ite = m_vNode.end(); it != ite; ++it)
     {
         Node const& node = *it;
-        for (std::vector<index_type>::const_iterator itp = node.pins().begin(), itpe = node.pins().end(); itp != itpe; ++itp)
+        IndexRange<index_type const> vNodePin = nodePins(node);
+        for (IndexRange<index_type const>::const_iterator itp = vNodePin.begin(), itpe = vNodePin.end(); itp != itpe; ++itp)
         {
             Pin const& pin = m_vPin[*itp];
             dreamplaceAssert(pin.nodeId() == node.id());
@@ -1615,7 +1662,8 @@ void PlaceDB::sortNetByDegree()
     for (std::vector<Net>::const_iterator it = m_vNet.begin(), ite = m_vNet.end(); it != ite; ++it)
     {
         Net const& net = *it;
-        for (std::vector<index_type>::const_iterator itp = net.pins().begin(), itpe = net.pins().end(); itp != itpe; ++itp)
+        IndexRange<index_type const> vNetPin = netPins(net);
+        for (IndexRange<index_type const>::const_iterator itp = vNetPin.begin(), itpe = vNetPin.end(); itp != itpe; ++itp)
         {
             Pin const& pin = m_vPin[*itp];
             dreamplaceAssert(pin.netId() == net.id());
@@ -1695,18 +1743,25 @@ void PlaceDB::sortNodeByPlaceStatus()
                 );
     }
     // update node id and pin to node id
+    // rows of node-to-pin map follow the new node order
+    std::vector<index_type> vNewNode2Old (m_vNode.size());
+    for (index_type i = 0, ie = m_vNode.size(); i != ie; ++i)
+        vNewNode2Old[i] = i;
     for (index_type i = 0, ie = vNodeOrder.size(); i != ie; ++i)
     {
         Node& node = m_vNode[i];
-        for (std::vector<index_type>::const_iterator it = node.pins().begin(), ite = node.pins().end(); it != ite; ++it)
+        IndexRange<index_type const> vNodePin = nodePins(node);
+        for (IndexRange<index_type const>::const_iterator it = vNodePin.begin(), ite = vNodePin.end(); it != ite; ++it)
         {
             // we have not update the node id yet
             // so it should be consistent
             dreamplaceAssert(m_vPin[*it].nodeId() == node.id());
             m_vPin[*it].setNodeId(i);
         }
+        vNewNode2Old[i] = node.id();
         node.setId(i);
     }
+    permuteFlatMap(m_vNode2PinStart, m_vNode2Pin, vNewNode2Old);
 
     m_vMovableNodeIndex.clear();
     m_vFixedNodeIndex.clear();
@@ -1746,18 +1801,23 @@ void PlaceDB::sortNodeByPlaceStatus()
             m_mNodeName2Index[m_vNodeProperty[i].name()] = i; 
         }
         // update node id and pin to node id for IO pins 
+        for (index_type i = 0, ie = m_vNode.size(); i != ie; ++i)
+            vNewNode2Old[i] = i;
         for (index_type i = m_vNode.size() - numIOPin() - numPlaceBlockages(), ie = m_vNode.size(); i < ie; ++i)
         {
             Node& node = m_vNode[i]; 
-            for (std::vector<index_type>::const_iterator it = node.pins().begin(), ite = node.pins().end(); it != ite; ++it)
+            IndexRange<index_type const> vNodePin = nodePins(node);
+            for (IndexRange<index_type const>::const_iterator it = vNodePin.begin(), ite = vNodePin.end(); it != ite; ++it)
             {
                 // we have not update the node id yet
                 // so it should be consistent
                 dreamplaceAssert(m_vPin[*it].nodeId() == node.id());
                 m_vPin[*it].setNodeId(i);
             }
+            vNewNode2Old[i] = node.id();
             node.setId(i);
         }
+        permuteFlatMap(m_vNode2PinStart, m_vNode2Pin, vNewNode2Old);
 
         // update blockage indices
         m_vPlaceBlockageIndex.clear();
@@ -1774,7 +1834,8 @@ void PlaceDB::sortNodeByPlaceStatus()
     for (std::vector<Node>::const_iterator it = m_vNode.begin(), ite = m_vNode.end(); it != ite; ++it)
     {
         Node const& node = *it;
-        for (std::vector<index_type>::const_iterator itp = node.pins().begin(), itpe = node.pins().end(); itp != itpe; ++itp)
+        IndexRange<index_type const> vNodePin = nodePins(node);
+        for (IndexRange<index_type const>::const_iterator itp = vNodePin.begin(), itpe = vNodePin.end(); itp != itpe; ++itp)
         {
             Pin const& pin = m_vPin.at(*itp);
             dreamplaceAssert(pin.nodeId() == node.id());
@@ -1783,7 +1844,8 @@ void PlaceDB::sortNodeByPlaceStatus()
     for (std::vector<Net>::const_iterator it = m_vNet.begin(), ite = m_vNet.end(); it != ite; ++it)
     {
         Net const& net = *it;
-        for (std::vector<index_type>::const_iterator itp = net.pins().begin(), itpe = net.pins().end(); itp != itpe; ++itp)
+        IndexRange<index_type const> vNetPin = netPins(net);
+        for (IndexRange<index_type const>::const_iterator itp = vNetPin.begin(), itpe = vNetPin.end(); itp != itpe; ++itp)
         {
             Pin const& pin = m_vPin.at(*itp);
             dreamplaceAssert(pin.netId() == net.id());
@@ -23,6 +23,7 @@
 #include "Region.h"
 #include "Group.h"
 #include "Site.h"
+#include "IndexRange.h"
 #include "Params.h"
 #include "BenchMetrics.h"
 
@@ -41,6 +42,7 @@ template <typename PlaceDBType, typename IteratorTagType>
 class DBIterator;
 
 class PlaceDB;
+class PlaceDBSnapshot;
 
 /// iterator 
 typedef DBIterator<PlaceDB, MovableNodeIteratorTag> MovableNodeIterator;
@@ -61,6 +63,8 @@ class PlaceDB : public DefParser::DefDataBase
                 , public BookshelfParser::BookshelfDataBase
 {
     public:
+        friend class PlaceDBSnapshot;
+
         typedef Object::coordinate_type coordinate_type;
         typedef coordinate_traits<coordinate_type>::manhattan_distance_type manhattan_distance_type;
         typedef coordinate_traits<coordinate_type>::index_type index_type;
@@ -99,6 +103,19 @@ class PlaceDB : public DefParser::DefDataBase
         Pin const& pin(index_type id) const {return m_vPin.at(id);}
         Pin& pin(index_type id) {return m_vPin.at(id);}
 
+        /// pins of a node or a net, only valid after buildPinMaps() 
+        IndexRange<index_type const> nodePins(Node const& n) const {return IndexRange<index_type const>(m_vNode2Pin.data()+m_vNode2PinStart.at(n.id()), m_vNode2Pin.data()+m_vNode2PinStart.at(n.id()+1));}
+        IndexRange<index_type> nodePins(Node const& n) {return IndexRange<index_type>(m_vNode2Pin.data()+m_vNode2PinStart.at(n.id()), m_vNode2Pin.data()+m_vNode2PinStart.at(n.id()+1));}
+        IndexRange<index_type const> netPins(Net const& n) const {return IndexRange<index_type const>(m_vNet2Pin.data()+m_vNet2PinStart.at(n.id()), m_vNet2Pin.data()+m_vNet2PinStart.at(n.id()+1));}
+        IndexRange<index_type> netPins(Net const& n) {return IndexRange<index_type>(m_vNet2Pin.data()+m_vNet2PinStart.at(n.id()), m_vNet2Pin.data()+m_vNet2PinStart.at(n.id()+1));}
+        /// \return the source pin index of the net 
+        index_type netSource(Net const& n) const {IndexRange<index_type const> r = netPins(n); return (!r.empty())? r.front() : std::numeric_limits<index_type>::max();}
+        /// flat node-to-pin and net-to-pin maps in CSR format 
+        std::vector<index_type> const& flatNode2PinStartMap() const {return m_vNode2PinStart;}
+        std::vector<index_type> const& flatNode2PinMap() const {return m_vNode2Pin;}
+        std::vector<index_type> const& flatNet2PinStartMap() const {return m_vNet2PinStart;}
+        std::vector<index_type> const& flatNet2PinMap() const {return m_vNet2Pin;}
+
         std::vector<Macro> const& macros() const {return m_vMacro;}
         std::vector<Macro>& macros() {return m_vMacro;}
         Macro const& macro(index_type id) const {return m_vMacro.at(id);}
@@ -250,6 +267,9 @@ class PlaceDB : public DefParser::DefDataBase
         /// adjust user input parameters 
         /// must be called after parsing input files 
         void adjustParams();
+        /// build flat node-to-pin and net-to-pin maps from m_vPin 
+        /// with two passes of counting and filling; called by adjustParams() 
+        void buildPinMaps();
         /// sort net from small degrees to large degrees 
         /// sort pins such that all pins belonging to the same net is adjacent 
         void sortNetByDegree();
@@ -365,7 +385,7 @@ class PlaceDB : public DefParser::DefDataBase
 
         ///==== prepare data ==== 
         /// mainly used to reserve spaces 
-        virtual void prepare(unsigned numRows, unsigned numNodes, unsigned numIOPin, unsigned numNets, unsigned numBlockages);
+        virtual void prepare(unsigned numRows, unsigned numNodes, unsigned numIOPin, unsigned numNets, unsigned numBlockages, unsigned numPins = 0);
 
         /// report statistics 
         virtual void reportStats();
@@ -408,6 +428,10 @@ class PlaceDB : public DefParser::DefDataBase
         std::vector<Net> m_vNet; ///< nets 
         std::vector<NetProperty> m_vNetProperty; ///< some unimportant properties for nets, together with m_vNet
         std::vector<Pin> m_vPin; ///< pins for instances and nets, the offset of a pin must be adjusted when a node is moved 
+        std::vector<index_type> m_vNode2PinStart; ///< start of pins of each node in m_vNode2Pin, length of #nodes+1 
+        std::vector<index_type> m_vNode2Pin; ///< pins of all nodes, ordered by creation within a node 
+        std::vector<index_type> m_vNet2PinStart; ///< start of pins of each net in m_vNet2Pin, length of #nets+1 
+        std::vector<index_type> m_vNet2Pin; ///< pins of all nets, the first pin of a net is its source 
         std::vector<Macro> m_vMacro; ///< macros for standard cells, for io pins, virtual macros are appended  
         std::vector<Row> m_vRow; ///< placement rows 
         Site m_site; ///< placement site 
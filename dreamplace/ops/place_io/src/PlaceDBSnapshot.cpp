@@ -0,0 +1,1145 @@
+/**
+ * @file   PlaceDBSnapshot.cpp
+ * @author agent
+ * @date   Oct 2026
+ */
+
+#include "PlaceDBSnapshot.h"
+#include "MappedFile.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <stdint.h>
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+namespace snapshot
+{
+
+/// sections of a snapshot file
+/// the order does not matter, as each section is located by its tag
+enum SectionTag
+{
+    kScalars,
+    kStringChars,
+    kStringOffsets,
+    kNodes,
+    kNode2PinStart,
+    kNode2Pin,
+    kNets,
+    kNet2PinStart,
+    kNet2Pin,
+    kPins,
+    kMacros,
+    kMacroPins,
+    kMacroPorts,
+    kMacroPortBoxes,
+    kMacroObs,
+    kMacroObsBoxes,
+    kRows,
+    kRegions,
+    kRegionBoxes,
+    kGroups,
+    kGroupNodeNames,
+    kGroupNodes,
+    kMovableNodes,
+    kFixedNodes,
+    kPlaceBlockages,
+    kDuplicateNets,
+    kNumSections
+};
+
+/// file header
+struct Header
+{
+    char magic[8]; ///< "DPSNAP"
+    uint32_t version; ///< format version
+    uint32_t endian; ///< 0x01020304 written in native byte order
+    uint32_t coordinateSize; ///< sizeof(coordinate_type)
+    uint32_t indexSize; ///< sizeof(index_type)
+    uint64_t fingerprint; ///< fingerprint of input files
+    uint64_t fileSize; ///< total size of the file in bytes
+    uint32_t numSections; ///< number of entries in the section table
+    uint32_t reserved;
+};
+
+/// an entry in the section table
+struct Section
+{
+    uint32_t tag; ///< SectionTag
+    uint32_t recordSize; ///< size of one record in bytes
+    uint64_t offset; ///< offset of the first record from the beginning of the file
+    uint64_t count; ///< number of records
+};
+
+struct BoxRecord
+{
+    int32_t xl;
+    int32_t yl;
+    int32_t xh;
+    int32_t yh;
+};
+
+struct ScalarsRecord
+{
+    uint64_t numMovable;
+    uint64_t numFixed;
+    uint64_t numMacro;
+    uint64_t numIOPin;
+    uint64_t numIgnoredNet;
+    uint64_t numPlaceBlockages;
+    uint64_t numNetsWithDuplicatePins;
+    uint64_t numPinsDuplicatedInNets;
+    BoxRecord dieArea;
+    BoxRecord rowBbox;
+    int32_t lefUnit;
+    int32_t defUnit;
+    int32_t siteSize[2];
+    uint32_t siteName;
+    uint32_t siteClassName;
+    uint32_t siteSymmetry;
+    uint32_t lefVersion;
+    uint32_t defVersion;
+    uint32_t designName;
+};
+
+struct NodeRecord
+{
+    BoxRecord box;
+    int32_t initPos[2];
+    uint32_t name;
+    uint32_t macroId;
+    uint8_t status;
+    uint8_t multiRowAttr;
+    uint8_t orient;
+    uint8_t initOrient;
+};
+
+struct NetRecord
+{
+    double weight;
+    BoxRecord bbox;
+    uint32_t name;
+    uint32_t ignore;
+};
+
+struct PinRecord
+{
+    uint32_t macroPinId;
+    uint32_t nodeId;
+    uint32_t netId;
+    int32_t offset[2];
+    uint32_t direct;
+};
+
+struct MacroRecord
+{
+    BoxRecord box;
+    int32_t initOrigin[2];
+    uint32_t name;
+    uint32_t className;
+    uint32_t siteName;
+    uint32_t edgeName[2];
+    uint32_t symmetry;
+    uint32_t macroPinBegin; ///< range in kMacroPins
+    uint32_t macroPinEnd;
+    uint32_t obsBegin; ///< range in kMacroObs
+    uint32_t obsEnd;
+};
+
+struct MacroPinRecord
+{
+    BoxRecord bbox;
+    uint32_t name;
+    uint32_t direct;
+    uint32_t portBegin; ///< range in kMacroPorts
+    uint32_t portEnd;
+};
+
+struct MacroPortRecord
+{
+    BoxRecord bbox;
+    uint32_t boxBegin; ///< range in kMacroPortBoxes
+    uint32_t boxEnd;
+};
+
+/// a box with a layer name
+struct LayerBoxRecord
+{
+    BoxRecord box;
+    uint32_t layer;
+    uint32_t reserved;
+};
+
+struct MacroObsRecord
+{
+    uint32_t layer;
+    uint32_t boxBegin; ///< range in kMacroObsBoxes
+    uint32_t boxEnd;
+    uint32_t reserved;
+};
+
+struct RowRecord
+{
+    BoxRecord box;
+    int32_t step[2];
+    uint32_t name;
+    uint32_t macroName;
+    uint32_t orient;
+    uint32_t reserved;
+};
+
+struct RegionRecord
+{
+    uint32_t name;
+    uint32_t type;
+    uint32_t boxBegin; ///< range in kRegionBoxes
+    uint32_t boxEnd;
+};
+
+struct GroupRecord
+{
+    uint32_t name;
+    uint32_t region;
+    uint32_t nodeNameBegin; ///< range in kGroupNodeNames
+    uint32_t nodeNameEnd;
+    uint32_t nodeBegin; ///< range in kGroupNodes
+    uint32_t nodeEnd;
+};
+
+static const char kMagic[8] = {'D', 'P', 'S', 'N', 'A', 'P', '\0', '\0'};
+static const uint32_t kEndian = 0x01020304;
+
+template <typename T>
+inline BoxRecord toRecord(Box<T> const& b)
+{
+    BoxRecord r;
+    r.xl = b.xl();
+    r.yl = b.yl();
+    r.xh = b.xh();
+    r.yh = b.yh();
+    return r;
+}
+
+inline Box<PlaceDB::coordinate_type> fromRecord(BoxRecord const& r)
+{
+    return Box<PlaceDB::coordinate_type>(r.xl, r.yl, r.xh, r.yh);
+}
+
+/// collect all strings into one character array
+class StringPool
+{
+    public:
+        StringPool() : m_vOffset(1, 0) {}
+
+        uint32_t add(std::string const& s)
+        {
+            m_vChar.insert(m_vChar.end(), s.begin(), s.end());
+            m_vOffset.push_back(m_vChar.size());
+            return m_vOffset.size()-2;
+        }
+        std::vector<char> const& chars() const {return m_vChar;}
+        std::vector<uint64_t> const& offsets() const {return m_vOffset;}
+    protected:
+        std::vector<char> m_vChar;
+        std::vector<uint64_t> m_vOffset; ///< length of #strings+1
+};
+
+/// buffered sections before writing
+class SectionWriter
+{
+    public:
+        SectionWriter() : m_vSection(kNumSections), m_vData(kNumSections)
+        {
+            for (uint32_t i = 0; i < kNumSections; ++i)
+            {
+                m_vSection[i].tag = i;
+                m_vSection[i].recordSize = 0;
+                m_vSection[i].offset = 0;
+                m_vSection[i].count = 0;
+            }
+        }
+
+        template <typename T>
+        void set(SectionTag tag, T const* data, std::size_t count)
+        {
+            m_vSection[tag].recordSize = sizeof(T);
+            m_vSection[tag].count = count;
+            m_vData[tag] = reinterpret_cast<char const*>(data);
+        }
+        template <typename T>
+        void set(SectionTag tag, std::vector<T> const& v)
+        {
+            set(tag, v.data(), v.size());
+        }
+
+        bool write(std::string const& filename, uint64_t fingerprint)
+        {
+            // layout: header, section table, 8-byte aligned payloads
+            uint64_t offset = align(sizeof(Header) + sizeof(Section)*kNumSections);
+            for (uint32_t i = 0; i < kNumSections; ++i)
+            {
+                m_vSection[i].offset = offset;
+                offset = align(offset + m_vSection[i].recordSize*m_vSection[i].count);
+            }
+
+            Header header;
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, kMagic, sizeof(kMagic));
+            header.version = PlaceDBSnapshot::version;
+            header.endian = kEndian;
+            header.coordinateSize = sizeof(PlaceDB::coordinate_type);
+            header.indexSize = sizeof(PlaceDB::index_type);
+            header.fingerprint = fingerprint;
+            header.fileSize = offset;
+            header.numSections = kNumSections;
+
+            // write to a temporary file first, so an interrupted run never leaves a broken snapshot
+            std::string tmpFilename = filename + ".tmp";
+            FILE* out = fopen(tmpFilename.c_str(), "wb");
+            if (out == NULL)
+            {
+                dreamplacePrint(kERROR, "unable to open %s for write\n", tmpFilename.c_str());
+                return false;
+            }
+            bool flag = (fwrite(&header, sizeof(header), 1, out) == 1);
+            flag = flag && (fwrite(m_vSection.data(), sizeof(Section), kNumSections, out) == kNumSections);
+            uint64_t pos = sizeof(Header) + sizeof(Section)*kNumSections;
+            static const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+            for (uint32_t i = 0; flag && i < kNumSections; ++i)
+            {
+                Section const& section = m_vSection[i];
+                flag = (fwrite(padding, 1, section.offset-pos, out) == section.offset-pos);
+                uint64_t bytes = section.recordSize*section.count;
+                if (flag && bytes)
+                {
+                    flag = (fwrite(m_vData[i], 1, bytes, out) == bytes);
+                }
+                pos = section.offset + bytes;
+            }
+            flag = flag && (fwrite(padding, 1, header.fileSize-pos, out) == header.fileSize-pos);
+            flag = (fclose(out) == 0) && flag;
+            if (flag)
+            {
+                flag = (rename(tmpFilename.c_str(), filename.c_str()) == 0);
+            }
+            if (!flag)
+            {
+                dreamplacePrint(kERROR, "failed to write %s\n", filename.c_str());
+                remove(tmpFilename.c_str());
+            }
+            return flag;
+        }
+    protected:
+        static uint64_t align(uint64_t v) {return (v+7) & ~uint64_t(7);}
+
+        std::vector<Section> m_vSection;
+        std::vector<char const*> m_vData; ///< the data is owned by the caller
+};
+
+/// read-only view of a memory-mapped snapshot
+class SectionReader
+{
+    public:
+        SectionReader() : m_data(NULL), m_size(0), m_vSection(NULL) {}
+
+        /// map the file and validate the header and section table
+        bool open(std::string const& filename, uint64_t fingerprint)
+        {
+            if (!m_file.open(filename))
+            {
+                return false;
+            }
+            m_data = m_file.data();
+            m_size = m_file.size();
+            if (m_size < sizeof(Header))
+            {
+                dreamplacePrint(kWARN, "snapshot %s is broken, ignored\n", filename.c_str());
+                return false;
+            }
+
+            Header const& header = *reinterpret_cast<Header const*>(m_data);
+            if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0
+                    || header.endian != kEndian
+                    || header.coordinateSize != sizeof(PlaceDB::coordinate_type)
+                    || header.indexSize != sizeof(PlaceDB::index_type))
+            {
+                dreamplacePrint(kWARN, "%s is not a compatible snapshot, ignored\n", filename.c_str());
+                return false;
+            }
+            if (header.version != PlaceDBSnapshot::version)
+            {
+                dreamplacePrint(kWARN, "snapshot %s has version %u, expect %u, ignored\n", filename.c_str(), header.version, PlaceDBSnapshot::version);
+                return false;
+            }
+            if (header.fingerprint != fingerprint)
+            {
+                dreamplacePrint(kINFO, "snapshot %s is outdated with respect to the input files, ignored\n", filename.c_str());
+                return false;
+            }
+            if (header.fileSize != m_size || header.numSections != kNumSections
+                    || sizeof(Header) + sizeof(Section)*kNumSections > m_size)
+            {
+                dreamplacePrint(kWARN, "snapshot %s is truncated, ignored\n", filename.c_str());
+                return false;
+            }
+            m_vSection = reinterpret_cast<Section const*>(m_data + sizeof(Header));
+            for (uint32_t i = 0; i < kNumSections; ++i)
+            {
+                Section const& section = m_vSection[i];
+                if (section.tag != i || section.offset % 8 || section.offset + section.recordSize*section.count > m_size)
+                {
+                    dreamplacePrint(kWARN, "snapshot %s has invalid section %u, ignored\n", filename.c_str(), i);
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /// \return pointer to the records of a section, or NULL if the record size mismatches
+        template <typename T>
+        T const* get(SectionTag tag, std::size_t& count) const
+        {
+            Section const& section = m_vSection[tag];
+            if (section.recordSize != sizeof(T) && section.count)
+            {
+                dreamplacePrint(kWARN, "snapshot section %u has record size %u, expect %u\n", (uint32_t)tag, section.recordSize, (uint32_t)sizeof(T));
+                count = 0;
+                return NULL;
+            }
+            count = section.count;
+            return reinterpret_cast<T const*>(m_data + section.offset);
+        }
+
+    protected:
+        MappedFile m_file;
+        char const* m_data;
+        std::size_t m_size;
+        Section const* m_vSection;
+};
+
+/// \return true if [begin, end) is a range within count records
+inline bool validRange(uint64_t begin, uint64_t end, uint64_t count)
+{
+    return begin <= end && end <= count;
+}
+
+/// \return true if n+1 start offsets go from 0 to count without decreasing
+template <typename T>
+inline bool validStarts(T const* vStart, std::size_t n, uint64_t count)
+{
+    if (vStart[0] != 0 || vStart[n] != count)
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (vStart[i] > vStart[i+1])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// \return true if all n indices are smaller than bound
+template <typename T>
+inline bool validIndices(T const* vIndex, std::size_t n, uint64_t bound)
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if ((uint64_t)vIndex[i] >= bound)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// FNV-1a hash
+inline uint64_t hashBytes(uint64_t h, void const* data, std::size_t n)
+{
+    unsigned char const* p = static_cast<unsigned char const*>(data);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+inline uint64_t hashString(uint64_t h, std::string const& s)
+{
+    h = hashBytes(h, s.data(), s.size());
+    return hashBytes(h, "\0", 1); // separator
+}
+
+/// hash path, size and modification time of a file
+inline uint64_t hashFile(uint64_t h, std::string const& filename)
+{
+    h = hashString(h, filename);
+    if (filename.empty())
+    {
+        return h;
+    }
+    struct stat st;
+    int64_t stamp[3] = {-1, -1, -1};
+    if (stat(filename.c_str(), &st) == 0)
+    {
+        stamp[0] = st.st_size;
+        stamp[1] = st.st_mtim.tv_sec;
+        stamp[2] = st.st_mtim.tv_nsec;
+    }
+    return hashBytes(h, stamp, sizeof(stamp));
+}
+
+/// hash the .aux file and every file listed in it,
+/// as an edited .nodes, .nets, .wts, .pl or .scl file leaves the .aux file untouched
+inline uint64_t hashAuxFile(uint64_t h, std::string const& auxFile)
+{
+    h = hashFile(h, auxFile);
+    if (auxFile.empty())
+    {
+        return h;
+    }
+    std::ifstream in (auxFile.c_str());
+    // files are relative to the directory of .aux file
+    std::size_t found = auxFile.rfind('/');
+    std::string auxPath = (found == std::string::npos)? std::string() : auxFile.substr(0, found+1);
+    // RowBasedPlacement : a.nodes a.nets a.wts a.pl a.scl ...
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::size_t colon = line.find(':');
+        if (colon == std::string::npos)
+        {
+            continue;
+        }
+        std::istringstream tokens (line.substr(colon+1));
+        std::string filename;
+        while (tokens >> filename)
+        {
+            h = hashFile(h, auxPath + filename);
+        }
+    }
+    return h;
+}
+
+} // namespace snapshot
+
+unsigned long PlaceDBSnapshot::fingerprint(UserParam const& param)
+{
+    using namespace snapshot;
+
+    uint64_t h = 14695981039346656037ULL;
+    for (std::vector<std::string>::const_iterator it = param.vLefInput.begin(), ite = param.vLefInput.end(); it != ite; ++it)
+    {
+        h = hashFile(h, *it);
+    }
+    h = hashFile(h, param.defInput);
+    h = hashFile(h, param.verilogInput);
+    h = hashAuxFile(h, param.bookshelfAuxInput);
+    h = hashFile(h, param.bookshelfPlInput);
+    h = hashFile(h, param.defSizeInput);
+    // options that change the built database
+    unsigned char sortNetsByDegree = param.sortNetsByDegree;
+    h = hashBytes(h, &sortNetsByDegree, 1);
+    for (std::set<std::string>::const_iterator it = param.sDefIgnoreCellType.begin(), ite = param.sDefIgnoreCellType.end(); it != ite; ++it)
+    {
+        h = hashString(h, *it);
+    }
+    return h;
+}
+
+bool PlaceDBSnapshot::write(std::string const& filename) const
+{
+    using namespace snapshot;
+
+    dreamplacePrint(kINFO, "writing snapshot to %s\n", filename.c_str());
+    hr_clock_rep timer_start = get_globaltime();
+
+    PlaceDB const& db = m_db;
+    StringPool pool;
+    SectionWriter writer;
+
+    ScalarsRecord scalars;
+    std::memset(&scalars, 0, sizeof(scalars));
+    scalars.numMovable = db.m_numMovable;
+    scalars.numFixed = db.m_numFixed;
+    scalars.numMacro = db.m_numMacro;
+    scalars.numIOPin = db.m_numIOPin;
+    scalars.numIgnoredNet = db.m_numIgnoredNet;
+    scalars.numPlaceBlockages = db.m_numPlaceBlockages;
+    scalars.numNetsWithDuplicatePins = db.m_numNetsWithDuplicatePins;
+    scalars.numPinsDuplicatedInNets = db.m_numPinsDuplicatedInNets;
+    scalars.dieArea = toRecord(db.m_dieArea);
+    scalars.rowBbox = toRecord(db.m_rowBbox);
+    scalars.lefUnit = db.m_lefUnit;
+    scalars.defUnit = db.m_defUnit;
+    scalars.siteSize[kX] = db.m_site.size(kX);
+    scalars.siteSize[kY] = db.m_site.size(kY);
+    scalars.siteName = pool.add(db.m_site.name());
+    scalars.siteClassName = pool.add(db.m_site.className());
+    scalars.siteSymmetry = db.m_site.symmetry();
+    scalars.lefVersion = pool.add(db.m_lefVersion);
+    scalars.defVersion = pool.add(db.m_defVersion);
+    scalars.designName = pool.add(db.m_designName);
+    writer.set(kScalars, &scalars, 1);
+
+    // nodes
+    std::vector<NodeRecord> vNode (db.m_vNode.size());
+    // pin maps are already flat in PlaceDB
+    std::vector<uint32_t> vNode2PinStart (db.m_vNode2PinStart.begin(), db.m_vNode2PinStart.end());
+    std::vector<uint32_t> vNode2Pin (db.m_vNode2Pin.begin(), db.m_vNode2Pin.end());
+    for (index_type i = 0, ie = db.m_vNode.size(); i < ie; ++i)
+    {
+        Node const& node = db.m_vNode[i];
+        NodeProperty const& property = db.m_vNodeProperty[i];
+        NodeRecord& record = vNode[i];
+        std::memset(&record, 0, sizeof(record));
+        record.box = toRecord(node);
+        record.initPos[kX] = node.initPos().x();
+        record.initPos[kY] = node.initPos().y();
+        record.name = pool.add(property.name());
+        record.macroId = property.macroId();
+        record.status = node.status();
+        record.multiRowAttr = node.multiRowAttr();
+        record.orient = node.orient();
+        record.initOrient = node.initOrient();
+    }
+    writer.set(kNodes, vNode);
+    writer.set(kNode2PinStart, vNode2PinStart);
+    writer.set(kNode2Pin, vNode2Pin);
+
+    // nets
+    std::vector<NetRecord> vNet (db.m_vNet.size());
+    std::vector<uint32_t> vNet2PinStart (db.m_vNet2PinStart.begin(), db.m_vNet2PinStart.end());
+    std::vector<uint32_t> vNet2Pin (db.m_vNet2Pin.begin(), db.m_vNet2Pin.end());
+    for (index_type i = 0, ie = db.m_vNet.size(); i < ie; ++i)
+    {
+        Net const& net = db.m_vNet[i];
+        NetRecord& record = vNet[i];
+        std::memset(&record, 0, sizeof(record));
+        record.weight = net.weight();
+        record.bbox = toRecord(net.bbox());
+        record.name = pool.add(db.m_vNetProperty[i].name());
+        record.ignore = db.m_vNetIgnoreFlag[i];
+    }
+    writer.set(kNets, vNet);
+    writer.set(kNet2PinStart, vNet2PinStart);
+    writer.set(kNet2Pin, vNet2Pin);
+
+    // pins
+    std::vector<PinRecord> vPin (db.m_vPin.size());
+    for (index_type i = 0, ie = db.m_vPin.size(); i < ie; ++i)
+    {
+        Pin const& pin = db.m_vPin[i];
+        PinRecord& record = vPin[i];
+        record.macroPinId = pin.macroPinId();
+        record.nodeId = pin.nodeId();
+        record.netId = pin.netId();
+        record.offset[kX] = pin.offset().x();
+        record.offset[kY] = pin.offset().y();
+        record.direct = pin.direct().value();
+    }
+    writer.set(kPins, vPin);
+
+    // macros
+    std::vector<MacroRecord> vMacro (db.m_vMacro.size());
+    std::vector<MacroPinRecord> vMacroPin;
+    std::vector<MacroPortRecord> vMacroPort;
+    std::vector<LayerBoxRecord> vMacroPortBox;
+    std::vector<MacroObsRecord> vMacroObs;
+    std::vector<BoxRecord> vMacroObsBox;
+    for (index_type i = 0, ie = db.m_vMacro.size(); i < ie; ++i)
+    {
+        Macro const& macro = db.m_vMacro[i];
+        MacroRecord& record = vMacro[i];
+        std::memset(&record, 0, sizeof(record));
+        record.box = toRecord(macro);
+        record.initOrigin[kX] = macro.initOrigin().x();
+        record.initOrigin[kY] = macro.initOrigin().y();
+        record.name = pool.add(macro.name());
+        record.className = pool.add(macro.className());
+        record.siteName = pool.add(macro.siteName());
+        record.edgeName[kLEFT] = pool.add(macro.edgeName(kLEFT));
+        record.edgeName[kRIGHT] = pool.add(macro.edgeName(kRIGHT));
+        record.symmetry = macro.symmetry();
+        record.macroPinBegin = vMacroPin.size();
+        for (std::vector<MacroPin>::const_iterator itp = macro.macroPins().begin(), itpe = macro.macroPins().end(); itp != itpe; ++itp)
+        {
+            MacroPinRecord pinRecord;
+            pinRecord.bbox = toRecord(itp->bbox());
+            pinRecord.name = pool.add(itp->name());
+            pinRecord.direct = itp->direct().value();
+            pinRecord.portBegin = vMacroPort.size();
+            for (std::vector<MacroPort>::const_iterator itport = itp->macroPorts().begin(), itporte = itp->macroPorts().end(); itport != itporte; ++itport)
+            {
+                MacroPortRecord portRecord;
+                portRecord.bbox = toRecord(itport->bbox());
+                portRecord.boxBegin = vMacroPortBox.size();
+                for (index_type j = 0, je = itport->boxes().size(); j < je; ++j)
+                {
+                    LayerBoxRecord boxRecord;
+                    boxRecord.box = toRecord(itport->boxes()[j]);
+                    boxRecord.layer = pool.add((j < itport->layers().size())? itport->layers()[j] : std::string());
+                    boxRecord.reserved = 0;
+                    vMacroPortBox.push_back(boxRecord);
+                }
+                portRecord.boxEnd = vMacroPortBox.size();
+                vMacroPort.push_back(portRecord);
+            }
+            pinRecord.portEnd = vMacroPort.size();
+            vMacroPin.push_back(pinRecord);
+        }
+        record.macroPinEnd = vMacroPin.size();
+        record.obsBegin = vMacroObs.size();
+        for (MacroObs::ObsConstIterator ito = macro.obs().begin(), itoe = macro.obs().end(); ito != itoe; ++ito)
+        {
+            MacroObsRecord obsRecord;
+            obsRecord.layer = pool.add(ito->first);
+            obsRecord.boxBegin = vMacroObsBox.size();
+            for (std::vector<MacroObs::box_type>::const_iterator itb = ito->second.begin(), itbe = ito->second.end(); itb != itbe; ++itb)
+            {
+                vMacroObsBox.push_back(toRecord(*itb));
+            }
+            obsRecord.boxEnd = vMacroObsBox.size();
+            obsRecord.reserved = 0;
+            vMacroObs.push_back(obsRecord);
+        }
+        record.obsEnd = vMacroObs.size();
+    }
+    writer.set(kMacros, vMacro);
+    writer.set(kMacroPins, vMacroPin);
+    writer.set(kMacroPorts, vMacroPort);
+    writer.set(kMacroPortBoxes, vMacroPortBox);
+    writer.set(kMacroObs, vMacroObs);
+    writer.set(kMacroObsBoxes, vMacroObsBox);
+
+    // rows
+    std::vector<RowRecord> vRow (db.m_vRow.size());
+    for (index_type i = 0, ie = db.m_vRow.size(); i < ie; ++i)
+    {
+        Row const& row = db.m_vRow[i];
+        RowRecord& record = vRow[i];
+        std::memset(&record, 0, sizeof(record));
+        record.box = toRecord(row);
+        record.step[kX] = row.step(kX);
+        record.step[kY] = row.step(kY);
+        record.name = pool.add(row.name());
+        record.macroName = pool.add(row.macroName());
+        record.orient = row.orient().value();
+    }
+    writer.set(kRows, vRow);
+
+    // regions and groups
+    std::vector<RegionRecord> vRegion (db.m_vRegion.size());
+    std::vector<BoxRecord> vRegionBox;
+    for (index_type i = 0, ie = db.m_vRegion.size(); i < ie; ++i)
+    {
+        Region const& region = db.m_vRegion[i];
+        RegionRecord& record = vRegion[i];
+        record.name = pool.add(region.name());
+        record.type = region.type();
+        record.boxBegin = vRegionBox.size();
+        for (std::vector<Region::box_type>::const_iterator itb = region.boxes().begin(), itbe = region.boxes().end(); itb != itbe; ++itb)
+        {
+            vRegionBox.push_back(toRecord(*itb));
+        }
+        record.boxEnd = vRegionBox.size();
+    }
+    std::vector<GroupRecord> vGroup (db.m_vGroup.size());
+    std::vector<uint32_t> vGroupNodeName;
+    std::vector<uint32_t> vGroupNode;
+    for (index_type i = 0, ie = db.m_vGroup.size(); i < ie; ++i)
+    {
+        Group const& group = db.m_vGroup[i];
+        GroupRecord& record = vGroup[i];
+        record.name = pool.add(group.name());
+        record.region = group.region();
+        record.nodeNameBegin = vGroupNodeName.size();
+        for (std::vector<std::string>::const_iterator it = group.nodeNames().begin(), ite = group.nodeNames().end(); it != ite; ++it)
+        {
+            vGroupNodeName.push_back(pool.add(*it));
+        }
+        record.nodeNameEnd = vGroupNodeName.size();
+        record.nodeBegin = vGroupNode.size();
+        vGroupNode.insert(vGroupNode.end(), group.nodes().begin(), group.nodes().end());
+        record.nodeEnd = vGroupNode.size();
+    }
+    writer.set(kRegions, vRegion);
+    writer.set(kRegionBoxes, vRegionBox);
+    writer.set(kGroups, vGroup);
+    writer.set(kGroupNodeNames, vGroupNodeName);
+    writer.set(kGroupNodes, vGroupNode);
+
+    // index arrays
+    std::vector<uint32_t> vDuplicateNet (db.m_vDuplicateNet.size());
+    for (index_type i = 0, ie = db.m_vDuplicateNet.size(); i < ie; ++i)
+    {
+        vDuplicateNet[i] = pool.add(db.m_vDuplicateNet[i]);
+    }
+    writer.set(kMovableNodes, db.m_vMovableNodeIndex);
+    writer.set(kFixedNodes, db.m_vFixedNodeIndex);
+    writer.set(kPlaceBlockages, db.m_vPlaceBlockageIndex);
+    writer.set(kDuplicateNets, vDuplicateNet);
+
+    // string pool must be the last, as all other sections add strings
+    writer.set(kStringChars, pool.chars());
+    writer.set(kStringOffsets, pool.offsets());
+
+    bool flag = writer.write(filename, fingerprint(db.userParam()));
+    if (flag)
+    {
+        dreamplacePrint(kINFO, "writing snapshot takes %g ms\n", (get_globaltime()-timer_start)*get_timer_period());
+    }
+    return flag;
+}
+
+bool PlaceDBSnapshot::read(std::string const& filename, unsigned long fp)
+{
+    using namespace snapshot;
+
+    dreamplaceAssertMsg(m_db.m_vNode.empty() && m_db.m_vMacro.empty(), "snapshot can only be loaded into an empty database");
+
+    SectionReader reader;
+    if (!reader.open(filename, fp))
+    {
+        return false;
+    }
+    dreamplacePrint(kINFO, "reading snapshot %s\n", filename.c_str());
+    hr_clock_rep timer_start = get_globaltime();
+
+    // check record sizes of all sections before touching the database
+    std::size_t numScalars, numChars, numOffsets;
+    std::size_t numNodes, numNode2PinStart, numNode2Pin, numNets, numNet2PinStart, numNet2Pin, numPins;
+    std::size_t numMacros, numMacroPins, numMacroPorts, numMacroPortBoxes, numMacroObs, numMacroObsBoxes;
+    std::size_t numRows, numRegions, numRegionBoxes, numGroups, numGroupNodeNames, numGroupNodes;
+    std::size_t numMovableNodes, numFixedNodes, numPlaceBlockages, numDuplicateNets;
+    ScalarsRecord const* scalars = reader.get<ScalarsRecord>(kScalars, numScalars);
+    char const* chars = reader.get<char>(kStringChars, numChars);
+    uint64_t const* offsets = reader.get<uint64_t>(kStringOffsets, numOffsets);
+    NodeRecord const* vNode = reader.get<NodeRecord>(kNodes, numNodes);
+    uint32_t const* vNode2PinStart = reader.get<uint32_t>(kNode2PinStart, numNode2PinStart);
+    uint32_t const* vNode2Pin = reader.get<uint32_t>(kNode2Pin, numNode2Pin);
+    NetRecord const* vNet = reader.get<NetRecord>(kNets, numNets);
+    uint32_t const* vNet2PinStart = reader.get<uint32_t>(kNet2PinStart, numNet2PinStart);
+    uint32_t const* vNet2Pin = reader.get<uint32_t>(kNet2Pin, numNet2Pin);
+    PinRecord const* vPin = reader.get<PinRecord>(kPins, numPins);
+    MacroRecord const* vMacro = reader.get<MacroRecord>(kMacros, numMacros);
+    MacroPinRecord const* vMacroPin = reader.get<MacroPinRecord>(kMacroPins, numMacroPins);
+    MacroPortRecord const* vMacroPort = reader.get<MacroPortRecord>(kMacroPorts, numMacroPorts);
+    LayerBoxRecord const* vMacroPortBox = reader.get<LayerBoxRecord>(kMacroPortBoxes, numMacroPortBoxes);
+    MacroObsRecord const* vMacroObs = reader.get<MacroObsRecord>(kMacroObs, numMacroObs);
+    BoxRecord const* vMacroObsBox = reader.get<BoxRecord>(kMacroObsBoxes, numMacroObsBoxes);
+    RowRecord const* vRow = reader.get<RowRecord>(kRows, numRows);
+    RegionRecord const* vRegion = reader.get<RegionRecord>(kRegions, numRegions);
+    BoxRecord const* vRegionBox = reader.get<BoxRecord>(kRegionBoxes, numRegionBoxes);
+    GroupRecord const* vGroup = reader.get<GroupRecord>(kGroups, numGroups);
+    uint32_t const* vGroupNodeName = reader.get<uint32_t>(kGroupNodeNames, numGroupNodeNames);
+    uint32_t const* vGroupNode = reader.get<uint32_t>(kGroupNodes, numGroupNodes);
+    index_type const* vMovableNode = reader.get<index_type>(kMovableNodes, numMovableNodes);
+    index_type const* vFixedNode = reader.get<index_type>(kFixedNodes, numFixedNodes);
+    index_type const* vPlaceBlockage = reader.get<index_type>(kPlaceBlockages, numPlaceBlockages);
+    uint32_t const* vDuplicateNet = reader.get<uint32_t>(kDuplicateNets, numDuplicateNets);
+    if (numScalars != 1 || numOffsets == 0
+            || numNode2PinStart != numNodes+1 || numNet2PinStart != numNets+1
+            || !scalars || !chars || !offsets || !vNode || !vNode2PinStart || !vNode2Pin
+            || !vNet || !vNet2PinStart || !vNet2Pin || !vPin
+            || !vMacro || !vMacroPin || !vMacroPort || !vMacroPortBox || !vMacroObs || !vMacroObsBox
+            || !vRow || !vRegion || !vRegionBox || !vGroup || !vGroupNodeName || !vGroupNode
+            || !vMovableNode || !vFixedNode || !vPlaceBlockage || !vDuplicateNet)
+    {
+        dreamplacePrint(kWARN, "snapshot %s is inconsistent, ignored\n", filename.c_str());
+        return false;
+    }
+
+    // validate every index and range before touching the database,
+    // so that a corrupted snapshot is ignored instead of read out of bounds
+    std::size_t numStrings = numOffsets-1;
+    auto validString = [&](uint32_t i){return i < numStrings;};
+    // ids may be invalid on purpose, e.g., macros of Bookshelf nodes, but never out of range
+    uint32_t const invalidId = std::numeric_limits<index_type>::max();
+    auto validId = [&](uint32_t i, uint64_t bound){return i == invalidId || i < bound;};
+    bool valid = validStarts(offsets, numStrings, numChars)
+        && validStarts(vNode2PinStart, numNodes, numNode2Pin)
+        && validStarts(vNet2PinStart, numNets, numNet2Pin)
+        && validIndices(vNode2Pin, numNode2Pin, numPins)
+        && validIndices(vNet2Pin, numNet2Pin, numPins)
+        && validIndices(vGroupNode, numGroupNodes, numNodes)
+        && validIndices(vMovableNode, numMovableNodes, numNodes)
+        && validIndices(vFixedNode, numFixedNodes, numNodes)
+        && validIndices(vPlaceBlockage, numPlaceBlockages, numNodes)
+        && validIndices(vGroupNodeName, numGroupNodeNames, numStrings)
+        && validIndices(vDuplicateNet, numDuplicateNets, numStrings)
+        && validString(scalars->siteName) && validString(scalars->siteClassName)
+        && validString(scalars->lefVersion) && validString(scalars->defVersion) && validString(scalars->designName);
+    for (std::size_t i = 0; valid && i < numMacros; ++i)
+    {
+        MacroRecord const& record = vMacro[i];
+        valid = validString(record.name) && validString(record.className) && validString(record.siteName)
+            && validString(record.edgeName[kLEFT]) && validString(record.edgeName[kRIGHT])
+            && validRange(record.macroPinBegin, record.macroPinEnd, numMacroPins)
+            && validRange(record.obsBegin, record.obsEnd, numMacroObs);
+    }
+    for (std::size_t i = 0; valid && i < numMacroPins; ++i)
+    {
+        valid = validString(vMacroPin[i].name) && validRange(vMacroPin[i].portBegin, vMacroPin[i].portEnd, numMacroPorts)
+            && vMacroPin[i].direct <= SignalDirectEnum::UNKNOWN;
+    }
+    for (std::size_t i = 0; valid && i < numMacroPorts; ++i)
+    {
+        valid = validRange(vMacroPort[i].boxBegin, vMacroPort[i].boxEnd, numMacroPortBoxes);
+    }
+    for (std::size_t i = 0; valid && i < numMacroPortBoxes; ++i)
+    {
+        valid = validString(vMacroPortBox[i].layer);
+    }
+    for (std::size_t i = 0; valid && i < numMacroObs; ++i)
+    {
+        valid = validString(vMacroObs[i].layer) && validRange(vMacroObs[i].boxBegin, vMacroObs[i].boxEnd, numMacroObsBoxes);
+    }
+    for (std::size_t i = 0; valid && i < numNodes; ++i)
+    {
+        NodeRecord const& record = vNode[i];
+        valid = validString(record.name) && validId(record.macroId, numMacros)
+            && record.status <= PlaceStatusEnum::UNKNOWN && record.multiRowAttr <= MultiRowAttrEnum::UNKNOWN
+            && record.orient <= OrientEnum::UNKNOWN && record.initOrient <= OrientEnum::UNKNOWN;
+    }
+    for (std::size_t i = 0; valid && i < numNets; ++i)
+    {
+        valid = validString(vNet[i].name);
+    }
+    for (std::size_t i = 0; valid && i < numPins; ++i)
+    {
+        PinRecord const& record = vPin[i];
+        valid = record.nodeId < numNodes && record.netId < numNets && record.direct <= SignalDirectEnum::UNKNOWN;
+        // a macro pin refers to the pins of the macro of its node
+        if (valid && record.macroPinId != invalidId)
+        {
+            uint32_t macroId = vNode[record.nodeId].macroId;
+            valid = macroId != invalidId && record.macroPinId < vMacro[macroId].macroPinEnd-vMacro[macroId].macroPinBegin;
+        }
+    }
+    for (std::size_t i = 0; valid && i < numRows; ++i)
+    {
+        valid = validString(vRow[i].name) && validString(vRow[i].macroName) && vRow[i].orient <= OrientEnum::UNKNOWN;
+    }
+    for (std::size_t i = 0; valid && i < numRegions; ++i)
+    {
+        valid = validString(vRegion[i].name) && validRange(vRegion[i].boxBegin, vRegion[i].boxEnd, numRegionBoxes)
+            && vRegion[i].type <= RegionTypeEnum::UNKNOWN;
+    }
+    for (std::size_t i = 0; valid && i < numGroups; ++i)
+    {
+        GroupRecord const& record = vGroup[i];
+        valid = validString(record.name) && validId(record.region, numRegions)
+            && validRange(record.nodeNameBegin, record.nodeNameEnd, numGroupNodeNames)
+            && validRange(record.nodeBegin, record.nodeEnd, numGroupNodes);
+    }
+    if (!valid)
+    {
+        dreamplacePrint(kWARN, "snapshot %s has invalid indices, ignored\n", filename.c_str());
+        return false;
+    }
+
+    PlaceDB& db = m_db;
+    // string accessor, indices are validated above
+    auto str = [&](uint32_t i){
+        return std::string(chars + offsets[i], chars + offsets[i+1]);
+    };
+
+    // scalars
+    db.m_numMovable = scalars->numMovable;
+    db.m_numFixed = scalars->numFixed;
+    db.m_numMacro = scalars->numMacro;
+    db.m_numIOPin = scalars->numIOPin;
+    db.m_numIgnoredNet = scalars->numIgnoredNet;
+    db.m_numPlaceBlockages = scalars->numPlaceBlockages;
+    db.m_numNetsWithDuplicatePins = scalars->numNetsWithDuplicatePins;
+    db.m_numPinsDuplicatedInNets = scalars->numPinsDuplicatedInNets;
+    db.m_dieArea = fromRecord(scalars->dieArea);
+    db.m_rowBbox = fromRecord(scalars->rowBbox);
+    db.m_lefUnit = scalars->lefUnit;
+    db.m_defUnit = scalars->defUnit;
+    db.m_site.setName(str(scalars->siteName));
+    db.m_site.setClassName(str(scalars->siteClassName));
+    db.m_site.setSymmetry(scalars->siteSymmetry);
+    db.m_site.setSize(kX, scalars->siteSize[kX]);
+    db.m_site.setSize(kY, scalars->siteSize[kY]);
+    db.m_lefVersion = str(scalars->lefVersion);
+    db.m_defVersion = str(scalars->defVersion);
+    db.m_designName = str(scalars->designName);
+
+    // macros
+    db.m_vMacro.resize(numMacros);
+    db.m_mMacroName2Index.reserve(numMacros);
+    for (std::size_t i = 0; i < numMacros; ++i)
+    {
+        MacroRecord const& record = vMacro[i];
+        Macro& macro = db.m_vMacro[i];
+        macro.setId(i);
+        macro.set(record.box.xl, record.box.yl, record.box.xh, record.box.yh);
+        macro.setInitOrigin(record.initOrigin[kX], record.initOrigin[kY]);
+        macro.setName(str(record.name));
+        macro.setClassName(str(record.className));
+        macro.setSiteName(str(record.siteName));
+        macro.setEdgeName(str(record.edgeName[kLEFT]), str(record.edgeName[kRIGHT]));
+        macro.setSymmetry(record.symmetry);
+        macro.macroPins().reserve(record.macroPinEnd-record.macroPinBegin);
+        for (uint32_t j = record.macroPinBegin; j < record.macroPinEnd; ++j)
+        {
+            MacroPinRecord const& pinRecord = vMacroPin[j];
+            MacroPin& mPin = macro.macroPin(macro.addMacroPin(str(pinRecord.name)).first);
+            mPin.setDirect(SignalDirect((SignalDirectEnum::SignalDirectType)pinRecord.direct));
+            mPin.setBbox(fromRecord(pinRecord.bbox));
+            for (uint32_t k = pinRecord.portBegin; k < pinRecord.portEnd; ++k)
+            {
+                MacroPortRecord const& portRecord = vMacroPort[k];
+                MacroPort& macroPort = mPin.macroPort(mPin.addMacroPort());
+                macroPort.setBbox(fromRecord(portRecord.bbox));
+                macroPort.boxes().reserve(portRecord.boxEnd-portRecord.boxBegin);
+                macroPort.layers().reserve(portRecord.boxEnd-portRecord.boxBegin);
+                for (uint32_t b = portRecord.boxBegin; b < portRecord.boxEnd; ++b)
+                {
+                    macroPort.boxes().push_back(fromRecord(vMacroPortBox[b].box));
+                    macroPort.layers().push_back(str(vMacroPortBox[b].layer));
+                }
+            }
+        }
+        for (uint32_t j = record.obsBegin; j < record.obsEnd; ++j)
+        {
+            MacroObsRecord const& obsRecord = vMacroObs[j];
+            std::string layer = str(obsRecord.layer);
+            for (uint32_t b = obsRecord.boxBegin; b < obsRecord.boxEnd; ++b)
+            {
+                macro.obs().add(layer, fromRecord(vMacroObsBox[b]));
+            }
+        }
+        db.m_mMacroName2Index.insert(std::make_pair(macro.name(), macro.id()));
+    }
+
+    // nodes
+    db.m_vNode.resize(numNodes);
+    db.m_vNodeProperty.resize(numNodes);
+    db.m_mNodeName2Index.reserve(numNodes);
+    for (std::size_t i = 0; i < numNodes; ++i)
+    {
+        NodeRecord const& record = vNode[i];
+        Node& node = db.m_vNode[i];
+        NodeProperty& property = db.m_vNodeProperty[i];
+        node.setId(i);
+        node.set(record.box.xl, record.box.yl, record.box.xh, record.box.yh);
+        node.setInitPos(Node::point_type(record.initPos[kX], record.initPos[kY]));
+        node.setStatus((PlaceStatusEnum::PlaceStatusType)record.status);
+        node.setMultiRowAttr((MultiRowAttrEnum::MultiRowAttrType)record.multiRowAttr);
+        node.setOrient((OrientEnum::OrientType)record.orient);
+        node.setInitOrient((OrientEnum::OrientType)record.initOrient);
+        property.setName(str(record.name));
+        property.setMacroId(record.macroId);
+        db.m_mNodeName2Index.insert(std::make_pair(property.name(), node.id()));
+    }
+
+    // nets
+    db.m_vNet.resize(numNets);
+    db.m_vNetProperty.resize(numNets);
+    db.m_vNetIgnoreFlag.assign(numNets, false);
+    db.m_mNetName2Index.reserve(numNets);
+    for (std::size_t i = 0; i < numNets; ++i)
+    {
+        NetRecord const& record = vNet[i];
+        Net& net = db.m_vNet[i];
+        NetProperty& property = db.m_vNetProperty[i];
+        net.setId(i);
+        net.setWeight(record.weight);
+        net.setBbox(fromRecord(record.bbox));
+        property.setName(str(record.name));
+        db.m_vNetIgnoreFlag[i] = record.ignore;
+        db.m_mNetName2Index.insert(std::make_pair(property.name(), net.id()));
+    }
+
+    db.m_vNode2PinStart.assign(vNode2PinStart, vNode2PinStart+numNode2PinStart);
+    db.m_vNode2Pin.assign(vNode2Pin, vNode2Pin+numNode2Pin);
+    db.m_vNet2PinStart.assign(vNet2PinStart, vNet2PinStart+numNet2PinStart);
+    db.m_vNet2Pin.assign(vNet2Pin, vNet2Pin+numNet2Pin);
+
+    // pins
+    db.m_vPin.resize(numPins);
+    for (std::size_t i = 0; i < numPins; ++i)
+    {
+        PinRecord const& record = vPin[i];
+        Pin& pin = db.m_vPin[i];
+        pin.setId(i);
+        pin.setMacroPinId(record.macroPinId);
+        pin.setNodeId(record.nodeId);
+        pin.setNetId(record.netId);
+        pin.setOffset(Pin::point_type(record.offset[kX], record.offset[kY]));
+        pin.setDirect(SignalDirect((SignalDirectEnum::SignalDirectType)record.direct));
+    }
+
+    // rows
+    db.m_vRow.resize(numRows);
+    for (std::size_t i = 0; i < numRows; ++i)
+    {
+        RowRecord const& record = vRow[i];
+        Row& row = db.m_vRow[i];
+        row.setId(i);
+        row.set(record.box.xl, record.box.yl, record.box.xh, record.box.yh);
+        row.setStep(record.step[kX], record.step[kY]);
+        row.setName(str(record.name));
+        row.setMacroName(str(record.macroName));
+        row.setOrient(Orient((OrientEnum::OrientType)record.orient));
+    }
+
+    // regions and groups
+    db.m_vRegion.resize(numRegions);
+    for (std::size_t i = 0; i < numRegions; ++i)
+    {
+        RegionRecord const& record = vRegion[i];
+        Region& region = db.m_vRegion[i];
+        region.setId(i);
+        region.setName(str(record.name));
+        region.setType((RegionTypeEnum::RegionEnumType)record.type);
+        for (uint32_t b = record.boxBegin; b < record.boxEnd; ++b)
+        {
+            region.addBox(fromRecord(vRegionBox[b]));
+        }
+        db.m_mRegionName2Index.insert(std::make_pair(region.name(), region.id()));
+    }
+    db.m_vGroup.resize(numGroups);
+    for (std::size_t i = 0; i < numGroups; ++i)
+    {
+        GroupRecord const& record = vGroup[i];
+        Group& group = db.m_vGroup[i];
+        group.setId(i);
+        group.setName(str(record.name));
+        group.setRegion(record.region);
+        for (uint32_t j = record.nodeNameBegin; j < record.nodeNameEnd; ++j)
+        {
+            group.nodeNames().push_back(str(vGroupNodeName[j]));
+        }
+        group.nodes().assign(vGroupNode + record.nodeBegin, vGroupNode + record.nodeEnd);
+        db.m_mGroupName2Index.insert(std::make_pair(group.name(), group.id()));
+    }
+
+    // index arrays
+    db.m_vMovableNodeIndex.assign(vMovableNode, vMovableNode + numMovableNodes);
+    db.m_vFixedNodeIndex.assign(vFixedNode, vFixedNode + numFixedNodes);
+    db.m_vPlaceBlockageIndex.assign(vPlaceBlockage, vPlaceBlockage + numPlaceBlockages);
+    db.m_vDuplicateNet.resize(numDuplicateNets);
+    for (std::size_t i = 0; i < numDuplicateNets; ++i)
+    {
+        db.m_vDuplicateNet[i] = str(vDuplicateNet[i]);
+    }
+
+    // parameters derived from user input, same as PlaceDB::adjustParams()
+    db.m_maxDisplace = (coordinate_type)std::floor(db.userParam().maxDisplace*db.defUnit());
+
+    dreamplacePrint(kINFO, "reading snapshot takes %g ms\n", (get_globaltime()-timer_start)*get_timer_period());
+    return true;
+}
+
+DREAMPLACE_END_NAMESPACE
@@ -0,0 +1,59 @@
+/**
+ * @file   PlaceDBSnapshot.h
+ * @author agent
+ * @date   Oct 2026
+ * @brief  Binary snapshot of a fully built PlaceDB.
+ *
+ * The snapshot is a flat, versioned file that can be memory-mapped.
+ * It starts with a fixed header and a section table;
+ * every section is an 8-byte aligned array of plain records,
+ * so loading is a linear copy of the file without any parsing.
+ * All strings are stored once in a string pool and referenced by index.
+ */
+
+#ifndef DREAMPLACE_PLACEDBSNAPSHOT_H
+#define DREAMPLACE_PLACEDBSNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include "PlaceDB.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// class PlaceDBSnapshot writes and loads binary snapshots of PlaceDB.
+/// It is a friend of PlaceDB, so it can restore the internal states directly.
+class PlaceDBSnapshot
+{
+    public:
+        typedef PlaceDB::coordinate_type coordinate_type;
+        typedef PlaceDB::index_type index_type;
+
+        /// current version of the format; bump it whenever a record changes
+        static const unsigned int version = 2;
+
+        /// @param db placement database
+        PlaceDBSnapshot(PlaceDB& db) : m_db(db) {}
+
+        /// @brief compute a fingerprint of the input files and the options that change the built database.
+        /// Input files are identified by path, size and modification time,
+        /// including every file listed in the Bookshelf .aux file.
+        /// A snapshot is only loaded when the fingerprint matches.
+        static unsigned long fingerprint(UserParam const& param);
+
+        /// @brief write snapshot, must be called after PlaceDB::adjustParams()
+        /// @param filename output file
+        /// @return true if succeed
+        bool write(std::string const& filename) const;
+        /// @brief load snapshot; the database must be empty
+        /// @param filename input file
+        /// @param fp expected fingerprint of the input files
+        /// @return true if succeed; false if the file does not exist, is outdated, or is broken
+        bool read(std::string const& filename, unsigned long fp);
+
+    protected:
+        PlaceDB& m_db;
+};
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * @file   TextBuffer.h
+ * @author agent
+ * @date   Oct 2026
+ * @brief  Helpers to format text records into buffers and write them in order.
+ */
+
+#ifndef DREAMPLACE_TEXTBUFFER_H
+#define DREAMPLACE_TEXTBUFFER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <omp.h>
+#include "utility/src/Msg.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// @brief append the decimal representation of an integer,
+/// a lightweight replacement of std::to_chars in C++17
+inline void appendInt(std::string& buf, long long v)
+{
+    char tmp[24];
+    char* last = tmp+sizeof(tmp);
+    char* p = last;
+    unsigned long long u = (v < 0)? 0ULL-(unsigned long long)v : (unsigned long long)v;
+    do
+    {
+        *--p = '0'+(u%10);
+        u /= 10;
+    } while (u);
+    if (v < 0)
+    {
+        *--p = '-';
+    }
+    buf.append(p, last-p);
+}
+
+/// @brief use a large stdio buffer, must be called before any output to the stream
+inline void setLargeBuffer(FILE* os, std::size_t size = (1<<22))
+{
+    setvbuf(os, NULL, _IOFBF, size);
+}
+
+/// @brief format records [0, n) into thread-local buffers in parallel and write them in order.
+/// Records are processed in rounds of numThreads chunks to bound the memory of buffers.
+/// @param fmt functor with fmt(std::string& buf, std::size_t i) to append record i to buf;
+/// it is called concurrently, so it must not modify shared states
+/// @param chunkSize number of records per chunk
+template <typename FormatterType>
+inline void writeRecordsParallel(FILE* os, std::size_t n, int numThreads, FormatterType const& fmt, std::size_t chunkSize = (1<<16))
+{
+    numThreads = std::max(numThreads, 1);
+    std::vector<std::string> vBuffer (numThreads); // capacity is reused across rounds
+    for (std::size_t roundBegin = 0; roundBegin < n; roundBegin += chunkSize*numThreads)
+    {
+        int numChunks = std::min((n-roundBegin+chunkSize-1)/chunkSize, (std::size_t)numThreads);
+#pragma omp parallel for num_threads(numThreads) schedule(static, 1)
+        for (int i = 0; i < numChunks; ++i)
+        {
+            std::string& buf = vBuffer[i];
+            buf.clear();
+            std::size_t first = roundBegin+i*chunkSize;
+            std::size_t last = std::min(first+chunkSize, n);
+            for (std::size_t j = first; j < last; ++j)
+            {
+                fmt(buf, j);
+            }
+        }
+        for (int i = 0; i < numChunks; ++i)
+        {
+            fwrite(vBuffer[i].data(), 1, vBuffer[i].size(), os);
+        }
+    }
+}
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
@@ -9,8 +9,13 @@
 #include <pybind11/stl_bind.h>
 #include <pybind11/numpy.h>
 #include <sstream>
+#include <stdexcept>
+#include <cstdio>
 //#include <boost/timer/timer.hpp>
 #include "PlaceDB.h"
+#include "PlaceDBSnapshot.h"
+#include "BookshelfParallelReader.h"
+#include "MappedFile.h"
 #include "utility/src/torch.h"
 
 DREAMPLACE_BEGIN_NAMESPACE
@@ -40,6 +45,9 @@ bool readLef(PlaceDB& db)
 	return true;
 }
 
+/// @brief read DEF with the Limbo parser. 
+/// Only the pre-reading counts are collected in parallel; 
+/// the body is parsed serially, as the Limbo grammar cannot be split into chunks. 
 bool readDef(PlaceDB& db)
 {
 	// read def 
@@ -48,7 +56,7 @@ bool readDef(PlaceDB& db)
     {
         std::string const& filename = defInput;
         dreamplacePrint(kINFO, "reading %s\n", filename.c_str());
-        // a pre-reading phase to grep number of components, nets, and pins 
+        // a pre-reading phase to grep number of components, nets, and pins in parallel chunks 
         prereadDef(db, filename);
         bool flag = DefParser::read(db, filename);
         if (!flag) 
@@ -62,10 +70,47 @@ bool readDef(PlaceDB& db)
 	return true;
 }
 
+/// @brief check whether a line starts with a keyword
+inline bool lineStartsWith(char const* line, char const* last, char const* keyword, std::size_t n)
+{
+    return (std::size_t)(last-line) >= n && std::strncmp(line, keyword, n) == 0;
+}
+
+/// @brief count pin references like "( inst pin )" in a range of a NETS section; 
+/// routing points like "( 100 200 )" or "( * 200 )" are skipped 
+inline unsigned countNetPins(char const* first, char const* last)
+{
+    unsigned count = 0;
+    for (char const* p = first; p != last; ++p)
+    {
+        if (*p == '(')
+        {
+            char const* q = p+1;
+            while (q != last && (*q == ' ' || *q == '\t'))
+                ++q;
+            if (q != last && !(*q >= '0' && *q <= '9') && *q != '*' && *q != '-')
+                ++count;
+        }
+    }
+    return count;
+}
+
+/// @brief parse the number after a keyword, e.g., COMPONENTS 100 ;
+inline unsigned lineCount(char const* line, char const* last, std::size_t n)
+{
+    char const* p = line+n;
+    while (p != last && (*p == ' ' || *p == '\t'))
+        ++p;
+    unsigned count = 0;
+    for (; p != last && *p >= '0' && *p <= '9'; ++p)
+        count = count*10 + (*p-'0');
+    return count;
+}
+
 void prereadDef(PlaceDB& db, std::string const& filename)
 {
-    std::ifstream inFile (filename.c_str());
-    if (!inFile.good())
+    MappedFile file;
+    if (!file.open(filename))
         return;
 
     // need to extract following information 
@@ -74,40 +119,53 @@ void prereadDef(PlaceDB& db, std::string const& filename)
     unsigned numIOPin = 0;
     unsigned numNets = 0;
     unsigned numBlockages = 0;
-
-    std::string line;
-    std::string token;
-    while (!inFile.eof())
+    unsigned numPins = 0;
+    std::size_t netsBegin = file.size(); 
+    std::size_t netsEnd = file.size(); 
+
+    // scan chunks of lines in parallel; 
+    // each section header appears once, so summation gives the counts 
+    int numThreads = std::max(db.userParam().numThreads, 1);
+    std::vector<char const*> vBoundary = splitLines(file.begin(), file.end(), numThreads, AnyLine());
+    int numChunks = vBoundary.size()-1;
+#pragma omp parallel for num_threads(numThreads) reduction(+:numRows,numNodes,numIOPin,numNets,numBlockages) reduction(min:netsBegin,netsEnd)
+    for (int i = 0; i < numChunks; ++i)
     {
-        std::getline(inFile, line);
-        if (line.compare(0, 3, "ROW") == 0) // a line starts with keyword "ROW"
-            ++numRows;
-        else if (line.compare(0, 10, "COMPONENTS") == 0)
-        {
-            std::istringstream iss (line);
-            iss >> token >> numNodes >> token;
-        }
-        else if (line.compare(0, 4, "PINS") == 0)
-        {
-            std::istringstream iss (line);
-            iss >> token >> numIOPin >> token;
-        }
-        else if (line.compare(0, 4, "NETS") == 0)
+        char const* last = vBoundary[i+1];
+        for (char const* line = vBoundary[i]; line != last; line = nextLine(line, last))
         {
-            std::istringstream iss (line);
-            iss >> token >> numNets >> token;
+            if (lineStartsWith(line, last, "ROW", 3)) // a line starts with keyword "ROW"
+                ++numRows;
+            else if (lineStartsWith(line, last, "COMPONENTS", 10))
+                numNodes += lineCount(line, last, 10);
+            else if (lineStartsWith(line, last, "PINS", 4))
+                numIOPin += lineCount(line, last, 4);
+            else if (lineStartsWith(line, last, "NETS", 4))
+            {
+                numNets += lineCount(line, last, 4);
+                netsBegin = nextLine(line, last)-file.begin(); 
+            }
+            else if (lineStartsWith(line, last, "END NETS", 8))
+                netsEnd = line-file.begin(); 
+            else if (lineStartsWith(line, last, "BLOCKAGES", 9))
+                numBlockages += lineCount(line, last, 9);
         }
-        else if (line.compare(0, 9, "BLOCKAGES") == 0)
+    }
+
+    // second pass to count pins in NETS section 
+    if (netsBegin < netsEnd)
+    {
+        vBoundary = splitLines(file.begin()+netsBegin, file.begin()+netsEnd, numThreads, AnyLine());
+        numChunks = vBoundary.size()-1;
+#pragma omp parallel for num_threads(numThreads) reduction(+:numPins)
+        for (int i = 0; i < numChunks; ++i)
         {
-            std::istringstream iss (line);
-            iss >> token >> numBlockages >> token;
+            numPins += countNetPins(vBoundary[i], vBoundary[i+1]);
         }
     }
 
-    dreamplacePrint(kINFO, "detect %u rows, %u components, %u IO pins, %u nets, %u blockages\n", numRows, numNodes, numIOPin, numNets, numBlockages);
-    db.prepare(numRows, numNodes, numIOPin, numNets, numBlockages);
-
-    inFile.close();
+    dreamplacePrint(kINFO, "detect %u rows, %u components, %u IO pins, %u nets, %u pins, %u blockages\n", numRows, numNodes, numIOPin, numNets, numPins, numBlockages);
+    db.prepare(numRows, numNodes, numIOPin, numNets, numBlockages, numPins);
 }
 
 bool readVerilog(PlaceDB& db)
@@ -138,7 +196,10 @@ bool readBookshelf(PlaceDB& db)
     {
         std::string const& filename = bookshelfAuxInput;
         dreamplacePrint(kINFO, "reading %s\n", filename.c_str());
-        bool flag = BookshelfParser::read(db, filename);
+        // tokenize large files with multiple threads if allowed 
+        bool flag = (db.userParam().numThreads > 1)? 
+            BookshelfParallelReader(db, db.userParam().numThreads).read(filename) : 
+            BookshelfParser::read(db, filename);
         if (!flag)
         {
             dreamplacePrint(kERROR, "Bookshelf file parsing failed: %s\n", filename.c_str());
@@ -153,7 +214,9 @@ bool readBookshelf(PlaceDB& db)
     {
         std::string const& filename = bookshelfPlInput;
         dreamplacePrint(kINFO, "reading %s\n", filename.c_str());
-        bool flag = BookshelfParser::readPl(db, filename);
+        bool flag = (db.userParam().numThreads > 1)? 
+            BookshelfParallelReader(db, db.userParam().numThreads).readPl(filename) : 
+            BookshelfParser::readPl(db, filename);
         if (!flag)
         {
             dreamplacePrint(kERROR, "Bookshelf additional .pl file parsing failed: %s\n", filename.c_str());
@@ -218,42 +281,111 @@ void apply(PlaceDB& db,
         pybind11::array_t<T, pybind11::array::c_style | pybind11::array::forcecast> const& y 
         )
 {
+    // orientation of a node after moving into a row, indexed by (row orient, node orient) 
+    // e.g., a node flipped vertically from the row is set to the row orientation 
+    int const numOrients = OrientEnum::UNKNOWN+1; 
+    std::vector<unsigned char> vOrientMap (numOrients*numOrients); 
+    for (int r = 0; r < numOrients; ++r)
+    {
+        Orient rowOrient ((OrientEnum::OrientType)r); 
+        for (int o = 0; o < numOrients; ++o)
+        {
+            Orient orient ((OrientEnum::OrientType)o); 
+            if (orient == OrientEnum::UNKNOWN)
+            {
+                orient = rowOrient; 
+            }
+            else if (rowOrient == Orient::vflip(orient)) // only vertically flipped
+            {
+                orient = rowOrient; 
+            }
+            else if (rowOrient == Orient::hflip(Orient::vflip(orient))) // both vertically and horizontally flipped
+            {
+                // flip vertically 
+                orient = Orient::vflip(orient); 
+            }
+            // other cases, no need to change 
+            vOrientMap[r*numOrients+o] = orient.value(); 
+        }
+    }
+    std::vector<unsigned char> vRowOrient (db.rows().size()); 
+    for (PlaceDB::index_type i = 0, ie = db.rows().size(); i < ie; ++i)
+    {
+        vRowOrient[i] = db.row(i).orient().value(); 
+    }
+
+    // same as PlaceDB::getRowIndex, with row parameters hoisted out of the loop 
+    long rowYL = db.rowYL(); 
+    long rowHeight = db.rowHeight(); 
+    long lastRow = (long)db.rows().size()-1; 
+
+    T const* vx = x.data(); 
+    T const* vy = y.data(); 
+    long numNodes = db.nodes().size(); 
+    long numPositions = std::min(x.size(), y.size()); 
+
+    // check before moving anything, so a short array leaves the database untouched 
+    // and raises IndexError in Python 
+    long numOutOfRange = 0; 
+    for (long i = numPositions; i < numNodes; ++i)
+    {
+        numOutOfRange += (db.node(i).status() != PlaceStatusEnum::FIXED); 
+    }
+    if (numOutOfRange)
+    {
+        char buf[256]; 
+        snprintf(buf, sizeof(buf), "%ld nodes out of range of positions with length %ld", numOutOfRange, numPositions); 
+        throw std::out_of_range(buf); 
+    }
+
     // assume all the movable nodes are in front of fixed nodes 
     // this is ensured by PlaceDB::sortNodeByPlaceStatus()
-    for (auto& node : db.nodes())
+#pragma omp parallel for num_threads(db.userParam().numThreads)
+    for (long i = 0; i < numNodes; ++i)
     {
+        Node& node = db.node(i); 
         if (node.status() != PlaceStatusEnum::FIXED)
         {
-            PlaceDB::coordinate_type xx = x.at(node.id()); 
-            PlaceDB::coordinate_type yy = y.at(node.id()); 
+            PlaceDB::coordinate_type xx = vx[i]; 
+            PlaceDB::coordinate_type yy = vy[i]; 
             moveTo(node, xx, yy);
 
             // update place status 
             node.setStatus(PlaceStatusEnum::PLACED); 
-            // update orient 
-            auto rowId = db.getRowIndex(node.yl());
-            auto const& row = db.row(rowId); 
-            if (node.orient() == OrientEnum::UNKNOWN)
-            {
-                node.setOrient(row.orient()); 
-            }
-            else 
+            // update orient, which follows the row, if any 
+            if (lastRow >= 0)
             {
-                if (row.orient() == Orient::vflip(node.orient())) // only vertically flipped
-                {
-                    node.setOrient(row.orient()); 
-                }
-                else if (row.orient() == Orient::hflip(Orient::vflip(node.orient()))) // both vertically and horizontally flipped
-                {
-                    // flip vertically 
-                    node.setOrient(Orient::vflip(node.orient()));
-                }
-                // other cases, no need to change 
+                long rowId = std::min(std::max((yy-rowYL)/rowHeight, 0L), lastRow); 
+                node.setOrient((OrientEnum::OrientType)vOrientMap[vRowOrient[rowId]*numOrients+node.orient()]); 
             }
         }
     }
 }
 
+/// flip movable nodes horizontally, e.g., N <=> FN and S <=> FS, 
+/// together with the offsets of their pins 
+void apply_flip(PlaceDB& db, 
+        pybind11::array_t<unsigned char, pybind11::array::c_style | pybind11::array::forcecast> const& flip_x 
+        )
+{
+    unsigned char const* vFlip = flip_x.data(); 
+    long numFlips = std::min((long)flip_x.size(), (long)db.nodes().size()); 
+
+    // pins of different nodes are disjoint 
+#pragma omp parallel for num_threads(db.userParam().numThreads)
+    for (long i = 0; i < numFlips; ++i)
+    {
+        Node& node = db.node(i); 
+        if (vFlip[i] && node.status() != PlaceStatusEnum::FIXED)
+        {
+            Orient origOrient (node.orient()); 
+            Orient newOrient = Orient::hflip(origOrient); 
+            db.updateNodePinOffset(node, origOrient, newOrient); 
+            node.setOrient(newOrient); 
+        }
+    }
+}
+
 /// database for python 
 struct PyPlaceDB
 {
@@ -334,19 +466,20 @@ struct PyPlaceDB
             node_size_x.append(node.width()); 
             node_size_y.append(node.height());
 
+            IndexRange<PlaceDB::index_type const> vNodePin = db.nodePins(node); 
             pybind11::list pins;
-            for (std::vector<Node::index_type>::const_iterator it = node.pins().begin(), ite = node.pins().end(); it != ite; ++it)
+            for (IndexRange<PlaceDB::index_type const>::const_iterator it = vNodePin.begin(), ite = vNodePin.end(); it != ite; ++it)
             {
                 pins.append(*it);
             }
             node2pin_map.append(pins); 
 
-            for (std::vector<Node::index_type>::const_iterator it = node.pins().begin(), ite = node.pins().end(); it != ite; ++it)
+            for (IndexRange<PlaceDB::index_type const>::const_iterator it = vNodePin.begin(), ite = vNodePin.end(); it != ite; ++it)
             {
                 flat_node2pin_map.append(*it); 
             }
             flat_node2pin_start_map.append(count); 
-            count += node.pins().size(); 
+            count += vNodePin.size(); 
         }
         flat_node2pin_start_map.append(count); 
 
@@ -373,19 +506,20 @@ struct PyPlaceDB
             net_weights.append(net.weight());
             net_name2id_map[pybind11::str(db.netName(net))] = net.id(); 
             net_names.append(pybind11::str(db.netName(net))); 
+            IndexRange<PlaceDB::index_type const> vNetPin = db.netPins(net); 
             pybind11::list pins; 
-            for (std::vector<Net::index_type>::const_iterator it = net.pins().begin(), ite = net.pins().end(); it != ite; ++it)
+            for (IndexRange<PlaceDB::index_type const>::const_iterator it = vNetPin.begin(), ite = vNetPin.end(); it != ite; ++it)
             {
                 pins.append(*it);
             }
             net2pin_map.append(pins); 
 
-            for (std::vector<Net::index_type>::const_iterator it = net.pins().begin(), ite = net.pins().end(); it != ite; ++it)
+            for (IndexRange<PlaceDB::index_type const>::const_iterator it = vNetPin.begin(), ite = vNetPin.end(); it != ite; ++it)
             {
                 flat_net2pin_map.append(*it); 
             }
             flat_net2pin_start_map.append(count); 
-            count += net.pins().size(); 
+            count += vNetPin.size(); 
         }
         flat_net2pin_start_map.append(count); 
 
@@ -470,6 +604,18 @@ DREAMPLACE_NAMESPACE::PlaceDB place_io_forward(pybind11::list const& args)
     }
     delete [] argv; 
 	
+    // load from snapshot if it is up to date with the input files 
+    std::string const& snapshotFile = db.userParam().snapshotFile; 
+    unsigned long fingerprint = 0; 
+    if (!snapshotFile.empty())
+    {
+        fingerprint = DREAMPLACE_NAMESPACE::PlaceDBSnapshot::fingerprint(db.userParam()); 
+        if (DREAMPLACE_NAMESPACE::PlaceDBSnapshot(db).read(snapshotFile, fingerprint))
+        {
+            return db; 
+        }
+    }
+
 	// order for reading files 
 	// 1. lef files 
 	// 2. def files 
@@ -498,6 +644,12 @@ DREAMPLACE_NAMESPACE::PlaceDB place_io_forward(pybind11::list const& args)
     // adjust input parameters 
     db.adjustParams();
 
+    // save snapshot for later runs, failure is not fatal 
+    if (!snapshotFile.empty())
+    {
+        DREAMPLACE_NAMESPACE::PlaceDBSnapshot(db).write(snapshotFile); 
+    }
+
     //return DREAMPLACE_NAMESPACE::PyPlaceDB(db); 
     return db; 
 }
@@ -587,6 +739,7 @@ PYBIND11_MODULE(TORCH_EXTENSION_NAME, m) {
     pybind11::enum_<SolutionFileFormat>(m, "SolutionFileFormat")
         .value("DEF", DREAMPLACE_NAMESPACE::DEF)
         .value("DEFSIMPLE", DREAMPLACE_NAMESPACE::DEFSIMPLE)
+        .value("DEFDELTA", DREAMPLACE_NAMESPACE::DEFDELTA)
         .value("BOOKSHELF", DREAMPLACE_NAMESPACE::BOOKSHELF)
         .value("BOOKSHELFALL", DREAMPLACE_NAMESPACE::BOOKSHELFALL)
         .export_values()
@@ -1045,5 +1198,8 @@ PYBIND11_MODULE(TORCH_EXTENSION_NAME, m) {
                 pybind11::array_t<double, pybind11::array::c_style | pybind11::array::forcecast> const& x, 
                 pybind11::array_t<double, pybind11::array::c_style | pybind11::array::forcecast> const& y) {apply(db, x, y);},
              "Apply Placement Solution (double)");
+    m.def("apply_flip", [](DREAMPLACE_NAMESPACE::PlaceDB& db, 
+                pybind11::array_t<unsigned char, pybind11::array::c_style | pybind11::array::forcecast> const& flip_x) {apply_flip(db, flip_x);},
+             "Flip Nodes Horizontally");
 }
 
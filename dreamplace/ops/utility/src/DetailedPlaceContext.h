@@ -0,0 +1,49 @@
+/**
+ * @file   DetailedPlaceContext.h
+ * @author agent
+ * @date   Oct 2026
+ * @brief  Indices shared by detailed placement passes run one after another
+ */
+
+#ifndef _DREAMPLACE_UTILITY_DETAILEDPLACECONTEXT_H
+#define _DREAMPLACE_UTILITY_DETAILEDPLACECONTEXT_H
+
+#include <vector>
+#include "utility/src/Msg.h"
+#include "utility/src/RowOccupancy.h"
+#include "utility/src/NetBoxCache.h"
+#include "utility/src/DetailedPlaceDB.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// @brief Row occupancy, net boxes and HPWL of the current placement of a DetailedPlaceDB.
+/// A pass given the context takes over the indices instead of building its own,
+/// keeps them up to date while moving cells, and hands them back at exit,
+/// so a sequence of passes only builds them once.
+/// Each pass also reports the cells it moved, so the result can be checked incrementally.
+/// Passes running on the same context must use the same locations and pin offsets.
+template <typename T>
+struct DetailedPlaceContext
+{
+    RowOccupancy<T> row_occupancy; ///< cells in rows and locations of cells
+    NetBoxCache<T> net_boxes; ///< extreme pins of nets
+    T hpwl; ///< total HPWL of the current placement
+    std::vector<int> moved_nodes; ///< cells moved by the last pass, may contain duplicates
+
+    DetailedPlaceContext()
+        : hpwl(0)
+    {
+    }
+
+    /// @brief build the indices from the current placement
+    void build(const DetailedPlaceDB<T>& db, int num_threads)
+    {
+        db.make_row_occupancy(db.x, db.y, row_occupancy, num_threads);
+        db.make_net_box_cache(net_boxes, num_threads);
+        hpwl = db.compute_total_hpwl();
+    }
+};
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
@@ -11,6 +11,7 @@
 #include "utility/src/Msg.h"
 #include "utility/src/Box.cuh"
 #include "utility/src/utils.cuh"
+#include "utility/src/RowOccupancy.h"
 #include "legality_check/src/legality_check.h"
 #include "draw_place/src/draw_place.h"
 //#include <thrust/host_vector.h>
@@ -306,58 +307,7 @@ struct DetailedPlaceDB
 #endif
         for (int i = 0; i < num_sites_y; ++i)
         {
-            auto& row2nodes = row2node_map[i];
-            // sort cells within rows according to left edges 
-            std::sort(row2nodes.begin(), row2nodes.end(), 
-                    [&] (int node_id1, int node_id2) {
-                        T x1 = host_x[node_id1];
-                        T x2 = host_x[node_id2];
-                        return x1 < x2 || (x1 == x2 && node_id1 < node_id2);
-                    });
-            // After sorting by left edge, 
-            // there is a special case for fixed cells where 
-            // one fixed cell is completely within another in a row. 
-            // This will cause failure to detect some overlaps. 
-            // We need to remove the "small" fixed cell that is inside another. 
-            if (!row2nodes.empty())
-            {
-                std::vector<int> tmp_nodes; 
-                tmp_nodes.reserve(row2nodes.size());
-                tmp_nodes.push_back(row2nodes.front()); 
-                for (int j = 1, je = row2nodes.size(); j < je; ++j)
-                {
-                    int node_id1 = row2nodes.at(j-1);
-                    int node_id2 = row2nodes.at(j);
-                    // two fixed cells 
-                    if (node_id1 >= num_movable_nodes && node_id2 >= num_movable_nodes)
-                    {
-                        T xl1 = host_x[node_id1]; 
-                        T xl2 = host_x[node_id2];
-                        T width1 = host_node_size_x[node_id1]; 
-                        T width2 = host_node_size_x[node_id2]; 
-                        T xh1 = xl1 + width1; 
-                        T xh2 = xl2 + width2; 
-                        // only collect node_id2 if its right edge is righter than node_id1 
-                        if (xh1 < xh2)
-                        {
-                            tmp_nodes.push_back(node_id2);
-                        }
-                    }
-                    else 
-                    {
-                        tmp_nodes.push_back(node_id2);
-                    }
-                }
-                row2nodes.swap(tmp_nodes);
-
-                // sort according to center 
-                std::sort(row2nodes.begin(), row2nodes.end(), 
-                        [&] (int node_id1, int node_id2) {
-                            T x1 = host_x[node_id1] + host_node_size_x[node_id1]/2;
-                            T x2 = host_x[node_id2] + host_node_size_x[node_id2]/2;
-                            return x1 < x2 || (x1 == x2 && node_id1 < node_id2);
-                        });
-            }
+            sortRowNodes(host_x, host_node_size_x, num_movable_nodes, row2node_map[i]);
         }
     }
     /// @brief distribute cells to rows 
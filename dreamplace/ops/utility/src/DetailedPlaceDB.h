@@ -9,6 +9,8 @@
 
 #include "utility/src/Msg.h"
 #include "utility/src/Box.h"
+#include "utility/src/RowOccupancy.h"
+#include "utility/src/NetBoxCache.h"
 #include "legality_check/src/legality_check.h"
 #include "draw_place/src/draw_place.h"
 
@@ -195,6 +197,48 @@ struct DetailedPlaceDB
 
         return box; 
     }
+    /// @brief compute optimal region for a cell with cached boxes of nets, 
+    /// which only visits the pins of the cell 
+    Box<T> compute_optimal_region(int node_id, const NetBoxCache<T>& net_boxes) const
+    {
+        Box<T> box (
+                std::numeric_limits<T>::max(),
+                std::numeric_limits<T>::max(),
+                -std::numeric_limits<T>::max(),
+                -std::numeric_limits<T>::max()
+                ); 
+        for (int node2pin_id = flat_node2pin_start_map[node_id]; node2pin_id < flat_node2pin_start_map[node_id+1]; ++node2pin_id)
+        {
+            int node_pin_id = flat_node2pin_map[node2pin_id];
+            int net_id = pin2net_map[node_pin_id];
+            if (net_mask[net_id])
+            {
+                Box<T> net_box = net_boxes.boxWithout(net_id, node_id); 
+                box.xl = std::min(box.xl, net_box.xl);
+                box.xh = std::max(box.xh, net_box.xh);
+                box.yl = std::min(box.yl, net_box.yl);
+                box.yh = std::max(box.yh, net_box.yh);
+            }
+        }
+        shift_box_to_layout(box);
+
+        return box; 
+    }
+    /// @brief extend a box with the pins of a cell on a net, with the cell at (xx, yy) 
+    void encompass_node_pins(Box<T>& box, int node_id, T xx, T yy, int net_id) const 
+    {
+        for (int node2pin_id = flat_node2pin_start_map[node_id]; node2pin_id < flat_node2pin_start_map[node_id+1]; ++node2pin_id)
+        {
+            int node_pin_id = flat_node2pin_map[node2pin_id];
+            if (pin2net_map[node_pin_id] == net_id)
+            {
+                box.xl = std::min(box.xl, xx+pin_offset_x[node_pin_id]);
+                box.xh = std::max(box.xh, xx+pin_offset_x[node_pin_id]);
+                box.yl = std::min(box.yl, yy+pin_offset_y[node_pin_id]);
+                box.yh = std::max(box.yh, yy+pin_offset_y[node_pin_id]);
+            }
+        }
+    }
     /// @brief compute HPWL for a net 
     T compute_net_hpwl(int net_id) const
     {
@@ -234,95 +278,22 @@ struct DetailedPlaceDB
         //dreamplacePrint(kDEBUG, "end compute_total_hpwl\n");
         return total_hpwl; 
     }
-    /// @brief distribute cells to rows 
-    void make_row2node_map(const T* vx, const T* vy, std::vector<std::vector<int> >& row2node_map, int num_threads) const 
+    /// @brief distribute cells to rows and sort them from left to right 
+    void make_row_occupancy(const T* vx, const T* vy, RowOccupancy<T>& occupancy, int num_threads) const 
     {
-        // distribute cells to rows 
-        for (int i = 0; i < num_nodes; ++i)
-        {
-            //T node_xl = vx[i]; 
-            T node_yl = vy[i];
-            //T node_xh = node_xl+node_size_x[i];
-            T node_yh = node_yl+node_size_y[i];
-
-            int row_idxl = (node_yl-yl)/row_height; 
-            int row_idxh = ceil((node_yh-yl)/row_height)+1;
-            row_idxl = std::max(row_idxl, 0); 
-            row_idxh = std::min(row_idxh, num_sites_y); 
-
-            for (int row_id = row_idxl; row_id < row_idxh; ++row_id)
-            {
-                T row_yl = yl+row_id*row_height; 
-                T row_yh = row_yl+row_height; 
-
-                if (node_yl < row_yh && node_yh > row_yl) // overlap with row 
-                {
-                    row2node_map[row_id].push_back(i); 
-                }
-            }
-        }
-
-        // sort cells within rows 
-        // it is safer to sort by center 
-        // sometimes there might be cells with 0 sizes 
-#ifdef _OPENMP
-#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 1)
-#endif
-        for (int i = 0; i < num_sites_y; ++i)
-        {
-            auto& row2nodes = row2node_map[i];
-            // sort cells within rows according to left edges 
-            std::sort(row2nodes.begin(), row2nodes.end(), 
-                    [&] (int node_id1, int node_id2) {
-                    T x1 = vx[node_id1];
-                    T x2 = vx[node_id2];
-                    return x1 < x2 || (x1 == x2 && node_id1 < node_id2);
-                    });
-            // After sorting by left edge, 
-            // there is a special case for fixed cells where 
-            // one fixed cell is completely within another in a row. 
-            // This will cause failure to detect some overlaps. 
-            // We need to remove the "small" fixed cell that is inside another. 
-            if (!row2nodes.empty())
-            {
-                std::vector<int> tmp_nodes; 
-                tmp_nodes.reserve(row2nodes.size());
-                tmp_nodes.push_back(row2nodes.front()); 
-                for (int j = 1, je = row2nodes.size(); j < je; ++j)
-                {
-                    int node_id1 = row2nodes.at(j-1);
-                    int node_id2 = row2nodes.at(j);
-                    // two fixed cells 
-                    if (node_id1 >= num_movable_nodes && node_id2 >= num_movable_nodes)
-                    {
-                        T xl1 = vx[node_id1]; 
-                        T xl2 = vx[node_id2];
-                        T width1 = node_size_x[node_id1]; 
-                        T width2 = node_size_x[node_id2]; 
-                        T xh1 = xl1 + width1; 
-                        T xh2 = xl2 + width2; 
-                        // only collect node_id2 if its right edge is righter than node_id1 
-                        if (xh1 < xh2)
-                        {
-                            tmp_nodes.push_back(node_id2);
-                        }
-                    }
-                    else 
-                    {
-                        tmp_nodes.push_back(node_id2);
-                    }
-                }
-                row2nodes.swap(tmp_nodes);
-
-                // sort according to center 
-                std::sort(row2nodes.begin(), row2nodes.end(), 
-                        [&] (int node_id1, int node_id2) {
-                        T x1 = vx[node_id1] + node_size_x[node_id1]/2;
-                        T x2 = vx[node_id2] + node_size_x[node_id2]/2;
-                        return x1 < x2 || (x1 == x2 && node_id1 < node_id2);
-                        });
-            }
-        }
+        occupancy.build(vx, vy, node_size_x, node_size_y, 
+                xl, yl, xh, row_height, 
+                num_sites_y, num_nodes, num_movable_nodes, 
+                num_threads); 
+    }
+    /// @brief compute the extreme pins of nets 
+    void make_net_box_cache(NetBoxCache<T>& net_boxes, int num_threads) const 
+    {
+        net_boxes.build(x, y, pin_offset_x, pin_offset_y, 
+                flat_net2pin_map, flat_net2pin_start_map, pin2net_map, 
+                flat_node2pin_map, flat_node2pin_start_map, pin2node_map, 
+                net_mask, 
+                num_nets, num_threads); 
     }
     /// @brief distribute movable cells to bins 
     void make_bin2node_map(const T* host_x, const T* host_y, 
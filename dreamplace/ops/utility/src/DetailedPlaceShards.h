@@ -0,0 +1,317 @@
+/**
+ * @file   DetailedPlaceShards.h
+ * @author agent
+ * @date   Oct 2026
+ * @brief  Partition detailed placement into independent rectangular shards.
+ */
+
+#ifndef _DREAMPLACE_UTILITY_DETAILEDPLACESHARDS_H
+#define _DREAMPLACE_UTILITY_DETAILEDPLACESHARDS_H
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "utility/src/DetailedPlaceDB.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// @brief a detailed placement sub-problem on a rectangular shard of the layout.
+/// The layout of the local database is the shard, so local placers keep the movable cells inside it.
+/// Local arrays of cells are laid out as [movable cells, obstacles, halo pins], where
+/// movable cells are those completely inside the shard,
+/// obstacles are the other cells overlapping with the shard, which are fixed locally, and
+/// halo pins are the pins of cells outside the movable ones on nets of the movable ones.
+/// Each halo pin is a fixed cell of 0 size with one pin, located at the pin clamped into the shard.
+/// As all movable pins are inside the shard, clamping keeps the change of HPWL of any move exact.
+/// The local database points to the local arrays, so the object must not be copied after build.
+template <typename T>
+struct DetailedPlaceShard
+{
+    std::vector<int> node_ids; ///< movable cells in the original database, sorted
+    std::vector<T> init_x;
+    std::vector<T> init_y;
+    std::vector<T> node_size_x;
+    std::vector<T> node_size_y;
+    std::vector<T> x;
+    std::vector<T> y;
+    std::vector<int> node2fence_region_map; ///< length of number of local movable cells
+    std::vector<int> flat_net2pin_map;
+    std::vector<int> flat_net2pin_start_map;
+    std::vector<int> pin2net_map;
+    std::vector<int> flat_node2pin_map;
+    std::vector<int> flat_node2pin_start_map;
+    std::vector<int> pin2node_map;
+    std::vector<T> pin_offset_x;
+    std::vector<T> pin_offset_y;
+    std::vector<unsigned char> net_mask;
+    DetailedPlaceDB<T> db; ///< database on local arrays
+
+    /// @brief collect cells, nets and halo pins of a shard from current locations of the original database
+    /// @param box shard aligned to sites and rows
+    /// @param movable_ids sorted movable cells completely inside the shard
+    /// @param obstacle_ids other cells overlapping with the shard
+    void build(const DetailedPlaceDB<T>& src, const Box<T>& box,
+            const std::vector<int>& movable_ids, const std::vector<int>& obstacle_ids)
+    {
+        node_ids = movable_ids;
+        for (auto node_id : node_ids)
+        {
+            addNode(src, node_id);
+            node2fence_region_map.push_back(src.node2fence_region_map[node_id]);
+        }
+        for (auto node_id : obstacle_ids)
+        {
+            addNode(src, node_id);
+        }
+        int num_nodes = x.size();
+
+        // nets of movable cells
+        std::vector<int> net_ids;
+        for (auto node_id : node_ids)
+        {
+            for (int node2pin_id = src.flat_node2pin_start_map[node_id]; node2pin_id < src.flat_node2pin_start_map[node_id+1]; ++node2pin_id)
+            {
+                net_ids.push_back(src.pin2net_map[src.flat_node2pin_map[node2pin_id]]);
+            }
+        }
+        std::sort(net_ids.begin(), net_ids.end());
+        net_ids.erase(std::unique(net_ids.begin(), net_ids.end()), net_ids.end());
+
+        flat_net2pin_start_map.reserve(net_ids.size()+1);
+        net_mask.reserve(net_ids.size());
+        for (unsigned int i = 0; i < net_ids.size(); ++i)
+        {
+            int net_id = net_ids[i];
+            flat_net2pin_start_map.push_back(pin2net_map.size());
+            net_mask.push_back(src.net_mask[net_id]);
+            for (int net2pin_id = src.flat_net2pin_start_map[net_id]; net2pin_id < src.flat_net2pin_start_map[net_id+1]; ++net2pin_id)
+            {
+                int net_pin_id = src.flat_net2pin_map[net2pin_id];
+                int node_id = src.pin2node_map[net_pin_id];
+                auto found = std::lower_bound(node_ids.begin(), node_ids.end(), node_id);
+                if (found != node_ids.end() && *found == node_id)
+                {
+                    pin2node_map.push_back(found-node_ids.begin());
+                    pin_offset_x.push_back(src.pin_offset_x[net_pin_id]);
+                    pin_offset_y.push_back(src.pin_offset_y[net_pin_id]);
+                }
+                else
+                {
+                    T pin_x = std::min(std::max(src.x[node_id]+src.pin_offset_x[net_pin_id], box.xl), box.xh);
+                    T pin_y = std::min(std::max(src.y[node_id]+src.pin_offset_y[net_pin_id], box.yl), box.yh);
+                    pin2node_map.push_back(x.size());
+                    pin_offset_x.push_back(0);
+                    pin_offset_y.push_back(0);
+                    addPoint(pin_x, pin_y);
+                }
+                flat_net2pin_map.push_back(pin2net_map.size());
+                pin2net_map.push_back(i);
+            }
+        }
+        flat_net2pin_start_map.push_back(pin2net_map.size());
+
+        // pins of each cell by counting
+        int num_all_nodes = x.size();
+        int num_pins = pin2node_map.size();
+        flat_node2pin_start_map.assign(num_all_nodes+1, 0);
+        for (int i = 0; i < num_pins; ++i)
+        {
+            flat_node2pin_start_map[pin2node_map[i]+1] += 1;
+        }
+        for (int i = 0; i < num_all_nodes; ++i)
+        {
+            flat_node2pin_start_map[i+1] += flat_node2pin_start_map[i];
+        }
+        flat_node2pin_map.resize(num_pins);
+        std::vector<int> positions (flat_node2pin_start_map.begin(), flat_node2pin_start_map.end()-1);
+        for (int i = 0; i < num_pins; ++i)
+        {
+            flat_node2pin_map[positions[pin2node_map[i]]++] = i;
+        }
+
+        db = src;
+        db.init_x = init_x.data();
+        db.init_y = init_y.data();
+        db.node_size_x = node_size_x.data();
+        db.node_size_y = node_size_y.data();
+        db.node2fence_region_map = node2fence_region_map.data();
+        db.x = x.data();
+        db.y = y.data();
+        db.flat_net2pin_map = flat_net2pin_map.data();
+        db.flat_net2pin_start_map = flat_net2pin_start_map.data();
+        db.pin2net_map = pin2net_map.data();
+        db.flat_node2pin_map = flat_node2pin_map.data();
+        db.flat_node2pin_start_map = flat_node2pin_start_map.data();
+        db.pin2node_map = pin2node_map.data();
+        db.pin_offset_x = pin_offset_x.data();
+        db.pin_offset_y = pin_offset_y.data();
+        db.net_mask = net_mask.data();
+        db.xl = box.xl;
+        db.yl = box.yl;
+        db.xh = box.xh;
+        db.yh = box.yh;
+        // keep the size of bins close to the original one
+        db.num_bins_x = std::max((int)round((box.xh-box.xl)/src.bin_size_x), 1);
+        db.num_bins_y = std::max((int)round((box.yh-box.yl)/src.bin_size_y), 1);
+        db.bin_size_x = (box.xh-box.xl)/db.num_bins_x;
+        db.bin_size_y = (box.yh-box.yl)/db.num_bins_y;
+        db.num_sites_x = round((box.xh-box.xl)/src.site_width);
+        db.num_sites_y = round((box.yh-box.yl)/src.row_height);
+        db.num_nodes = num_nodes;
+        db.num_movable_nodes = node_ids.size();
+        db.num_nets = net_ids.size();
+        db.num_pins = num_pins;
+    }
+
+    /// @brief write locations of movable cells back to the original database
+    void writeBack(const DetailedPlaceDB<T>& src) const
+    {
+        for (unsigned int i = 0; i < node_ids.size(); ++i)
+        {
+            src.x[node_ids[i]] = x[i];
+            src.y[node_ids[i]] = y[i];
+        }
+    }
+
+    protected:
+        void addNode(const DetailedPlaceDB<T>& src, int node_id)
+        {
+            init_x.push_back(src.init_x[node_id]);
+            init_y.push_back(src.init_y[node_id]);
+            node_size_x.push_back(src.node_size_x[node_id]);
+            node_size_y.push_back(src.node_size_y[node_id]);
+            x.push_back(src.x[node_id]);
+            y.push_back(src.y[node_id]);
+        }
+        void addPoint(T xx, T yy)
+        {
+            init_x.push_back(xx);
+            init_y.push_back(yy);
+            node_size_x.push_back(0);
+            node_size_y.push_back(0);
+            x.push_back(xx);
+            y.push_back(yy);
+        }
+};
+
+/// @brief cut [lo, hi] into n pieces aligned to unit, shifted by a fraction of a piece
+/// @return boundaries of pieces from lo to hi
+template <typename T>
+std::vector<T> makeShardCuts(T lo, T hi, T unit, int n, T shift)
+{
+    std::vector<T> cuts (1, lo);
+    for (int k = 0; k < n; ++k)
+    {
+        T c = lo + (hi-lo)*(k+shift)/n;
+        c = lo + round((c-lo)/unit)*unit;
+        if (c > cuts.back() && c < hi)
+        {
+            cuts.push_back(c);
+        }
+    }
+    cuts.push_back(hi);
+    return cuts;
+}
+
+/// @brief run a detailed placer on rectangular shards of the layout concurrently.
+/// Cells completely inside a shard are placed within the shard, and cells crossing boundaries stay fixed,
+/// so shards never interfere with each other.
+/// Pins of cells outside a shard on its nets form the halo of the shard,
+/// which is copied from current locations when shards are built.
+/// There are two rounds, where the second round shifts the cuts by half a shard,
+/// so cells fixed on boundaries in the first round are placed in the second one,
+/// and halos are exchanged by rebuilding shards from the results of the first round.
+/// With a single shard, the placer runs on the original database directly.
+/// @param num_shards number of shards of the first round, arranged in a grid following the aspect ratio of the layout
+/// @param place functor with place(const DetailedPlaceDB<T>& db, int num_threads)
+template <typename T, typename DetailedPlacerType>
+void detailedPlaceShards(const DetailedPlaceDB<T>& db, int num_shards, int num_threads, DetailedPlacerType const& place)
+{
+    if (num_shards <= 1)
+    {
+        place(db, num_threads);
+        return;
+    }
+
+    T width = db.xh-db.xl;
+    T height = db.yh-db.yl;
+    int num_shards_x = std::max((int)round(sqrt(num_shards*width/height)), 1);
+    num_shards_x = std::min(std::min(num_shards_x, num_shards), db.num_sites_x);
+    int num_shards_y = std::min(std::max(num_shards/num_shards_x, 1), db.num_sites_y);
+
+    for (int round_id = 0; round_id < 2; ++round_id)
+    {
+        std::vector<T> cuts_x = makeShardCuts(db.xl, db.xh, db.site_width, num_shards_x, (T)((round_id && num_shards_x > 1)? 0.5 : 0));
+        std::vector<T> cuts_y = makeShardCuts(db.yl, db.yh, db.row_height, num_shards_y, (T)((round_id && num_shards_y > 1)? 0.5 : 0));
+        int nx = cuts_x.size()-1;
+        int ny = cuts_y.size()-1;
+
+        // distribute cells to shards
+        std::vector<std::vector<int> > movable_ids (nx*ny);
+        std::vector<std::vector<int> > obstacle_ids (nx*ny);
+        for (int i = 0; i < db.num_nodes; ++i)
+        {
+            T node_xl = db.x[i];
+            T node_yl = db.y[i];
+            T node_xh = node_xl+db.node_size_x[i];
+            T node_yh = node_yl+db.node_size_y[i];
+            int ixl = std::upper_bound(cuts_x.begin(), cuts_x.end(), node_xl)-cuts_x.begin()-1;
+            int ixh = std::lower_bound(cuts_x.begin(), cuts_x.end(), node_xh)-cuts_x.begin()-1;
+            int iyl = std::upper_bound(cuts_y.begin(), cuts_y.end(), node_yl)-cuts_y.begin()-1;
+            int iyh = std::lower_bound(cuts_y.begin(), cuts_y.end(), node_yh)-cuts_y.begin()-1;
+            ixl = std::min(std::max(ixl, 0), nx-1);
+            ixh = std::min(std::max(ixh, ixl), nx-1);
+            iyl = std::min(std::max(iyl, 0), ny-1);
+            iyh = std::min(std::max(iyh, iyl), ny-1);
+            if (i < db.num_movable_nodes && ixl == ixh && iyl == iyh
+                    && node_xl >= cuts_x[ixl] && node_xh <= cuts_x[ixl+1]
+                    && node_yl >= cuts_y[iyl] && node_yh <= cuts_y[iyl+1])
+            {
+                movable_ids[ixl*ny+iyl].push_back(i);
+            }
+            else
+            {
+                for (int ix = ixl; ix <= ixh; ++ix)
+                {
+                    for (int iy = iyl; iy <= iyh; ++iy)
+                    {
+                        obstacle_ids[ix*ny+iy].push_back(i);
+                    }
+                }
+            }
+        }
+
+        // build all shards before placing any of them, so halos are consistent snapshots
+        std::vector<DetailedPlaceShard<T> > shards (nx*ny);
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 1)
+        for (int shard_id = 0; shard_id < nx*ny; ++shard_id)
+        {
+            if (!movable_ids[shard_id].empty())
+            {
+                int ix = shard_id/ny;
+                int iy = shard_id%ny;
+                Box<T> box (cuts_x[ix], cuts_y[iy], cuts_x[ix+1], cuts_y[iy+1]);
+                shards[shard_id].build(db, box, movable_ids[shard_id], obstacle_ids[shard_id]);
+            }
+        }
+
+        // threads are split among shards, which only takes effect with nested parallelism
+        int shard_num_threads = std::max(num_threads/(nx*ny), 1);
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 1)
+        for (int shard_id = 0; shard_id < nx*ny; ++shard_id)
+        {
+            auto& shard = shards[shard_id];
+            if (!shard.node_ids.empty())
+            {
+                dreamplacePrint(kDEBUG, "round %d: place %d cells in shard %d with %d obstacles, %d nets\n",
+                        round_id, shard.db.num_movable_nodes, shard_id, shard.db.num_nodes-shard.db.num_movable_nodes, shard.db.num_nets);
+                place(shard.db, shard_num_threads);
+                shard.writeBack(db);
+            }
+        }
+    }
+}
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
@@ -14,6 +14,20 @@
 
 DREAMPLACE_BEGIN_NAMESPACE
 
+/// Multi-row standard cells up to this number of rows are handled by the standard cell legalizers, 
+/// and only taller movable cells are regarded as movable macros in legalization. 
+/// The placement database still marks cells taller than DUMMY_FIXED_NUM_ROWS as DUMMY_FIXED. 
+#define LEGALIZATION_MAX_NUM_ROWS 4
+
+/// @brief check power rail parity of a cell with num_node_rows rows placed at row row_id. 
+/// Power rails alternate between VSS and VDD at row boundaries starting from VSS. 
+/// A cell with an odd number of rows can be flipped to fit either parity, 
+/// while one with an even number of rows has VSS at both edges and must start at an even row. 
+inline bool isPowerRailAligned(int row_id, int num_node_rows)
+{
+    return (num_node_rows & 1) || !(row_id & 1); 
+}
+
 /// @brief a wrapper class of required data for legalization
 template <typename T>
 struct LegalizationDB
@@ -57,7 +71,12 @@ struct LegalizationDB
         dreamplaceAssert(node_id < db.num_nodes);
 #endif
         T height = node_size_y[node_id];
-        return (node_id < num_movable_nodes && height > (row_height*DUMMY_FIXED_NUM_ROWS));
+        return (node_id < num_movable_nodes && height > (row_height*LEGALIZATION_MAX_NUM_ROWS));
+    }
+    /// @brief number of rows taken by a cell 
+    inline int num_node_rows(int node_id) const 
+    {
+        return ceil(node_size_y[node_id]/row_height); 
     }
     /// @brief align cell to a row 
     inline T align2row(T y, T height) const 
@@ -0,0 +1,316 @@
+/**
+ * @file   LegalizationRegions.h
+ * @author agent
+ * @date   Oct 2026
+ * @brief  Partition legalization into independent sub-problems by fence regions.
+ */
+
+#ifndef _DREAMPLACE_UTILITY_LEGALIZATIONREGIONS_H
+#define _DREAMPLACE_UTILITY_LEGALIZATIONREGIONS_H
+
+#include <cmath>
+#include <climits>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "utility/src/LegalizationDB.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// @brief a legalization sub-problem with the movable cells of one fence region or the default region.
+/// Local arrays are laid out as [movable cells of the region, fixed cells, blockages],
+/// where blockages are virtual fixed cells covering the area not available to the region,
+/// i.e., the area out of the fence region, or all fence regions for the default region.
+/// The local database points to the local arrays, so the object must not be copied after build.
+template <typename T>
+struct LegalizationRegionProblem
+{
+    std::vector<int> node_ids; ///< movable cells in the original database
+    std::vector<T> init_x;
+    std::vector<T> init_y;
+    std::vector<T> node_size_x;
+    std::vector<T> node_size_y;
+    std::vector<T> x;
+    std::vector<T> y;
+    std::vector<int> region_boxes_start; ///< boxes of the fence region for the local database
+    std::vector<int> node2fence_region_map; ///< length of number of local movable cells
+    LegalizationDB<T> db; ///< database on local arrays
+
+    /// @brief collect cells and blockages of a region from the original database
+    /// @param region_id fence region, or src.num_regions for the default region
+    void build(const LegalizationDB<T>& src, int region_id)
+    {
+        bool fence_flag = (region_id < src.num_regions);
+        for (int i = 0; i < src.num_movable_nodes; ++i)
+        {
+            int node_region_id = src.node2fence_region_map[i];
+            if ((fence_flag && node_region_id == region_id) || (!fence_flag && node_region_id >= src.num_regions))
+            {
+                node_ids.push_back(i);
+            }
+        }
+        db = src;
+        db.num_movable_nodes = node_ids.size();
+        if (node_ids.empty())
+        {
+            return;
+        }
+
+        int box_bgn = (fence_flag)? src.flat_region_boxes_start[region_id] : 0;
+        int box_end = (fence_flag)? src.flat_region_boxes_start[region_id+1] : src.flat_region_boxes_start[src.num_regions];
+
+        // bounding box of the area available to the region
+        T bxl = src.xl;
+        T byl = src.yl;
+        T bxh = src.xh;
+        T byh = src.yh;
+        if (fence_flag)
+        {
+            bxl = src.xh;
+            byl = src.yh;
+            bxh = src.xl;
+            byh = src.yl;
+            for (int box_id = box_bgn; box_id < box_end; ++box_id)
+            {
+                const T* box = src.flat_region_boxes+box_id*4;
+                bxl = std::min(bxl, box[0]);
+                byl = std::min(byl, box[1]);
+                bxh = std::max(bxh, box[2]);
+                byh = std::max(byh, box[3]);
+            }
+        }
+
+        for (auto node_id : node_ids)
+        {
+            addNode(src, node_id);
+        }
+        // fixed cells out of the bounding box are covered by blockages
+        for (int i = src.num_movable_nodes; i < src.num_nodes; ++i)
+        {
+            T node_xl = src.init_x[i];
+            T node_yl = src.init_y[i];
+            if (node_xl < bxh && node_xl+src.node_size_x[i] > bxl && node_yl < byh && node_yl+src.node_size_y[i] > byl)
+            {
+                addNode(src, i);
+            }
+        }
+        if (fence_flag)
+        {
+            addFenceBlockages(src, box_bgn, box_end);
+        }
+        else
+        {
+            addDefaultBlockages(src, box_bgn, box_end);
+        }
+
+        db.init_x = init_x.data();
+        db.init_y = init_y.data();
+        db.node_size_x = node_size_x.data();
+        db.node_size_y = node_size_y.data();
+        db.x = x.data();
+        db.y = y.data();
+        db.num_nodes = x.size();
+        if (fence_flag)
+        {
+            // keep the boxes of this region so that the local database can be checked alone
+            region_boxes_start.assign(1, 0);
+            region_boxes_start.push_back(box_end-box_bgn);
+            node2fence_region_map.assign(node_ids.size(), 0);
+            db.flat_region_boxes = src.flat_region_boxes+box_bgn*4;
+            db.num_regions = 1;
+        }
+        else
+        {
+            region_boxes_start.assign(1, 0);
+            node2fence_region_map.assign(node_ids.size(), INT_MAX);
+            db.num_regions = 0;
+        }
+        db.flat_region_boxes_start = region_boxes_start.data();
+        db.node2fence_region_map = node2fence_region_map.data();
+    }
+
+    /// @brief write locations of movable cells back to the original database
+    void writeBack(const LegalizationDB<T>& src) const
+    {
+        for (unsigned int i = 0; i < node_ids.size(); ++i)
+        {
+            src.x[node_ids[i]] = x[i];
+            src.y[node_ids[i]] = y[i];
+        }
+    }
+
+    protected:
+        void addNode(const LegalizationDB<T>& src, int node_id)
+        {
+            init_x.push_back(src.init_x[node_id]);
+            init_y.push_back(src.init_y[node_id]);
+            node_size_x.push_back(src.node_size_x[node_id]);
+            node_size_y.push_back(src.node_size_y[node_id]);
+            x.push_back(src.x[node_id]);
+            y.push_back(src.y[node_id]);
+        }
+        void addBlockage(T xl, T yl, T width, T height)
+        {
+            init_x.push_back(xl);
+            init_y.push_back(yl);
+            node_size_x.push_back(width);
+            node_size_y.push_back(height);
+            x.push_back(xl);
+            y.push_back(yl);
+        }
+        /// @brief intervals of a row fully covered by the boxes of a fence region, sorted from left to right.
+        /// Boxes may only cover a row together, e.g., boxes stacked at a height in the middle of the row,
+        /// so each interval between box edges is checked against the union of the boxes over it.
+        void coveredIntervals(const LegalizationDB<T>& src, int box_bgn, int box_end, T row_yl, T row_yh,
+                std::vector<std::pair<T, T> >& covered) const
+        {
+            covered.clear();
+            std::vector<T> xs;
+            for (int box_id = box_bgn; box_id < box_end; ++box_id)
+            {
+                const T* box = src.flat_region_boxes+box_id*4;
+                if (box[1] < row_yh && box[3] > row_yl && box[0] < box[2])
+                {
+                    xs.push_back(box[0]);
+                    xs.push_back(box[2]);
+                }
+            }
+            std::sort(xs.begin(), xs.end());
+            xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+            std::vector<std::pair<T, T> > spans;
+            for (int k = 0; k+1 < (int)xs.size(); ++k)
+            {
+                // vertical spans of the boxes over [xs[k], xs[k+1]]
+                spans.clear();
+                for (int box_id = box_bgn; box_id < box_end; ++box_id)
+                {
+                    const T* box = src.flat_region_boxes+box_id*4;
+                    if (box[1] < row_yh && box[3] > row_yl && box[0] <= xs[k] && box[2] >= xs[k+1])
+                    {
+                        spans.push_back(std::make_pair(box[1], box[3]));
+                    }
+                }
+                std::sort(spans.begin(), spans.end());
+                T cur_y = row_yl;
+                for (auto const& span : spans)
+                {
+                    if (span.first > cur_y)
+                    {
+                        break;
+                    }
+                    cur_y = std::max(cur_y, span.second);
+                }
+                if (cur_y < row_yh)
+                {
+                    continue;
+                }
+                if (!covered.empty() && covered.back().second == xs[k])
+                {
+                    covered.back().second = xs[k+1];
+                }
+                else
+                {
+                    covered.push_back(std::make_pair(xs[k], xs[k+1]));
+                }
+            }
+        }
+        /// @brief block the parts of rows not fully covered by the boxes of a fence region.
+        /// Consecutive rows with the same blocked intervals share one blockage.
+        void addFenceBlockages(const LegalizationDB<T>& src, int box_bgn, int box_end)
+        {
+            int num_rows = (src.yh-src.yl)/src.row_height;
+            std::vector<std::pair<T, T> > allowed;
+            std::vector<std::pair<T, T> > blocked;
+            std::vector<std::pair<T, T> > run_blocked;
+            int run_bgn = 0;
+            for (int i = 0; i <= num_rows; ++i)
+            {
+                blocked.clear();
+                if (i < num_rows)
+                {
+                    T row_yl = src.yl+i*src.row_height;
+                    T row_yh = row_yl+src.row_height;
+                    coveredIntervals(src, box_bgn, box_end, row_yl, row_yh, allowed);
+                    T cur_x = src.xl;
+                    for (auto const& interval : allowed)
+                    {
+                        if (interval.first > cur_x)
+                        {
+                            blocked.push_back(std::make_pair(cur_x, interval.first));
+                        }
+                        cur_x = std::max(cur_x, interval.second);
+                    }
+                    if (cur_x < src.xh)
+                    {
+                        blocked.push_back(std::make_pair(cur_x, src.xh));
+                    }
+                }
+                if (i == num_rows || blocked != run_blocked)
+                {
+                    for (auto const& interval : run_blocked)
+                    {
+                        addBlockage(interval.first, src.yl+run_bgn*src.row_height, interval.second-interval.first, (i-run_bgn)*src.row_height);
+                    }
+                    run_blocked.swap(blocked);
+                    run_bgn = i;
+                }
+            }
+        }
+        /// @brief block all fence regions, extended to whole rows
+        void addDefaultBlockages(const LegalizationDB<T>& src, int box_bgn, int box_end)
+        {
+            for (int box_id = box_bgn; box_id < box_end; ++box_id)
+            {
+                const T* box = src.flat_region_boxes+box_id*4;
+                T box_yl = floor((box[1]-src.yl)/src.row_height)*src.row_height+src.yl;
+                T box_yh = ceil((box[3]-src.yl)/src.row_height)*src.row_height+src.yl;
+                if (box[0] < box[2] && box_yl < box_yh)
+                {
+                    addBlockage(box[0], box_yl, box[2]-box[0], box_yh-box_yl);
+                }
+            }
+        }
+};
+
+/// @brief legalize cells of each fence region against the rows inside the region,
+/// and then legalize cells of the default region against the rows outside all fence regions.
+/// Fence regions are disjoint, so they are legalized concurrently.
+/// Without fence regions, the legalizer runs on the original database directly.
+/// @param legalize functor with legalize(const LegalizationDB<T>& db, int num_threads)
+template <typename T, typename LegalizerType>
+void legalizeFenceRegions(const LegalizationDB<T>& db, int num_threads, LegalizerType const& legalize)
+{
+    if (db.num_regions <= 0)
+    {
+        legalize(db, num_threads);
+        return;
+    }
+
+    // threads are split among regions, which only takes effect with nested parallelism
+    int region_num_threads = std::max(num_threads/db.num_regions, 1);
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 1)
+    for (int region_id = 0; region_id < db.num_regions; ++region_id)
+    {
+        LegalizationRegionProblem<T> problem;
+        problem.build(db, region_id);
+        if (problem.db.num_movable_nodes)
+        {
+            dreamplacePrint(kDEBUG, "legalize %d cells in fence region %d\n", problem.db.num_movable_nodes, region_id);
+            legalize(problem.db, region_num_threads);
+            problem.writeBack(db);
+        }
+    }
+
+    LegalizationRegionProblem<T> problem;
+    problem.build(db, db.num_regions);
+    if (problem.db.num_movable_nodes)
+    {
+        dreamplacePrint(kDEBUG, "legalize %d cells in default region\n", problem.db.num_movable_nodes);
+        legalize(problem.db, num_threads);
+        problem.writeBack(db);
+    }
+}
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
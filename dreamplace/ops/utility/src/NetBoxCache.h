@@ -0,0 +1,276 @@
+/**
+ * @file   NetBoxCache.h
+ * @author agent
+ * @date   Oct 2026
+ * @brief  Bounding boxes of nets excluding given cells in constant time
+ */
+
+#ifndef _DREAMPLACE_UTILITY_NETBOXCACHE_H
+#define _DREAMPLACE_UTILITY_NETBOXCACHE_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "utility/src/Msg.h"
+#include "utility/src/Box.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// @brief Pin bounding boxes of nets, with the two most extreme pins of different cells on each side.
+/// The box of a net without a cell takes the second extreme on the sides where the cell is the first one,
+/// so it costs O(1) instead of a scan of the net.
+/// A side is only scanned when both of its extremes belong to the excluded cells.
+/// The cache keeps pointers to the positions;
+/// callers moving cells must call update() for them.
+/// Nets out of the net mask are never tracked, as no caller queries them,
+/// so cells only sharing masked nets can be updated concurrently.
+template <typename T>
+class NetBoxCache
+{
+    public:
+        NetBoxCache()
+            : m_x(NULL)
+            , m_y(NULL)
+            , m_pin_offset_x(NULL)
+            , m_pin_offset_y(NULL)
+            , m_flat_net2pin_map(NULL)
+            , m_flat_net2pin_start_map(NULL)
+            , m_pin2net_map(NULL)
+            , m_flat_node2pin_map(NULL)
+            , m_flat_node2pin_start_map(NULL)
+            , m_pin2node_map(NULL)
+            , m_net_mask(NULL)
+        {
+        }
+
+        /// @brief compute the extremes of all nets
+        /// @param x, y current locations of cells, kept for later queries
+        /// @param net_mask nets to track; the boxes of the others are empty
+        void build(const T* x, const T* y,
+                const T* pin_offset_x, const T* pin_offset_y,
+                const int* flat_net2pin_map, const int* flat_net2pin_start_map, const int* pin2net_map,
+                const int* flat_node2pin_map, const int* flat_node2pin_start_map, const int* pin2node_map,
+                const unsigned char* net_mask,
+                int num_nets, int num_threads)
+        {
+            m_x = x;
+            m_y = y;
+            m_pin_offset_x = pin_offset_x;
+            m_pin_offset_y = pin_offset_y;
+            m_flat_net2pin_map = flat_net2pin_map;
+            m_flat_net2pin_start_map = flat_net2pin_start_map;
+            m_pin2net_map = pin2net_map;
+            m_flat_node2pin_map = flat_node2pin_map;
+            m_flat_node2pin_start_map = flat_node2pin_start_map;
+            m_pin2node_map = pin2node_map;
+            m_net_mask = net_mask;
+
+            m_extremes.resize(num_nets*8);
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 256)
+            for (int net_id = 0; net_id < num_nets; ++net_id)
+            {
+                if (m_net_mask[net_id])
+                {
+                    rebuild(net_id);
+                }
+                else
+                {
+                    reset(net_id);
+                }
+            }
+        }
+
+        /// @brief box of the pins of a net, excluding the pins of one or two cells.
+        /// Sides without any pin left are at the numeric limits, i.e., xl > xh and yl > yh.
+        Box<T> boxWithout(int net_id, int node_id, int other_node_id = std::numeric_limits<int>::max()) const
+        {
+            T values[4];
+            const Extreme* extremes = m_extremes.data()+net_id*8;
+            for (int side = 0; side < 4; ++side)
+            {
+                const Extreme* e = extremes+side*2;
+                if (e[0].node_id != node_id && e[0].node_id != other_node_id)
+                {
+                    values[side] = e[0].value;
+                }
+                else if (e[1].node_id != node_id && e[1].node_id != other_node_id)
+                {
+                    values[side] = e[1].value;
+                }
+                else
+                {
+                    values[side] = scan(net_id, side, node_id, other_node_id);
+                }
+            }
+            return Box<T>(values[0], values[1], values[2], values[3]);
+        }
+
+        /// @brief refresh the nets of a cell after it moves.
+        /// Nets where the cell is one of the extremes are recomputed,
+        /// and the others only need to compare the new pins.
+        void update(int node_id)
+        {
+            for (int node2pin_id = m_flat_node2pin_start_map[node_id]; node2pin_id < m_flat_node2pin_start_map[node_id+1]; ++node2pin_id)
+            {
+                int node_pin_id = m_flat_node2pin_map[node2pin_id];
+                int net_id = m_pin2net_map[node_pin_id];
+                if (!m_net_mask[net_id])
+                {
+                    continue;
+                }
+                Extreme* extremes = m_extremes.data()+net_id*8;
+                bool extreme = false;
+                for (int k = 0; k < 8; ++k)
+                {
+                    extreme |= (extremes[k].node_id == node_id);
+                }
+                if (extreme)
+                {
+                    rebuild(net_id);
+                }
+                else
+                {
+                    for (int side = 0; side < 4; ++side)
+                    {
+                        insert(extremes+side*2, side, pinValue(node_pin_id, node_id, side), node_id);
+                    }
+                }
+            }
+        }
+        /// @brief refresh the nets of many cells after they move or their pins change,
+        /// e.g., at the end of a pass that does not query the cache.
+        /// Each net touched is recomputed once, so cells may share nets.
+        void update(const std::vector<int>& node_ids, int num_threads)
+        {
+            std::vector<unsigned char> net_markers (m_extremes.size()/8, 0);
+            std::vector<int> net_ids;
+            for (auto node_id : node_ids)
+            {
+                for (int node2pin_id = m_flat_node2pin_start_map[node_id]; node2pin_id < m_flat_node2pin_start_map[node_id+1]; ++node2pin_id)
+                {
+                    int net_id = m_pin2net_map[m_flat_node2pin_map[node2pin_id]];
+                    if (m_net_mask[net_id] && !net_markers[net_id])
+                    {
+                        net_markers[net_id] = 1;
+                        net_ids.push_back(net_id);
+                    }
+                }
+            }
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 256)
+            for (int i = 0; i < (int)net_ids.size(); ++i)
+            {
+                rebuild(net_ids[i]);
+            }
+        }
+
+    protected:
+        /// @brief extreme pin of a net on a side
+        struct Extreme
+        {
+            T value;
+            int node_id; ///< -1 if none
+        };
+
+        /// sides are ordered as xl, yl, xh, yh
+        static bool better(int side, T v1, T v2)
+        {
+            return (side < 2)? v1 < v2 : v1 > v2;
+        }
+        static T limit(int side)
+        {
+            return (side < 2)? std::numeric_limits<T>::max() : -std::numeric_limits<T>::max();
+        }
+        T pinValue(int pin_id, int node_id, int side) const
+        {
+            return (side&1)? m_y[node_id]+m_pin_offset_y[pin_id] : m_x[node_id]+m_pin_offset_x[pin_id];
+        }
+
+        /// @brief add a pin to the two extremes of a side, keeping them from different cells
+        static void insert(Extreme* e, int side, T value, int node_id)
+        {
+            if (e[0].node_id == node_id)
+            {
+                e[0].value = better(side, value, e[0].value)? value : e[0].value;
+            }
+            else if (e[1].node_id == node_id)
+            {
+                if (better(side, value, e[1].value))
+                {
+                    e[1].value = value;
+                    if (better(side, e[1].value, e[0].value))
+                    {
+                        std::swap(e[0], e[1]);
+                    }
+                }
+            }
+            else if (better(side, value, e[0].value))
+            {
+                e[1] = e[0];
+                e[0].value = value;
+                e[0].node_id = node_id;
+            }
+            else if (better(side, value, e[1].value))
+            {
+                e[1].value = value;
+                e[1].node_id = node_id;
+            }
+        }
+
+        void reset(int net_id)
+        {
+            Extreme* extremes = m_extremes.data()+net_id*8;
+            for (int side = 0; side < 4; ++side)
+            {
+                extremes[side*2].value = extremes[side*2+1].value = limit(side);
+                extremes[side*2].node_id = extremes[side*2+1].node_id = -1;
+            }
+        }
+        void rebuild(int net_id)
+        {
+            Extreme* extremes = m_extremes.data()+net_id*8;
+            reset(net_id);
+            for (int net2pin_id = m_flat_net2pin_start_map[net_id]; net2pin_id < m_flat_net2pin_start_map[net_id+1]; ++net2pin_id)
+            {
+                int net_pin_id = m_flat_net2pin_map[net2pin_id];
+                int other_node_id = m_pin2node_map[net_pin_id];
+                for (int side = 0; side < 4; ++side)
+                {
+                    insert(extremes+side*2, side, pinValue(net_pin_id, other_node_id, side), other_node_id);
+                }
+            }
+        }
+
+        /// @brief extreme of a side over the pins of other cells
+        T scan(int net_id, int side, int node_id, int other_node_id) const
+        {
+            T value = limit(side);
+            for (int net2pin_id = m_flat_net2pin_start_map[net_id]; net2pin_id < m_flat_net2pin_start_map[net_id+1]; ++net2pin_id)
+            {
+                int net_pin_id = m_flat_net2pin_map[net2pin_id];
+                int pin_node_id = m_pin2node_map[net_pin_id];
+                if (pin_node_id != node_id && pin_node_id != other_node_id)
+                {
+                    T v = pinValue(net_pin_id, pin_node_id, side);
+                    value = better(side, v, value)? v : value;
+                }
+            }
+            return value;
+        }
+
+        const T* m_x;
+        const T* m_y;
+        const T* m_pin_offset_x;
+        const T* m_pin_offset_y;
+        const int* m_flat_net2pin_map;
+        const int* m_flat_net2pin_start_map;
+        const int* m_pin2net_map;
+        const int* m_flat_node2pin_map;
+        const int* m_flat_node2pin_start_map;
+        const int* m_pin2node_map;
+        const unsigned char* m_net_mask;
+        std::vector<Extreme> m_extremes; ///< two extremes for each side of each net, 8 per net
+};
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
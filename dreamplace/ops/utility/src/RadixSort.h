@@ -0,0 +1,80 @@
+/**
+ * @file   RadixSort.h
+ * @author agent
+ * @date   Oct 2026
+ * @brief  Parallel radix sort by small integer keys
+ */
+
+#ifndef _DREAMPLACE_UTILITY_RADIXSORT_H
+#define _DREAMPLACE_UTILITY_RADIXSORT_H
+
+#include <vector>
+#include <algorithm>
+#include "utility/src/Msg.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// @brief stable LSD radix sort of values by unsigned integer keys, 8 bits per pass.
+/// Values are split into one chunk per thread, and each pass counts digits per chunk
+/// before scattering, so the order of equal keys is kept.
+/// Passes stop at the highest bit of the largest key, so small keys such as counters take a single pass.
+/// @param values values to sort
+/// @param buffer temporary storage, which may be swapped with values
+/// @param key functor returning the key of a value
+template <typename V, typename KeyFunc>
+void radixSort(std::vector<V>& values, std::vector<V>& buffer, KeyFunc key, int num_threads)
+{
+    const int num_bits = 8;
+    const int num_buckets = 1<<num_bits;
+    int n = values.size();
+    num_threads = std::max(num_threads, 1);
+    buffer.resize(n);
+
+    unsigned int max_key = 0;
+#pragma omp parallel for num_threads (num_threads) reduction(max:max_key)
+    for (int i = 0; i < n; ++i)
+    {
+        max_key = std::max(max_key, (unsigned int)key(values[i]));
+    }
+
+    int chunk_size = (n+num_threads-1)/num_threads;
+    std::vector<int> offsets (num_threads*num_buckets);
+    for (int shift = 0; shift < (int)sizeof(unsigned int)*8 && (max_key>>shift); shift += num_bits)
+    {
+        std::fill(offsets.begin(), offsets.end(), 0);
+#pragma omp parallel for num_threads (num_threads) schedule(static, 1)
+        for (int c = 0; c < num_threads; ++c)
+        {
+            int* counts = offsets.data()+c*num_buckets;
+            for (int i = c*chunk_size, ie = std::min(i+chunk_size, n); i < ie; ++i)
+            {
+                counts[((unsigned int)key(values[i])>>shift)&(num_buckets-1)] += 1;
+            }
+        }
+        // bucket by bucket, and chunk by chunk within a bucket for stability
+        int offset = 0;
+        for (int b = 0; b < num_buckets; ++b)
+        {
+            for (int c = 0; c < num_threads; ++c)
+            {
+                int count = offsets[c*num_buckets+b];
+                offsets[c*num_buckets+b] = offset;
+                offset += count;
+            }
+        }
+#pragma omp parallel for num_threads (num_threads) schedule(static, 1)
+        for (int c = 0; c < num_threads; ++c)
+        {
+            int* positions = offsets.data()+c*num_buckets;
+            for (int i = c*chunk_size, ie = std::min(i+chunk_size, n); i < ie; ++i)
+            {
+                buffer[positions[((unsigned int)key(values[i])>>shift)&(num_buckets-1)]++] = values[i];
+            }
+        }
+        values.swap(buffer);
+    }
+}
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
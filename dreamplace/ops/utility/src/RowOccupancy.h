@@ -0,0 +1,343 @@
+/**
+ * @file   RowOccupancy.h
+ * @author agent
+ * @date   Oct 2026
+ * @brief  Occupancy of placement rows shared by legalizers and detailed placers
+ */
+
+#ifndef _DREAMPLACE_UTILITY_ROWOCCUPANCY_H
+#define _DREAMPLACE_UTILITY_ROWOCCUPANCY_H
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "utility/src/Msg.h"
+
+DREAMPLACE_BEGIN_NAMESPACE
+
+/// @brief sort cells in a row from left to right,
+/// and remove fixed cells completely inside another fixed cell.
+/// Cells are finally ordered by centers, as there might be cells with 0 sizes.
+/// @param row2nodes cells overlapping with the row
+template <typename T>
+void sortRowNodes(
+        const T* x,
+        const T* node_size_x,
+        const int num_movable_nodes,
+        std::vector<int>& row2nodes
+        )
+{
+    if (row2nodes.empty())
+    {
+        return;
+    }
+    // first sort by left edge
+    std::sort(row2nodes.begin(), row2nodes.end(),
+            [&] (int node_id1, int node_id2) {
+            T x1 = x[node_id1];
+            T x2 = x[node_id2];
+            return x1 < x2 || (x1 == x2 && node_id1 < node_id2);
+            });
+    // After sorting by left edge,
+    // there is a special case for fixed cells where
+    // one fixed cell is completely within another in a row.
+    // This will cause failure to detect some overlaps.
+    // We need to remove the "small" fixed cell that is inside another.
+    // Filter in place, as the kept cells are never ahead of the scanned ones.
+    int num_kept = 1;
+    for (int j = 1, je = row2nodes.size(); j < je; ++j)
+    {
+        int node_id1 = row2nodes[j-1];
+        int node_id2 = row2nodes[j];
+        // two fixed cells
+        if (node_id1 >= num_movable_nodes && node_id2 >= num_movable_nodes)
+        {
+            T xh1 = x[node_id1] + node_size_x[node_id1];
+            T xh2 = x[node_id2] + node_size_x[node_id2];
+            // only collect node_id2 if its right edge is righter than node_id1
+            if (xh1 < xh2)
+            {
+                row2nodes[num_kept++] = node_id2;
+            }
+        }
+        else
+        {
+            row2nodes[num_kept++] = node_id2;
+        }
+    }
+    row2nodes.resize(num_kept);
+
+    // sort according to center
+    std::sort(row2nodes.begin(), row2nodes.end(),
+            [&] (int node_id1, int node_id2) {
+            T x1 = x[node_id1] + node_size_x[node_id1]/2;
+            T x2 = x[node_id2] + node_size_x[node_id2]/2;
+            return x1 < x2 || (x1 == x2 && node_id1 < node_id2);
+            });
+}
+
+/// @brief Cells of each row sorted from left to right,
+/// with the location of each cell in its rows.
+/// A cell is recorded in every row it overlaps, and its location refers to its bottom row.
+/// The index keeps pointers to the positions, so queries always see current locations;
+/// callers moving cells must keep the order with swap() or update().
+template <typename T>
+class RowOccupancy
+{
+    public:
+        /// @brief location of a cell in the index
+        struct Location
+        {
+            int row_id; ///< bottom row of the cell, -1 if the cell is in no row
+            int sub_id; ///< index of the cell in the bottom row
+        };
+
+        RowOccupancy()
+            : m_x(NULL)
+            , m_y(NULL)
+            , m_node_size_x(NULL)
+            , m_node_size_y(NULL)
+            , m_xl(0)
+            , m_yl(0)
+            , m_xh(0)
+            , m_row_height(1)
+            , m_num_movable_nodes(0)
+        {
+        }
+
+        /// @brief distribute cells to rows and sort them
+        /// @param x, y current locations of cells, kept for later queries
+        /// @param num_rows number of rows from yl
+        /// @param num_nodes number of cells to distribute
+        void build(const T* x, const T* y,
+                const T* node_size_x, const T* node_size_y,
+                T xl, T yl, T xh, T row_height,
+                int num_rows, int num_nodes, int num_movable_nodes,
+                int num_threads)
+        {
+            m_x = x;
+            m_y = y;
+            m_node_size_x = node_size_x;
+            m_node_size_y = node_size_y;
+            m_xl = xl;
+            m_yl = yl;
+            m_xh = xh;
+            m_row_height = row_height;
+            m_num_movable_nodes = num_movable_nodes;
+
+            m_row2node_map.assign(num_rows, std::vector<int>());
+            Location invalid;
+            invalid.row_id = -1;
+            invalid.sub_id = -1;
+            m_node2row_map.assign(num_nodes, invalid);
+
+            // distribute cells to rows
+            for (int i = 0; i < num_nodes; ++i)
+            {
+                int row_idxl, row_idxh;
+                rowRange(i, row_idxl, row_idxh);
+                for (int row_id = row_idxl; row_id < row_idxh; ++row_id)
+                {
+                    if (overlapRow(i, row_id))
+                    {
+                        m_row2node_map[row_id].push_back(i);
+                    }
+                }
+            }
+
+            // sort cells within rows
+#pragma omp parallel for num_threads (num_threads) schedule(dynamic, 1)
+            for (int i = 0; i < num_rows; ++i)
+            {
+                sortRowNodes(x, node_size_x, num_movable_nodes, m_row2node_map[i]);
+            }
+
+            // record the bottom row of each cell
+            for (int i = num_rows-1; i >= 0; --i)
+            {
+                auto const& row2nodes = m_row2node_map[i];
+                for (int j = 0, je = row2nodes.size(); j < je; ++j)
+                {
+                    Location& loc = m_node2row_map[row2nodes[j]];
+                    loc.row_id = i;
+                    loc.sub_id = j;
+                }
+            }
+        }
+
+        /// @return number of rows
+        int numRows() const {return m_row2node_map.size();}
+        /// @return cells in a row from left to right
+        const std::vector<int>& row(int row_id) const {return m_row2node_map[row_id];}
+        /// @return cells of all rows
+        const std::vector<std::vector<int> >& rows() const {return m_row2node_map;}
+        /// @return location of a cell
+        const Location& location(int node_id) const {return m_node2row_map[node_id];}
+
+        /// @return the cell on the left of a cell in its bottom row, -1 if none
+        int prev(int node_id) const
+        {
+            auto const& loc = m_node2row_map[node_id];
+            return (loc.sub_id > 0)? m_row2node_map[loc.row_id][loc.sub_id-1] : -1;
+        }
+        /// @return the cell on the right of a cell in its bottom row, -1 if none
+        int next(int node_id) const
+        {
+            auto const& loc = m_node2row_map[node_id];
+            return (loc.row_id >= 0 && loc.sub_id+1 < (int)m_row2node_map[loc.row_id].size())? m_row2node_map[loc.row_id][loc.sub_id+1] : -1;
+        }
+        /// @brief whitespace around a cell in its bottom row,
+        /// from the right edge of the left neighbor to the left edge of the right neighbor,
+        /// clamped to the layout
+        void space(int node_id, T& space_xl, T& space_xh) const
+        {
+            space_xl = m_xl;
+            space_xh = m_xh;
+            int left_node_id = prev(node_id);
+            if (left_node_id >= 0)
+            {
+                space_xl = std::max(space_xl, m_x[left_node_id]+m_node_size_x[left_node_id]);
+            }
+            int right_node_id = next(node_id);
+            if (right_node_id >= 0)
+            {
+                space_xh = std::min(space_xh, m_x[right_node_id]);
+            }
+        }
+        /// @return index of the first cell in a row whose right edge is no smaller than xx
+        int lowerBound(int row_id, T xx) const
+        {
+            auto const& row2nodes = m_row2node_map[row_id];
+            return std::lower_bound(row2nodes.begin(), row2nodes.end(), xx,
+                    [&](int node_id, T value) {
+                    return m_x[node_id]+m_node_size_x[node_id] < value;
+                    }) - row2nodes.begin();
+        }
+
+        /// @brief exchange the slots of two single-row cells after their locations are exchanged
+        void swap(int node_id1, int node_id2)
+        {
+            Location& loc1 = m_node2row_map[node_id1];
+            Location& loc2 = m_node2row_map[node_id2];
+            std::swap(m_row2node_map[loc1.row_id][loc1.sub_id], m_row2node_map[loc2.row_id][loc2.sub_id]);
+            std::swap(loc1, loc2);
+        }
+        /// @brief put a single-row cell to a slot of its row,
+        /// used to write back cells reordered among their own slots
+        void assign(int row_id, int sub_id, int node_id)
+        {
+            m_row2node_map[row_id][sub_id] = node_id;
+            m_node2row_map[node_id].sub_id = sub_id;
+        }
+        /// @brief put a single-row cell to a slot of any row,
+        /// used to write back cells moved among the slots of each other, possibly in different rows
+        void assign(const Location& loc, int node_id)
+        {
+            m_row2node_map[loc.row_id][loc.sub_id] = node_id;
+            m_node2row_map[node_id] = loc;
+        }
+        /// @brief restore the order of a single-row cell moved horizontally within its row
+        void update(int node_id)
+        {
+            Location& loc = m_node2row_map[node_id];
+            auto& row2nodes = m_row2node_map[loc.row_id];
+            T center = m_x[node_id]+m_node_size_x[node_id]/2;
+            int j = loc.sub_id;
+            while (j > 0 && before(center, node_id, row2nodes[j-1]))
+            {
+                row2nodes[j] = row2nodes[j-1];
+                m_node2row_map[row2nodes[j]].sub_id = j;
+                --j;
+            }
+            while (j+1 < (int)row2nodes.size() && !before(center, node_id, row2nodes[j+1]))
+            {
+                row2nodes[j] = row2nodes[j+1];
+                m_node2row_map[row2nodes[j]].sub_id = j;
+                ++j;
+            }
+            row2nodes[j] = node_id;
+            loc.sub_id = j;
+        }
+
+        /// @brief check whether cells are still sorted and recorded in the rows they overlap,
+        /// which is cheaper than rebuilding the index
+        bool check() const
+        {
+            for (int i = 0, ie = m_row2node_map.size(); i < ie; ++i)
+            {
+                auto const& row2nodes = m_row2node_map[i];
+                for (int j = 0, je = row2nodes.size(); j < je; ++j)
+                {
+                    int node_id = row2nodes[j];
+                    if (!overlapRow(node_id, i))
+                    {
+                        dreamplacePrint(kERROR, "node %d not in row %d\n", node_id, i);
+                        return false;
+                    }
+                    if (j && before(m_x[node_id]+m_node_size_x[node_id]/2, node_id, row2nodes[j-1]))
+                    {
+                        dreamplacePrint(kERROR, "node %d not sorted in row %d\n", node_id, i);
+                        return false;
+                    }
+                }
+            }
+            for (int i = 0, ie = std::min(m_num_movable_nodes, (int)m_node2row_map.size()); i < ie; ++i)
+            {
+                int row_idxl, row_idxh;
+                rowRange(i, row_idxl, row_idxh);
+                while (row_idxl < row_idxh && !overlapRow(i, row_idxl))
+                {
+                    ++row_idxl;
+                }
+                auto const& loc = m_node2row_map[i];
+                int row_id = (row_idxl < row_idxh)? row_idxl : -1;
+                if (loc.row_id != row_id || (row_id >= 0 && m_row2node_map[row_id][loc.sub_id] != i))
+                {
+                    dreamplacePrint(kERROR, "node %d wrong location in row %d\n", i, loc.row_id);
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    protected:
+        /// @brief candidate rows [row_idxl, row_idxh) of a cell
+        void rowRange(int node_id, int& row_idxl, int& row_idxh) const
+        {
+            T node_yl = m_y[node_id];
+            T node_yh = node_yl+m_node_size_y[node_id];
+            row_idxl = std::max((int)((node_yl-m_yl)/m_row_height), 0);
+            row_idxh = std::min((int)std::ceil((node_yh-m_yl)/m_row_height)+1, (int)m_row2node_map.size());
+        }
+        /// @return true if a cell overlaps with a row
+        bool overlapRow(int node_id, int row_id) const
+        {
+            T node_yl = m_y[node_id];
+            T node_yh = node_yl+m_node_size_y[node_id];
+            T row_yl = m_yl+row_id*m_row_height;
+            T row_yh = row_yl+m_row_height;
+            return node_yl < row_yh && node_yh > row_yl;
+        }
+        /// @return true if a cell with center is ordered before another cell
+        bool before(T center, int node_id, int other_node_id) const
+        {
+            T other_center = m_x[other_node_id]+m_node_size_x[other_node_id]/2;
+            return center < other_center || (center == other_center && node_id < other_node_id);
+        }
+
+        const T* m_x;
+        const T* m_y;
+        const T* m_node_size_x;
+        const T* m_node_size_y;
+        T m_xl;
+        T m_yl;
+        T m_xh;
+        T m_row_height;
+        int m_num_movable_nodes;
+        std::vector<std::vector<int> > m_row2node_map; ///< cells of each row from left to right
+        std::vector<Location> m_node2row_map; ///< location of each cell
+};
+
+DREAMPLACE_END_NAMESPACE
+
+#endif
@@ -4,6 +4,7 @@
  * @date   Oct 2018
  */
 #include <iostream>
+#include "utility/src/LegalizationDB.h"
 #include "abacus_legalize/src/abacus_legalize_cpu.h"
 
 DREAMPLACE_BEGIN_NAMESPACE
@@ -43,9 +44,114 @@ void test_row()
     printf("\n");
 }
 
+/// rows with 2-row and 3-row cells among single-row cells, 
+/// starting from a legal placement like the one from greedy legalization, 
+/// with target locations scattered around it 
+/// @param sol_x x locations after legalization 
+bool test_multi_row(int num_bins_x, int num_threads, std::vector<double>& sol_x)
+{
+    double xl = 0, yl = 0, xh = 100, yh = 80; 
+    double site_width = 1, row_height = 10; 
+    int num_rows = 8; 
+    std::vector<double> init_x, init_y, node_size_x, node_size_y, x; 
+    unsigned int seed = 1; 
+    auto rand = [&](int n){seed = seed*1103515245+12345; return (int)((seed>>16)%n);};
+    // right end of the cells in each row 
+    std::vector<double> row_ends (num_rows, xl); 
+    for (int k = 0; k < 300; ++k)
+    {
+        int num_node_rows = 1; 
+        int r = rand(10); 
+        if (r == 0) num_node_rows = 2; 
+        else if (r == 1) num_node_rows = 3; 
+        int row_id = rand(num_rows-num_node_rows+1); 
+        if (!isPowerRailAligned(row_id, num_node_rows))
+        {
+            row_id -= 1; 
+        }
+        double width = 1+rand(4); 
+        double xx = xl; 
+        for (int i = row_id; i < row_id+num_node_rows; ++i)
+        {
+            xx = std::max(xx, row_ends[i]); 
+        }
+        xx += rand(3)*site_width; 
+        if (xx+width > xh)
+        {
+            continue; 
+        }
+        for (int i = row_id; i < row_id+num_node_rows; ++i)
+        {
+            row_ends[i] = xx+width; 
+        }
+        x.push_back(xx); 
+        init_x.push_back(std::max(std::min(xx+rand(21)-10+rand(10)/10.0, xh-width), xl)); 
+        init_y.push_back(yl+row_id*row_height); 
+        node_size_x.push_back(width); 
+        node_size_y.push_back(num_node_rows*row_height); 
+    }
+    int num_nodes = init_x.size(); 
+    int num_movable_nodes = num_nodes; 
+    std::vector<double> y = init_y; 
+
+    abacusLegalizationCPU(
+            init_x.data(), init_y.data(), 
+            node_size_x.data(), node_size_y.data(), 
+            x.data(), y.data(), 
+            xl, yl, xh, yh, 
+            site_width, row_height, 
+            num_bins_x, num_rows, 
+            num_nodes, 
+            num_movable_nodes, 
+            num_threads
+            );
+
+    bool legal = true; 
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        int row_id = (y[i]-yl)/row_height; 
+        int num_node_rows = node_size_y[i]/row_height; 
+        if (y[i] != init_y[i] || !isPowerRailAligned(row_id, num_node_rows))
+        {
+            printf("node %d (%g, %g) with %d rows is not power rail aligned\n", i, x[i], y[i], num_node_rows); 
+            legal = false; 
+        }
+        if (x[i] < xl || x[i]+node_size_x[i] > xh || x[i] != xl+floor((x[i]-xl)/site_width)*site_width)
+        {
+            printf("node %d (%g, %g) is not aligned to sites\n", i, x[i], y[i]); 
+            legal = false; 
+        }
+        for (int j = i+1; j < num_nodes; ++j)
+        {
+            if (x[i] < x[j]+node_size_x[j] && x[j] < x[i]+node_size_x[i] && y[i] < y[j]+node_size_y[j] && y[j] < y[i]+node_size_y[i])
+            {
+                printf("node %d (%g, %g) overlaps with node %d (%g, %g)\n", i, x[i], y[i], j, x[j], y[j]); 
+                legal = false; 
+            }
+        }
+    }
+    printf("multi-row with %d bins in x, %d threads: %d cells, %s\n", num_bins_x, num_threads, num_nodes, (legal)? "legal" : "illegal"); 
+    sol_x = x; 
+    return legal; 
+}
+
 DREAMPLACE_END_NAMESPACE
 
 int main()
 {
     DREAMPLACE_NAMESPACE::test_row(); 
+    bool legal = true; 
+    for (int num_bins_x = 1; num_bins_x <= 2; ++num_bins_x)
+    {
+        std::vector<double> x1, x4; 
+        legal &= DREAMPLACE_NAMESPACE::test_multi_row(num_bins_x, 1, x1); 
+        // rows are clustered in parallel, which should not change the result 
+        legal &= DREAMPLACE_NAMESPACE::test_multi_row(num_bins_x, 4, x4); 
+        if (x1 != x4)
+        {
+            printf("multi-row with %d bins in x: results differ between 1 and 4 threads\n", num_bins_x); 
+            legal = false; 
+        }
+    }
+    return (legal)? 0 : 1; 
 }
@@ -0,0 +1,221 @@
+##
+# @file   detailed_place_unitest.py
+# @author agent
+# @date   Oct 2026
+#
+
+import os
+import sys
+import numpy as np
+import unittest
+
+import torch
+from torch.autograd import Function, Variable
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))))
+from dreamplace.ops.detailed_place import detailed_place
+from dreamplace.ops.k_reorder import k_reorder
+from dreamplace.ops.independent_set_matching import independent_set_matching
+from dreamplace.ops.global_swap import global_swap
+from dreamplace.ops.legality_check import legality_check
+sys.path.pop()
+
+def flatten_2D_map(net2pin_map):
+    num_pins = 0
+    for pins in net2pin_map:
+        num_pins += len(pins)
+    # pin2net_map
+    pin2net_map = np.zeros(num_pins, dtype=np.int32)
+    for net_id, pins in enumerate(net2pin_map):
+        for pin in pins:
+            pin2net_map[pin] = net_id
+    # construct flat_net2pin_map and flat_net2pin_start_map
+    # flat netpin map, length of #pins
+    flat_net2pin_map = np.zeros(num_pins, dtype=np.int32)
+    # starting index in netpin map for each net, length of #nets+1, the last entry is #pins
+    flat_net2pin_start_map = np.zeros(len(net2pin_map)+1, dtype=np.int32)
+    count = 0
+    for i in range(len(net2pin_map)):
+        flat_net2pin_map[count:count+len(net2pin_map[i])] = net2pin_map[i]
+        flat_net2pin_start_map[i] = count
+        count += len(net2pin_map[i])
+    flat_net2pin_start_map[len(net2pin_map)] = num_pins
+
+    return pin2net_map, flat_net2pin_map, flat_net2pin_start_map
+
+class RandomDesign(object):
+    """ legal placement of single-row and double-row cells in pairs of rows,
+    with random nets among nearby cells
+    """
+    def __init__(self, num_rows, num_sites, seed):
+        rng = np.random.RandomState(seed)
+        self.dtype = np.float64
+        self.xl = 0.0
+        self.yl = 0.0
+        self.xh = float(num_sites)
+        self.row_height = 10.0
+        self.yh = num_rows*self.row_height
+        self.site_width = 1.0
+        xx = []
+        yy = []
+        node_size_x = []
+        node_size_y = []
+        for row in range(0, num_rows-1, 2):
+            y = row*self.row_height
+            site = 0
+            while True:
+                site += rng.randint(3)
+                if rng.randint(8) == 0:
+                    # double-row cell covering both rows
+                    width = 2+rng.randint(3)
+                    if site+width > num_sites:
+                        break
+                    xx.append(site)
+                    yy.append(y)
+                    node_size_x.append(width)
+                    node_size_y.append(2*self.row_height)
+                    site += width
+                else:
+                    # a single-row cell in each row
+                    width0 = 1+rng.randint(4)
+                    width1 = 1+rng.randint(4)
+                    site1 = site+rng.randint(2)
+                    if max(site+width0, site1+width1) > num_sites:
+                        break
+                    xx.extend([site, site1])
+                    yy.extend([y, y+self.row_height])
+                    node_size_x.extend([width0, width1])
+                    node_size_y.extend([self.row_height, self.row_height])
+                    site = max(site+width0, site1+width1)
+        self.xx = np.array(xx, dtype=self.dtype)
+        self.yy = np.array(yy, dtype=self.dtype)
+        self.node_size_x = np.array(node_size_x, dtype=self.dtype)
+        self.node_size_y = np.array(node_size_y, dtype=self.dtype)
+        self.num_nodes = len(xx)
+        self.num_movable_nodes = self.num_nodes
+
+        # each net connects a cell to cells close to it in the order of placement
+        net2pin_map = []
+        node2pin_map = [[] for i in range(self.num_nodes)]
+        pin2node_map = []
+        for net_id in range(self.num_nodes):
+            center = rng.randint(self.num_nodes)
+            pins = []
+            for k in range(2+rng.randint(3)):
+                node_id = center if k == 0 else min(max(center+rng.randint(-100, 100), 0), self.num_nodes-1)
+                pins.append(len(pin2node_map))
+                node2pin_map[node_id].append(len(pin2node_map))
+                pin2node_map.append(node_id)
+            net2pin_map.append(pins)
+        self.pin2net_map, self.flat_net2pin_map, self.flat_net2pin_start_map = flatten_2D_map(net2pin_map)
+        self.flat_node2pin_map = np.concatenate([np.array(pins, dtype=np.int32) for pins in node2pin_map])
+        self.flat_node2pin_start_map = np.cumsum([0] + [len(pins) for pins in node2pin_map]).astype(np.int32)
+        self.pin2node_map = np.array(pin2node_map, dtype=np.int32)
+        self.pin_offset_x = self.node_size_x[self.pin2node_map]/2
+        self.pin_offset_y = np.full(len(pin2node_map), self.row_height/2, dtype=self.dtype)
+        self.net_mask = np.ones(len(net2pin_map), dtype=np.uint8)
+        self.flat_region_boxes = np.zeros(0, dtype=self.dtype)
+        self.flat_region_boxes_start = np.array([0], dtype=np.int32)
+        self.node2fence_region_map = np.full(self.num_movable_nodes, np.iinfo(np.int32).max, dtype=np.int32)
+        self.num_bins_x = 16
+        self.num_bins_y = 16
+
+    def common_args(self):
+        """ arguments shared by all detailed placement ops """
+        return dict(
+                node_size_x=torch.from_numpy(self.node_size_x), node_size_y=torch.from_numpy(self.node_size_y),
+                flat_region_boxes=torch.from_numpy(self.flat_region_boxes), flat_region_boxes_start=torch.from_numpy(self.flat_region_boxes_start), node2fence_region_map=torch.from_numpy(self.node2fence_region_map),
+                flat_net2pin_map=torch.from_numpy(self.flat_net2pin_map), flat_net2pin_start_map=torch.from_numpy(self.flat_net2pin_start_map), pin2net_map=torch.from_numpy(self.pin2net_map),
+                flat_node2pin_map=torch.from_numpy(self.flat_node2pin_map), flat_node2pin_start_map=torch.from_numpy(self.flat_node2pin_start_map), pin2node_map=torch.from_numpy(self.pin2node_map),
+                pin_offset_x=torch.from_numpy(self.pin_offset_x), pin_offset_y=torch.from_numpy(self.pin_offset_y),
+                net_mask=torch.from_numpy(self.net_mask),
+                xl=self.xl, yl=self.yl, xh=self.xh, yh=self.yh,
+                site_width=self.site_width, row_height=self.row_height,
+                num_bins_x=self.num_bins_x, num_bins_y=self.num_bins_y,
+                num_movable_nodes=self.num_movable_nodes,
+                num_terminal_NIs=0,
+                num_filler_nodes=0
+                )
+
+    def pos(self):
+        return Variable(torch.from_numpy(np.concatenate([self.xx, self.yy])))
+
+    def hpwl(self, pos):
+        x = pos[:self.num_nodes][self.pin2node_map] + self.pin_offset_x
+        y = pos[self.num_nodes:][self.pin2node_map] + self.pin_offset_y
+        hpwl = 0
+        for net_id in range(len(self.net_mask)):
+            pins = self.flat_net2pin_map[self.flat_net2pin_start_map[net_id]:self.flat_net2pin_start_map[net_id+1]]
+            hpwl += x[pins].max()-x[pins].min() + y[pins].max()-y[pins].min()
+        return hpwl
+
+    def legal(self, pos):
+        check = legality_check.LegalityCheck(
+                node_size_x=torch.from_numpy(self.node_size_x), node_size_y=torch.from_numpy(self.node_size_y),
+                flat_region_boxes=torch.from_numpy(self.flat_region_boxes), flat_region_boxes_start=torch.from_numpy(self.flat_region_boxes_start), node2fence_region_map=torch.from_numpy(self.node2fence_region_map),
+                xl=self.xl, yl=self.yl, xh=self.xh, yh=self.yh,
+                site_width=self.site_width, row_height=self.row_height,
+                num_terminals=0,
+                num_movable_nodes=self.num_movable_nodes,
+                num_threads=1
+                )
+        return check(pos)
+
+class DetailedPlaceOpTest(unittest.TestCase):
+    def run_schedule(self, design, max_rounds, num_shards, num_threads):
+        custom = detailed_place.DetailedPlace(
+                node_flip_x=torch.zeros(design.num_movable_nodes, dtype=torch.uint8),
+                passes=("k_reorder", "independent_set_matching", "global_swap", "k_reorder"),
+                max_rounds=max_rounds,
+                # run all rounds to compare with the separate ops
+                stop_threshold=0,
+                K=4,
+                k_reorder_max_iters=2,
+                ism_batch_size=64,
+                ism_set_size=16,
+                ism_max_iters=10,
+                gs_batch_size=64,
+                gs_max_iters=2,
+                gs_bin_ratio=2,
+                num_shards=num_shards,
+                num_threads=num_threads,
+                **design.common_args())
+        result = custom(design.pos())
+        self.assertTrue(custom.legal)
+        return result
+
+    def test_schedule(self):
+        design = RandomDesign(num_rows=40, num_sites=300, seed=7)
+        pos = design.pos()
+        result = self.run_schedule(design, max_rounds=2, num_shards=1, num_threads=1)
+
+        self.assertTrue(design.legal(result))
+        self.assertLessEqual(design.hpwl(result.numpy()), design.hpwl(pos.numpy()))
+
+        # the same passes as separate ops, each building its own indices
+        kr = k_reorder.KReorder(K=4, max_iters=2, num_threads=1, **design.common_args())
+        ism_args = design.common_args()
+        ism = independent_set_matching.IndependentSetMatching(batch_size=64, set_size=16, max_iters=10, algorithm="concurrent", num_threads=1, **ism_args)
+        gs_args = design.common_args()
+        gs_args["num_bins_x"] = design.num_bins_x//2
+        gs_args["num_bins_y"] = design.num_bins_y//2
+        gs = global_swap.GlobalSwap(batch_size=64, max_iters=2, algorithm="concurrent", num_threads=1, **gs_args)
+        golden = pos
+        for i in range(2):
+            golden = kr(golden)
+            golden = ism(golden)
+            golden = gs(golden)
+            golden = kr(golden)
+
+        np.testing.assert_allclose(result.numpy(), golden.numpy())
+
+    def test_shards(self):
+        design = RandomDesign(num_rows=40, num_sites=300, seed=7)
+        pos = design.pos()
+        result = self.run_schedule(design, max_rounds=2, num_shards=4, num_threads=4)
+
+        self.assertTrue(design.legal(result))
+        self.assertLessEqual(design.hpwl(result.numpy()), design.hpwl(pos.numpy()))
+
+if __name__ == '__main__':
+    unittest.main()
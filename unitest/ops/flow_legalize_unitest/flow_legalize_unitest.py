@@ -0,0 +1,80 @@
+##
+# @file   flow_legalize_unitest.py
+# @author agent
+# @date   Oct 2026
+#
+
+import os 
+import sys
+import numpy as np
+import unittest
+
+import torch
+from torch.autograd import Function, Variable
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))))
+from dreamplace.ops.flow_legalize import flow_legalize
+sys.path.pop()
+
+class FlowLegalizeOpTest(unittest.TestCase):
+    def test_flowLegalizeRandom(self):
+        dtype = np.float64
+        np.random.seed(1)
+        xl = 0.0 
+        yl = 0.0 
+        xh = 100.0
+        yh = 40.0
+        site_width = 1 
+        row_height = 4 
+        # movable cells crowded at the center, and one fixed macro 
+        num_movable_nodes = 200 
+        node_size_x = np.concatenate([np.random.randint(1, 6, num_movable_nodes), [20]]).astype(dtype)
+        node_size_y = np.concatenate([np.full(num_movable_nodes, row_height), [3*row_height]]).astype(dtype)
+        xx = np.concatenate([np.random.normal(50, 10, num_movable_nodes), [10]]).clip(xl, xh-node_size_x).astype(dtype)
+        yy = np.concatenate([np.random.normal(20, 5, num_movable_nodes), [12]]).clip(yl, yh-node_size_y).astype(dtype)
+        num_terminal_NIs = 0 
+        num_filler_nodes = 0
+        flat_region_boxes = np.zeros(0, dtype=dtype)
+        flat_region_boxes_start = np.array([0], dtype=np.int32)
+        node2fence_region_map = np.full(num_movable_nodes, np.iinfo(np.int32).max, dtype=np.int32)
+
+        custom = flow_legalize.FlowLegalize(
+                    torch.from_numpy(node_size_x), torch.from_numpy(node_size_y), 
+                    torch.from_numpy(flat_region_boxes), torch.from_numpy(flat_region_boxes_start), torch.from_numpy(node2fence_region_map), 
+                    xl=xl, yl=yl, xh=xh, yh=yh, 
+                    site_width=site_width, row_height=row_height, 
+                    num_movable_nodes=num_movable_nodes, 
+                    num_terminal_NIs=num_terminal_NIs, 
+                    num_filler_nodes=num_filler_nodes, 
+                    max_displacement=5*row_height)
+
+        pos = Variable(torch.from_numpy(np.concatenate([xx, yy])))
+        result = custom(pos, pos).numpy()
+        num_nodes = len(xx)
+        x = result[:num_nodes]
+        y = result[num_nodes:]
+
+        # fixed macro is not moved 
+        np.testing.assert_allclose(x[num_movable_nodes:], xx[num_movable_nodes:])
+        np.testing.assert_allclose(y[num_movable_nodes:], yy[num_movable_nodes:])
+        # aligned to rows and sites, within the layout 
+        np.testing.assert_allclose(np.fmod(y[:num_movable_nodes]-yl, row_height), 0)
+        np.testing.assert_allclose(np.fmod(x[:num_movable_nodes]-xl, site_width), 0)
+        self.assertTrue(np.all(x >= xl) and np.all(x+node_size_x <= xh))
+        self.assertTrue(np.all(y >= yl) and np.all(y+node_size_y <= yh))
+        # no overlap 
+        for i in range(num_nodes): 
+            for j in range(i+1, num_nodes): 
+                dx = min(x[i]+node_size_x[i], x[j]+node_size_x[j]) - max(x[i], x[j])
+                dy = min(y[i]+node_size_y[i], y[j]+node_size_y[j]) - max(y[i], y[j])
+                self.assertFalse(dx > 0 and dy > 0, "node %d overlaps with node %d" % (i, j))
+
+        # displacement statistics 
+        displacement = np.abs(x-xx)[:num_movable_nodes] + np.abs(y-yy)[:num_movable_nodes]
+        np.testing.assert_allclose(custom.displacement.numpy(), displacement)
+        avg_displacement, max_displacement, num_exceeded = custom.displacement_statistics()
+        print("average displacement = %g, max displacement = %g, %d cells exceed the bound" % (avg_displacement, max_displacement, num_exceeded))
+        np.testing.assert_allclose(max_displacement, displacement.max())
+
+if __name__ == '__main__':
+    unittest.main()
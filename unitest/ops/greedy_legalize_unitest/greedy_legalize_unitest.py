@@ -16,6 +16,7 @@ from torch.autograd import Function, Variable
 
 sys.path.append(os.path.dirname(os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))))
 from dreamplace.ops.greedy_legalize import greedy_legalize
+from dreamplace.ops.legality_check import legality_check
 sys.path.pop()
 
 def plot(figname, 
@@ -197,5 +198,76 @@ class GreedyLegalizeOpTest(unittest.TestCase):
 
             #np.testing.assert_allclose(result, result_cuda.data.cpu())
 
+    def test_greedyLegalizeFenceRegions(self):
+        """ two fence regions and the default region;
+        region 1 has two boxes stacked in the middle of a row, which only cover the row together,
+        and a box covering half of a row, which must stay blocked
+        """
+        dtype = np.float64
+        rng = np.random.RandomState(5)
+        xl = 0.0
+        yl = 0.0
+        xh = 200.0
+        yh = 100.0
+        site_width = 1.0
+        row_height = 10.0
+        region_boxes = [
+                [[10, 0, 60, 40]],
+                [[100, 0, 160, 15], [100, 15, 160, 40], [160, 0, 190, 40], [100, 40, 130, 45]]
+                ]
+        flat_region_boxes = np.array(region_boxes[0]+region_boxes[1], dtype=dtype).ravel()
+        flat_region_boxes_start = np.array([0, len(region_boxes[0]), len(region_boxes[0])+len(region_boxes[1])], dtype=np.int32)
+        num_movable_nodes = 180
+        # cells are assigned to region 0, region 1 and the default region in turn
+        node2fence_region_map = np.array([i%3 if i%3 < 2 else np.iinfo(np.int32).max for i in range(num_movable_nodes)], dtype=np.int32)
+        xx = rng.uniform(0, 190, num_movable_nodes).astype(dtype)
+        yy = rng.uniform(0, 90, num_movable_nodes).astype(dtype)
+        node_size_x = rng.randint(1, 5, num_movable_nodes).astype(dtype)
+        node_size_y = np.full(num_movable_nodes, row_height, dtype=dtype)
+
+        custom = greedy_legalize.GreedyLegalize(
+                    torch.from_numpy(node_size_x), torch.from_numpy(node_size_y),
+                    torch.from_numpy(flat_region_boxes), torch.from_numpy(flat_region_boxes_start), torch.from_numpy(node2fence_region_map),
+                    xl=xl, yl=yl, xh=xh, yh=yh,
+                    site_width=site_width, row_height=row_height,
+                    num_bins_x=4, num_bins_y=4,
+                    num_movable_nodes=num_movable_nodes,
+                    num_terminal_NIs=0,
+                    num_filler_nodes=0,
+                    num_threads=2)
+        pos = Variable(torch.from_numpy(np.concatenate([xx, yy])))
+        result = custom(pos, pos.clone()).numpy()
+        x = result[:num_movable_nodes]
+        y = result[num_movable_nodes:]
+
+        check = legality_check.LegalityCheck(
+                    torch.from_numpy(node_size_x), torch.from_numpy(node_size_y),
+                    torch.from_numpy(flat_region_boxes), torch.from_numpy(flat_region_boxes_start), torch.from_numpy(node2fence_region_map),
+                    xl=xl, yl=yl, xh=xh, yh=yh,
+                    site_width=site_width, row_height=row_height,
+                    num_terminals=0,
+                    num_movable_nodes=num_movable_nodes,
+                    num_threads=1)
+        self.assertTrue(check(torch.from_numpy(result)))
+
+        def inside(px, py, boxes):
+            for box in boxes:
+                if box[0] < px < box[2] and box[1] < py < box[3]:
+                    return True
+            return False
+        # every site a cell covers is inside its fence, or outside all fences for the default region
+        for i in range(num_movable_nodes):
+            for px in np.arange(x[i]+site_width/2, x[i]+node_size_x[i], site_width):
+                # a row may be covered by boxes stacked at its middle
+                for py in (y[i]+row_height/4, y[i]+row_height*3/4):
+                    if node2fence_region_map[i] < 2:
+                        self.assertTrue(inside(px, py, region_boxes[node2fence_region_map[i]]), "cell %d at (%g, %g) out of region %d" % (i, x[i], y[i], node2fence_region_map[i]))
+                    else:
+                        self.assertFalse(inside(px, py, region_boxes[0]+region_boxes[1]), "cell %d at (%g, %g) in a fence region" % (i, x[i], y[i]))
+        # the row covered by the stacked boxes together is available to region 1
+        self.assertTrue(np.any((node2fence_region_map == 1) & (y == 10) & (x >= 100) & (x < 160)))
+        # the row covered by half only is not
+        self.assertFalse(np.any((node2fence_region_map == 1) & (y == 40)))
+
 if __name__ == '__main__':
     unittest.main()
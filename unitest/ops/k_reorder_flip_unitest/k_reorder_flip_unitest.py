@@ -0,0 +1,83 @@
+##
+# @file   k_reorder_flip_unitest.py
+# @author agent
+# @date   Oct 2026
+#
+
+import os
+import sys
+import numpy as np
+import unittest
+
+import torch
+from torch.autograd import Function, Variable
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))))
+from dreamplace.ops.k_reorder_flip import k_reorder_flip
+sys.path.pop()
+
+class KReorderFlipOpTest(unittest.TestCase):
+    def test_kReorderFlip(self):
+        dtype = np.float64
+        xl = 0.0
+        yl = 0.0
+        xh = 20.0
+        yh = 2.0
+        site_width = 1
+        row_height = 1
+        # two movable cells in a row, and a fixed cell on the right
+        # the only net connects the left pin of cell 0 to the fixed cell,
+        # so cell 0 should move to the right of cell 1 and be flipped
+        num_movable_nodes = 2
+        node_size_x = np.array([4, 2, 1], dtype=dtype)
+        node_size_y = np.array([1, 1, 1], dtype=dtype)
+        xx = np.array([2, 8, 19], dtype=dtype)
+        yy = np.array([0, 0, 0], dtype=dtype)
+        pin_offset_x = np.array([0.5, 0.5, 1], dtype=dtype)
+        pin_offset_y = np.array([0.5, 0.5, 0.5], dtype=dtype)
+        pin2node_map = np.array([0, 2, 1], dtype=np.int32)
+        pin2net_map = np.array([0, 0, 1], dtype=np.int32)
+        flat_net2pin_map = np.array([0, 1, 2], dtype=np.int32)
+        flat_net2pin_start_map = np.array([0, 2, 3], dtype=np.int32)
+        flat_node2pin_map = np.array([0, 2, 1], dtype=np.int32)
+        flat_node2pin_start_map = np.array([0, 1, 2, 3], dtype=np.int32)
+        net_mask = np.array([1, 0], dtype=np.uint8)
+        num_terminal_NIs = 0
+        num_filler_nodes = 0
+        flat_region_boxes = np.zeros(0, dtype=dtype)
+        flat_region_boxes_start = np.array([0], dtype=np.int32)
+        node2fence_region_map = np.full(num_movable_nodes, np.iinfo(np.int32).max, dtype=np.int32)
+
+        pin_offset_x_tensor = torch.from_numpy(pin_offset_x.copy())
+        node_flip_x = torch.zeros(num_movable_nodes, dtype=torch.uint8)
+        custom = k_reorder_flip.KReorderFlip(
+                    torch.from_numpy(node_size_x), torch.from_numpy(node_size_y),
+                    torch.from_numpy(flat_region_boxes), torch.from_numpy(flat_region_boxes_start), torch.from_numpy(node2fence_region_map),
+                    torch.from_numpy(flat_net2pin_map), torch.from_numpy(flat_net2pin_start_map), torch.from_numpy(pin2net_map),
+                    torch.from_numpy(flat_node2pin_map), torch.from_numpy(flat_node2pin_start_map), torch.from_numpy(pin2node_map),
+                    pin_offset_x_tensor, torch.from_numpy(pin_offset_y),
+                    torch.from_numpy(net_mask),
+                    node_flip_x,
+                    xl=xl, yl=yl, xh=xh, yh=yh,
+                    site_width=site_width, row_height=row_height,
+                    num_bins_x=1, num_bins_y=1,
+                    num_movable_nodes=num_movable_nodes,
+                    num_terminal_NIs=num_terminal_NIs,
+                    num_filler_nodes=num_filler_nodes,
+                    K=4,
+                    max_iters=2)
+
+        pos = Variable(torch.from_numpy(np.concatenate([xx, yy])))
+        result = custom(pos).numpy()
+        num_nodes = len(xx)
+        x = result[:num_nodes]
+        y = result[num_nodes:]
+
+        np.testing.assert_allclose(x, [13, 2, 19])
+        np.testing.assert_allclose(y, yy)
+        # cell 0 is flipped with its pin mirrored
+        np.testing.assert_array_equal(node_flip_x.numpy(), [1, 0])
+        np.testing.assert_allclose(pin_offset_x_tensor.numpy(), [3.5, 0.5, 1])
+
+if __name__ == '__main__':
+    unittest.main()
@@ -6,6 +6,8 @@
 
 import os 
 import sys
+import shutil
+import tempfile
 import numpy as np 
 import unittest
 
@@ -83,5 +85,36 @@ class PlaceIOOpTest(unittest.TestCase):
 
         np.testing.assert_array_equal(content.strip(), golden.strip())
 
+    def test_snapshot_outdated(self):
+        """ editing a file listed in the .aux file must invalidate the snapshot,
+        even if the .aux file itself is untouched
+        """
+        design = os.path.dirname(os.path.realpath(__file__))
+        tmpdir = tempfile.mkdtemp()
+        try:
+            shutil.copytree(os.path.join(design, "simple"), os.path.join(tmpdir, "simple"))
+            params = Params()
+            params.aux_input = os.path.join(tmpdir, "simple/simple.aux")
+            params.placedb_snapshot = os.path.join(tmpdir, "simple.snapshot")
+
+            # the first read writes the snapshot, and the second one loads it
+            pydb = place_io.PlaceIOFunction.pydb(place_io.PlaceIOFunction.read(params))
+            self.assertTrue(os.path.exists(params.placedb_snapshot))
+            node_id = pydb.node_name2id_map["o0"]
+            self.assertEqual(pydb.node_size_x[node_id], 16)
+            pydb = place_io.PlaceIOFunction.pydb(place_io.PlaceIOFunction.read(params))
+            self.assertEqual(pydb.node_size_x[node_id], 16)
+
+            # widen o0 in .nodes only
+            nodes_file = os.path.join(tmpdir, "simple/simple.nodes")
+            with open(nodes_file, "r") as f:
+                content = f.read()
+            with open(nodes_file, "w") as f:
+                f.write(content.replace("\to0\t16\t24", "\to0\t160\t24"))
+            pydb = place_io.PlaceIOFunction.pydb(place_io.PlaceIOFunction.read(params))
+            self.assertEqual(pydb.node_size_x[node_id], 160)
+        finally:
+            shutil.rmtree(tmpdir)
+
 if __name__ == "__main__":
     unittest.main()